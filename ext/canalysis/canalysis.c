@@ -0,0 +1,429 @@
+#include <ruby.h>
+#include <math.h>
+#include <string.h>
+
+#define R 6371000.0
+
+/* The great circle calculations are compiled like those of ccoord so that
+ * their results match Coord#distance_to and Coord#interpolate exactly,
+ * while the rest of the analysis follows Ruby's floating point. */
+#ifdef __GNUC__
+#define COORD_MATH __attribute__ ((optimize("fast-math")))
+#else
+#define COORD_MATH
+#endif
+
+typedef struct {
+    long n;
+    const double *times;
+    const double *lats;
+    const double *lons;
+    const double *alts;
+    double *s;
+    long s_n;
+} track_t;
+
+typedef struct {
+    double lat;
+    double lon;
+    double alt;
+    double s;
+    int raw;
+} position_t;
+
+typedef struct {
+    long n;
+    long capacity;
+    long *indexes;
+    char *maximums;
+} extremes_t;
+
+void Init_canalysis(void);
+
+static double COORD_MATH
+distance(double lat1, double lon1, double lat2, double lon2)
+{
+    double d = sin(lat1) * sin(lat2) + cos(lat1) * cos(lat2) * cos(lon2 - lon1);
+    return d < 1.0 ? acos(d) : 0.0;
+}
+
+static void COORD_MATH
+interpolate(double lat1, double lon1, double lat2, double lon2, double delta, double *lat3, double *lon3)
+{
+    double cos_lat1 = cos(lat1);
+    double sin_lat1 = sin(lat1);
+    double cos_lat2 = cos(lat2);
+    double sin_lat2 = sin(lat2);
+    double lon = lon2 - lon1;
+    double cos_lon = cos(lon);
+    double d = sin_lat1 * sin_lat2 + cos_lat1 * cos_lat2 * cos_lon;
+    d = d < 1.0 ? delta * acos(d) : 0.0;
+    double theta = atan2(sin(lon) * cos_lat2, cos_lat1 * sin_lat2 - sin_lat1 * cos_lat2 * cos_lon);
+    double cos_d = cos(d);
+    double sin_d = sin(d);
+    *lat3 = asin(sin_lat1 * cos_d + cos_lat1 * sin_d * cos(theta));
+    *lon3 = lon1 + atan2(sin(theta) * sin_d * cos_lat1, cos_d - sin_lat1 * sin(*lat3));
+}
+
+static const double *
+fix_buffer_column(VALUE rb_fix_buffer, const char *name, long n)
+{
+    VALUE rb_column = rb_funcall(rb_fix_buffer, rb_intern(name), 0);
+    Check_Type(rb_column, T_STRING);
+    if (n >= 0 && RSTRING(rb_column)->len != n * (long) sizeof(double))
+        rb_raise(rb_eArgError, "fix buffer %s has %ld bytes, expected %ld", name, (long) RSTRING(rb_column)->len, n * (long) sizeof(double));
+    return (const double *) RSTRING(rb_column)->ptr;
+}
+
+/* Returns the distance along the track to fix i, extending the cumulative
+ * distances as the leading edge of the window advances.  As with
+ * Coord#distance_to, the distance from the first fix to itself may round
+ * to a few centimetres rather than zero. */
+static inline double
+track_s(track_t *track, long i)
+{
+    for (; track->s_n <= i; ++track->s_n) {
+        long j = track->s_n, j0 = j ? j - 1 : 0;
+        track->s[j] = (j ? track->s[j - 1] : 0.0) + R * distance(track->lats[j0], track->lons[j0], track->lats[j], track->lons[j]);
+    }
+    return track->s[i];
+}
+
+/* Sets position to the track's position at time t, where i is the index
+ * of the first fix at or after t, or n if there is none */
+static void
+track_position(track_t *track, long i, double t, position_t *position)
+{
+    if (i == 0 || i == track->n) {
+        long j = i ? i - 1 : 0;
+        position->lat = track->lats[j];
+        position->lon = track->lons[j];
+        position->alt = track->alts[j];
+        position->s = track_s(track, j);
+        position->raw = 1;
+    } else {
+        double k = (t - track->times[i - 1]) / (track->times[i] - track->times[i - 1]);
+        interpolate(track->lats[i - 1], track->lons[i - 1], track->lats[i], track->lons[i], k, &position->lat, &position->lon);
+        position->alt = (1.0 - k) * track->alts[i - 1] + k * track->alts[i];
+        position->s = (1.0 - k) * track_s(track, i - 1) + k * track_s(track, i);
+        position->raw = 0;
+    }
+}
+
+static void
+extremes_push(extremes_t *extremes, long index, int maximum)
+{
+    if (extremes->n == extremes->capacity) {
+        extremes->capacity = extremes->capacity ? 2 * extremes->capacity : 64;
+        REALLOC_N(extremes->indexes, long, extremes->capacity);
+        REALLOC_N(extremes->maximums, char, extremes->capacity);
+    }
+    extremes->indexes[extremes->n] = index;
+    extremes->maximums[extremes->n] = maximum;
+    ++extremes->n;
+}
+
+/* Removes the discarded extremes, merging each run of extremes of the
+ * same kind into its highest maximum or lowest minimum.  Returns non-zero
+ * if any were discarded. */
+static int
+extremes_discard(extremes_t *extremes, char *discard, const double *alts)
+{
+    long i, n = 0;
+    int discarded = 0;
+    for (i = 0; i < extremes->n; ++i)
+        if (discard[i])
+            discarded = 1;
+    if (!discarded)
+        return 0;
+    long best = -1;
+    for (i = 0; i < extremes->n; ++i) {
+        if (discard[i])
+            continue;
+        if (best == -1) {
+            best = i;
+        } else if (extremes->maximums[i] == extremes->maximums[best]) {
+            if (extremes->maximums[best] ? alts[extremes->indexes[i]] > alts[extremes->indexes[best]] : alts[extremes->indexes[i]] < alts[extremes->indexes[best]])
+                best = i;
+        } else {
+            extremes->indexes[n] = extremes->indexes[best];
+            extremes->maximums[n] = extremes->maximums[best];
+            ++n;
+            best = i;
+        }
+    }
+    if (best != -1) {
+        extremes->indexes[n] = extremes->indexes[best];
+        extremes->maximums[n] = extremes->maximums[best];
+        ++n;
+    }
+    extremes->n = n;
+    memset(discard, 0, extremes->n);
+    return 1;
+}
+
+/* Discards extremes whose altitude differences are smaller than absolute
+ * or than relative times those of their neighbours until none remain */
+static void
+extremes_simplify(extremes_t *extremes, const double *alts, double absolute, double relative)
+{
+    char *discard = ALLOC_N(char, extremes->n + 1);
+    memset(discard, 0, extremes->n);
+    int discarded;
+    do {
+        long i;
+#define ALT(j) alts[extremes->indexes[(j)]]
+        for (i = 0; i + 3 < extremes->n; ++i) {
+            double dz03 = fabs(ALT(i + 3) - ALT(i));
+            double dz12 = fabs(ALT(i + 2) - ALT(i + 1));
+            if (dz12 < absolute || dz12 / dz03 < relative) {
+                if (extremes->maximums[i]) {
+                    discard[ALT(i) > ALT(i + 2) ? i + 2 : i] = 1;
+                    discard[ALT(i + 1) < ALT(i + 3) ? i + 3 : i + 1] = 1;
+                } else {
+                    discard[ALT(i) < ALT(i + 2) ? i + 2 : i] = 1;
+                    discard[ALT(i + 1) > ALT(i + 3) ? i + 3 : i + 1] = 1;
+                }
+            }
+        }
+        discarded = extremes_discard(extremes, discard, alts);
+        for (i = 1; i + 1 < extremes->n; ++i) {
+            if (extremes->maximums[i])
+                discard[i] = ALT(i) < ALT(i - 1) || ALT(i) < ALT(i + 1);
+            else
+                discard[i] = ALT(i) > ALT(i - 1) || ALT(i) > ALT(i + 1);
+        }
+        discarded |= extremes_discard(extremes, discard, alts);
+        if (extremes->n > 2) {
+            discard[0] = fabs(ALT(1) - ALT(0)) < absolute;
+            discard[extremes->n - 1] = fabs(ALT(extremes->n - 1) - ALT(extremes->n - 2)) < absolute;
+        }
+        discarded |= extremes_discard(extremes, discard, alts);
+#undef ALT
+    } while (discarded);
+    xfree(discard);
+}
+
+static inline void
+bounds_update(double *bounds, double value)
+{
+    if (value < bounds[0])
+        bounds[0] = value;
+    if (value > bounds[1])
+        bounds[1] = value;
+}
+
+/* Analyses the packed columns of rb_fix_buffer in one pass, averaging the
+ * speed, climb, glide and progress over a window of dt seconds centred on
+ * each fix, finding the altitude extremes and the bounds.  Returns the
+ * speeds, climbs, glides and progresses as packed doubles, the extremes
+ * as an array of pairs of fix index and whether it is a maximum, and the
+ * minimum and maximum latitude, longitude, altitude, speed, climb and
+ * glide. */
+static VALUE
+rb_IGC_analyse_fix_buffer(VALUE rb_self, VALUE rb_fix_buffer, VALUE rb_dt, VALUE rb_absolute, VALUE rb_relative)
+{
+    double dt = NUM2DBL(rb_dt);
+    /* an integer dt gives integer climbs between two unmodified fixes */
+    int integral = FIXNUM_P(rb_dt);
+    double absolute = NUM2DBL(rb_absolute);
+    double relative = NUM2DBL(rb_relative);
+    track_t track;
+    track.n = NUM2LONG(rb_funcall(rb_fix_buffer, rb_intern("length"), 0));
+    if (track.n == 0)
+        rb_raise(rb_eArgError, "no fixes");
+    VALUE rb_speeds = rb_str_new(NULL, track.n * sizeof(double));
+    VALUE rb_climbs = rb_str_new(NULL, track.n * sizeof(double));
+    VALUE rb_glides = rb_str_new(NULL, track.n * sizeof(double));
+    VALUE rb_progresses = rb_str_new(NULL, track.n * sizeof(double));
+    track.times = fix_buffer_column(rb_fix_buffer, "times", track.n);
+    track.lats = fix_buffer_column(rb_fix_buffer, "lats", track.n);
+    track.lons = fix_buffer_column(rb_fix_buffer, "lons", track.n);
+    track.alts = fix_buffer_column(rb_fix_buffer, "alts", track.n);
+    track.s = ALLOC_N(double, track.n);
+    track.s_n = 0;
+    double *speeds = (double *) RSTRING(rb_speeds)->ptr;
+    double *climbs = (double *) RSTRING(rb_climbs)->ptr;
+    double *glides = (double *) RSTRING(rb_glides)->ptr;
+    double *progresses = (double *) RSTRING(rb_progresses)->ptr;
+    double bounds[12] = {
+        track.lats[0], track.lats[0],
+        track.lons[0], track.lons[0],
+        track.alts[0], track.alts[0],
+        0.0, 0.0,
+        -0.5, 0.5,
+        0.0, 0.0,
+    };
+    extremes_t extremes = { 0, 0, NULL, NULL };
+    long last_extreme = 0, i, i0 = 0, i1 = 0;
+    int direction = 0;
+    for (i = 0; i < track.n; ++i) {
+        bounds_update(bounds + 0, track.lats[i]);
+        bounds_update(bounds + 2, track.lons[i]);
+        bounds_update(bounds + 4, track.alts[i]);
+        if (i) {
+            double dz = track.alts[i] - track.alts[i - 1];
+            if (dz < 0.0) {
+                if (direction != -1)
+                    extremes_push(&extremes, last_extreme, 1);
+                direction = -1;
+                last_extreme = i;
+            } else if (dz > 0.0) {
+                if (direction != 1)
+                    extremes_push(&extremes, last_extreme, 0);
+                direction = 1;
+                last_extreme = i;
+            }
+        }
+        position_t position0, position1;
+        double t0 = track.times[i] - 0.5 * dt;
+        while (track.times[i0] < t0)
+            ++i0;
+        track_position(&track, i0, t0, &position0);
+        double t1 = t0 + dt;
+        while (i1 < track.n && track.times[i1] < t1)
+            ++i1;
+        track_position(&track, i1, t1, &position1);
+        double ds = position1.s - position0.s;
+        double dz = position1.alt - position0.alt;
+        double dp = R * distance(position0.lat, position0.lon, position1.lat, position1.lon);
+        speeds[i] = ds / dt;
+        climbs[i] = integral && position0.raw && position1.raw ? floor(dz / dt) : dz / dt;
+        glides[i] = atan2(dz, ds);
+        progresses[i] = ds == 0.0 ? 0.0 : dp / ds;
+        if (i == 0)
+            bounds[7] = speeds[i];
+        bounds_update(bounds + 6, speeds[i]);
+        bounds_update(bounds + 8, climbs[i]);
+        if (i == 0)
+            bounds[10] = bounds[11] = glides[i];
+        bounds_update(bounds + 10, glides[i]);
+    }
+    if (direction)
+        extremes_push(&extremes, last_extreme, direction == 1);
+    xfree(track.s);
+    extremes_simplify(&extremes, track.alts, absolute, relative);
+    VALUE rb_extremes = rb_ary_new2(extremes.n);
+    for (i = 0; i < extremes.n; ++i)
+        rb_ary_push(rb_extremes, rb_assoc_new(LONG2NUM(extremes.indexes[i]), extremes.maximums[i] ? Qtrue : Qfalse));
+    xfree(extremes.indexes);
+    xfree(extremes.maximums);
+    VALUE rb_bounds = rb_ary_new2(12);
+    for (i = 0; i < 12; ++i)
+        rb_ary_push(rb_bounds, rb_float_new(bounds[i]));
+    return rb_ary_new3(6, rb_speeds, rb_climbs, rb_glides, rb_progresses, rb_extremes, rb_bounds);
+}
+
+/* Returns the square of the distance from p to the segment a-b. */
+static inline double
+segment_distance2(const double *p, const double *a, const double *b)
+{
+    double ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    double ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+    double ab2 = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+    double t = ab2 > 0.0 ? (ap[0] * ab[0] + ap[1] * ab[1] + ap[2] * ab[2]) / ab2 : 0.0;
+    if (t < 0.0)
+        t = 0.0;
+    else if (t > 1.0)
+        t = 1.0;
+    double d[3] = { ap[0] - t * ab[0], ap[1] - t * ab[1], ap[2] - t * ab[2] };
+    return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+}
+
+/* Simplifies the track in rb_fix_buffer with the Douglas-Peucker algorithm,
+ * in three dimensions with the fixes at their altitude above a spherical
+ * Earth, so that no fix lies more than tolerance metres from the
+ * simplified track.  Only the fixes first..last (by default all of them)
+ * are simplified.  The first and last fixes and the fixes at the indexes
+ * in rb_keep that lie between them are always kept, and the track is
+ * simplified separately between them.  Returns the indexes of the kept
+ * fixes in order. */
+static VALUE
+rb_IGC_simplify_fix_buffer(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_fix_buffer, rb_tolerance, rb_keep, rb_first, rb_last;
+    rb_scan_args(argc, argv, "32", &rb_fix_buffer, &rb_tolerance, &rb_keep, &rb_first, &rb_last);
+    double tolerance2 = NUM2DBL(rb_tolerance) * NUM2DBL(rb_tolerance);
+    long n = NUM2LONG(rb_funcall(rb_fix_buffer, rb_intern("length"), 0));
+    const double *lats = fix_buffer_column(rb_fix_buffer, "lats", n);
+    const double *lons = fix_buffer_column(rb_fix_buffer, "lons", n);
+    const double *alts = fix_buffer_column(rb_fix_buffer, "alts", n);
+    Check_Type(rb_keep, T_ARRAY);
+    long first = NIL_P(rb_first) ? 0 : NUM2LONG(rb_first);
+    long last = NIL_P(rb_last) ? n - 1 : NUM2LONG(rb_last);
+    if (n == 0)
+        return rb_ary_new();
+    if (first < 0 || last < first || n <= last)
+        rb_raise(rb_eArgError, "invalid range %ld..%ld", first, last);
+    long m = last - first + 1, i;
+    for (i = 0; i < RARRAY(rb_keep)->len; ++i) {
+        long index = NUM2LONG(RARRAY(rb_keep)->ptr[i]);
+        if (index < 0 || n <= index)
+            rb_raise(rb_eArgError, "index %ld out of range", index);
+    }
+    char *kept = ALLOC_N(char, m);
+    memset(kept, 0, m);
+    kept[0] = kept[m - 1] = 1;
+    for (i = 0; i < RARRAY(rb_keep)->len; ++i) {
+        long index = NUM2LONG(RARRAY(rb_keep)->ptr[i]);
+        if (first <= index && index <= last)
+            kept[index - first] = 1;
+    }
+    double (*xyz)[3] = (double (*)[3]) ALLOC_N(double, 3 * m);
+    for (i = 0; i < m; ++i) {
+        double r = R + alts[first + i];
+        xyz[i][0] = r * cos(lats[first + i]) * cos(lons[first + i]);
+        xyz[i][1] = r * cos(lats[first + i]) * sin(lons[first + i]);
+        xyz[i][2] = r * sin(lats[first + i]);
+    }
+    /* each stack entry is the first and last fix of a span still to be
+     * simplified, and no more spans than fixes are ever pending */
+    long (*stack)[2] = (long (*)[2]) ALLOC_N(long, 2 * m);
+    long span_first = 0, span_last;
+    for (span_last = 1; span_last < m; ++span_last) {
+        if (!kept[span_last])
+            continue;
+        long top = 0;
+        stack[top][0] = span_first;
+        stack[top][1] = span_last;
+        ++top;
+        while (top) {
+            --top;
+            long a = stack[top][0], b = stack[top][1], farthest = -1;
+            double farthest_distance2 = tolerance2;
+            for (i = a + 1; i < b; ++i) {
+                double distance2 = segment_distance2(xyz[i], xyz[a], xyz[b]);
+                if (distance2 > farthest_distance2) {
+                    farthest_distance2 = distance2;
+                    farthest = i;
+                }
+            }
+            if (farthest != -1) {
+                kept[farthest] = 1;
+                stack[top][0] = a;
+                stack[top][1] = farthest;
+                ++top;
+                stack[top][0] = farthest;
+                stack[top][1] = b;
+                ++top;
+            }
+        }
+        span_first = span_last;
+    }
+    VALUE rb_indexes = rb_ary_new();
+    for (i = 0; i < m; ++i)
+        if (kept[i])
+            rb_ary_push(rb_indexes, LONG2NUM(first + i));
+    xfree(stack);
+    xfree(xyz);
+    xfree(kept);
+    return rb_indexes;
+}
+
+void
+Init_canalysis(void)
+{
+    VALUE rb_cIGC = rb_define_class("IGC", rb_cObject);
+    rb_define_singleton_method(rb_cIGC, "analyse_fix_buffer", rb_IGC_analyse_fix_buffer, 4);
+    rb_define_singleton_method(rb_cIGC, "simplify_fix_buffer", rb_IGC_simplify_fix_buffer, -1);
+}
@@ -0,0 +1,68 @@
+require "canalysis"
+require "coord"
+require "igc"
+require "test/unit"
+
+class TC_CAnalysis < Test::Unit::TestCase
+
+  # A straight track at 10m/s that climbs at 3m/s for 30s then sinks at
+  # 3m/s for 30s
+  def setup
+    fixes = Array.new(61) do |i|
+      IGC::Fix.new(Time.at(1000000000 + i).utc, 0.8, 0.1 + i * 10.0 / (6371000.0 * Math.cos(0.8)), 1000 + 3 * (i < 30 ? i : 60 - i))
+    end
+    @fix_buffer = IGC::FixBuffer.new(fixes)
+  end
+
+  def test_averages
+    speeds, climbs, glides, progresses = IGC.analyse_fix_buffer(@fix_buffer, 15, 64, 1.0 / 8.0)
+    speeds, climbs, glides, progresses = [speeds, climbs, glides, progresses].collect { |column| column.unpack("d*") }
+    assert_equal(61, speeds.length)
+    assert_in_delta(10.0, speeds[10], 0.01)
+    assert_in_delta(3.0, climbs[10], 1.0e-9)
+    assert_in_delta(-3.0, climbs[50], 1.0e-9)
+    assert_in_delta(Math.atan2(3.0, speeds[10]), glides[10], 1.0e-9)
+    assert_in_delta(1.0, progresses[10], 1.0e-3)
+    assert_in_delta(0.0, climbs[30], 1.0)
+  end
+
+  # With fixes every second and a 2s window each interior speed is half the
+  # cumulative distance over two legs, which must match Coord#distance_to
+  # bit for bit
+  def test_distances_match_coord
+    srand(1)
+    coords = Array.new(40) { |i| Coord.new(0.8 + 1.0e-4 * rand, 0.1 + 2.0e-5 * i + 1.0e-4 * rand, 1000.0) }
+    fix_buffer = IGC::FixBuffer.new((0...coords.length).collect { |i| IGC::Fix.new(Time.at(1000000000 + i).utc, coords[i].lat, coords[i].lon, coords[i].alt) })
+    s = [0.0 + coords[0].distance_to(coords[0])]
+    coords.each_cons(2) { |coord0, coord1| s << s[-1] + coord0.distance_to(coord1) }
+    speeds = IGC.analyse_fix_buffer(fix_buffer, 2, 64, 1.0 / 8.0)[0].unpack("d*")
+    (1...coords.length - 1).each do |i|
+      assert_equal((s[i + 1] - s[i - 1]) / 2.0, speeds[i])
+    end
+  end
+
+  def test_extremes_and_bounds
+    extremes, bounds = IGC.analyse_fix_buffer(@fix_buffer, 15, 64, 1.0 / 8.0)[4, 2]
+    assert_equal([[0, false], [30, true], [60, false]], extremes)
+    assert_equal([1000.0, 1090.0], bounds[4, 2])
+    assert_equal(0.0, bounds[6])
+    assert_equal([-3.0, 3.0], bounds[8, 2].collect { |climb| climb.round })
+  end
+
+  def test_simplify
+    assert_equal([0, 30, 60], IGC.simplify_fix_buffer(@fix_buffer, 1.0, []))
+    assert_equal([0, 30, 60], IGC.simplify_fix_buffer(@fix_buffer, 40.0, [30]))
+    assert_equal([0, 60], IGC.simplify_fix_buffer(@fix_buffer, 100.0, []))
+    assert_equal([0, 12, 30, 60], IGC.simplify_fix_buffer(@fix_buffer, 100.0, [30, 12]))
+    assert_equal(61, IGC.simplify_fix_buffer(@fix_buffer, 0.0, []).length)
+    assert_equal([10, 30, 40], IGC.simplify_fix_buffer(@fix_buffer, 1.0, [5, 50], 10, 40))
+    assert_raise(ArgumentError) { IGC.simplify_fix_buffer(@fix_buffer, 1.0, [61]) }
+    assert_raise(ArgumentError) { IGC.simplify_fix_buffer(@fix_buffer, 1.0, [], 10, 61) }
+  end
+
+  def test_small_extremes
+    extremes = IGC.analyse_fix_buffer(@fix_buffer, 15, 100, 1.0 / 8.0)[4]
+    assert_equal([[30, true]], extremes)
+  end
+
+end
@@ -1,8 +1,5 @@
 /* vim: set filetype=ragel shiftwidth=4 softtabstop=4 tabstop=8: */
 
-/* FIXME remove asserts */
-
-#include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
@@ -18,6 +15,8 @@
 static VALUE id_read;
 static VALUE id_write;
 
+static VALUE rb_eFormatError;
+
 void Init_ccgiarcsi(void);
 
 %%{
@@ -60,31 +59,36 @@ double = posDouble | negDouble;
 
 action ncols {
     ncols = _unsigned;
-    assert(ncols > 0);
+    if (ncols == 0)
+	rb_raise(rb_eFormatError, "invalid ncols");
 }
 ncols = "ncols" whitespace+ unsigned %ncols newline;
 
 action nrows {
     nrows = _unsigned;
-    assert(nrows > 0);
+    if (nrows == 0)
+	rb_raise(rb_eFormatError, "invalid nrows");
 }
 nrows = "nrows" whitespace+ unsigned %nrows newline;
 
 action xllcorner {
     xllcorner = _double;
-    assert(-180.0 <= xllcorner && xllcorner < 180.0);
+    if (!(-180.0 <= xllcorner && xllcorner < 180.0))
+	rb_raise(rb_eFormatError, "invalid xllcorner");
 }
 xllcorner = "xllcorner" whitespace+ double %xllcorner newline;
 
 action yllcorner {
     yllcorner = _double;
-    assert(-180.0 <= yllcorner && yllcorner < 180.0);
+    if (!(-180.0 <= yllcorner && yllcorner < 180.0))
+	rb_raise(rb_eFormatError, "invalid yllcorner");
 }
 yllcorner = "yllcorner" whitespace+ double %yllcorner newline;
 
 action cellsize {
     cellsize = _double;
-    assert(cellsize > 0.0);
+    if (!(cellsize > 0.0))
+	rb_raise(rb_eFormatError, "invalid cellsize");
 }
 cellsize = "cellsize" whitespace+ double %cellsize newline;
 
@@ -96,18 +100,21 @@ NODATA_value = "NODATA_value" whitespace+ int %NODATA_value newline;
 header = ncols nrows xllcorner yllcorner cellsize NODATA_value;
 
 action rowStart {
-    assert(row < nrows);
+    if (row == nrows)
+	rb_raise(rb_eFormatError, "more than %u rows", nrows);
     ++row;
     datump = (short *) RSTRING(rb_row)->ptr;
 }
 
 action datum {
-    assert(datump < rowe);
+    if (datump == rowe)
+	rb_raise(rb_eFormatError, "row %u: more than %u values", row, ncols);
     *datump++ = _int;
 }
 
 action rowEnd {
-    assert(datump == rowe);
+    if (datump != rowe)
+	rb_raise(rb_eFormatError, "row %u: fewer than %u values", row, ncols);
     rb_funcall(rb_dst, id_write, 1, rb_row);
 }
 
@@ -119,7 +126,8 @@ action dataStart {
 }
 
 action dataEnd {
-    assert(row == nrows);
+    if (row != nrows)
+	rb_raise(rb_eFormatError, "expected %u rows, got %u", nrows, row);
 }
 
 data = row+ >dataStart %dataEnd;
@@ -167,11 +175,10 @@ rb_CGIARCSI_parse_ASC(VALUE rb_self, VALUE rb_src, VALUE rb_dst)
 	}
     }
 
-    if (cs == cgiarcsi_error) {
-	assert(cs != cgiarcsi_error);
-    } else if (cs < cgiarcsi_first_final) {
-	assert(cs >= cgiarcsi_first_final);
-    }
+    if (cs == cgiarcsi_error)
+	rb_raise(rb_eFormatError, "syntax error in row %u", row);
+    else if (cs < cgiarcsi_first_final)
+	rb_raise(rb_eFormatError, "unexpected end of file");
 
     return Qnil;
 }
@@ -182,6 +189,7 @@ Init_ccgiarcsi(void)
     id_read = rb_intern("read");
     id_write = rb_intern("write");
     VALUE rb_CGIARCSI = rb_define_module("CGIARCSI");
+    rb_eFormatError = rb_define_class_under(rb_CGIARCSI, "FormatError", rb_eStandardError);
     rb_define_module_function(rb_CGIARCSI, "parse_ASC", rb_CGIARCSI_parse_ASC, 2);
 
 }
@@ -0,0 +1,568 @@
+#include <ruby.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "font.h"
+
+static VALUE id_end;
+static VALUE id_middle;
+static VALUE id_start;
+
+typedef struct {
+    int width;
+    int height;
+    unsigned char *pixels;
+    /* The viewport maps times t0...t1 and values v0...v1 onto the pixel
+     * rectangle at x, y, with values increasing upwards */
+    double x, y, w, h;
+    double t0, t1, v0, v1;
+} chart_t;
+
+void Init_cchart(void);
+
+/* Draws color, 0xRRGGBBAA, over the pixel at x, y with coverage scaling
+ * its alpha. */
+static inline void
+chart_blend(chart_t *chart, int x, int y, unsigned long color, int coverage)
+{
+    if (x < 0 || x >= chart->width || y < 0 || y >= chart->height)
+        return;
+    int a = (color & 0xff) * coverage / 255;
+    if (!a)
+        return;
+    unsigned char *p = chart->pixels + 4 * ((long) y * chart->width + x);
+    unsigned char source[3] = { color >> 24, color >> 16, color >> 8 };
+    if (a == 255 || !p[3]) {
+        memcpy(p, source, 3);
+        p[3] = a;
+        return;
+    }
+    int da = p[3] * (255 - a);
+    int oa = 255 * a + da;
+    int i;
+    for (i = 0; i < 3; ++i)
+        p[i] = (255 * a * source[i] + da * p[i] + oa / 2) / oa;
+    p[3] = (oa + 127) / 255;
+}
+
+static void
+chart_fill_rect(chart_t *chart, int x, int y, int w, int h, unsigned long color)
+{
+    int x0 = x < 0 ? 0 : x, x1 = x + w > chart->width ? chart->width : x + w;
+    int y0 = y < 0 ? 0 : y, y1 = y + h > chart->height ? chart->height : y + h;
+    for (y = y0; y < y1; ++y)
+        for (x = x0; x < x1; ++x)
+            chart_blend(chart, x, y, color, 255);
+}
+
+/* Returns x clamped to lo, hi, so that rounding it fits in an int. */
+static inline double
+chart_clamp(double x, double lo, double hi)
+{
+    return x < lo ? lo : x > hi ? hi : x;
+}
+
+/* Draws an anti-aliased line between pixel centres, one pixel per step
+ * along its major axis.  Lines with a NaN end are not drawn. */
+static void
+chart_line(chart_t *chart, double x0, double y0, double x1, double y1, unsigned long color)
+{
+    if (isnan(x0) || isnan(y0) || isnan(x1) || isnan(y1))
+        return;
+    int steep = fabs(y1 - y0) > fabs(x1 - x0);
+    double t;
+    if (steep) {
+        t = x0; x0 = y0; y0 = t;
+        t = x1; x1 = y1; y1 = t;
+    }
+    if (x0 > x1) {
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+    double gradient = x1 == x0 ? 0.0 : (y1 - y0) / (x1 - x0);
+    int limit = steep ? chart->height : chart->width;
+    int other = steep ? chart->width : chart->height;
+    int i0 = (int) floor(chart_clamp(x0, -1.0, limit) + 0.5), i1 = (int) floor(chart_clamp(x1, -1.0, limit) + 0.5);
+    if (i0 < 0)
+        i0 = 0;
+    if (i1 >= limit)
+        i1 = limit - 1;
+    int i;
+    for (i = i0; i <= i1; ++i) {
+        double y = y0 + gradient * (i - x0);
+        /* off the raster, or NaN where an infinite end gives no gradient */
+        if (!(y >= -1.0 && y < other))
+            continue;
+        int j = (int) floor(y);
+        int coverage = (int) (255.0 * (y - j) + 0.5);
+        if (steep) {
+            chart_blend(chart, j, i, color, 255 - coverage);
+            chart_blend(chart, j + 1, i, color, coverage);
+        } else {
+            chart_blend(chart, i, j, color, 255 - coverage);
+            chart_blend(chart, i, j + 1, color, coverage);
+        }
+    }
+}
+
+static const double *
+packed_doubles(VALUE rb_string, long *n)
+{
+    StringValue(rb_string);
+    if (RSTRING(rb_string)->len % sizeof(double))
+        rb_raise(rb_eArgError, "packed doubles expected");
+    *n = RSTRING(rb_string)->len / sizeof(double);
+    return (const double *) RSTRING(rb_string)->ptr;
+}
+
+static const double *
+packed_series(VALUE rb_times, VALUE rb_values, long *n)
+{
+    long m;
+    const double *times = packed_doubles(rb_times, n);
+    packed_doubles(rb_values, &m);
+    if (m != *n)
+        rb_raise(rb_eArgError, "times and values differ in length");
+    return times;
+}
+
+static inline double
+chart_x(const chart_t *chart, double t)
+{
+    return chart->x + chart->w * (t - chart->t0) / (chart->t1 - chart->t0);
+}
+
+static inline double
+chart_y(const chart_t *chart, double v)
+{
+    return chart->y + chart->h * (1.0 - (v - chart->v0) / (chart->v1 - chart->v0));
+}
+
+static void
+chart_free(chart_t *chart)
+{
+    if (chart->pixels)
+        xfree(chart->pixels);
+    xfree(chart);
+}
+
+static VALUE
+rb_Chart_alloc(VALUE rb_class)
+{
+    chart_t *chart;
+    VALUE rb_self = Data_Make_Struct(rb_class, chart_t, 0, chart_free, chart);
+    memset(chart, 0, sizeof(chart_t));
+    return rb_self;
+}
+
+static chart_t *
+rb_Chart_get(VALUE rb_self)
+{
+    chart_t *chart;
+    Data_Get_Struct(rb_self, chart_t, chart);
+    if (!chart->pixels)
+        rb_raise(rb_eRuntimeError, "uninitialized chart");
+    return chart;
+}
+
+static VALUE
+rb_Chart_initialize(VALUE rb_self, VALUE rb_width, VALUE rb_height)
+{
+    int width = NUM2INT(rb_width), height = NUM2INT(rb_height);
+    if (width < 1 || height < 1 || width > 16384 || height > 16384)
+        rb_raise(rb_eArgError, "invalid chart size");
+    chart_t *chart;
+    Data_Get_Struct(rb_self, chart_t, chart);
+    if (chart->pixels)
+        xfree(chart->pixels);
+    chart->width = width;
+    chart->height = height;
+    chart->pixels = ALLOC_N(unsigned char, 4 * (long) width * height);
+    memset(chart->pixels, 0, 4 * (long) width * height);
+    chart->x = chart->y = 0.0;
+    chart->w = width;
+    chart->h = height;
+    chart->t0 = chart->v0 = 0.0;
+    chart->t1 = chart->v1 = 1.0;
+    return rb_self;
+}
+
+static VALUE
+rb_Chart_width(VALUE rb_self)
+{
+    return INT2NUM(rb_Chart_get(rb_self)->width);
+}
+
+static VALUE
+rb_Chart_height(VALUE rb_self)
+{
+    return INT2NUM(rb_Chart_get(rb_self)->height);
+}
+
+static VALUE
+rb_Chart_viewport(VALUE rb_self, VALUE rb_x, VALUE rb_y, VALUE rb_w, VALUE rb_h, VALUE rb_t0, VALUE rb_t1, VALUE rb_v0, VALUE rb_v1)
+{
+    chart_t *chart = rb_Chart_get(rb_self);
+    double t0 = NUM2DBL(rb_t0), t1 = NUM2DBL(rb_t1), v0 = NUM2DBL(rb_v0), v1 = NUM2DBL(rb_v1);
+    if (t0 == t1 || v0 == v1)
+        rb_raise(rb_eArgError, "empty viewport");
+    chart->x = NUM2DBL(rb_x);
+    chart->y = NUM2DBL(rb_y);
+    chart->w = NUM2DBL(rb_w);
+    chart->h = NUM2DBL(rb_h);
+    chart->t0 = t0;
+    chart->t1 = t1;
+    chart->v0 = v0;
+    chart->v1 = v1;
+    return rb_self;
+}
+
+static VALUE
+rb_Chart_fill_rect(VALUE rb_self, VALUE rb_x, VALUE rb_y, VALUE rb_w, VALUE rb_h, VALUE rb_color)
+{
+    chart_fill_rect(rb_Chart_get(rb_self), NUM2INT(rb_x), NUM2INT(rb_y), NUM2INT(rb_w), NUM2INT(rb_h), NUM2ULONG(rb_color));
+    return rb_self;
+}
+
+static VALUE
+rb_Chart_line(VALUE rb_self, VALUE rb_x0, VALUE rb_y0, VALUE rb_x1, VALUE rb_y1, VALUE rb_color)
+{
+    chart_line(rb_Chart_get(rb_self), NUM2DBL(rb_x0), NUM2DBL(rb_y0), NUM2DBL(rb_x1), NUM2DBL(rb_y1), NUM2ULONG(rb_color));
+    return rb_self;
+}
+
+/* Draws the packed times and values through the viewport as a polyline,
+ * reduced first to where it enters, leaves and spans each pixel column so
+ * that the work does not grow with the number of points drawn into the
+ * same column.  Points with NaN coordinates are skipped, and the columns
+ * beyond either side of the raster are each treated as one column. */
+static VALUE
+rb_Chart_polyline(VALUE rb_self, VALUE rb_times, VALUE rb_values, VALUE rb_color)
+{
+    chart_t *chart = rb_Chart_get(rb_self);
+    unsigned long color = NUM2ULONG(rb_color);
+    long n, i;
+    const double *times = packed_series(rb_times, rb_values, &n);
+    const double *values = (const double *) RSTRING(rb_values)->ptr;
+    if (!n)
+        return rb_self;
+    double px = 0.0, py = 0.0, first_x = 0.0, first_y = 0.0, last_x = 0.0, last_y = 0.0, min = 0.0, max = 0.0;
+    long column = 0;
+    int have_column = 0, have_previous = 0;
+    for (i = 0; i <= n; ++i) {
+        double x = 0.0, y = 0.0;
+        long c = 0;
+        if (i < n) {
+            x = chart_x(chart, times[i]);
+            y = chart_y(chart, values[i]);
+            if (isnan(x) || isnan(y))
+                continue;
+            c = (long) floor(chart_clamp(x, -1.0, chart->width) + 0.5);
+            if (have_column && c == column) {
+                last_x = x;
+                last_y = y;
+                if (y < min)
+                    min = y;
+                if (y > max)
+                    max = y;
+                continue;
+            }
+        }
+        if (have_column) {
+            if (have_previous)
+                chart_line(chart, px, py, first_x, first_y, color);
+            if (max - min >= 1.0)
+                chart_line(chart, column, min, column, max, color);
+            px = last_x;
+            py = last_y;
+            have_previous = 1;
+        }
+        column = c;
+        have_column = 1;
+        first_x = last_x = x;
+        first_y = last_y = min = max = y;
+    }
+    return rb_self;
+}
+
+/* Fills the area between the packed times and values and the bottom of
+ * the viewport, taking the highest value that falls in each pixel column
+ * and interpolating across the columns that no point falls in. */
+static VALUE
+rb_Chart_fill_below(VALUE rb_self, VALUE rb_times, VALUE rb_values, VALUE rb_color)
+{
+    chart_t *chart = rb_Chart_get(rb_self);
+    unsigned long color = NUM2ULONG(rb_color);
+    long n, i;
+    const double *times = packed_series(rb_times, rb_values, &n);
+    const double *values = (const double *) RSTRING(rb_values)->ptr;
+    if (!n)
+        return rb_self;
+    long left = (long) floor(chart_clamp(chart->x, -1.0, chart->width) + 0.5);
+    long right = (long) floor(chart_clamp(chart->x + chart->w, -1.0, chart->width) + 0.5);
+    if (left < 0)
+        left = 0;
+    if (right >= chart->width)
+        right = chart->width - 1;
+    if (right < left)
+        return rb_self;
+    long columns = right - left + 1, c;
+    double *tops = ALLOC_N(double, columns);
+    for (c = 0; c < columns; ++c)
+        tops[c] = HUGE_VAL;
+    for (i = 0; i < n; ++i) {
+        double x = chart_x(chart, times[i]);
+        if (isnan(x))
+            continue;
+        c = (long) floor(chart_clamp(x, -1.0, chart->width) + 0.5) - left;
+        if (c < 0 || c >= columns)
+            continue;
+        double y = chart_y(chart, values[i]);
+        if (isfinite(y) && y < tops[c])
+            tops[c] = y;
+    }
+    long previous = -1;
+    for (c = 0; c <= columns; ++c) {
+        if (c < columns && tops[c] == HUGE_VAL)
+            continue;
+        long j;
+        if (previous == -1) {
+            if (c == columns)
+                break;
+            for (j = 0; j < c; ++j)
+                tops[j] = tops[c];
+        } else if (c == columns) {
+            for (j = previous + 1; j < columns; ++j)
+                tops[j] = tops[previous];
+        } else {
+            for (j = previous + 1; j < c; ++j)
+                tops[j] = tops[previous] + (tops[c] - tops[previous]) * (j - previous) / (c - previous);
+        }
+        previous = c;
+    }
+    double bottom = chart->y + chart->h;
+    if (previous != -1) {
+        for (c = 0; c < columns; ++c) {
+            double top = chart_clamp(tops[c], -1.0, chart->height);
+            int y = (int) floor(top + 0.5), y1 = (int) floor(chart_clamp(bottom, -1.0, chart->height) + 0.5);
+            for (; y <= y1; ++y) {
+                double coverage = (y + 0.5 < bottom ? y + 0.5 : bottom) - (y - 0.5 > top ? y - 0.5 : top);
+                if (coverage > 0.0)
+                    chart_blend(chart, left + c, y, color, coverage >= 1.0 ? 255 : (int) (255.0 * coverage + 0.5));
+            }
+        }
+    }
+    xfree(tops);
+    return rb_self;
+}
+
+static const struct font *
+font_of_size(int size)
+{
+    size_t i;
+    for (i = 0; i < sizeof fonts / sizeof fonts[0]; ++i)
+        if (fonts[i].size == size)
+            return &fonts[i];
+    rb_raise(rb_eArgError, "no font of size %d", size);
+    return 0;
+}
+
+static inline const struct glyph *
+font_glyph(const struct font *font, char c)
+{
+    return &font->glyphs[c >= 32 && c < 127 ? c - 32 : '?' - 32];
+}
+
+static VALUE
+rb_Chart_text_width(VALUE rb_self, VALUE rb_string, VALUE rb_size)
+{
+    const struct font *font = font_of_size(NUM2INT(rb_size));
+    StringValue(rb_string);
+    long i, width = 0;
+    for (i = 0; i < RSTRING(rb_string)->len; ++i)
+        width += font_glyph(font, RSTRING(rb_string)->ptr[i])->advance;
+    (void) rb_self;
+    return LONG2NUM(width);
+}
+
+/* Draws string with its baseline at y, starting, centred on or ending at x
+ * as anchor is :start, :middle or :end. */
+static VALUE
+rb_Chart_text(VALUE rb_self, VALUE rb_x, VALUE rb_y, VALUE rb_string, VALUE rb_size, VALUE rb_color, VALUE rb_anchor)
+{
+    chart_t *chart = rb_Chart_get(rb_self);
+    const struct font *font = font_of_size(NUM2INT(rb_size));
+    unsigned long color = NUM2ULONG(rb_color);
+    StringValue(rb_string);
+    const char *s = RSTRING(rb_string)->ptr;
+    long i, len = RSTRING(rb_string)->len;
+    double x = NUM2DBL(rb_x);
+    int y = (int) floor(NUM2DBL(rb_y) + 0.5);
+    ID anchor = SYM2ID(rb_anchor);
+    if (anchor != id_start) {
+        long width = NUM2LONG(rb_Chart_text_width(rb_self, rb_string, rb_size));
+        if (anchor == id_middle)
+            x -= width / 2.0;
+        else if (anchor == id_end)
+            x -= width;
+        else
+            rb_raise(rb_eArgError, "invalid anchor");
+    }
+    int pen = (int) floor(x + 0.5);
+    for (i = 0; i < len; ++i) {
+        const struct glyph *glyph = font_glyph(font, s[i]);
+        const unsigned char *mask = font->bitmap + glyph->offset;
+        int gx, gy;
+        for (gy = 0; gy < glyph->height; ++gy)
+            for (gx = 0; gx < glyph->width; ++gx)
+                chart_blend(chart, pen + glyph->left + gx, y - glyph->top + gy, color, *mask++);
+        pen += glyph->advance;
+    }
+    return rb_self;
+}
+
+/* Puts color behind every pixel within one pixel of a drawn one, at the
+ * opacity of the most opaque of them. */
+static VALUE
+rb_Chart_outline(VALUE rb_self, VALUE rb_color)
+{
+    chart_t *chart = rb_Chart_get(rb_self);
+    unsigned long color = NUM2ULONG(rb_color);
+    long size = 4 * (long) chart->width * chart->height;
+    unsigned char *pixels = chart->pixels;
+    chart->pixels = ALLOC_N(unsigned char, size);
+    int x, y, i, j;
+    for (y = 0; y < chart->height; ++y) {
+        for (x = 0; x < chart->width; ++x) {
+            int alpha = 0;
+            for (j = y - 1; j <= y + 1; ++j)
+                for (i = x - 1; i <= x + 1; ++i)
+                    if (i >= 0 && i < chart->width && j >= 0 && j < chart->height && pixels[4 * ((long) j * chart->width + i) + 3] > alpha)
+                        alpha = pixels[4 * ((long) j * chart->width + i) + 3];
+            unsigned char *p = chart->pixels + 4 * ((long) y * chart->width + x);
+            p[0] = color >> 24;
+            p[1] = color >> 16;
+            p[2] = color >> 8;
+            p[3] = (color & 0xff) * alpha / 255;
+        }
+    }
+    for (y = 0; y < chart->height; ++y) {
+        for (x = 0; x < chart->width; ++x) {
+            const unsigned char *q = pixels + 4 * ((long) y * chart->width + x);
+            chart_blend(chart, x, y, (unsigned long) q[0] << 24 | q[1] << 16 | q[2] << 8 | 0xff, q[3]);
+        }
+    }
+    xfree(pixels);
+    return rb_self;
+}
+
+/* Draws other over this chart with its top left corner at x, y. */
+static VALUE
+rb_Chart_composite(VALUE rb_self, VALUE rb_other, VALUE rb_x, VALUE rb_y)
+{
+    chart_t *chart = rb_Chart_get(rb_self);
+    chart_t *other = rb_Chart_get(rb_other);
+    int x0 = NUM2INT(rb_x), y0 = NUM2INT(rb_y), x, y;
+    for (y = 0; y < other->height; ++y) {
+        for (x = 0; x < other->width; ++x) {
+            const unsigned char *q = other->pixels + 4 * ((long) y * other->width + x);
+            chart_blend(chart, x0 + x, y0 + y, (unsigned long) q[0] << 24 | q[1] << 16 | q[2] << 8 | 0xff, q[3]);
+        }
+    }
+    return rb_self;
+}
+
+/* Replaces the chart's pixels with rgba, a string of width * height
+ * non-premultiplied RGBA pixels. */
+static VALUE
+rb_Chart_set_pixels(VALUE rb_self, VALUE rb_rgba)
+{
+    chart_t *chart = rb_Chart_get(rb_self);
+    StringValue(rb_rgba);
+    if (RSTRING(rb_rgba)->len != 4 * (long) chart->width * chart->height)
+        rb_raise(rb_eArgError, "%ld RGBA pixels expected", (long) chart->width * chart->height);
+    memcpy(chart->pixels, RSTRING(rb_rgba)->ptr, RSTRING(rb_rgba)->len);
+    return rb_rgba;
+}
+
+static unsigned char *
+png_uint32(unsigned char *p, uint32_t value)
+{
+    *p++ = value >> 24;
+    *p++ = value >> 16;
+    *p++ = value >> 8;
+    *p++ = value;
+    return p;
+}
+
+static void
+png_chunk(VALUE rb_png, const char *type, const unsigned char *data, uLong length)
+{
+    unsigned char header[8];
+    png_uint32(header, length);
+    memcpy(header + 4, type, 4);
+    rb_str_cat(rb_png, (const char *) header, 8);
+    rb_str_cat(rb_png, (const char *) data, length);
+    uLong crc = crc32(crc32(0, Z_NULL, 0), header + 4, 4);
+    crc = crc32(crc, data, length);
+    unsigned char trailer[4];
+    png_uint32(trailer, crc);
+    rb_str_cat(rb_png, (const char *) trailer, 4);
+}
+
+/* Returns the chart as an 8-bit RGBA PNG. */
+static VALUE
+rb_Chart_to_png(VALUE rb_self)
+{
+    chart_t *chart = rb_Chart_get(rb_self);
+    long stride = 4 * (long) chart->width, y;
+    uLong raw_size = (stride + 1) * chart->height;
+    unsigned char *raw = ALLOC_N(unsigned char, raw_size);
+    for (y = 0; y < chart->height; ++y) {
+        raw[y * (stride + 1)] = 0;
+        memcpy(raw + y * (stride + 1) + 1, chart->pixels + y * stride, stride);
+    }
+    uLongf compressed_size = compressBound(raw_size);
+    unsigned char *compressed = ALLOC_N(unsigned char, compressed_size);
+    int status = compress2(compressed, &compressed_size, raw, raw_size, Z_DEFAULT_COMPRESSION);
+    xfree(raw);
+    if (status != Z_OK) {
+        xfree(compressed);
+        rb_raise(rb_eRuntimeError, "compress2 failed: %d", status);
+    }
+    VALUE rb_png = rb_str_new("\x89PNG\r\n\x1a\n", 8);
+    unsigned char ihdr[13];
+    png_uint32(png_uint32(ihdr, chart->width), chart->height);
+    memcpy(ihdr + 8, "\x08\x06\x00\x00\x00", 5);
+    png_chunk(rb_png, "IHDR", ihdr, 13);
+    png_chunk(rb_png, "IDAT", compressed, compressed_size);
+    png_chunk(rb_png, "IEND", (const unsigned char *) "", 0);
+    xfree(compressed);
+    return rb_png;
+}
+
+void
+Init_cchart(void)
+{
+    id_end = rb_intern("end");
+    id_middle = rb_intern("middle");
+    id_start = rb_intern("start");
+    VALUE rb_cChart = rb_define_class("Chart", rb_cObject);
+    rb_define_alloc_func(rb_cChart, rb_Chart_alloc);
+    rb_define_method(rb_cChart, "initialize", rb_Chart_initialize, 2);
+    rb_define_method(rb_cChart, "width", rb_Chart_width, 0);
+    rb_define_method(rb_cChart, "height", rb_Chart_height, 0);
+    rb_define_method(rb_cChart, "viewport", rb_Chart_viewport, 8);
+    rb_define_method(rb_cChart, "fill_rect", rb_Chart_fill_rect, 5);
+    rb_define_method(rb_cChart, "line", rb_Chart_line, 5);
+    rb_define_method(rb_cChart, "polyline", rb_Chart_polyline, 3);
+    rb_define_method(rb_cChart, "fill_below", rb_Chart_fill_below, 3);
+    rb_define_method(rb_cChart, "text_width", rb_Chart_text_width, 2);
+    rb_define_method(rb_cChart, "text", rb_Chart_text, 6);
+    rb_define_method(rb_cChart, "outline", rb_Chart_outline, 1);
+    rb_define_method(rb_cChart, "composite", rb_Chart_composite, 3);
+    rb_define_method(rb_cChart, "pixels=", rb_Chart_set_pixels, 1);
+    rb_define_method(rb_cChart, "to_png", rb_Chart_to_png, 0);
+}
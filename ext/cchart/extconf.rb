@@ -0,0 +1,4 @@
+require "mkmf"
+
+$CFLAGS += " -Wall -Wextra -Wmissing-prototypes"
+have_header("zlib.h") and have_library("z", "compress2") and create_makefile("cchart")
@@ -0,0 +1,853 @@
+/* Anti-aliased coverage masks of the printable ASCII characters, rendered
+ * from DejaVu Sans Bold at 9 and 11 pixels.  Each glyph's mask starts at
+ * left, -top relative to the pen position on the baseline.
+ *
+ * The masks were produced with Python's Pillow from DejaVuSans-Bold.ttf:
+ * each character's ImageFont.getmask2(ch, mode="L", anchor="ls") gives its
+ * 8-bit mask and its left, -top offset from the baseline origin, and
+ * ImageFont.getlength(ch) rounded to the nearest pixel gives its advance.
+ * The masks are stored row by row, one after another, in bitmap.
+ *
+ * DejaVu Sans is derived from Bitstream Vera, whose licence follows.
+ *
+ * Copyright (c) 2003 by Bitstream, Inc. All Rights Reserved. Bitstream Vera
+ * is a trademark of Bitstream, Inc.  DejaVu changes are in public domain.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of the fonts accompanying this license ("Fonts") and associated
+ * documentation files (the "Font Software"), to reproduce and distribute the
+ * Font Software, including without limitation the rights to use, copy, merge,
+ * publish, distribute, and/or sell copies of the Font Software, and to permit
+ * persons to whom the Font Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright and trademark notices and this permission notice shall
+ * be included in all copies of one or more of the Font Software typefaces.
+ *
+ * The Font Software may be modified, altered, or added to, and in particular
+ * the designs of glyphs or characters in the Fonts may be modified and
+ * additional glyphs or characters may be added to the Fonts, only if the fonts
+ * are renamed to names not containing either the words "Bitstream" or the word
+ * "Vera".
+ *
+ * This License becomes null and void to the extent applicable to Fonts or Font
+ * Software that has been modified and is distributed under the "Bitstream
+ * Vera" names.
+ *
+ * The Font Software may be sold as part of a larger software package but no
+ * copy of one or more of the Font Software typefaces may be sold by itself.
+ *
+ * THE FONT SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF COPYRIGHT, PATENT,
+ * TRADEMARK, OR OTHER RIGHT. IN NO EVENT SHALL BITSTREAM OR THE GNOME
+ * FOUNDATION BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, INCLUDING
+ * ANY GENERAL, SPECIAL, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * THE USE OR INABILITY TO USE THE FONT SOFTWARE OR FROM OTHER DEALINGS IN THE
+ * FONT SOFTWARE.
+ *
+ * Except as contained in this notice, the names of Gnome, the Gnome
+ * Foundation, and Bitstream Inc., shall not be used in advertising or
+ * otherwise to promote the sale, use or other dealings in this Font Software
+ * without prior written authorization from the Gnome Foundation or Bitstream
+ * Inc., respectively. For further information, contact: fonts at gnome dot
+ * org.
+ */
+
+struct glyph {
+    signed char left;
+    signed char top;
+    unsigned char width;
+    unsigned char height;
+    unsigned char advance;
+    unsigned short offset;
+};
+
+struct font {
+    int size;
+    const struct glyph *glyphs;
+    const unsigned char *bitmap;
+};
+
+static const struct glyph font9_glyphs[] = {
+    {0, 0, 0, 0, 3, 0}, /* space */
+    {0, 7, 4, 7, 4, 0}, /* ! */
+    {0, 7, 5, 7, 5, 28}, /* " */
+    {0, 7, 8, 7, 8, 63}, /* # */
+    {0, 7, 6, 8, 6, 119}, /* $ */
+    {0, 7, 9, 7, 9, 167}, /* % */
+    {0, 7, 8, 7, 8, 230}, /* & */
+    {0, 7, 3, 7, 3, 286}, /* ' */
+    {0, 8, 4, 8, 4, 307}, /* ( */
+    {0, 8, 4, 8, 4, 339}, /* ) */
+    {0, 7, 5, 7, 5, 371}, /* asterisk */
+    {0, 5, 8, 5, 8, 406}, /* + */
+    {0, 2, 3, 3, 3, 446}, /* , */
+    {0, 3, 4, 3, 4, 455}, /* - */
+    {0, 2, 3, 2, 3, 467}, /* . */
+    {0, 7, 4, 7, 3, 473}, /* / */
+    {0, 7, 6, 7, 6, 501}, /* 0 */
+    {0, 7, 6, 7, 6, 543}, /* 1 */
+    {0, 7, 6, 7, 6, 585}, /* 2 */
+    {0, 7, 6, 7, 6, 627}, /* 3 */
+    {0, 7, 6, 7, 6, 669}, /* 4 */
+    {0, 7, 6, 7, 6, 711}, /* 5 */
+    {0, 7, 6, 7, 6, 753}, /* 6 */
+    {0, 7, 6, 7, 6, 795}, /* 7 */
+    {0, 7, 6, 7, 6, 837}, /* 8 */
+    {0, 7, 6, 7, 6, 879}, /* 9 */
+    {0, 5, 4, 5, 4, 921}, /* : */
+    {0, 5, 4, 6, 4, 941}, /* ; */
+    {0, 5, 8, 5, 8, 965}, /* < */
+    {0, 4, 8, 4, 8, 1005}, /* = */
+    {0, 5, 8, 5, 8, 1037}, /* > */
+    {0, 7, 5, 7, 5, 1077}, /* ? */
+    {0, 7, 9, 8, 9, 1112}, /* @ */
+    {0, 7, 7, 7, 7, 1184}, /* A */
+    {0, 7, 7, 7, 7, 1233}, /* B */
+    {0, 7, 7, 7, 7, 1282}, /* C */
+    {0, 7, 7, 7, 7, 1331}, /* D */
+    {0, 7, 6, 7, 6, 1380}, /* E */
+    {0, 7, 6, 7, 6, 1422}, /* F */
+    {0, 7, 7, 7, 7, 1464}, /* G */
+    {0, 7, 8, 7, 8, 1513}, /* H */
+    {0, 7, 3, 7, 3, 1569}, /* I */
+    {-1, 7, 4, 9, 3, 1590}, /* J */
+    {0, 7, 8, 7, 7, 1626}, /* K */
+    {0, 7, 6, 7, 6, 1682}, /* L */
+    {0, 7, 9, 7, 9, 1724}, /* M */
+    {0, 7, 8, 7, 8, 1787}, /* N */
+    {0, 7, 8, 7, 8, 1843}, /* O */
+    {0, 7, 7, 7, 7, 1899}, /* P */
+    {0, 7, 8, 8, 8, 1948}, /* Q */
+    {0, 7, 7, 7, 7, 2012}, /* R */
+    {0, 7, 6, 7, 6, 2061}, /* S */
+    {0, 7, 7, 7, 6, 2103}, /* T */
+    {0, 7, 7, 7, 7, 2152}, /* U */
+    {0, 7, 7, 7, 7, 2201}, /* V */
+    {0, 7, 10, 7, 10, 2250}, /* W */
+    {0, 7, 7, 7, 7, 2320}, /* X */
+    {-1, 7, 8, 7, 7, 2369}, /* Y */
+    {0, 7, 7, 7, 7, 2425}, /* Z */
+    {0, 8, 4, 8, 4, 2474}, /* [ */
+    {0, 7, 4, 7, 3, 2506}, /* backslash */
+    {0, 8, 4, 8, 4, 2534}, /* ] */
+    {0, 7, 8, 7, 8, 2566}, /* ^ */
+    {0, 0, 5, 2, 5, 2622}, /* _ */
+    {0, 7, 5, 7, 5, 2632}, /* ` */
+    {0, 5, 6, 5, 6, 2667}, /* a */
+    {0, 8, 7, 8, 6, 2697}, /* b */
+    {0, 5, 5, 5, 5, 2753}, /* c */
+    {0, 8, 6, 8, 6, 2778}, /* d */
+    {0, 5, 6, 5, 6, 2826}, /* e */
+    {0, 8, 4, 8, 4, 2856}, /* f */
+    {0, 5, 6, 7, 6, 2888}, /* g */
+    {0, 8, 6, 8, 6, 2930}, /* h */
+    {0, 8, 3, 8, 3, 2978}, /* i */
+    {-1, 8, 4, 10, 3, 3002}, /* j */
+    {0, 8, 7, 8, 6, 3042}, /* k */
+    {0, 8, 3, 8, 3, 3098}, /* l */
+    {0, 5, 9, 5, 9, 3122}, /* m */
+    {0, 5, 6, 5, 6, 3167}, /* n */
+    {0, 5, 6, 5, 6, 3197}, /* o */
+    {0, 5, 7, 7, 6, 3227}, /* p */
+    {0, 5, 6, 7, 6, 3276}, /* q */
+    {0, 5, 5, 5, 4, 3318}, /* r */
+    {0, 5, 5, 5, 5, 3343}, /* s */
+    {0, 6, 5, 6, 4, 3368}, /* t */
+    {0, 5, 6, 5, 6, 3398}, /* u */
+    {0, 5, 6, 5, 6, 3428}, /* v */
+    {0, 5, 8, 5, 8, 3458}, /* w */
+    {0, 5, 6, 5, 6, 3498}, /* x */
+    {0, 5, 6, 7, 6, 3528}, /* y */
+    {0, 5, 5, 5, 5, 3570}, /* z */
+    {0, 8, 6, 8, 6, 3595}, /* { */
+    {0, 7, 3, 9, 3, 3643}, /* | */
+    {0, 8, 6, 8, 6, 3670}, /* } */
+    {0, 5, 8, 5, 8, 3718}, /* ~ */
+};
+
+static const unsigned char font9_bitmap[] = {
+    0, 188, 216, 0, 0, 188, 216, 0, 0, 180, 208, 0, 0, 149, 176, 0,
+    0, 0, 0, 0, 0, 188, 216, 0, 0, 188, 216, 0, 36, 232, 52, 212,
+    0, 36, 232, 52, 212, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 20, 227, 1, 235, 11, 0, 0, 0, 73, 174, 40, 210, 0, 0, 0,
+    228, 255, 255, 255, 255, 240, 0, 0, 0, 204, 47, 168, 83, 0, 0, 100,
+    255, 255, 255, 255, 255, 108, 0, 0, 68, 180, 32, 216, 0, 0, 0, 0,
+    121, 126, 85, 162, 0, 0, 0, 0, 0, 56, 128, 0, 0, 1, 149, 241,
+    255, 255, 64, 56, 255, 125, 128, 0, 0, 46, 255, 255, 224, 133, 13, 0,
+    100, 207, 255, 255, 134, 0, 0, 56, 148, 225, 150, 71, 249, 249, 250, 198,
+    35, 0, 0, 56, 128, 0, 0, 48, 223, 231, 64, 0, 56, 190, 0, 0,
+    160, 138, 115, 184, 2, 199, 45, 0, 0, 160, 142, 119, 183, 100, 148, 0,
+    0, 0, 48, 223, 231, 80, 214, 79, 229, 225, 53, 0, 0, 0, 145, 103,
+    180, 119, 134, 168, 0, 0, 42, 202, 2, 180, 122, 139, 167, 0, 0, 187,
+    59, 0, 62, 229, 226, 53, 0, 21, 193, 250, 255, 76, 0, 0, 0, 110,
+    255, 54, 0, 0, 0, 0, 0, 81, 255, 166, 0, 0, 0, 0, 23, 232,
+    233, 255, 113, 69, 254, 17, 103, 255, 38, 162, 251, 201, 202, 0, 72, 255,
+    105, 18, 227, 255, 93, 0, 0, 129, 232, 246, 198, 210, 229, 31, 36, 232,
+    0, 36, 232, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 49, 252, 40, 0, 173, 188, 0, 9, 249, 114, 0, 45,
+    255, 77, 0, 46, 255, 76, 0, 9, 250, 114, 0, 0, 174, 187, 0, 0,
+    49, 251, 40, 21, 246, 78, 0, 0, 161, 202, 0, 0, 87, 255, 31, 0,
+    49, 255, 77, 0, 49, 255, 76, 0, 86, 255, 32, 0, 159, 203, 0, 21,
+    245, 78, 0, 0, 4, 188, 0, 0, 137, 109, 201, 149, 79, 8, 196, 255,
+    132, 0, 137, 109, 201, 150, 79, 0, 4, 188, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 192, 76, 0, 0, 0, 0, 0,
+    0, 192, 76, 0, 0, 0, 12, 255, 255, 255, 255, 255, 152, 0, 0, 0,
+    0, 192, 76, 0, 0, 0, 0, 0, 0, 192, 76, 0, 0, 0, 20, 255,
+    128, 34, 255, 91, 98, 190, 1, 132, 255, 255, 64, 0, 0, 0, 0, 0,
+    0, 0, 0, 20, 255, 128, 20, 255, 128, 0, 0, 217, 30, 0, 47, 200,
+    0, 0, 132, 116, 0, 0, 215, 32, 0, 45, 203, 0, 0, 129, 118, 0,
+    0, 213, 34, 0, 0, 0, 94, 222, 236, 144, 4, 38, 253, 122, 55, 255,
+    102, 113, 255, 47, 0, 235, 181, 136, 255, 35, 0, 223, 204, 113, 255, 47,
+    0, 235, 181, 39, 253, 121, 55, 255, 104, 0, 96, 224, 237, 146, 5, 0,
+    252, 255, 255, 40, 0, 0, 0, 116, 255, 40, 0, 0, 0, 116, 255, 40,
+    0, 0, 0, 116, 255, 40, 0, 0, 0, 116, 255, 40, 0, 0, 0, 116,
+    255, 40, 0, 0, 240, 255, 255, 255, 164, 68, 255, 255, 238, 152, 3, 0,
+    0, 3, 127, 255, 84, 0, 0, 0, 122, 255, 86, 0, 0, 65, 251, 192,
+    5, 0, 33, 236, 203, 11, 0, 12, 210, 230, 27, 0, 0, 72, 255, 255,
+    255, 255, 124, 28, 255, 255, 238, 161, 7, 0, 0, 3, 132, 255, 82, 0,
+    0, 4, 131, 254, 54, 0, 68, 255, 255, 181, 6, 0, 0, 5, 104, 255,
+    111, 0, 0, 3, 101, 255, 111, 100, 255, 254, 233, 155, 8, 0, 0, 69,
+    255, 232, 0, 0, 6, 216, 248, 232, 0, 0, 120, 214, 180, 232, 0, 29,
+    244, 75, 176, 232, 0, 141, 187, 0, 176, 232, 0, 152, 255, 255, 255, 255,
+    216, 0, 0, 0, 176, 232, 0, 12, 255, 255, 255, 255, 40, 12, 255, 76,
+    0, 0, 0, 12, 255, 76, 0, 0, 0, 12, 255, 248, 242, 178, 18, 0,
+    0, 2, 83, 255, 136, 0, 0, 2, 83, 255, 133, 80, 255, 255, 238, 167,
+    14, 0, 44, 193, 246, 255, 88, 8, 226, 199, 22, 0, 0, 74, 255, 81,
+    0, 0, 0, 103, 255, 213, 246, 203, 42, 84, 255, 149, 30, 245, 176, 20,
+    244, 148, 30, 245, 165, 0, 76, 218, 244, 187, 29, 100, 255, 255, 255, 255,
+    140, 0, 0, 0, 112, 255, 86, 0, 0, 0, 214, 228, 4, 0, 0, 63,
+    255, 123, 0, 0, 0, 166, 248, 21, 0, 0, 20, 248, 160, 0, 0, 0,
+    116, 255, 50, 0, 0, 2, 147, 237, 244, 186, 21, 61, 255, 125, 61, 255,
+    125, 42, 253, 129, 67, 255, 101, 0, 152, 255, 255, 207, 10, 79, 255, 97,
+    33, 251, 142, 93, 255, 102, 40, 251, 157, 7, 162, 238, 245, 193, 33, 4,
+    152, 237, 230, 124, 0, 101, 255, 80, 90, 255, 72, 114, 255, 80, 90, 255,
+    147, 13, 179, 245, 215, 251, 167, 0, 0, 0, 21, 255, 136, 0, 0, 10,
+    151, 252, 43, 24, 255, 252, 213, 80, 0, 0, 255, 152, 0, 0, 255, 152,
+    0, 0, 0, 0, 0, 0, 255, 152, 0, 0, 255, 152, 0, 0, 255, 152,
+    0, 0, 255, 152, 0, 0, 0, 0, 0, 0, 255, 152, 0, 14, 255, 115,
+    0, 78, 207, 5, 0, 0, 0, 0, 2, 65, 156, 136, 0, 0, 49, 140,
+    227, 200, 114, 27, 0, 12, 255, 218, 59, 0, 0, 0, 0, 0, 50, 141,
+    227, 199, 113, 26, 0, 0, 0, 0, 2, 66, 157, 136, 0, 12, 255, 255,
+    255, 255, 255, 152, 0, 0, 0, 0, 0, 0, 0, 0, 0, 12, 255, 255,
+    255, 255, 255, 152, 0, 0, 0, 0, 0, 0, 0, 0, 0, 11, 205, 115,
+    26, 0, 0, 0, 0, 1, 67, 153, 232, 189, 98, 15, 0, 0, 0, 0,
+    7, 137, 252, 152, 0, 1, 66, 152, 232, 190, 99, 15, 0, 11, 206, 116,
+    27, 0, 0, 0, 0, 96, 255, 252, 215, 59, 0, 0, 40, 254, 146, 0,
+    16, 214, 224, 32, 0, 104, 255, 57, 0, 0, 0, 0, 0, 0, 0, 120,
+    255, 28, 0, 0, 120, 255, 28, 0, 0, 0, 86, 212, 249, 224, 130, 7,
+    0, 0, 131, 189, 54, 8, 35, 166, 167, 0, 29, 210, 11, 178, 234, 199,
+    96, 182, 43, 90, 125, 71, 210, 15, 209, 96, 125, 81, 91, 132, 72, 210,
+    15, 209, 113, 198, 37, 31, 213, 13, 180, 237, 197, 221, 96, 0, 0, 136,
+    191, 55, 9, 59, 179, 2, 0, 0, 0, 106, 216, 250, 215, 81, 0, 0,
+    0, 0, 181, 255, 168, 0, 0, 0, 18, 250, 254, 245, 11, 0, 0, 102,
+    255, 162, 255, 90, 0, 0, 190, 247, 27, 252, 179, 0, 25, 253, 184, 0,
+    196, 250, 18, 111, 255, 255, 255, 255, 255, 101, 200, 236, 7, 0, 11, 241,
+    191, 44, 255, 255, 250, 217, 80, 0, 44, 255, 132, 10, 224, 223, 0, 44,
+    255, 132, 15, 224, 206, 0, 44, 255, 255, 255, 255, 117, 0, 44, 255, 132,
+    4, 172, 253, 29, 44, 255, 132, 9, 168, 255, 39, 44, 255, 255, 254, 231,
+    129, 0, 0, 35, 175, 234, 242, 195, 4, 14, 228, 217, 42, 25, 139, 7,
+    97, 255, 93, 0, 0, 0, 0, 129, 255, 59, 0, 0, 0, 0, 97, 255,
+    92, 0, 0, 0, 0, 15, 229, 215, 41, 23, 137, 7, 0, 38, 177, 235,
+    245, 197, 4, 44, 255, 255, 245, 210, 109, 0, 44, 255, 132, 17, 137, 255,
+    102, 44, 255, 132, 0, 2, 230, 212, 44, 255, 132, 0, 0, 200, 245, 44,
+    255, 132, 0, 3, 231, 212, 44, 255, 132, 17, 137, 255, 102, 44, 255, 255,
+    246, 214, 110, 0, 44, 255, 255, 255, 255, 100, 44, 255, 132, 0, 0, 0,
+    44, 255, 132, 0, 0, 0, 44, 255, 255, 255, 255, 56, 44, 255, 132, 0,
+    0, 0, 44, 255, 132, 0, 0, 0, 44, 255, 255, 255, 255, 124, 44, 255,
+    255, 255, 255, 100, 44, 255, 132, 0, 0, 0, 44, 255, 132, 0, 0, 0,
+    44, 255, 255, 255, 255, 56, 44, 255, 132, 0, 0, 0, 44, 255, 132, 0,
+    0, 0, 44, 255, 132, 0, 0, 0, 0, 35, 172, 232, 246, 215, 82, 14,
+    227, 220, 50, 16, 92, 103, 97, 255, 94, 0, 0, 0, 0, 129, 255, 59,
+    0, 232, 255, 184, 97, 255, 91, 0, 0, 224, 184, 15, 229, 214, 43, 10,
+    229, 184, 0, 38, 178, 236, 245, 213, 111, 44, 255, 132, 0, 0, 252, 180,
+    0, 44, 255, 132, 0, 0, 252, 180, 0, 44, 255, 132, 0, 0, 252, 180,
+    0, 44, 255, 255, 255, 255, 255, 180, 0, 44, 255, 132, 0, 0, 252, 180,
+    0, 44, 255, 132, 0, 0, 252, 180, 0, 44, 255, 132, 0, 0, 252, 180,
+    0, 44, 255, 132, 44, 255, 132, 44, 255, 132, 44, 255, 132, 44, 255, 132,
+    44, 255, 132, 44, 255, 132, 0, 44, 255, 132, 0, 44, 255, 132, 0, 44,
+    255, 132, 0, 44, 255, 132, 0, 44, 255, 132, 0, 44, 255, 132, 0, 45,
+    255, 129, 1, 108, 255, 91, 127, 236, 151, 3, 44, 255, 132, 0, 134, 255,
+    113, 0, 44, 255, 132, 121, 255, 126, 0, 0, 44, 255, 217, 255, 138, 0,
+    0, 0, 44, 255, 255, 241, 23, 0, 0, 0, 44, 255, 194, 249, 209, 17,
+    0, 0, 44, 255, 132, 80, 251, 200, 12, 0, 44, 255, 132, 0, 91, 253,
+    190, 8, 44, 255, 132, 0, 0, 0, 44, 255, 132, 0, 0, 0, 44, 255,
+    132, 0, 0, 0, 44, 255, 132, 0, 0, 0, 44, 255, 132, 0, 0, 0,
+    44, 255, 132, 0, 0, 0, 44, 255, 255, 255, 255, 124, 44, 255, 255, 43,
+    0, 53, 255, 255, 32, 44, 255, 255, 139, 0, 151, 255, 255, 32, 44, 255,
+    209, 231, 12, 239, 206, 255, 32, 44, 255, 124, 244, 165, 238, 127, 255, 32,
+    44, 255, 112, 161, 255, 148, 120, 255, 32, 44, 255, 112, 64, 255, 52, 120,
+    255, 32, 44, 255, 112, 0, 0, 0, 120, 255, 32, 44, 255, 235, 11, 0,
+    228, 180, 0, 44, 255, 255, 119, 0, 228, 180, 0, 44, 255, 215, 235, 11,
+    228, 180, 0, 44, 255, 119, 228, 118, 228, 180, 0, 44, 255, 112, 109, 234,
+    236, 180, 0, 44, 255, 112, 8, 230, 255, 180, 0, 44, 255, 112, 0, 111,
+    255, 180, 0, 0, 46, 188, 240, 226, 147, 12, 0, 18, 236, 199, 23, 62,
+    247, 164, 0, 101, 255, 84, 0, 0, 173, 255, 12, 130, 255, 58, 0, 0,
+    146, 255, 42, 101, 255, 84, 0, 0, 173, 255, 13, 19, 237, 199, 23, 62,
+    247, 166, 0, 0, 49, 190, 241, 228, 149, 13, 0, 44, 255, 255, 254, 227,
+    112, 0, 44, 255, 132, 6, 177, 255, 33, 44, 255, 132, 12, 178, 255, 33,
+    44, 255, 255, 254, 227, 113, 0, 44, 255, 132, 0, 0, 0, 0, 44, 255,
+    132, 0, 0, 0, 0, 44, 255, 132, 0, 0, 0, 0, 0, 46, 188, 240,
+    227, 148, 13, 0, 18, 236, 199, 23, 62, 247, 166, 0, 101, 255, 84, 0,
+    0, 173, 255, 12, 130, 255, 58, 0, 0, 146, 255, 43, 101, 255, 82, 0,
+    0, 173, 254, 20, 20, 237, 195, 22, 62, 247, 173, 0, 0, 48, 188, 240,
+    255, 190, 16, 0, 0, 0, 0, 0, 119, 237, 56, 0, 44, 255, 255, 251,
+    219, 83, 0, 44, 255, 132, 15, 227, 219, 0, 44, 255, 132, 15, 228, 195,
+    0, 44, 255, 255, 255, 239, 40, 0, 44, 255, 132, 57, 251, 174, 0, 44,
+    255, 132, 0, 167, 254, 36, 44, 255, 132, 0, 64, 255, 139, 0, 139, 235,
+    249, 226, 76, 62, 255, 97, 15, 99, 86, 74, 255, 140, 29, 0, 0, 4,
+    169, 253, 255, 216, 59, 0, 0, 20, 91, 250, 194, 68, 128, 30, 31, 233,
+    182, 49, 204, 242, 246, 201, 46, 244, 255, 255, 255, 255, 255, 24, 0, 0,
+    200, 236, 0, 0, 0, 0, 0, 200, 236, 0, 0, 0, 0, 0, 200, 236,
+    0, 0, 0, 0, 0, 200, 236, 0, 0, 0, 0, 0, 200, 236, 0, 0,
+    0, 0, 0, 200, 236, 0, 0, 0, 44, 255, 132, 0, 52, 255, 124, 44,
+    255, 132, 0, 52, 255, 124, 44, 255, 132, 0, 52, 255, 124, 44, 255, 132,
+    0, 52, 255, 124, 35, 255, 136, 0, 57, 255, 115, 4, 236, 197, 13, 125,
+    255, 64, 0, 68, 208, 247, 227, 122, 0, 200, 231, 2, 0, 5, 238, 190,
+    111, 255, 64, 0, 73, 255, 101, 25, 253, 150, 0, 159, 250, 18, 0, 190,
+    232, 8, 238, 179, 0, 0, 102, 255, 141, 255, 90, 0, 0, 18, 250, 253,
+    245, 11, 0, 0, 0, 180, 255, 168, 0, 0, 160, 248, 7, 2, 242, 227,
+    0, 20, 255, 135, 102, 255, 57, 45, 250, 255, 28, 77, 255, 78, 45, 255,
+    114, 102, 197, 221, 85, 134, 255, 22, 2, 241, 172, 158, 140, 164, 141, 190,
+    221, 0, 0, 187, 229, 215, 84, 107, 201, 243, 165, 0, 0, 130, 255, 255,
+    28, 50, 255, 255, 108, 0, 0, 73, 255, 228, 0, 4, 244, 255, 52, 0,
+    107, 255, 89, 0, 106, 255, 89, 1, 197, 233, 46, 241, 182, 0, 0, 41,
+    249, 245, 243, 30, 0, 0, 0, 182, 255, 165, 0, 0, 0, 61, 254, 231,
+    251, 47, 0, 7, 215, 221, 25, 230, 203, 3, 130, 255, 69, 0, 82, 255,
+    114, 1, 199, 242, 25, 0, 141, 255, 76, 0, 47, 251, 166, 43, 251, 174,
+    0, 0, 0, 141, 255, 218, 243, 28, 0, 0, 0, 12, 226, 255, 114, 0,
+    0, 0, 0, 0, 152, 255, 28, 0, 0, 0, 0, 0, 152, 255, 28, 0,
+    0, 0, 0, 0, 152, 255, 28, 0, 0, 128, 255, 255, 255, 255, 255, 4,
+    0, 0, 0, 113, 255, 193, 0, 0, 0, 49, 249, 237, 28, 0, 0, 11,
+    217, 255, 80, 0, 0, 0, 159, 255, 150, 0, 0, 0, 85, 255, 212, 8,
+    0, 0, 0, 152, 255, 255, 255, 255, 255, 32, 56, 255, 255, 128, 56, 255,
+    68, 0, 56, 255, 68, 0, 56, 255, 68, 0, 56, 255, 68, 0, 56, 255,
+    68, 0, 56, 255, 68, 0, 56, 255, 255, 128, 213, 34, 0, 0, 129, 118,
+    0, 0, 45, 203, 0, 0, 0, 215, 32, 0, 0, 132, 116, 0, 0, 47,
+    200, 0, 0, 0, 217, 30, 100, 255, 255, 88, 0, 40, 255, 88, 0, 40,
+    255, 88, 0, 40, 255, 88, 0, 40, 255, 88, 0, 40, 255, 88, 0, 40,
+    255, 88, 100, 255, 255, 88, 0, 0, 97, 248, 203, 23, 0, 0, 0, 130,
+    174, 31, 93, 200, 43, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 255, 255, 255, 255, 128, 56, 223, 15, 0, 0, 0, 96, 148,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 48, 255, 255, 235, 141,
+    0, 0, 0, 1, 94, 255, 56, 47, 206, 247, 255, 255, 89, 142, 255, 52,
+    111, 255, 92, 55, 224, 255, 255, 255, 92, 64, 255, 84, 0, 0, 0, 0,
+    64, 255, 84, 0, 0, 0, 0, 64, 255, 84, 0, 0, 0, 0, 64, 255,
+    255, 255, 222, 58, 0, 64, 255, 155, 18, 212, 212, 0, 64, 255, 90, 0,
+    159, 252, 1, 64, 255, 153, 17, 211, 212, 0, 64, 255, 255, 255, 222, 59,
+    0, 1, 133, 229, 255, 188, 95, 255, 107, 3, 0, 144, 255, 17, 0, 0,
+    96, 255, 105, 3, 0, 2, 136, 230, 255, 188, 0, 0, 0, 0, 228, 176,
+    0, 0, 0, 0, 228, 176, 0, 0, 0, 0, 228, 176, 7, 170, 249, 255,
+    255, 176, 102, 255, 82, 49, 253, 176, 143, 255, 14, 0, 235, 176, 102, 255,
+    80, 47, 253, 176, 7, 171, 249, 255, 255, 176, 2, 140, 232, 238, 155, 5,
+    98, 255, 77, 42, 254, 111, 145, 255, 255, 255, 255, 165, 98, 255, 70, 1,
+    0, 0, 2, 139, 231, 255, 255, 112, 0, 114, 242, 255, 0, 243, 164, 0,
+    11, 255, 136, 0, 212, 255, 255, 224, 12, 255, 136, 0, 12, 255, 136, 0,
+    12, 255, 136, 0, 12, 255, 136, 0, 7, 170, 249, 255, 255, 176, 102, 255,
+    82, 51, 253, 176, 143, 255, 14, 0, 235, 176, 102, 255, 80, 51, 253, 176,
+    7, 171, 249, 255, 255, 176, 0, 0, 1, 45, 248, 145, 0, 255, 255, 237,
+    170, 19, 64, 255, 84, 0, 0, 0, 64, 255, 84, 0, 0, 0, 64, 255,
+    84, 0, 0, 0, 64, 255, 255, 255, 228, 57, 64, 255, 157, 22, 243, 165,
+    64, 255, 87, 0, 224, 180, 64, 255, 84, 0, 224, 180, 64, 255, 84, 0,
+    224, 180, 64, 255, 84, 64, 255, 84, 0, 0, 0, 64, 255, 84, 64, 255,
+    84, 64, 255, 84, 64, 255, 84, 64, 255, 84, 0, 64, 255, 84, 0, 64,
+    255, 84, 0, 0, 0, 0, 0, 64, 255, 84, 0, 64, 255, 84, 0, 64,
+    255, 84, 0, 64, 255, 84, 0, 64, 255, 83, 0, 94, 255, 63, 76, 250,
+    175, 3, 64, 255, 84, 0, 0, 0, 0, 64, 255, 84, 0, 0, 0, 0,
+    64, 255, 84, 0, 0, 0, 0, 64, 255, 84, 93, 252, 114, 0, 64, 255,
+    171, 251, 103, 0, 0, 64, 255, 255, 208, 7, 0, 0, 64, 255, 133, 241,
+    177, 5, 0, 64, 255, 84, 63, 247, 169, 3, 64, 255, 84, 64, 255, 84,
+    64, 255, 84, 64, 255, 84, 64, 255, 84, 64, 255, 84, 64, 255, 84, 64,
+    255, 84, 64, 255, 255, 255, 238, 205, 246, 225, 52, 64, 255, 150, 58, 255,
+    190, 27, 246, 157, 64, 255, 86, 20, 255, 130, 0, 234, 172, 64, 255, 84,
+    20, 255, 128, 0, 236, 172, 64, 255, 84, 20, 255, 128, 0, 236, 172, 64,
+    255, 255, 255, 228, 57, 64, 255, 157, 22, 244, 165, 64, 255, 87, 0, 224,
+    180, 64, 255, 84, 0, 224, 180, 64, 255, 84, 0, 224, 180, 2, 141, 233,
+    239, 168, 16, 98, 255, 83, 43, 250, 145, 145, 255, 14, 0, 223, 192, 99,
+    255, 81, 41, 250, 146, 2, 144, 234, 240, 171, 17, 64, 255, 255, 255, 222,
+    58, 0, 64, 255, 155, 18, 212, 212, 0, 64, 255, 90, 0, 159, 252, 1,
+    64, 255, 153, 17, 211, 212, 0, 64, 255, 255, 255, 222, 59, 0, 64, 255,
+    84, 0, 0, 0, 0, 64, 255, 84, 0, 0, 0, 0, 7, 170, 249, 255,
+    255, 176, 102, 255, 82, 49, 253, 176, 143, 255, 14, 0, 235, 176, 102, 255,
+    80, 47, 253, 176, 7, 171, 249, 255, 255, 176, 0, 0, 0, 0, 228, 176,
+    0, 0, 0, 0, 228, 176, 64, 255, 255, 255, 104, 64, 255, 166, 8, 0,
+    64, 255, 87, 0, 0, 64, 255, 84, 0, 0, 64, 255, 84, 0, 0, 36,
+    206, 250, 255, 152, 124, 249, 104, 42, 0, 63, 245, 255, 255, 163, 0, 13,
+    68, 209, 226, 116, 255, 254, 228, 99, 24, 255, 120, 0, 0, 224, 255, 255,
+    255, 24, 24, 255, 120, 0, 0, 24, 255, 120, 0, 0, 17, 255, 139, 0,
+    0, 0, 172, 250, 244, 0, 76, 255, 72, 0, 236, 168, 76, 255, 72, 0,
+    236, 168, 76, 255, 72, 0, 239, 168, 62, 255, 110, 58, 255, 168, 4, 183,
+    251, 255, 255, 168, 171, 223, 1, 14, 247, 137, 73, 255, 61, 96, 255, 39,
+    2, 227, 152, 186, 195, 0, 0, 132, 240, 252, 96, 0, 0, 34, 254, 242,
+    11, 0, 143, 242, 3, 159, 237, 1, 168, 222, 77, 255, 51, 220, 244, 45,
+    229, 156, 14, 252, 139, 236, 160, 143, 255, 89, 0, 200, 243, 176, 97, 245,
+    255, 23, 0, 133, 255, 114, 35, 255, 213, 0, 107, 253, 60, 112, 252, 58,
+    0, 175, 224, 246, 125, 0, 0, 47, 255, 243, 11, 0, 3, 194, 212, 239,
+    149, 0, 127, 248, 44, 90, 255, 79, 175, 223, 1, 16, 250, 131, 67, 255,
+    68, 95, 255, 37, 0, 215, 167, 180, 197, 0, 0, 109, 248, 249, 102, 0,
+    0, 14, 243, 247, 16, 0, 0, 11, 216, 165, 0, 0, 24, 255, 217, 35,
+    0, 0, 124, 255, 255, 255, 208, 0, 0, 116, 255, 124, 0, 95, 254, 150,
+    0, 73, 251, 170, 2, 0, 152, 255, 255, 255, 208, 0, 0, 48, 221, 254,
+    72, 0, 0, 127, 254, 22, 0, 0, 4, 164, 243, 0, 0, 0, 224, 255,
+    146, 0, 0, 0, 11, 204, 236, 0, 0, 0, 0, 142, 252, 0, 0, 0,
+    0, 123, 255, 34, 0, 0, 0, 39, 217, 254, 72, 0, 220, 36, 0, 220,
+    36, 0, 220, 36, 0, 220, 36, 0, 220, 36, 0, 220, 36, 0, 220, 36,
+    0, 220, 36, 0, 220, 36, 0, 224, 243, 129, 0, 0, 0, 2, 169, 231,
+    0, 0, 0, 0, 139, 247, 25, 0, 0, 0, 50, 246, 255, 72, 0, 0,
+    132, 255, 63, 0, 0, 0, 148, 245, 0, 0, 0, 4, 181, 226, 0, 0,
+    0, 224, 242, 117, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 128,
+    237, 177, 41, 45, 114, 0, 8, 91, 14, 98, 226, 209, 44, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const struct glyph font11_glyphs[] = {
+    {0, 0, 0, 0, 4, 0}, /* space */
+    {0, 8, 5, 8, 5, 0}, /* ! */
+    {0, 8, 6, 8, 6, 40}, /* " */
+    {0, 8, 9, 8, 9, 88}, /* # */
+    {0, 8, 8, 10, 8, 160}, /* $ */
+    {0, 8, 11, 8, 11, 240}, /* % */
+    {0, 8, 10, 8, 10, 328}, /* & */
+    {0, 8, 3, 8, 3, 408}, /* ' */
+    {0, 9, 5, 10, 5, 432}, /* ( */
+    {0, 9, 5, 10, 5, 482}, /* ) */
+    {0, 8, 6, 8, 6, 532}, /* asterisk */
+    {0, 7, 9, 7, 9, 580}, /* + */
+    {0, 2, 4, 4, 4, 643}, /* , */
+    {0, 4, 5, 4, 5, 659}, /* - */
+    {0, 2, 4, 2, 4, 679}, /* . */
+    {0, 8, 5, 9, 4, 687}, /* / */
+    {0, 8, 8, 8, 8, 732}, /* 0 */
+    {0, 8, 8, 8, 8, 796}, /* 1 */
+    {0, 8, 8, 8, 8, 860}, /* 2 */
+    {0, 8, 8, 8, 8, 924}, /* 3 */
+    {0, 8, 8, 8, 8, 988}, /* 4 */
+    {0, 8, 8, 8, 8, 1052}, /* 5 */
+    {0, 8, 8, 8, 8, 1116}, /* 6 */
+    {0, 8, 8, 8, 8, 1180}, /* 7 */
+    {0, 8, 8, 8, 8, 1244}, /* 8 */
+    {0, 8, 8, 8, 8, 1308}, /* 9 */
+    {0, 6, 4, 6, 4, 1372}, /* : */
+    {0, 6, 4, 8, 4, 1396}, /* ; */
+    {0, 7, 9, 7, 9, 1428}, /* < */
+    {0, 5, 9, 5, 9, 1491}, /* = */
+    {0, 7, 9, 7, 9, 1536}, /* > */
+    {0, 8, 6, 8, 6, 1599}, /* ? */
+    {0, 8, 11, 10, 11, 1647}, /* @ */
+    {0, 8, 9, 8, 9, 1757}, /* A */
+    {0, 8, 8, 8, 8, 1829}, /* B */
+    {0, 8, 8, 8, 8, 1893}, /* C */
+    {0, 8, 9, 8, 9, 1957}, /* D */
+    {0, 8, 8, 8, 8, 2029}, /* E */
+    {0, 8, 8, 8, 8, 2093}, /* F */
+    {0, 8, 9, 8, 9, 2157}, /* G */
+    {0, 8, 9, 8, 9, 2229}, /* H */
+    {0, 8, 4, 8, 4, 2301}, /* I */
+    {-1, 8, 5, 10, 4, 2333}, /* J */
+    {0, 8, 9, 8, 9, 2383}, /* K */
+    {0, 8, 7, 8, 7, 2455}, /* L */
+    {0, 8, 11, 8, 11, 2511}, /* M */
+    {0, 8, 9, 8, 9, 2599}, /* N */
+    {0, 8, 9, 8, 9, 2671}, /* O */
+    {0, 8, 8, 8, 8, 2743}, /* P */
+    {0, 8, 9, 10, 9, 2807}, /* Q */
+    {0, 8, 9, 8, 8, 2897}, /* R */
+    {0, 8, 8, 8, 8, 2969}, /* S */
+    {0, 8, 8, 8, 8, 3033}, /* T */
+    {0, 8, 9, 8, 9, 3097}, /* U */
+    {0, 8, 9, 8, 9, 3169}, /* V */
+    {0, 8, 12, 8, 12, 3241}, /* W */
+    {0, 8, 9, 8, 8, 3337}, /* X */
+    {-1, 8, 10, 8, 8, 3409}, /* Y */
+    {0, 8, 8, 8, 8, 3489}, /* Z */
+    {0, 9, 5, 10, 5, 3553}, /* [ */
+    {0, 8, 5, 9, 4, 3603}, /* backslash */
+    {0, 9, 5, 10, 5, 3648}, /* ] */
+    {0, 8, 9, 8, 9, 3698}, /* ^ */
+    {0, 0, 6, 3, 6, 3770}, /* _ */
+    {0, 9, 6, 9, 6, 3788}, /* ` */
+    {0, 6, 7, 6, 7, 3842}, /* a */
+    {0, 9, 8, 9, 8, 3884}, /* b */
+    {0, 6, 7, 6, 7, 3956}, /* c */
+    {0, 9, 8, 9, 8, 3998}, /* d */
+    {0, 6, 7, 6, 7, 4070}, /* e */
+    {0, 9, 5, 9, 5, 4112}, /* f */
+    {0, 6, 8, 8, 8, 4157}, /* g */
+    {0, 9, 8, 9, 8, 4221}, /* h */
+    {0, 9, 4, 9, 4, 4293}, /* i */
+    {-1, 9, 5, 11, 4, 4329}, /* j */
+    {0, 9, 8, 9, 7, 4384}, /* k */
+    {0, 9, 4, 9, 4, 4456}, /* l */
+    {0, 6, 11, 6, 11, 4492}, /* m */
+    {0, 6, 8, 6, 8, 4558}, /* n */
+    {0, 6, 8, 6, 8, 4606}, /* o */
+    {0, 6, 8, 8, 8, 4654}, /* p */
+    {0, 6, 8, 8, 8, 4718}, /* q */
+    {0, 6, 6, 6, 5, 4782}, /* r */
+    {0, 6, 7, 6, 7, 4818}, /* s */
+    {0, 8, 5, 8, 5, 4860}, /* t */
+    {0, 6, 8, 6, 8, 4900}, /* u */
+    {0, 6, 8, 6, 7, 4948}, /* v */
+    {0, 6, 10, 6, 10, 4996}, /* w */
+    {0, 6, 7, 6, 7, 5056}, /* x */
+    {0, 6, 7, 8, 7, 5098}, /* y */
+    {0, 6, 6, 6, 6, 5154}, /* z */
+    {0, 9, 8, 10, 8, 5190}, /* { */
+    {0, 8, 4, 11, 4, 5270}, /* | */
+    {0, 9, 8, 10, 8, 5314}, /* } */
+    {0, 5, 9, 5, 9, 5394}, /* ~ */
+};
+
+static const unsigned char font11_bitmap[] = {
+    0, 116, 255, 120, 0, 0, 116, 255, 120, 0, 0, 115, 255, 119, 0, 0,
+    97, 255, 100, 0, 0, 64, 255, 68, 0, 0, 0, 0, 0, 0, 0, 116,
+    255, 120, 0, 0, 116, 255, 120, 0, 0, 244, 84, 152, 176, 0, 0, 244,
+    84, 152, 176, 0, 0, 244, 84, 152, 176, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 99, 205, 0, 199, 105,
+    0, 0, 0, 0, 143, 161, 0, 241, 61, 0, 0, 0, 0, 186, 117, 30,
+    255, 17, 0, 0, 164, 255, 255, 255, 255, 255, 255, 120, 0, 0, 76, 226,
+    2, 176, 131, 0, 0, 64, 255, 255, 255, 255, 255, 255, 220, 0, 0, 0,
+    225, 78, 70, 233, 1, 0, 0, 0, 35, 252, 15, 135, 168, 0, 0, 0,
+    0, 0, 0, 156, 68, 0, 0, 0, 0, 73, 211, 252, 255, 255, 108, 0,
+    6, 243, 183, 158, 68, 0, 0, 0, 23, 255, 247, 231, 146, 43, 0, 0,
+    0, 189, 255, 255, 255, 254, 115, 0, 0, 4, 82, 206, 232, 255, 217, 0,
+    0, 0, 0, 152, 82, 235, 193, 0, 31, 251, 248, 252, 244, 188, 41, 0,
+    0, 0, 0, 152, 68, 0, 0, 0, 0, 0, 0, 152, 68, 0, 0, 0,
+    28, 197, 246, 196, 27, 0, 8, 219, 75, 0, 0, 140, 215, 16, 220, 140,
+    0, 133, 170, 0, 0, 0, 140, 214, 26, 220, 139, 43, 235, 25, 0, 0,
+    0, 28, 197, 246, 196, 28, 196, 105, 0, 0, 0, 0, 0, 0, 0, 0,
+    103, 199, 27, 193, 246, 199, 31, 0, 0, 0, 23, 234, 45, 136, 221, 16,
+    215, 148, 0, 0, 0, 168, 136, 0, 136, 220, 26, 215, 147, 0, 0, 71,
+    222, 9, 0, 25, 194, 246, 200, 30, 0, 0, 113, 226, 254, 255, 124, 0,
+    0, 0, 0, 19, 255, 225, 11, 0, 0, 0, 0, 0, 0, 4, 230, 255,
+    108, 0, 0, 0, 0, 0, 0, 166, 255, 254, 250, 59, 3, 249, 170, 0,
+    53, 255, 198, 81, 254, 230, 85, 255, 121, 0, 73, 255, 145, 0, 125, 255,
+    253, 247, 30, 0, 18, 236, 230, 44, 25, 230, 255, 195, 1, 0, 0, 51,
+    191, 243, 242, 199, 189, 255, 157, 1, 0, 244, 84, 0, 244, 84, 0, 244,
+    84, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 185, 226, 5, 0, 57, 255, 120, 0, 0, 156, 255, 35, 0, 0,
+    223, 233, 0, 0, 3, 254, 204, 0, 0, 3, 254, 204, 0, 0, 0, 224,
+    233, 0, 0, 0, 156, 255, 35, 0, 0, 57, 255, 120, 0, 0, 0, 184,
+    226, 5, 4, 224, 188, 0, 0, 0, 116, 255, 61, 0, 0, 31, 255, 160,
+    0, 0, 0, 229, 229, 0, 0, 0, 201, 255, 9, 0, 0, 202, 255, 9,
+    0, 0, 230, 231, 0, 0, 31, 255, 164, 0, 0, 117, 255, 63, 0, 4,
+    224, 189, 0, 0, 0, 0, 148, 84, 0, 0, 126, 146, 172, 133, 175, 72,
+    0, 135, 255, 249, 82, 0, 126, 147, 172, 133, 176, 72, 0, 0, 148, 84,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 8, 255, 64, 0, 0, 0, 0, 0, 0,
+    8, 255, 64, 0, 0, 0, 0, 0, 0, 8, 255, 64, 0, 0, 0, 0,
+    212, 255, 255, 255, 255, 255, 255, 12, 0, 0, 0, 8, 255, 64, 0, 0,
+    0, 0, 0, 0, 8, 255, 64, 0, 0, 0, 0, 0, 0, 8, 255, 64,
+    0, 0, 0, 0, 224, 255, 16, 0, 225, 255, 13, 15, 253, 163, 0, 76,
+    241, 24, 0, 104, 255, 255, 248, 0, 104, 255, 255, 248, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 224, 255, 16, 0, 224, 255, 16, 0,
+    0, 85, 219, 0, 0, 0, 165, 139, 0, 0, 5, 239, 58, 0, 0, 70,
+    232, 2, 0, 0, 150, 153, 0, 0, 1, 229, 73, 0, 0, 55, 242, 6,
+    0, 0, 136, 168, 0, 0, 0, 216, 88, 0, 0, 0, 0, 38, 187, 247,
+    235, 144, 5, 0, 2, 212, 239, 35, 104, 255, 127, 0, 67, 255, 178, 0,
+    11, 255, 234, 0, 104, 255, 157, 0, 0, 246, 255, 15, 104, 255, 158, 0,
+    0, 247, 255, 15, 67, 255, 179, 0, 11, 255, 234, 0, 2, 214, 239, 35,
+    104, 255, 128, 0, 0, 39, 189, 248, 236, 146, 6, 0, 0, 196, 255, 255,
+    255, 20, 0, 0, 0, 0, 0, 228, 255, 20, 0, 0, 0, 0, 0, 228,
+    255, 20, 0, 0, 0, 0, 0, 228, 255, 20, 0, 0, 0, 0, 0, 228,
+    255, 20, 0, 0, 0, 0, 0, 228, 255, 20, 0, 0, 0, 0, 0, 228,
+    255, 20, 0, 0, 0, 180, 255, 255, 255, 255, 228, 0, 28, 255, 255, 253,
+    228, 139, 4, 0, 0, 0, 0, 16, 183, 255, 111, 0, 0, 0, 0, 0,
+    139, 255, 152, 0, 0, 0, 0, 60, 248, 253, 64, 0, 0, 0, 33, 235,
+    252, 97, 0, 0, 0, 13, 211, 255, 107, 0, 0, 0, 2, 179, 255, 150,
+    0, 0, 0, 0, 32, 255, 255, 255, 255, 255, 180, 0, 0, 67, 199, 246,
+    233, 164, 18, 0, 0, 154, 37, 15, 181, 255, 130, 0, 0, 0, 0, 16,
+    180, 255, 95, 0, 0, 0, 228, 255, 255, 177, 5, 0, 0, 0, 0, 23,
+    179, 255, 137, 0, 0, 0, 0, 0, 87, 255, 188, 0, 61, 127, 28, 19,
+    175, 255, 128, 0, 5, 120, 220, 246, 218, 129, 4, 0, 0, 0, 0, 169,
+    255, 255, 0, 0, 0, 0, 101, 250, 252, 255, 0, 0, 0, 42, 245, 125,
+    244, 255, 0, 0, 8, 211, 202, 4, 244, 255, 0, 0, 114, 247, 40, 0,
+    244, 255, 0, 0, 128, 255, 255, 255, 255, 255, 255, 40, 0, 0, 0, 0,
+    244, 255, 0, 0, 0, 0, 0, 0, 244, 255, 0, 0, 0, 212, 255, 255,
+    255, 255, 80, 0, 0, 212, 208, 0, 0, 0, 0, 0, 0, 212, 208, 0,
+    0, 0, 0, 0, 0, 212, 252, 249, 231, 157, 16, 0, 0, 0, 0, 13,
+    157, 255, 161, 0, 0, 0, 0, 0, 59, 255, 214, 0, 0, 0, 0, 13,
+    157, 255, 156, 0, 40, 255, 255, 252, 227, 148, 12, 0, 0, 4, 131, 226,
+    253, 255, 136, 0, 0, 139, 255, 118, 11, 0, 0, 0, 17, 250, 214, 0,
+    0, 0, 0, 0, 58, 255, 230, 224, 245, 192, 41, 0, 66, 255, 253, 49,
+    57, 255, 213, 0, 30, 255, 234, 0, 0, 243, 253, 5, 0, 181, 253, 48,
+    56, 255, 195, 0, 0, 23, 173, 244, 237, 171, 28, 0, 68, 255, 255, 255,
+    255, 255, 200, 0, 0, 0, 0, 0, 159, 255, 158, 0, 0, 0, 0, 19,
+    247, 254, 43, 0, 0, 0, 0, 119, 255, 181, 0, 0, 0, 0, 2, 223,
+    255, 64, 0, 0, 0, 0, 79, 255, 203, 0, 0, 0, 0, 0, 187, 255,
+    86, 0, 0, 0, 0, 39, 254, 223, 3, 0, 0, 0, 0, 95, 213, 247,
+    239, 187, 40, 0, 18, 254, 233, 23, 91, 255, 181, 0, 10, 234, 233, 30,
+    97, 255, 153, 0, 0, 68, 244, 255, 255, 207, 15, 0, 23, 241, 223, 25,
+    81, 255, 173, 0, 73, 255, 167, 0, 4, 255, 237, 0, 31, 250, 222, 23,
+    79, 255, 189, 0, 0, 82, 207, 245, 236, 177, 32, 0, 0, 75, 205, 246,
+    227, 119, 0, 0, 40, 250, 205, 16, 137, 255, 88, 0, 99, 255, 150, 0,
+    71, 255, 193, 0, 56, 255, 205, 16, 137, 255, 229, 0, 0, 105, 223, 248,
+    205, 255, 231, 0, 0, 0, 0, 0, 54, 255, 180, 0, 0, 0, 0, 30,
+    194, 252, 60, 0, 0, 232, 255, 249, 202, 70, 0, 0, 0, 196, 255, 44,
+    0, 196, 255, 44, 0, 0, 0, 0, 0, 0, 0, 0, 0, 196, 255, 44,
+    0, 196, 255, 44, 0, 196, 255, 44, 0, 196, 255, 44, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 196, 255, 44, 0, 197, 255, 40, 2, 238, 190, 0,
+    48, 250, 42, 0, 0, 0, 0, 0, 0, 30, 117, 206, 11, 0, 0, 21,
+    106, 195, 254, 207, 122, 3, 0, 159, 251, 204, 119, 35, 0, 0, 0, 0,
+    159, 251, 203, 118, 34, 0, 0, 0, 0, 0, 22, 107, 196, 254, 206, 121,
+    3, 0, 0, 0, 0, 0, 30, 118, 207, 11, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 212, 255, 255, 255, 255, 255, 255, 12, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 212, 255, 255, 255, 255, 255, 255, 12, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 181, 137, 48, 0, 0, 0, 0, 0, 0, 91, 188, 252, 215, 126, 37,
+    0, 0, 0, 0, 0, 20, 101, 185, 250, 204, 7, 0, 0, 0, 20, 100,
+    184, 250, 205, 7, 0, 91, 187, 252, 215, 127, 38, 0, 0, 0, 181, 138,
+    49, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 64,
+    255, 255, 243, 191, 37, 0, 0, 1, 109, 255, 153, 0, 0, 30, 224, 255,
+    91, 0, 0, 199, 255, 117, 0, 0, 20, 255, 222, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 32, 255, 208, 0, 0, 0, 32, 255, 208, 0, 0, 0,
+    0, 11, 128, 218, 248, 226, 145, 18, 0, 0, 0, 15, 208, 171, 51, 10,
+    33, 141, 223, 28, 0, 0, 159, 154, 13, 182, 236, 181, 200, 127, 171, 0,
+    16, 243, 16, 123, 206, 21, 203, 200, 10, 242, 14, 60, 202, 0, 181, 131,
+    0, 124, 200, 0, 210, 45, 61, 199, 0, 181, 131, 0, 124, 200, 0, 229,
+    21, 17, 242, 16, 124, 207, 20, 200, 202, 110, 185, 0, 0, 164, 158, 14,
+    184, 238, 181, 232, 161, 21, 0, 0, 18, 212, 173, 41, 5, 37, 161, 94,
+    0, 0, 0, 0, 13, 134, 221, 250, 228, 141, 19, 0, 0, 0, 0, 40,
+    255, 255, 170, 0, 0, 0, 0, 0, 136, 255, 254, 248, 17, 0, 0, 0,
+    2, 228, 249, 148, 255, 104, 0, 0, 0, 71, 255, 175, 42, 255, 199, 0,
+    0, 0, 166, 255, 85, 0, 209, 255, 39, 0, 14, 246, 255, 255, 255, 255,
+    255, 133, 0, 101, 255, 130, 0, 0, 8, 248, 226, 2, 196, 255, 64, 0,
+    0, 0, 192, 255, 68, 0, 252, 255, 255, 247, 219, 118, 0, 0, 252, 255,
+    20, 20, 231, 255, 46, 0, 252, 255, 20, 26, 230, 253, 39, 0, 252, 255,
+    255, 255, 255, 160, 0, 0, 252, 255, 20, 12, 189, 255, 90, 0, 252, 255,
+    20, 0, 124, 255, 146, 0, 252, 255, 20, 12, 189, 255, 102, 0, 252, 255,
+    255, 251, 226, 138, 3, 0, 2, 112, 210, 248, 242, 208, 62, 0, 161, 255,
+    170, 29, 24, 104, 82, 48, 255, 238, 11, 0, 0, 0, 0, 105, 255, 191,
+    0, 0, 0, 0, 0, 105, 255, 191, 0, 0, 0, 0, 0, 48, 255, 238,
+    11, 0, 0, 0, 0, 0, 161, 255, 169, 29, 22, 101, 81, 0, 3, 113,
+    211, 249, 245, 211, 63, 0, 252, 255, 252, 241, 206, 122, 6, 0, 0, 252,
+    255, 20, 30, 156, 255, 186, 1, 0, 252, 255, 20, 0, 3, 220, 255, 74,
+    0, 252, 255, 20, 0, 0, 164, 255, 133, 0, 252, 255, 20, 0, 0, 165,
+    255, 132, 0, 252, 255, 20, 0, 3, 220, 255, 74, 0, 252, 255, 20, 30,
+    156, 255, 186, 1, 0, 252, 255, 252, 242, 208, 123, 6, 0, 0, 252, 255,
+    255, 255, 255, 152, 0, 0, 252, 255, 20, 0, 0, 0, 0, 0, 252, 255,
+    20, 0, 0, 0, 0, 0, 252, 255, 255, 255, 255, 96, 0, 0, 252, 255,
+    20, 0, 0, 0, 0, 0, 252, 255, 20, 0, 0, 0, 0, 0, 252, 255,
+    20, 0, 0, 0, 0, 0, 252, 255, 255, 255, 255, 180, 0, 0, 252, 255,
+    255, 255, 255, 152, 0, 0, 252, 255, 20, 0, 0, 0, 0, 0, 252, 255,
+    20, 0, 0, 0, 0, 0, 252, 255, 255, 255, 255, 96, 0, 0, 252, 255,
+    20, 0, 0, 0, 0, 0, 252, 255, 20, 0, 0, 0, 0, 0, 252, 255,
+    20, 0, 0, 0, 0, 0, 252, 255, 20, 0, 0, 0, 0, 0, 2, 107,
+    206, 246, 246, 224, 165, 0, 0, 159, 255, 179, 37, 14, 68, 175, 0, 48,
+    255, 239, 14, 0, 0, 0, 0, 0, 104, 255, 192, 0, 0, 0, 0, 0,
+    0, 105, 255, 191, 0, 0, 255, 255, 255, 56, 48, 255, 238, 11, 0, 0,
+    192, 255, 56, 0, 161, 255, 171, 31, 9, 201, 255, 56, 0, 3, 113, 211,
+    249, 245, 223, 171, 29, 0, 252, 255, 20, 0, 0, 224, 255, 52, 0, 252,
+    255, 20, 0, 0, 224, 255, 52, 0, 252, 255, 20, 0, 0, 224, 255, 52,
+    0, 252, 255, 255, 255, 255, 255, 255, 52, 0, 252, 255, 20, 0, 0, 224,
+    255, 52, 0, 252, 255, 20, 0, 0, 224, 255, 52, 0, 252, 255, 20, 0,
+    0, 224, 255, 52, 0, 252, 255, 20, 0, 0, 224, 255, 52, 0, 252, 255,
+    20, 0, 252, 255, 20, 0, 252, 255, 20, 0, 252, 255, 20, 0, 252, 255,
+    20, 0, 252, 255, 20, 0, 252, 255, 20, 0, 252, 255, 20, 0, 0, 252,
+    255, 20, 0, 0, 252, 255, 20, 0, 0, 252, 255, 20, 0, 0, 252, 255,
+    20, 0, 0, 252, 255, 20, 0, 0, 252, 255, 20, 0, 0, 252, 255, 20,
+    0, 2, 253, 255, 14, 1, 86, 255, 217, 0, 159, 237, 185, 45, 0, 0,
+    252, 255, 20, 0, 115, 255, 215, 25, 0, 252, 255, 20, 120, 255, 212, 23,
+    0, 0, 252, 255, 144, 255, 209, 21, 0, 0, 0, 252, 255, 255, 218, 19,
+    0, 0, 0, 0, 252, 255, 252, 251, 86, 0, 0, 0, 0, 252, 255, 94,
+    248, 252, 88, 0, 0, 0, 252, 255, 20, 72, 247, 252, 90, 0, 0, 252,
+    255, 20, 0, 70, 247, 253, 93, 0, 252, 255, 20, 0, 0, 0, 0, 252,
+    255, 20, 0, 0, 0, 0, 252, 255, 20, 0, 0, 0, 0, 252, 255, 20,
+    0, 0, 0, 0, 252, 255, 20, 0, 0, 0, 0, 252, 255, 20, 0, 0,
+    0, 0, 252, 255, 20, 0, 0, 0, 0, 252, 255, 255, 255, 255, 180, 0,
+    252, 255, 219, 2, 0, 6, 229, 255, 240, 0, 0, 252, 255, 255, 84, 0,
+    98, 255, 255, 240, 0, 0, 252, 248, 205, 202, 1, 215, 196, 255, 240, 0,
+    0, 252, 248, 88, 255, 144, 255, 78, 255, 240, 0, 0, 252, 248, 3, 222,
+    255, 208, 8, 255, 240, 0, 0, 252, 248, 0, 107, 255, 90, 8, 255, 240,
+    0, 0, 252, 248, 0, 0, 0, 0, 8, 255, 240, 0, 0, 252, 248, 0,
+    0, 0, 0, 8, 255, 240, 0, 0, 252, 255, 147, 0, 0, 196, 255, 52,
+    0, 252, 255, 250, 33, 0, 196, 255, 52, 0, 252, 252, 243, 164, 0, 196,
+    255, 52, 0, 252, 248, 130, 254, 47, 196, 255, 52, 0, 252, 248, 14, 235,
+    181, 196, 255, 52, 0, 252, 248, 0, 113, 255, 240, 255, 52, 0, 252, 248,
+    0, 7, 225, 255, 255, 52, 0, 252, 248, 0, 0, 96, 255, 255, 52, 0,
+    7, 131, 220, 250, 236, 171, 37, 0, 0, 178, 255, 137, 17, 71, 244, 236,
+    29, 54, 255, 232, 4, 0, 0, 146, 255, 141, 106, 255, 189, 0, 0, 0,
+    97, 255, 193, 106, 255, 188, 0, 0, 0, 98, 255, 193, 54, 255, 231, 4,
+    0, 0, 146, 255, 141, 0, 178, 255, 135, 16, 70, 243, 236, 29, 0, 7,
+    131, 221, 250, 237, 171, 37, 0, 0, 252, 255, 255, 250, 220, 118, 0, 0,
+    252, 255, 20, 18, 205, 255, 91, 0, 252, 255, 20, 0, 140, 255, 143, 0,
+    252, 255, 20, 18, 205, 255, 92, 0, 252, 255, 255, 251, 221, 122, 0, 0,
+    252, 255, 20, 0, 0, 0, 0, 0, 252, 255, 20, 0, 0, 0, 0, 0,
+    252, 255, 20, 0, 0, 0, 0, 0, 7, 131, 220, 250, 235, 170, 36, 0,
+    0, 178, 255, 137, 17, 71, 244, 235, 27, 54, 255, 232, 4, 0, 0, 146,
+    255, 139, 106, 255, 189, 0, 0, 0, 97, 255, 191, 106, 255, 187, 0, 0,
+    0, 98, 255, 190, 55, 255, 229, 2, 0, 0, 146, 255, 140, 0, 181, 255,
+    130, 15, 70, 243, 237, 31, 0, 8, 132, 220, 251, 255, 219, 46, 0, 0,
+    0, 0, 0, 2, 198, 243, 35, 0, 0, 0, 0, 0, 0, 40, 247, 202,
+    5, 0, 252, 255, 255, 246, 211, 86, 0, 0, 0, 252, 255, 20, 41, 249,
+    250, 20, 0, 0, 252, 255, 20, 0, 222, 255, 49, 0, 0, 252, 255, 20,
+    41, 249, 227, 8, 0, 0, 252, 255, 255, 255, 243, 57, 0, 0, 0, 252,
+    255, 24, 89, 255, 226, 14, 0, 0, 252, 255, 20, 0, 176, 255, 127, 0,
+    0, 252, 255, 20, 0, 51, 255, 239, 15, 0, 64, 201, 245, 247, 226, 117,
+    0, 9, 240, 217, 26, 21, 98, 126, 0, 41, 255, 215, 13, 0, 0, 0,
+    0, 8, 230, 255, 247, 195, 125, 17, 0, 0, 34, 155, 227, 255, 255, 210,
+    0, 0, 0, 0, 0, 55, 252, 255, 16, 34, 172, 61, 13, 44, 246, 226,
+    0, 22, 188, 231, 249, 240, 191, 51, 0, 244, 255, 255, 255, 255, 255, 255,
+    112, 0, 0, 72, 255, 200, 0, 0, 0, 0, 0, 72, 255, 200, 0, 0,
+    0, 0, 0, 72, 255, 200, 0, 0, 0, 0, 0, 72, 255, 200, 0, 0,
+    0, 0, 0, 72, 255, 200, 0, 0, 0, 0, 0, 72, 255, 200, 0, 0,
+    0, 0, 0, 72, 255, 200, 0, 0, 0, 0, 252, 255, 20, 0, 36, 255,
+    236, 0, 0, 252, 255, 20, 0, 36, 255, 236, 0, 0, 252, 255, 20, 0,
+    36, 255, 236, 0, 0, 252, 255, 20, 0, 36, 255, 236, 0, 0, 252, 255,
+    20, 0, 36, 255, 236, 0, 0, 233, 255, 30, 0, 46, 255, 217, 0, 0,
+    164, 255, 121, 10, 136, 255, 146, 0, 0, 18, 153, 227, 248, 224, 145, 11,
+    0, 197, 255, 77, 0, 0, 0, 206, 255, 67, 101, 255, 170, 0, 0, 41,
+    255, 226, 2, 15, 246, 247, 15, 0, 133, 255, 133, 0, 0, 166, 255, 100,
+    1, 223, 255, 39, 0, 0, 71, 255, 193, 60, 255, 199, 0, 0, 0, 2,
+    228, 254, 182, 255, 104, 0, 0, 0, 0, 136, 255, 255, 248, 17, 0, 0,
+    0, 0, 40, 255, 255, 171, 0, 0, 0, 142, 255, 110, 0, 13, 252, 255,
+    45, 0, 75, 255, 173, 81, 255, 171, 0, 71, 255, 255, 106, 0, 136, 255,
+    112, 20, 255, 232, 0, 132, 235, 206, 167, 0, 197, 255, 52, 0, 215, 255,
+    37, 192, 176, 144, 227, 8, 249, 243, 4, 0, 154, 255, 104, 246, 115, 82,
+    255, 96, 255, 187, 0, 0, 93, 255, 215, 255, 55, 21, 255, 215, 255, 126,
+    0, 0, 32, 255, 255, 245, 5, 0, 216, 255, 255, 66, 0, 0, 0, 226,
+    255, 190, 0, 0, 155, 255, 251, 10, 0, 89, 255, 202, 4, 0, 91, 255,
+    204, 4, 0, 171, 255, 126, 26, 238, 248, 42, 0, 0, 20, 232, 250, 202,
+    255, 115, 0, 0, 0, 0, 78, 255, 255, 196, 2, 0, 0, 0, 0, 105,
+    255, 255, 215, 8, 0, 0, 0, 35, 244, 242, 175, 255, 143, 0, 0, 2,
+    195, 255, 101, 13, 222, 254, 63, 0, 117, 255, 182, 0, 0, 62, 253, 223,
+    13, 2, 197, 255, 121, 0, 0, 131, 255, 190, 1, 0, 38, 247, 247, 38,
+    44, 250, 244, 33, 0, 0, 0, 116, 255, 194, 201, 255, 107, 0, 0, 0,
+    0, 3, 199, 255, 255, 192, 1, 0, 0, 0, 0, 0, 45, 255, 255, 36,
+    0, 0, 0, 0, 0, 0, 12, 255, 255, 4, 0, 0, 0, 0, 0, 0,
+    12, 255, 255, 4, 0, 0, 0, 0, 0, 0, 12, 255, 255, 4, 0, 0,
+    0, 96, 255, 255, 255, 255, 255, 255, 92, 0, 0, 0, 0, 150, 255, 253,
+    54, 0, 0, 0, 89, 255, 255, 125, 0, 0, 0, 40, 243, 255, 184, 2,
+    0, 0, 10, 212, 255, 227, 20, 0, 0, 0, 161, 255, 250, 57, 0, 0,
+    0, 88, 255, 255, 113, 0, 0, 0, 0, 128, 255, 255, 255, 255, 255, 255,
+    124, 12, 255, 255, 255, 72, 12, 255, 196, 0, 0, 12, 255, 196, 0, 0,
+    12, 255, 196, 0, 0, 12, 255, 196, 0, 0, 12, 255, 196, 0, 0, 12,
+    255, 196, 0, 0, 12, 255, 196, 0, 0, 12, 255, 196, 0, 0, 12, 255,
+    255, 255, 72, 216, 87, 0, 0, 0, 136, 168, 0, 0, 0, 55, 241, 6,
+    0, 0, 1, 229, 73, 0, 0, 0, 150, 153, 0, 0, 0, 70, 232, 2,
+    0, 0, 5, 239, 58, 0, 0, 0, 165, 139, 0, 0, 0, 84, 219, 0,
+    64, 255, 255, 255, 20, 0, 0, 192, 255, 20, 0, 0, 192, 255, 20, 0,
+    0, 192, 255, 20, 0, 0, 192, 255, 20, 0, 0, 192, 255, 20, 0, 0,
+    192, 255, 20, 0, 0, 192, 255, 20, 0, 0, 192, 255, 20, 64, 255, 255,
+    255, 20, 0, 0, 0, 134, 255, 182, 6, 0, 0, 0, 0, 120, 250, 145,
+    236, 171, 3, 0, 0, 106, 222, 54, 0, 28, 193, 160, 1, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 255, 255, 255, 255, 255, 128, 32, 225, 104, 0,
+    0, 0, 0, 33, 218, 50, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 255, 255, 252, 228, 145, 4, 0, 0, 0, 7, 137, 255, 100,
+    8, 155, 231, 253, 255, 255, 141, 107, 255, 157, 6, 105, 255, 144, 112, 255,
+    157, 21, 198, 255, 144, 13, 181, 249, 255, 255, 255, 144, 20, 255, 216, 0,
+    0, 0, 0, 0, 20, 255, 216, 0, 0, 0, 0, 0, 20, 255, 216, 0,
+    0, 0, 0, 0, 20, 255, 255, 255, 255, 218, 70, 0, 20, 255, 255, 74,
+    34, 236, 241, 19, 20, 255, 229, 0, 0, 169, 255, 76, 20, 255, 228, 0,
+    0, 169, 255, 76, 20, 255, 255, 74, 34, 236, 241, 19, 20, 255, 255, 255,
+    255, 219, 73, 0, 0, 61, 192, 240, 255, 200, 0, 36, 245, 228, 46, 0,
+    0, 0, 112, 255, 137, 0, 0, 0, 0, 113, 255, 137, 0, 0, 0, 0,
+    37, 245, 228, 44, 0, 0, 0, 0, 61, 193, 241, 255, 200, 0, 0, 0,
+    0, 0, 0, 252, 244, 0, 0, 0, 0, 0, 0, 252, 244, 0, 0, 0,
+    0, 0, 0, 252, 244, 0, 0, 96, 227, 255, 255, 255, 244, 0, 41, 252,
+    216, 23, 108, 255, 244, 0, 109, 255, 137, 0, 9, 255, 244, 0, 110, 255,
+    136, 0, 9, 255, 244, 0, 42, 253, 216, 23, 108, 255, 244, 0, 0, 99,
+    228, 255, 255, 255, 244, 0, 0, 64, 197, 243, 231, 154, 15, 37, 246, 193,
+    15, 76, 255, 162, 113, 255, 255, 255, 255, 255, 228, 114, 255, 134, 0, 0,
+    0, 0, 39, 247, 228, 41, 0, 0, 0, 0, 66, 196, 241, 255, 255, 164,
+    0, 54, 213, 252, 224, 0, 183, 255, 59, 0, 0, 211, 255, 24, 0, 204,
+    255, 255, 255, 188, 0, 212, 255, 24, 0, 0, 212, 255, 24, 0, 0, 212,
+    255, 24, 0, 0, 212, 255, 24, 0, 0, 212, 255, 24, 0, 0, 93, 227,
+    255, 255, 255, 244, 0, 40, 252, 217, 24, 113, 255, 244, 0, 109, 255, 137,
+    0, 10, 255, 244, 0, 109, 255, 135, 0, 10, 255, 244, 0, 40, 252, 213,
+    21, 111, 255, 244, 0, 0, 93, 227, 255, 255, 255, 244, 0, 0, 0, 0,
+    5, 72, 255, 206, 0, 0, 196, 255, 251, 231, 171, 36, 0, 20, 255, 216,
+    0, 0, 0, 0, 0, 20, 255, 216, 0, 0, 0, 0, 0, 20, 255, 216,
+    0, 0, 0, 0, 0, 20, 255, 255, 255, 255, 227, 79, 0, 20, 255, 255,
+    74, 48, 255, 221, 0, 20, 255, 226, 0, 0, 250, 247, 0, 20, 255, 216,
+    0, 0, 248, 248, 0, 20, 255, 216, 0, 0, 248, 248, 0, 20, 255, 216,
+    0, 0, 248, 248, 0, 20, 255, 216, 0, 20, 255, 216, 0, 0, 0, 0,
+    0, 20, 255, 216, 0, 20, 255, 216, 0, 20, 255, 216, 0, 20, 255, 216,
+    0, 20, 255, 216, 0, 20, 255, 216, 0, 0, 20, 255, 216, 0, 0, 20,
+    255, 216, 0, 0, 0, 0, 0, 0, 0, 20, 255, 216, 0, 0, 20, 255,
+    216, 0, 0, 20, 255, 216, 0, 0, 20, 255, 216, 0, 0, 20, 255, 216,
+    0, 0, 20, 255, 215, 0, 0, 61, 255, 184, 0, 92, 252, 210, 50, 0,
+    20, 255, 216, 0, 0, 0, 0, 0, 20, 255, 216, 0, 0, 0, 0, 0,
+    20, 255, 216, 0, 0, 0, 0, 0, 20, 255, 216, 0, 113, 255, 184, 10,
+    20, 255, 216, 114, 255, 171, 6, 0, 20, 255, 250, 255, 173, 3, 0, 0,
+    20, 255, 239, 242, 235, 43, 0, 0, 20, 255, 216, 63, 246, 232, 40, 0,
+    20, 255, 216, 0, 74, 250, 229, 36, 20, 255, 216, 0, 20, 255, 216, 0,
+    20, 255, 216, 0, 20, 255, 216, 0, 20, 255, 216, 0, 20, 255, 216, 0,
+    20, 255, 216, 0, 20, 255, 216, 0, 20, 255, 216, 0, 24, 255, 255, 255,
+    254, 238, 200, 235, 248, 193, 21, 24, 255, 254, 59, 100, 255, 246, 39, 129,
+    255, 125, 24, 255, 225, 0, 59, 255, 194, 0, 87, 255, 151, 24, 255, 216,
+    0, 56, 255, 184, 0, 88, 255, 152, 24, 255, 216, 0, 56, 255, 184, 0,
+    88, 255, 152, 24, 255, 216, 0, 56, 255, 184, 0, 88, 255, 152, 20, 255,
+    255, 255, 255, 227, 79, 0, 20, 255, 255, 74, 48, 255, 221, 0, 20, 255,
+    226, 0, 0, 250, 247, 0, 20, 255, 216, 0, 0, 248, 248, 0, 20, 255,
+    216, 0, 0, 248, 248, 0, 20, 255, 216, 0, 0, 248, 248, 0, 0, 68,
+    200, 243, 228, 153, 17, 0, 39, 248, 214, 23, 96, 255, 171, 0, 114, 255,
+    133, 0, 1, 248, 249, 4, 114, 255, 132, 0, 1, 248, 249, 4, 39, 248,
+    213, 23, 96, 255, 171, 0, 0, 69, 200, 244, 229, 153, 17, 0, 20, 255,
+    255, 255, 255, 218, 70, 0, 20, 255, 255, 74, 34, 236, 241, 19, 20, 255,
+    229, 0, 0, 169, 255, 76, 20, 255, 228, 0, 0, 169, 255, 76, 20, 255,
+    255, 74, 34, 236, 241, 19, 20, 255, 255, 255, 255, 219, 73, 0, 20, 255,
+    216, 0, 0, 0, 0, 0, 20, 255, 216, 0, 0, 0, 0, 0, 0, 96,
+    227, 255, 255, 255, 244, 0, 41, 252, 216, 23, 108, 255, 244, 0, 109, 255,
+    137, 0, 9, 255, 244, 0, 110, 255, 136, 0, 9, 255, 244, 0, 41, 252,
+    216, 23, 108, 255, 244, 0, 0, 96, 227, 255, 255, 255, 244, 0, 0, 0,
+    0, 0, 0, 252, 244, 0, 0, 0, 0, 0, 0, 252, 244, 0, 20, 255,
+    255, 255, 255, 100, 20, 255, 255, 87, 3, 0, 20, 255, 227, 0, 0, 0,
+    20, 255, 216, 0, 0, 0, 20, 255, 216, 0, 0, 0, 20, 255, 216, 0,
+    0, 0, 6, 158, 236, 255, 255, 160, 0, 88, 255, 140, 19, 0, 0, 0,
+    87, 255, 255, 255, 216, 85, 0, 5, 147, 230, 255, 255, 241, 0, 0, 0,
+    0, 36, 237, 235, 0, 88, 255, 255, 248, 209, 72, 0, 0, 232, 255, 8,
+    0, 0, 232, 255, 8, 0, 220, 255, 255, 255, 255, 0, 232, 255, 8, 0,
+    0, 232, 255, 8, 0, 0, 232, 255, 8, 0, 0, 218, 255, 32, 0, 0,
+    102, 234, 255, 216, 36, 255, 203, 0, 4, 255, 232, 0, 36, 255, 201, 0,
+    4, 255, 232, 0, 36, 255, 200, 0, 4, 255, 232, 0, 35, 255, 202, 0,
+    14, 255, 232, 0, 13, 253, 236, 24, 114, 255, 232, 0, 0, 115, 237, 255,
+    255, 255, 232, 0, 162, 255, 69, 0, 28, 253, 209, 0, 61, 255, 162, 0,
+    118, 255, 107, 0, 0, 216, 244, 11, 210, 246, 16, 0, 0, 116, 255, 137,
+    255, 160, 0, 0, 0, 21, 249, 254, 255, 59, 0, 0, 0, 0, 170, 255,
+    214, 0, 0, 0, 123, 255, 94, 0, 216, 249, 9, 56, 255, 165, 55, 255,
+    157, 22, 255, 255, 65, 120, 255, 98, 3, 240, 220, 85, 235, 198, 128, 183,
+    255, 31, 0, 177, 255, 176, 175, 134, 194, 242, 219, 0, 0, 109, 255, 254,
+    113, 71, 255, 255, 152, 0, 0, 42, 255, 255, 51, 12, 251, 255, 85, 0,
+    90, 255, 168, 0, 142, 255, 116, 0, 159, 255, 148, 254, 181, 1, 0, 11,
+    216, 255, 229, 20, 0, 0, 21, 229, 255, 241, 35, 0, 1, 182, 254, 119,
+    250, 203, 5, 117, 255, 142, 0, 119, 255, 141, 165, 255, 66, 0, 32, 255,
+    197, 54, 255, 167, 0, 118, 255, 97, 0, 200, 248, 19, 204, 242, 11, 0,
+    89, 255, 148, 255, 153, 0, 0, 5, 229, 255, 255, 53, 0, 0, 0, 124,
+    255, 208, 0, 0, 0, 0, 101, 255, 102, 0, 0, 0, 232, 247, 162, 4,
+    0, 0, 96, 255, 255, 255, 255, 224, 0, 0, 7, 194, 255, 189, 0, 2,
+    171, 255, 218, 21, 0, 145, 255, 232, 34, 0, 94, 255, 243, 51, 0, 0,
+    128, 255, 255, 255, 255, 224, 0, 0, 0, 107, 231, 254, 116, 0, 0, 0,
+    0, 233, 244, 24, 0, 0, 0, 0, 0, 245, 224, 0, 0, 0, 0, 1,
+    55, 255, 202, 0, 0, 0, 0, 160, 255, 251, 79, 0, 0, 0, 0, 2,
+    89, 255, 194, 0, 0, 0, 0, 0, 2, 253, 222, 0, 0, 0, 0, 0,
+    0, 244, 226, 0, 0, 0, 0, 0, 0, 226, 248, 31, 0, 0, 0, 0,
+    0, 92, 228, 254, 116, 0, 0, 156, 156, 0, 0, 156, 156, 0, 0, 156,
+    156, 0, 0, 156, 156, 0, 0, 156, 156, 0, 0, 156, 156, 0, 0, 156,
+    156, 0, 0, 156, 156, 0, 0, 156, 156, 0, 0, 156, 156, 0, 0, 156,
+    156, 0, 0, 160, 253, 222, 75, 0, 0, 0, 0, 0, 57, 255, 188, 0,
+    0, 0, 0, 0, 12, 255, 201, 0, 0, 0, 0, 0, 2, 245, 236, 29,
+    0, 0, 0, 0, 0, 119, 255, 255, 116, 0, 0, 0, 0, 239, 251, 49,
+    0, 0, 0, 0, 10, 255, 211, 0, 0, 0, 0, 0, 14, 255, 200, 0,
+    0, 0, 0, 0, 69, 255, 182, 0, 0, 0, 0, 160, 253, 218, 61, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 70, 210, 240, 151,
+    39, 20, 159, 12, 0, 123, 34, 23, 125, 229, 226, 110, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const struct font fonts[] = {
+    {9, font9_glyphs, font9_bitmap},
+    {11, font11_glyphs, font11_bitmap},
+};
@@ -0,0 +1,131 @@
+require "cchart"
+require "test/unit"
+require "zlib"
+
+class TC_CChart < Test::Unit::TestCase
+
+  # Returns the width, height and rows of RGBA pixels of an unfiltered PNG
+  def decode(png)
+    assert_equal("\x89PNG\r\n\x1a\n".unpack("C*"), png[0, 8].unpack("C*"))
+    offset, idat, width, height = 8, "", nil, nil
+    while offset < png.length
+      length, type = png[offset, 8].unpack("Na4")
+      data = png[offset + 8, length]
+      assert_equal(Zlib.crc32(type + data), png[offset + 8 + length, 4].unpack("N")[0])
+      case type
+      when "IHDR" then width, height = data.unpack("NN")
+      when "IDAT" then idat << data
+      end
+      offset += 12 + length
+    end
+    raw = Zlib::Inflate.inflate(idat)
+    rows = (0...height).collect do |y|
+      assert_equal(0, raw[y * (4 * width + 1)].ord)
+      raw[y * (4 * width + 1) + 1, 4 * width].unpack("C*").enum_for(:each_slice, 4).to_a
+    end
+    [width, height, rows]
+  end
+
+  def test_png
+    chart = Chart.new(3, 2)
+    chart.fill_rect(1, 0, 5, 1, 0xff000080)
+    width, height, rows = decode(chart.to_png)
+    assert_equal([3, 2], [width, height])
+    assert_equal([[0, 0, 0, 0], [255, 0, 0, 128], [255, 0, 0, 128]], rows[0])
+    assert_equal([[0, 0, 0, 0]] * 3, rows[1])
+  end
+
+  def test_blend
+    chart = Chart.new(1, 1)
+    chart.fill_rect(0, 0, 1, 1, 0xffffffff)
+    chart.fill_rect(0, 0, 1, 1, 0x00000040)
+    assert_equal([[[191, 191, 191, 255]]], decode(chart.to_png)[2])
+  end
+
+  def test_polyline
+    chart = Chart.new(12, 12)
+    chart.viewport(1, 1, 10, 10, 0.0, 1.0, 0.0, 1.0)
+    n = 10001
+    times = Array.new(n) { |i| i.to_f / (n - 1) }
+    values = Array.new(n) { |i| i.even? ? 0.0 : 1.0 }
+    chart.polyline(times.pack("d*"), values.pack("d*"), 0x000000ff)
+    rows = decode(chart.to_png)[2]
+    (1..11).each { |y| (1..10).each { |x| assert_equal(255, rows[y][x][3]) } }
+    assert_equal([0] * 12, rows[0].collect { |pixel| pixel[3] })
+    assert_raise(ArgumentError) { chart.polyline([0.0].pack("d"), "", 0x000000ff) }
+  end
+
+  # Coordinates far outside the raster are clipped and NaNs are skipped
+  def test_out_of_range
+    nan, inf = 0.0 / 0.0, 1.0 / 0.0
+    chart = Chart.new(4, 4)
+    chart.line(-1.0e300, 1.0, 1.0e300, 1.0, 0x000000ff)
+    chart.line(nan, 0.0, 3.0, 3.0, 0x000000ff)
+    chart.line(-inf, 3.0, 2.0, 3.0, 0x000000ff)
+    rows = decode(chart.to_png)[2]
+    assert_equal([255] * 4, rows[1].collect { |pixel| pixel[3] })
+    assert_equal([0] * 4, rows[0].collect { |pixel| pixel[3] })
+    assert_equal([0] * 4, rows[3].collect { |pixel| pixel[3] })
+    chart = Chart.new(4, 4)
+    chart.viewport(0, 0, 4, 4, 0.0, 1.0, 0.0, 1.0)
+    chart.polyline([nan, -1.0e300, 0.0, 1.0, 1.0e300].pack("d*"), [0.5, nan, 0.5, 0.5, 1.0e300].pack("d*"), 0x000000ff)
+    rows = decode(chart.to_png)[2]
+    assert_equal([[0] * 4, [0] * 4, [255] * 4, [0] * 4], rows.collect { |row| row.collect { |pixel| pixel[3] } })
+    chart = Chart.new(4, 4)
+    chart.viewport(0, 0, 4, 4, 0.0, 1.0, 0.0, 1.0)
+    chart.fill_below([nan, -1.0e300, 0.0, 1.0].pack("d*"), [0.0, 1.0, 0.5, inf].pack("d*"), 0x000000ff)
+    rows = decode(chart.to_png)[2]
+    assert_equal([[0] * 4, [0] * 4, [128] * 4, [255] * 4], rows.collect { |row| row.collect { |pixel| pixel[3] } })
+  end
+
+  def test_fill_below
+    chart = Chart.new(5, 11)
+    chart.viewport(0, 0, 4, 10, 0.0, 2.0, 0.0, 10.0)
+    chart.fill_below([0.0, 2.0].pack("d*"), [5.0, 5.0].pack("d*"), 0x000000ff)
+    rows = decode(chart.to_png)[2]
+    assert_equal([0] * 5, rows[4].collect { |pixel| pixel[3] })
+    assert_equal([128] * 5, rows[5].collect { |pixel| pixel[3] })
+    assert_equal([255] * 5, rows[6].collect { |pixel| pixel[3] })
+    assert_equal([128] * 5, rows[10].collect { |pixel| pixel[3] })
+  end
+
+  def test_text
+    assert_equal(12, Chart.new(1, 1).text_width("00", 9))
+    [[:start, 20, 31], [:middle, 14, 25], [:end, 8, 19]].each do |anchor, left, right|
+      chart = Chart.new(32, 12)
+      chart.text(20, 10, "00", 9, 0xffffffff, anchor)
+      columns = decode(chart.to_png)[2].transpose.collect { |column| column.any? { |pixel| pixel[3].nonzero? } }
+      assert_equal(left, columns.index(true))
+      assert_equal(right, columns.rindex(true))
+    end
+    assert_raise(ArgumentError) { Chart.new(1, 1).text(0, 0, "0", 10, 0xffffffff, :start) }
+    assert_raise(ArgumentError) { Chart.new(1, 1).text(0, 0, "0", 9, 0xffffffff, :left) }
+  end
+
+  def test_outline_and_composite
+    chart = Chart.new(5, 5)
+    chart.fill_rect(2, 2, 1, 1, 0xffffffff)
+    chart.outline(0x000000ff)
+    rows = decode(chart.to_png)[2]
+    assert_equal([255, 255, 255, 255], rows[2][2])
+    assert_equal([0, 0, 0, 255], rows[1][3])
+    assert_equal([0, 0, 0, 0], rows[0][2])
+    other = Chart.new(2, 2)
+    other.fill_rect(0, 0, 2, 2, 0xff0000ff)
+    chart.composite(other, 4, 4)
+    assert_equal([255, 0, 0, 255], decode(chart.to_png)[2][4][4])
+  end
+
+  def test_pixels
+    chart = Chart.new(2, 1)
+    chart.pixels = [1, 2, 3, 4, 5, 6, 7, 8].pack("C*")
+    assert_equal([[[1, 2, 3, 4], [5, 6, 7, 8]]], decode(chart.to_png)[2])
+    assert_raise(ArgumentError) { chart.pixels = "\0" * 4 }
+  end
+
+  def test_malformed
+    assert_raise(ArgumentError) { Chart.new(0, 1) }
+    assert_raise(ArgumentError) { Chart.new(1, 1).viewport(0, 0, 1, 1, 0.0, 0.0, 0.0, 1.0) }
+  end
+
+end
@@ -2,15 +2,29 @@
 
 #include <ruby.h>
 #include <math.h>
+#include <stdint.h>
 
 #define DEFAULT_R 6371000.0
 
 static VALUE rb_cCoord;
+static VALUE rb_cCoordArray;
+static VALUE id_at_alts;
+static VALUE id_at_lats;
+static VALUE id_at_lons;
+static VALUE id_at_times;
 static VALUE id_alt;
 static VALUE id_lat;
 static VALUE id_lon;
 static VALUE id_new;
 
+typedef struct {
+    long n;
+    double *lats;
+    double *lons;
+    double *alts;
+    double *times;
+} coord_array_t;
+
 void Init_ccoord(void);
 
 static inline VALUE
@@ -19,6 +33,50 @@ rb_coord_new(double lat, double lon, double alt)
     return rb_funcall(rb_cCoord, id_new, 3, rb_float_new(lat), rb_float_new(lon), rb_float_new(alt));
 }
 
+/* Returns the angle subtended by the great circle between two coordinates */
+static inline double
+distance(double lat1, double lon1, double lat2, double lon2)
+{
+    double d = sin(lat1) * sin(lat2) + cos(lat1) * cos(lat2) * cos(lon2 - lon1);
+    return d < 1.0 ? acos(d) : 0.0;
+}
+
+static inline void
+halfway(double lat1, double lon1, double lat2, double lon2, double *lat, double *lon)
+{
+    double delta_lon = lon2 - lon1;
+    double Bx = cos(lat2) * cos(delta_lon);
+    double By = cos(lat2) * sin(delta_lon);
+    double cos_lat1_plus_Bx = cos(lat1) + Bx;
+    *lat = atan2(sin(lat1) + sin(lat2), sqrt(cos_lat1_plus_Bx * cos_lat1_plus_Bx + By * By));
+    *lon = lon1 + atan2(By, cos_lat1_plus_Bx);
+}
+
+static inline double
+initial_bearing(double lat1, double lon1, double lat2, double lon2)
+{
+    double lon = lon2 - lon1;
+    return atan2(sin(lon) * cos(lat2), cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(lon));
+}
+
+static inline void
+interpolate(double lat1, double lon1, double lat2, double lon2, double delta, double *lat3, double *lon3)
+{
+    double cos_lat1 = cos(lat1);
+    double sin_lat1 = sin(lat1);
+    double cos_lat2 = cos(lat2);
+    double sin_lat2 = sin(lat2);
+    double lon = lon2 - lon1;
+    double cos_lon = cos(lon);
+    double d = sin_lat1 * sin_lat2 + cos_lat1 * cos_lat2 * cos_lon;
+    d = d < 1.0 ? delta * acos(d) : 0.0;
+    double theta = atan2(sin(lon) * cos_lat2, cos_lat1 * sin_lat2 - sin_lat1 * cos_lat2 * cos_lon);
+    double cos_d = cos(d);
+    double sin_d = sin(d);
+    *lat3 = asin(sin_lat1 * cos_d + cos_lat1 * sin_d * cos(theta));
+    *lon3 = lon1 + atan2(sin(theta) * sin_d * cos_lat1, cos_d - sin_lat1 * sin(*lat3));
+}
+
 static VALUE
 rb_coord_distance_to(int argc, VALUE *argv, VALUE obj)
 {
@@ -29,9 +87,8 @@ rb_coord_distance_to(int argc, VALUE *argv, VALUE obj)
     double lon1 = NUM2DBL(rb_funcall(obj, id_lon, 0));
     double lat2 = NUM2DBL(rb_funcall(oth, id_lat, 0));
     double lon2 = NUM2DBL(rb_funcall(oth, id_lon, 0));
-    double R = argc < 2 ? DEFAULT_R : NUM2DBL(argv[2]);
-    double d = sin(lat1) * sin(lat2) + cos(lat1) * cos(lat2) * cos(lon2 - lon1);
-    return rb_float_new(d < 1.0 ? R * acos(d) : 0.0);
+    double R = argc < 2 ? DEFAULT_R : NUM2DBL(argv[1]);
+    return rb_float_new(R * distance(lat1, lon1, lat2, lon2));
 }
 
 static VALUE
@@ -43,12 +100,8 @@ rb_coord_halfway_to(VALUE obj, VALUE oth)
     double lat2 = NUM2DBL(rb_funcall(oth, id_lat, 0));
     double lon2 = NUM2DBL(rb_funcall(oth, id_lon, 0));
     double alt2 = NUM2DBL(rb_funcall(oth, id_alt, 0));
-    double delta_lon = lon2 - lon1;
-    double Bx = cos(lat2) * cos(delta_lon);
-    double By = cos(lat2) * sin(delta_lon);
-    double cos_lat1_plus_Bx = cos(lat1) + Bx;
-    double lat = atan2(sin(lat1) + sin(lat2), sqrt(cos_lat1_plus_Bx * cos_lat1_plus_Bx + By * By));
-    double lon = lon1 + atan2(By, cos_lat1_plus_Bx);
+    double lat, lon;
+    halfway(lat1, lon1, lat2, lon2, &lat, &lon);
     double alt = (alt1 + alt2) / 2.0;
     return rb_coord_new(lat, lon, alt);
 }
@@ -60,8 +113,7 @@ rb_coord_initial_bearing_to(VALUE obj, VALUE oth)
     double lon1 = NUM2DBL(rb_funcall(obj, id_lon, 0));
     double lat2 = NUM2DBL(rb_funcall(oth, id_lat, 0));
     double lon2 = NUM2DBL(rb_funcall(oth, id_lon, 0));
-    double lon = lon2 - lon1;
-    return rb_float_new(atan2(sin(lon) * cos(lat2), cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(lon)));
+    return rb_float_new(initial_bearing(lat1, lon1, lat2, lon2));
 }
 
 static VALUE
@@ -93,27 +145,457 @@ rb_coord_interpolate(VALUE obj, VALUE oth, VALUE rb_delta)
     double lon2 = NUM2DBL(rb_funcall(oth, id_lon, 0));
     double alt2 = NUM2DBL(rb_funcall(oth, id_alt, 0));
     double delta = NUM2DBL(rb_delta);
-    double cos_lat1 = cos(lat1);
-    double sin_lat1 = sin(lat1);
-    double cos_lat2 = cos(lat2);
-    double sin_lat2 = sin(lat2);
-    double lon = lon2 - lon1;
-    double cos_lon = cos(lon);
-    double d = sin_lat1 * sin_lat2 + cos_lat1 * cos_lat2 * cos_lon;
-    d = d < 1.0 ? delta * acos(d) : 0.0;
-    double theta = atan2(sin(lon) * cos_lat2, cos_lat1 * sin_lat2 - sin_lat1 * cos_lat2 * cos_lon);
-    double cos_d = cos(d);
-    double sin_d = sin(d);
-    double lat3 = asin(sin_lat1 * cos_d + cos_lat1 * sin_d * cos(theta));
-    double lon3 = lon1 + atan2(sin(theta) * sin_d * cos_lat1, cos_d - sin_lat1 * sin(lat3));
+    double lat3, lon3;
+    interpolate(lat1, lon1, lat2, lon2, delta, &lat3, &lon3);
     double alt3 = (1.0 - delta) * alt1 + delta * alt2;
     return rb_coord_new(lat3, lon3, alt3);
 }
 
+static double *
+packed_doubles(VALUE rb_doubles, long *n)
+{
+    Check_Type(rb_doubles, T_STRING);
+    if (RSTRING(rb_doubles)->len % sizeof(double))
+        rb_raise(rb_eArgError, "packed doubles have a partial value");
+    *n = RSTRING(rb_doubles)->len / sizeof(double);
+    return (double *) RSTRING(rb_doubles)->ptr;
+}
+
+/* Resizes the string *rb_out in place to hold n doubles, or creates it if
+ * it is nil, and returns its buffer */
+static double *
+double_buffer(VALUE *rb_out, long n)
+{
+    if (NIL_P(*rb_out)) {
+        *rb_out = rb_str_new(NULL, n * sizeof(double));
+    } else {
+        Check_Type(*rb_out, T_STRING);
+        rb_str_modify(*rb_out);
+        rb_str_resize(*rb_out, n * sizeof(double));
+    }
+    return (double *) RSTRING(*rb_out)->ptr;
+}
+
+static double *
+coord_array_column_buffer(VALUE rb_coord_array, ID id, long n)
+{
+    VALUE rb_column = rb_ivar_defined(rb_coord_array, id) ? rb_ivar_get(rb_coord_array, id) : Qnil;
+    double *column = double_buffer(&rb_column, n);
+    rb_ivar_set(rb_coord_array, id, rb_column);
+    return column;
+}
+
+/* Returns rb_out, or a new CoordArray if it is nil, with its columns
+ * resized in place to hold n coordinates */
+static VALUE
+coord_array_output(VALUE rb_out, long n, int times, coord_array_t *out)
+{
+    if (NIL_P(rb_out))
+        rb_out = rb_obj_alloc(rb_cCoordArray);
+    else if (!rb_obj_is_kind_of(rb_out, rb_cCoordArray))
+        rb_raise(rb_eTypeError, "output is not a CoordArray");
+    out->n = n;
+    out->lats = coord_array_column_buffer(rb_out, id_at_lats, n);
+    out->lons = coord_array_column_buffer(rb_out, id_at_lons, n);
+    out->alts = coord_array_column_buffer(rb_out, id_at_alts, n);
+    if (times) {
+        out->times = coord_array_column_buffer(rb_out, id_at_times, n);
+    } else {
+        out->times = NULL;
+        rb_ivar_set(rb_out, id_at_times, Qnil);
+    }
+    return rb_out;
+}
+
+/* Fills in coord_array from the columns of rb_coord_array.  Outputs must
+ * be allocated first, since they may be resized in place. */
+static void
+coord_array_get(VALUE rb_coord_array, coord_array_t *coord_array)
+{
+    long n_lons, n_alts, n_times;
+    coord_array->lats = packed_doubles(rb_ivar_get(rb_coord_array, id_at_lats), &coord_array->n);
+    coord_array->lons = packed_doubles(rb_ivar_get(rb_coord_array, id_at_lons), &n_lons);
+    coord_array->alts = packed_doubles(rb_ivar_get(rb_coord_array, id_at_alts), &n_alts);
+    VALUE rb_times = rb_ivar_get(rb_coord_array, id_at_times);
+    coord_array->times = NIL_P(rb_times) ? NULL : packed_doubles(rb_times, &n_times);
+    if (n_lons != coord_array->n || n_alts != coord_array->n || (coord_array->times && n_times != coord_array->n))
+        rb_raise(rb_eArgError, "columns have different lengths");
+}
+
+/* Raises if the string rb_column shares its buffer with a column of
+ * rb_self, which writing it as an output would resize and overwrite while
+ * they are read */
+static void
+coord_array_check_column(VALUE rb_self, VALUE rb_column)
+{
+    if (TYPE(rb_column) != T_STRING || !RSTRING(rb_column)->len)
+        return;
+    ID ids[4] = { id_at_lats, id_at_lons, id_at_alts, id_at_times };
+    int i;
+    for (i = 0; i < 4; ++i) {
+        VALUE rb_input = rb_ivar_defined(rb_self, ids[i]) ? rb_ivar_get(rb_self, ids[i]) : Qnil;
+        if (TYPE(rb_input) == T_STRING && (rb_input == rb_column || RSTRING(rb_input)->ptr == RSTRING(rb_column)->ptr))
+            rb_raise(rb_eArgError, "output shares a column with the input");
+    }
+}
+
+static void
+coord_array_check_output(VALUE rb_self, VALUE rb_out)
+{
+    if (rb_out == rb_self)
+        rb_raise(rb_eArgError, "output is the input");
+    if (NIL_P(rb_out) || !rb_obj_is_kind_of(rb_out, rb_cCoordArray))
+        return;
+    ID ids[4] = { id_at_lats, id_at_lons, id_at_alts, id_at_times };
+    int i;
+    for (i = 0; i < 4; ++i)
+        if (rb_ivar_defined(rb_out, ids[i]))
+            coord_array_check_column(rb_self, rb_ivar_get(rb_out, ids[i]));
+}
+
+/* Returns the distances in metres between successive coordinates as packed
+ * doubles, written into out if it is given */
+static VALUE
+rb_coord_array_distances(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_out;
+    rb_scan_args(argc, argv, "01", &rb_out);
+    coord_array_check_column(rb_self, rb_out);
+    coord_array_t coord_array;
+    coord_array_get(rb_self, &coord_array);
+    long n = coord_array.n ? coord_array.n - 1 : 0, i;
+    double *out = double_buffer(&rb_out, n);
+    coord_array_get(rb_self, &coord_array);
+    for (i = 0; i < n; ++i)
+        out[i] = DEFAULT_R * distance(coord_array.lats[i], coord_array.lons[i], coord_array.lats[i + 1], coord_array.lons[i + 1]);
+    return rb_out;
+}
+
+/* Returns the distance in metres along the track to each coordinate as
+ * packed doubles, written into out if it is given */
+static VALUE
+rb_coord_array_cumulative_distances(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_out;
+    rb_scan_args(argc, argv, "01", &rb_out);
+    coord_array_check_column(rb_self, rb_out);
+    coord_array_t coord_array;
+    coord_array_get(rb_self, &coord_array);
+    double *out = double_buffer(&rb_out, coord_array.n);
+    coord_array_get(rb_self, &coord_array);
+    double accumulator = 0.0;
+    long i;
+    for (i = 0; i < coord_array.n; ++i) {
+        if (i)
+            accumulator += DEFAULT_R * distance(coord_array.lats[i - 1], coord_array.lons[i - 1], coord_array.lats[i], coord_array.lons[i]);
+        out[i] = accumulator;
+    }
+    return rb_out;
+}
+
+/* Returns the initial bearings in radians from each coordinate to the next
+ * as packed doubles, written into out if it is given */
+static VALUE
+rb_coord_array_initial_bearings(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_out;
+    rb_scan_args(argc, argv, "01", &rb_out);
+    coord_array_check_column(rb_self, rb_out);
+    coord_array_t coord_array;
+    coord_array_get(rb_self, &coord_array);
+    long n = coord_array.n ? coord_array.n - 1 : 0, i;
+    double *out = double_buffer(&rb_out, n);
+    coord_array_get(rb_self, &coord_array);
+    for (i = 0; i < n; ++i)
+        out[i] = initial_bearing(coord_array.lats[i], coord_array.lons[i], coord_array.lats[i + 1], coord_array.lons[i + 1]);
+    return rb_out;
+}
+
+/* Returns a CoordArray of the points halfway between successive
+ * coordinates, written into out if it is given */
+static VALUE
+rb_coord_array_halfway_points(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_out;
+    rb_scan_args(argc, argv, "01", &rb_out);
+    coord_array_check_output(rb_self, rb_out);
+    coord_array_t coord_array, out;
+    coord_array_get(rb_self, &coord_array);
+    long n = coord_array.n ? coord_array.n - 1 : 0, i;
+    rb_out = coord_array_output(rb_out, n, coord_array.times != NULL, &out);
+    coord_array_get(rb_self, &coord_array);
+    for (i = 0; i < n; ++i) {
+        halfway(coord_array.lats[i], coord_array.lons[i], coord_array.lats[i + 1], coord_array.lons[i + 1], out.lats + i, out.lons + i);
+        out.alts[i] = (coord_array.alts[i] + coord_array.alts[i + 1]) / 2.0;
+        if (out.times)
+            out.times[i] = (coord_array.times[i] + coord_array.times[i + 1]) / 2.0;
+    }
+    return rb_out;
+}
+
+/* Returns a CoordArray of the track's positions at each of the packed
+ * doubles times, written into out if it is given.  Times before the first
+ * coordinate or after the last give the first or last coordinate. */
+static VALUE
+rb_coord_array_interpolate(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_times, rb_out;
+    rb_scan_args(argc, argv, "11", &rb_times, &rb_out);
+    coord_array_check_output(rb_self, rb_out);
+    coord_array_t coord_array, out;
+    coord_array_get(rb_self, &coord_array);
+    if (!coord_array.times)
+        rb_raise(rb_eArgError, "coordinates have no times");
+    long n, i, j = 0;
+    packed_doubles(rb_times, &n);
+    if (n && !coord_array.n)
+        rb_raise(rb_eArgError, "no coordinates to interpolate");
+    rb_out = coord_array_output(rb_out, n, 1, &out);
+    coord_array_get(rb_self, &coord_array);
+    const double *times = packed_doubles(rb_times, &n);
+    for (i = 0; i < n; ++i) {
+        double t = times[i];
+        /* find the first coordinate at or after t, walking forwards from
+         * the last one found since times are usually increasing */
+        if (j > 0 && coord_array.times[j - 1] >= t) {
+            long lo = 0, hi = j;
+            while (lo < hi) {
+                long mid = (lo + hi) / 2;
+                if (coord_array.times[mid] < t)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            j = lo;
+        }
+        while (j < coord_array.n && coord_array.times[j] < t)
+            ++j;
+        if (j == 0 || j == coord_array.n || coord_array.times[j] == t) {
+            long k = j == coord_array.n ? j - 1 : j;
+            out.lats[i] = coord_array.lats[k];
+            out.lons[i] = coord_array.lons[k];
+            out.alts[i] = coord_array.alts[k];
+        } else {
+            double delta = (t - coord_array.times[j - 1]) / (coord_array.times[j] - coord_array.times[j - 1]);
+            interpolate(coord_array.lats[j - 1], coord_array.lons[j - 1], coord_array.lats[j], coord_array.lons[j], delta, out.lats + i, out.lons + i);
+            out.alts[i] = (1.0 - delta) * coord_array.alts[j - 1] + delta * coord_array.alts[j];
+        }
+        out.times[i] = t;
+    }
+    return rb_out;
+}
+
+typedef struct {
+    int64_t x, y, z;
+    long head;
+} cell_t;
+
+/* The clusters in a grid over the unit sphere whose cells are as wide as
+ * the threshold, so that every cluster within the threshold of a point is
+ * in the point's cell or one of its 26 neighbours.  Clusters are numbered
+ * by the coordinate that created them and each cell's clusters are kept
+ * in a doubly linked list.  The cells are an open addressed hash table,
+ * of which at most one cell is added per coordinate. */
+typedef struct {
+    double scale;
+    cell_t *cells;
+    long mask;
+    double *lats, *lons, *alts, *weights;
+    long *cell, *next, *prev, *parent;
+} clusters_t;
+
+static long
+clusters_cell(clusters_t *clusters, int64_t x, int64_t y, int64_t z, int add)
+{
+    uint64_t hash = (uint64_t) x * 73856093u ^ (uint64_t) y * 19349663u ^ (uint64_t) z * 83492791u;
+    long i = (hash ^ (hash >> 29)) & clusters->mask;
+    while (clusters->cells[i].head != -2) {
+        if (clusters->cells[i].x == x && clusters->cells[i].y == y && clusters->cells[i].z == z)
+            return i;
+        i = (i + 1) & clusters->mask;
+    }
+    if (!add)
+        return -1;
+    clusters->cells[i].x = x;
+    clusters->cells[i].y = y;
+    clusters->cells[i].z = z;
+    clusters->cells[i].head = -1;
+    return i;
+}
+
+static void
+clusters_grid(const clusters_t *clusters, double lat, double lon, int64_t *xyz)
+{
+    xyz[0] = (int64_t) floor(clusters->scale * cos(lat) * cos(lon));
+    xyz[1] = (int64_t) floor(clusters->scale * cos(lat) * sin(lon));
+    xyz[2] = (int64_t) floor(clusters->scale * sin(lat));
+}
+
+static void
+clusters_insert(clusters_t *clusters, long i)
+{
+    int64_t xyz[3];
+    clusters_grid(clusters, clusters->lats[i], clusters->lons[i], xyz);
+    long c = clusters_cell(clusters, xyz[0], xyz[1], xyz[2], 1);
+    clusters->cell[i] = c;
+    clusters->prev[i] = -1;
+    clusters->next[i] = clusters->cells[c].head;
+    if (clusters->next[i] != -1)
+        clusters->prev[clusters->next[i]] = i;
+    clusters->cells[c].head = i;
+}
+
+static void
+clusters_remove(clusters_t *clusters, long i)
+{
+    if (clusters->prev[i] == -1)
+        clusters->cells[clusters->cell[i]].head = clusters->next[i];
+    else
+        clusters->next[clusters->prev[i]] = clusters->next[i];
+    if (clusters->next[i] != -1)
+        clusters->prev[clusters->next[i]] = clusters->prev[i];
+    clusters->cell[i] = -1;
+}
+
+static int
+compare_longs(const void *a, const void *b)
+{
+    long x = *(const long *) a, y = *(const long *) b;
+    return x < y ? -1 : x > y;
+}
+
+/* Clusters the coordinates, each weighted by the corresponding packed
+ * double of weights or by one, in order.  Each coordinate is merged with
+ * every cluster within threshold metres of it, oldest first, into a new
+ * cluster at the weighted interpolation of their positions.  An altitude
+ * of zero is taken as unknown.  Returns a CoordArray of the clusters'
+ * positions, their weights as packed doubles and the index of the cluster
+ * of each coordinate. */
+static VALUE
+rb_coord_array_cluster(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_threshold, rb_weights;
+    rb_scan_args(argc, argv, "11", &rb_threshold, &rb_weights);
+    double threshold = NUM2DBL(rb_threshold);
+    if (!(threshold > 0.0))
+        rb_raise(rb_eArgError, "threshold must be positive");
+    coord_array_t coord_array;
+    coord_array_get(rb_self, &coord_array);
+    long n = coord_array.n, i, j, m;
+    const double *weights = NULL;
+    if (!NIL_P(rb_weights)) {
+        weights = packed_doubles(rb_weights, &m);
+        if (m != n)
+            rb_raise(rb_eArgError, "weights and coordinates have different lengths");
+    }
+    clusters_t clusters;
+    clusters.scale = DEFAULT_R / threshold;
+    long size = 16;
+    while (size < 2 * n + 1)
+        size *= 2;
+    clusters.mask = size - 1;
+    clusters.cells = ALLOC_N(cell_t, size);
+    for (i = 0; i < size; ++i)
+        clusters.cells[i].head = -2;
+    clusters.lats = ALLOC_N(double, n ? n : 1);
+    clusters.lons = ALLOC_N(double, n ? n : 1);
+    clusters.alts = ALLOC_N(double, n ? n : 1);
+    clusters.weights = ALLOC_N(double, n ? n : 1);
+    clusters.cell = ALLOC_N(long, n ? n : 1);
+    clusters.next = ALLOC_N(long, n ? n : 1);
+    clusters.prev = ALLOC_N(long, n ? n : 1);
+    clusters.parent = ALLOC_N(long, n ? n : 1);
+    long neighbours_size = 16, neighbours_n;
+    long *neighbours = ALLOC_N(long, neighbours_size);
+    for (i = 0; i < n; ++i) {
+        double lat = coord_array.lats[i], lon = coord_array.lons[i], alt = coord_array.alts[i];
+        double weight = weights ? weights[i] : 1.0;
+        int64_t xyz[3], dx, dy, dz;
+        clusters_grid(&clusters, lat, lon, xyz);
+        neighbours_n = 0;
+        for (dx = -1; dx <= 1; ++dx)
+            for (dy = -1; dy <= 1; ++dy)
+                for (dz = -1; dz <= 1; ++dz) {
+                    long c = clusters_cell(&clusters, xyz[0] + dx, xyz[1] + dy, xyz[2] + dz, 0);
+                    if (c == -1)
+                        continue;
+                    for (j = clusters.cells[c].head; j != -1; j = clusters.next[j]) {
+                        if (DEFAULT_R * distance(clusters.lats[j], clusters.lons[j], lat, lon) >= threshold)
+                            continue;
+                        if (neighbours_n == neighbours_size) {
+                            neighbours_size *= 2;
+                            REALLOC_N(neighbours, long, neighbours_size);
+                        }
+                        neighbours[neighbours_n++] = j;
+                    }
+                }
+        qsort(neighbours, neighbours_n, sizeof(long), compare_longs);
+        for (j = 0; j < neighbours_n; ++j) {
+            long k = neighbours[j];
+            double delta = clusters.weights[k] / (weight + clusters.weights[k]);
+            double merged_alt = (1.0 - delta) * alt + delta * clusters.alts[k];
+            if (clusters.alts[k] == 0.0)
+                merged_alt = alt;
+            if (alt == 0.0)
+                merged_alt = clusters.alts[k];
+            interpolate(lat, lon, clusters.lats[k], clusters.lons[k], delta, &lat, &lon);
+            alt = merged_alt;
+            weight += clusters.weights[k];
+            clusters_remove(&clusters, k);
+            clusters.parent[k] = i;
+        }
+        clusters.lats[i] = lat;
+        clusters.lons[i] = lon;
+        clusters.alts[i] = alt;
+        clusters.weights[i] = weight;
+        clusters.parent[i] = -1;
+        clusters_insert(&clusters, i);
+    }
+    /* Number the surviving clusters in order and then point each
+     * coordinate at the cluster that absorbed it, which is always later */
+    for (i = 0, m = 0; i < n; ++i)
+        if (clusters.parent[i] == -1)
+            clusters.cell[i] = m++;
+    for (i = n - 1; i >= 0; --i)
+        if (clusters.parent[i] != -1)
+            clusters.cell[i] = clusters.cell[clusters.parent[i]];
+    coord_array_t out;
+    VALUE rb_centres = coord_array_output(Qnil, m, 0, &out);
+    VALUE rb_weights_out = Qnil;
+    double *weights_out = double_buffer(&rb_weights_out, m);
+    VALUE rb_clusters = rb_ary_new2(n);
+    for (i = 0; i < n; ++i) {
+        if (clusters.parent[i] == -1) {
+            long k = clusters.cell[i];
+            out.lats[k] = clusters.lats[i];
+            out.lons[k] = clusters.lons[i];
+            out.alts[k] = clusters.alts[i];
+            weights_out[k] = clusters.weights[i];
+        }
+        rb_ary_push(rb_clusters, LONG2NUM(clusters.cell[i]));
+    }
+    xfree(neighbours);
+    xfree(clusters.cells);
+    xfree(clusters.lats);
+    xfree(clusters.lons);
+    xfree(clusters.alts);
+    xfree(clusters.weights);
+    xfree(clusters.cell);
+    xfree(clusters.next);
+    xfree(clusters.prev);
+    xfree(clusters.parent);
+    return rb_ary_new3(3, rb_centres, rb_weights_out, rb_clusters);
+}
+
 void
 Init_ccoord(void)
 {
     rb_cCoord = rb_define_class("Coord", rb_cObject);
+    rb_cCoordArray = rb_define_class("CoordArray", rb_cObject);
+    id_at_alts = rb_intern("@alts");
+    id_at_lats = rb_intern("@lats");
+    id_at_lons = rb_intern("@lons");
+    id_at_times = rb_intern("@times");
     id_alt = rb_intern("alt");
     id_lat = rb_intern("lat");
     id_lon = rb_intern("lon");
@@ -123,4 +605,10 @@ Init_ccoord(void)
     rb_define_method(rb_cCoord, "initial_bearing_to", rb_coord_initial_bearing_to, 1);
     rb_define_method(rb_cCoord, "destination_at", rb_coord_destination_at, -1);
     rb_define_method(rb_cCoord, "interpolate", rb_coord_interpolate, 2);
+    rb_define_method(rb_cCoordArray, "cluster", rb_coord_array_cluster, -1);
+    rb_define_method(rb_cCoordArray, "cumulative_distances", rb_coord_array_cumulative_distances, -1);
+    rb_define_method(rb_cCoordArray, "distances", rb_coord_array_distances, -1);
+    rb_define_method(rb_cCoordArray, "halfway_points", rb_coord_array_halfway_points, -1);
+    rb_define_method(rb_cCoordArray, "initial_bearings", rb_coord_array_initial_bearings, -1);
+    rb_define_method(rb_cCoordArray, "interpolate", rb_coord_array_interpolate, -1);
 }
@@ -4,10 +4,19 @@
 #define DEFAULT_R 6371000.0
 
 static VALUE rb_cCoord;
+static VALUE rb_cCoordArray;
 static VALUE rb_cPoint;
+static VALUE rb_cPointArray;
+static VALUE id_at_alts;
+static VALUE id_at_lats;
+static VALUE id_at_lons;
+static VALUE id_at_times;
 static VALUE id_at_x;
+static VALUE id_at_xs;
 static VALUE id_at_y;
+static VALUE id_at_ys;
 static VALUE id_at_z;
+static VALUE id_at_zs;
 static VALUE id_alt;
 static VALUE id_lat;
 static VALUE id_lon;
@@ -27,6 +36,24 @@ rb_point_new(double x, double y, double z)
     return rb_funcall(rb_cPoint, id_new, 3, rb_float_new(x), rb_float_new(y), rb_float_new(z));
 }
 
+static inline void
+to_point(double lat, double lon, double alt, double R, double *x, double *y, double *z)
+{
+    double r = R + alt;
+    double cos_lon = cos(lon);
+    *x = r * cos_lon * cos(lat);
+    *y = r * cos_lon * sin(lat);
+    *z = r * sin(lon);
+}
+
+static inline void
+to_coord(double x, double y, double z, double R, double *lat, double *lon, double *alt)
+{
+    *lat = atan2(y, x);
+    *lon = atan2(z, sqrt(x * x + y * y));
+    *alt = sqrt(x * x + y * y + z * z) - R;
+}
+
 static VALUE
 rb_coord_to_point(int argc, VALUE *argv, VALUE obj)
 {
@@ -36,11 +63,8 @@ rb_coord_to_point(int argc, VALUE *argv, VALUE obj)
     double lon = NUM2DBL(rb_funcall(obj, id_lon, 0));
     double alt = NUM2DBL(rb_funcall(obj, id_alt, 0));
     double R = argc < 1 ? DEFAULT_R : NUM2DBL(argv[0]);
-    double r = R + alt;
-    double cos_lon = cos(lon);
-    double x = r * cos_lon * cos(lat);
-    double y = r * cos_lon * sin(lat);
-    double z = r * sin(lon);
+    double x, y, z;
+    to_point(lat, lon, alt, R, &x, &y, &z);
     return rb_point_new(x, y, z);
 }
 
@@ -195,21 +219,146 @@ rb_point_to_coord(int argc, VALUE *argv, VALUE obj)
     double y = NUM2DBL(rb_ivar_get(obj, id_at_y));
     double z = NUM2DBL(rb_ivar_get(obj, id_at_z));
     double R = argc < 1 ? DEFAULT_R : NUM2DBL(argv[0]);
-    double lat = atan2(y, x);
-    double lon = atan2(z, sqrt(x * x + y * y));
-    double r = sqrt(x * x + y * y + z * z);
-    double alt = r - R;
+    double lat, lon, alt;
+    to_coord(x, y, z, R, &lat, &lon, &alt);
     return rb_coord_new(lat, lon, alt);
 }
 
+static double *
+packed_doubles(VALUE rb_doubles, long *n)
+{
+    Check_Type(rb_doubles, T_STRING);
+    if (RSTRING(rb_doubles)->len % sizeof(double))
+        rb_raise(rb_eArgError, "packed doubles have a partial value");
+    *n = RSTRING(rb_doubles)->len / sizeof(double);
+    return (double *) RSTRING(rb_doubles)->ptr;
+}
+
+/* Returns the columns named by ids[0..2] of rb_obj, checking that they
+ * have the same length */
+static long
+columns_get(VALUE rb_obj, const ID *ids, double **columns)
+{
+    long n, m;
+    int i;
+    for (i = 0; i < 3; ++i) {
+        columns[i] = packed_doubles(rb_ivar_get(rb_obj, ids[i]), i ? &m : &n);
+        if (i && m != n)
+            rb_raise(rb_eArgError, "columns have different lengths");
+    }
+    return n;
+}
+
+/* Returns rb_out, or a new instance of klass if it is nil, with its
+ * columns named by ids[0..2] resized in place to hold n doubles */
+static VALUE
+columns_output(VALUE rb_self, VALUE rb_out, VALUE klass, const ID *ids, long n, double **columns)
+{
+    if (NIL_P(rb_out))
+        rb_out = rb_obj_alloc(klass);
+    else if (rb_out == rb_self)
+        rb_raise(rb_eArgError, "output is the input");
+    else if (!rb_obj_is_kind_of(rb_out, klass))
+        rb_raise(rb_eTypeError, "output is not a %s", rb_class2name(klass));
+    int i;
+    for (i = 0; i < 3; ++i) {
+        VALUE rb_column = rb_ivar_defined(rb_out, ids[i]) ? rb_ivar_get(rb_out, ids[i]) : Qnil;
+        if (NIL_P(rb_column)) {
+            rb_column = rb_str_new(NULL, n * sizeof(double));
+            rb_ivar_set(rb_out, ids[i], rb_column);
+        } else {
+            Check_Type(rb_column, T_STRING);
+            rb_str_modify(rb_column);
+            rb_str_resize(rb_column, n * sizeof(double));
+        }
+        columns[i] = (double *) RSTRING(rb_column)->ptr;
+    }
+    return rb_out;
+}
+
+/* Returns a PointArray of the coordinates converted to Cartesian
+ * coordinates, written into out if it is given */
+static VALUE
+rb_coord_array_to_points(int argc, VALUE *argv, VALUE obj)
+{
+    VALUE rb_out, rb_R;
+    rb_scan_args(argc, argv, "02", &rb_out, &rb_R);
+    double R = NIL_P(rb_R) ? DEFAULT_R : NUM2DBL(rb_R);
+    ID coord_ids[3] = { id_at_lats, id_at_lons, id_at_alts };
+    ID point_ids[3] = { id_at_xs, id_at_ys, id_at_zs };
+    double *coords[3], *points[3];
+    long n = columns_get(obj, coord_ids, coords), i;
+    rb_out = columns_output(obj, rb_out, rb_cPointArray, point_ids, n, points);
+    columns_get(obj, coord_ids, coords);
+    for (i = 0; i < n; ++i)
+        to_point(coords[0][i], coords[1][i], coords[2][i], R, points[0] + i, points[1] + i, points[2] + i);
+    return rb_out;
+}
+
+/* Returns the dot products of each point with point as packed doubles,
+ * written into out if it is given */
+static VALUE
+rb_point_array_dots(int argc, VALUE *argv, VALUE obj)
+{
+    VALUE rb_point, rb_out;
+    rb_scan_args(argc, argv, "11", &rb_point, &rb_out);
+    double x = NUM2DBL(rb_ivar_get(rb_point, id_at_x));
+    double y = NUM2DBL(rb_ivar_get(rb_point, id_at_y));
+    double z = NUM2DBL(rb_ivar_get(rb_point, id_at_z));
+    ID point_ids[3] = { id_at_xs, id_at_ys, id_at_zs };
+    double *points[3];
+    long n = columns_get(obj, point_ids, points), i;
+    if (NIL_P(rb_out)) {
+        rb_out = rb_str_new(NULL, n * sizeof(double));
+    } else {
+        Check_Type(rb_out, T_STRING);
+        rb_str_modify(rb_out);
+        rb_str_resize(rb_out, n * sizeof(double));
+    }
+    double *out = (double *) RSTRING(rb_out)->ptr;
+    columns_get(obj, point_ids, points);
+    for (i = 0; i < n; ++i)
+        out[i] = points[0][i] * x + points[1][i] * y + points[2][i] * z;
+    return rb_out;
+}
+
+/* Returns a CoordArray, without times, of the points converted back to
+ * coordinates, written into out if it is given */
+static VALUE
+rb_point_array_to_coords(int argc, VALUE *argv, VALUE obj)
+{
+    VALUE rb_out, rb_R;
+    rb_scan_args(argc, argv, "02", &rb_out, &rb_R);
+    double R = NIL_P(rb_R) ? DEFAULT_R : NUM2DBL(rb_R);
+    ID coord_ids[3] = { id_at_lats, id_at_lons, id_at_alts };
+    ID point_ids[3] = { id_at_xs, id_at_ys, id_at_zs };
+    double *coords[3], *points[3];
+    long n = columns_get(obj, point_ids, points), i;
+    rb_out = columns_output(obj, rb_out, rb_cCoordArray, coord_ids, n, coords);
+    rb_ivar_set(rb_out, id_at_times, Qnil);
+    columns_get(obj, point_ids, points);
+    for (i = 0; i < n; ++i)
+        to_coord(points[0][i], points[1][i], points[2][i], R, coords[0] + i, coords[1] + i, coords[2] + i);
+    return rb_out;
+}
+
 void
 Init_cgeometry(void)
 {
     rb_cCoord = rb_define_class("Coord", rb_cObject);
+    rb_cCoordArray = rb_define_class("CoordArray", rb_cObject);
     rb_cPoint = rb_define_class("Point", rb_cObject);
+    rb_cPointArray = rb_define_class("PointArray", rb_cObject);
+    id_at_alts = rb_intern("@alts");
+    id_at_lats = rb_intern("@lats");
+    id_at_lons = rb_intern("@lons");
+    id_at_times = rb_intern("@times");
     id_at_x = rb_intern("@x");
+    id_at_xs = rb_intern("@xs");
     id_at_y = rb_intern("@y");
+    id_at_ys = rb_intern("@ys");
     id_at_z = rb_intern("@z");
+    id_at_zs = rb_intern("@zs");
     id_alt = rb_intern("alt");
     id_lat = rb_intern("lat");
     id_lon = rb_intern("lon");
@@ -229,4 +378,7 @@ Init_cgeometry(void)
     rb_define_method(rb_cPoint, "+", rb_point_plus, 1);
     rb_define_method(rb_cPoint, "-", rb_point_minus, 1);
     rb_define_method(rb_cPoint, "-@", rb_point_uminus, 0);
+    rb_define_method(rb_cCoordArray, "to_points", rb_coord_array_to_points, -1);
+    rb_define_method(rb_cPointArray, "dots", rb_point_array_dots, -1);
+    rb_define_method(rb_cPointArray, "to_coords", rb_point_array_to_coords, -1);
 }
@@ -0,0 +1,604 @@
+#include <ruby.h>
+#ifdef HAVE_RUBY_THREAD_H
+#include <ruby/thread.h>
+#endif
+
+#include <errno.h>
+#include <math.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define HEATMAP_MAGIC "HEATMAP1"
+#define HEATMAP_SIZE_MAX 65536
+#define MERGE_CHUNK 65536
+
+/* A heatmap accumulates, for each cell of a grid over a latitude and
+ * longitude box, the number of climbing fix pairs whose halfway points
+ * fall in the cell and the sum of their climb rates.  Row 0 is the
+ * northernmost.  The accumulator file is a header followed by the two
+ * grids and a trailer of the caller's choosing, all in native byte
+ * order. */
+
+typedef struct {
+    char magic[8];
+    uint32_t width;
+    uint32_t height;
+    double west, south, east, north;
+    uint64_t tracks;
+    uint64_t samples;
+    uint64_t trailer_size;
+} header_t;
+
+typedef struct {
+    int width;
+    int height;
+    double west, south, east, north;
+    uint64_t tracks;
+    uint64_t samples;
+    double *n;
+    double *x;
+} heatmap_t;
+
+typedef struct {
+    const double *lats;
+    const double *lons;
+    const double *alts;
+    const double *times;
+    long length;
+} track_t;
+
+typedef struct {
+#ifdef HAVE_PTHREAD_H
+    pthread_t threads[256];
+#endif
+    int started;
+} workers_t;
+
+/* The state shared by the threads adding a batch of tracks.  Each thread
+ * claims a grid, the heatmap's own for the first and a private one for
+ * the others, and then claims tracks until there are none left.  The
+ * private grids are then summed into the heatmap's, again in parallel,
+ * by chunks of cells. */
+typedef struct {
+    heatmap_t *heatmap;
+    const track_t *tracks;
+    int ntracks;
+    int next;
+    int grids;
+    double **ns;
+    double **xs;
+    int merging;
+    long cells;
+    uint64_t samples;
+} ingest_t;
+
+static int heatmap_threads = 1;
+
+void Init_cheatmap(void);
+
+static inline void
+halfway(double lat1, double lon1, double lat2, double lon2, double *lat, double *lon)
+{
+    double delta_lon = lon2 - lon1;
+    double Bx = cos(lat2) * cos(delta_lon);
+    double By = cos(lat2) * sin(delta_lon);
+    double cos_lat1_plus_Bx = cos(lat1) + Bx;
+    *lat = atan2(sin(lat1) + sin(lat2), sqrt(cos_lat1_plus_Bx * cos_lat1_plus_Bx + By * By));
+    *lon = lon1 + atan2(By, cos_lat1_plus_Bx);
+}
+
+/* Samples the climbing fix pairs of track into the grids n and x,
+ * returning the number of samples */
+static uint64_t
+heatmap_sample(const heatmap_t *heatmap, double *n, double *x, const track_t *track)
+{
+    double col_scale = heatmap->width / (heatmap->east - heatmap->west);
+    double row_scale = heatmap->height / (heatmap->north - heatmap->south);
+    uint64_t samples = 0;
+    long i;
+    for (i = 0; i + 1 < track->length; ++i) {
+        double dz = track->alts[i + 1] - track->alts[i];
+        double dt = track->times[i + 1] - track->times[i];
+        if (dz <= 0.0 || dt <= 0.0)
+            continue;
+        double lat, lon;
+        halfway(track->lats[i], track->lons[i], track->lats[i + 1], track->lons[i + 1], &lat, &lon);
+        double col = floor(col_scale * (lon - heatmap->west));
+        double row = floor(row_scale * (heatmap->north - lat));
+        if (col < 0.0 || col >= heatmap->width || row < 0.0 || row >= heatmap->height)
+            continue;
+        long k = (long) row * heatmap->width + (long) col;
+        n[k] += 1.0;
+        x[k] += dz / dt;
+        ++samples;
+    }
+    return samples;
+}
+
+/* Starts threads running worker(arg) alongside the caller, up to
+ * heatmap_threads in all and no more than there are chunks of n items */
+static void
+workers_start(workers_t *workers, void *(*worker)(void *), void *arg, long n, long chunk)
+{
+    workers->started = 0;
+#ifdef HAVE_PTHREAD_H
+    int i;
+    for (i = 1; i < heatmap_threads && i * chunk < n; ++i)
+        if (pthread_create(&workers->threads[workers->started], NULL, worker, arg) == 0)
+            ++workers->started;
+#endif
+}
+
+static void
+workers_join(workers_t *workers)
+{
+#ifdef HAVE_PTHREAD_H
+    int i;
+    for (i = 0; i < workers->started; ++i)
+        pthread_join(workers->threads[i], NULL);
+#endif
+}
+
+static void *
+ingest_worker(void *arg)
+{
+    ingest_t *ingest = arg;
+    heatmap_t *heatmap = ingest->heatmap;
+    int grid = __atomic_fetch_add(&ingest->grids, 1, __ATOMIC_RELAXED);
+    double *n = grid ? ingest->ns[grid] : heatmap->n;
+    double *x = grid ? ingest->xs[grid] : heatmap->x;
+    uint64_t samples = 0;
+    while (1) {
+        int i = __atomic_fetch_add(&ingest->next, 1, __ATOMIC_RELAXED);
+        if (i >= ingest->ntracks)
+            break;
+        samples += heatmap_sample(heatmap, n, x, ingest->tracks + i);
+    }
+    __atomic_fetch_add(&ingest->samples, samples, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void *
+merge_worker(void *arg)
+{
+    ingest_t *ingest = arg;
+    heatmap_t *heatmap = ingest->heatmap;
+    while (1) {
+        long begin = __atomic_fetch_add(&ingest->cells, MERGE_CHUNK, __ATOMIC_RELAXED);
+        long end = (long) heatmap->width * heatmap->height;
+        if (begin >= end)
+            break;
+        if (begin + MERGE_CHUNK < end)
+            end = begin + MERGE_CHUNK;
+        int grid;
+        long k;
+        for (grid = 1; grid < ingest->merging; ++grid)
+            for (k = begin; k < end; ++k) {
+                heatmap->n[k] += ingest->ns[grid][k];
+                heatmap->x[k] += ingest->xs[grid][k];
+            }
+    }
+    return NULL;
+}
+
+static void *
+ingest_run(void *arg)
+{
+    ingest_t *ingest = arg;
+    workers_t workers;
+    workers_start(&workers, ingest_worker, ingest, ingest->ntracks, 1);
+    ingest_worker(ingest);
+    workers_join(&workers);
+    ingest->merging = ingest->grids;
+    if (ingest->merging > 1) {
+        workers_start(&workers, merge_worker, ingest, (long) ingest->heatmap->width * ingest->heatmap->height, MERGE_CHUNK);
+        merge_worker(ingest);
+        workers_join(&workers);
+    }
+    return NULL;
+}
+
+static const double *
+fix_buffer_column(VALUE rb_fix_buffer, const char *name, long n)
+{
+    VALUE rb_column = rb_funcall(rb_fix_buffer, rb_intern(name), 0);
+    Check_Type(rb_column, T_STRING);
+    if (RSTRING(rb_column)->len != n * (long) sizeof(double))
+        rb_raise(rb_eArgError, "fix buffer %s has %ld bytes, expected %ld", name, (long) RSTRING(rb_column)->len, n * (long) sizeof(double));
+    return (const double *) RSTRING(rb_column)->ptr;
+}
+
+static void
+heatmap_free(heatmap_t *heatmap)
+{
+    if (heatmap->n)
+        xfree(heatmap->n);
+    if (heatmap->x)
+        xfree(heatmap->x);
+    xfree(heatmap);
+}
+
+static VALUE
+rb_Heatmap_alloc(VALUE rb_class)
+{
+    heatmap_t *heatmap;
+    VALUE rb_self = Data_Make_Struct(rb_class, heatmap_t, 0, heatmap_free, heatmap);
+    memset(heatmap, 0, sizeof(heatmap_t));
+    return rb_self;
+}
+
+static heatmap_t *
+rb_Heatmap_get(VALUE rb_self)
+{
+    heatmap_t *heatmap;
+    Data_Get_Struct(rb_self, heatmap_t, heatmap);
+    if (!heatmap->n)
+        rb_raise(rb_eRuntimeError, "uninitialized heatmap");
+    return heatmap;
+}
+
+static void
+heatmap_init(heatmap_t *heatmap, double west, double south, double east, double north, long width, long height)
+{
+    if (width < 1 || height < 1 || width > HEATMAP_SIZE_MAX || height > HEATMAP_SIZE_MAX)
+        rb_raise(rb_eArgError, "invalid heatmap size");
+    if (!(west < east) || !(south < north))
+        rb_raise(rb_eArgError, "invalid heatmap bounds");
+    long cells = width * height;
+    if (heatmap->n)
+        xfree(heatmap->n);
+    if (heatmap->x)
+        xfree(heatmap->x);
+    heatmap->n = heatmap->x = NULL;
+    heatmap->n = ALLOC_N(double, cells);
+    heatmap->x = ALLOC_N(double, cells);
+    memset(heatmap->n, 0, cells * sizeof(double));
+    memset(heatmap->x, 0, cells * sizeof(double));
+    heatmap->width = width;
+    heatmap->height = height;
+    heatmap->west = west;
+    heatmap->south = south;
+    heatmap->east = east;
+    heatmap->north = north;
+    heatmap->tracks = heatmap->samples = 0;
+}
+
+/* Creates an empty heatmap of width by height cells over west, south,
+ * east and north, in radians. */
+static VALUE
+rb_Heatmap_initialize(VALUE rb_self, VALUE rb_west, VALUE rb_south, VALUE rb_east, VALUE rb_north, VALUE rb_width, VALUE rb_height)
+{
+    heatmap_t *heatmap;
+    Data_Get_Struct(rb_self, heatmap_t, heatmap);
+    heatmap_init(heatmap, NUM2DBL(rb_west), NUM2DBL(rb_south), NUM2DBL(rb_east), NUM2DBL(rb_north), NUM2LONG(rb_width), NUM2LONG(rb_height));
+    return rb_self;
+}
+
+static VALUE
+rb_Heatmap_width(VALUE rb_self)
+{
+    return INT2NUM(rb_Heatmap_get(rb_self)->width);
+}
+
+static VALUE
+rb_Heatmap_height(VALUE rb_self)
+{
+    return INT2NUM(rb_Heatmap_get(rb_self)->height);
+}
+
+/* Returns [west, south, east, north] in radians. */
+static VALUE
+rb_Heatmap_bounds(VALUE rb_self)
+{
+    heatmap_t *heatmap = rb_Heatmap_get(rb_self);
+    return rb_ary_new3(4, rb_float_new(heatmap->west), rb_float_new(heatmap->south), rb_float_new(heatmap->east), rb_float_new(heatmap->north));
+}
+
+static VALUE
+rb_Heatmap_tracks(VALUE rb_self)
+{
+    return ULL2NUM(rb_Heatmap_get(rb_self)->tracks);
+}
+
+static VALUE
+rb_Heatmap_samples(VALUE rb_self)
+{
+    return ULL2NUM(rb_Heatmap_get(rb_self)->samples);
+}
+
+/* The state of Heatmap#add, whose buffers are freed even if reading a fix
+ * buffer raises */
+typedef struct {
+    ingest_t ingest;
+    VALUE rb_fix_buffers;
+    track_t *tracks;
+    int grids;
+    long cells;
+} add_t;
+
+static VALUE
+heatmap_add_run(VALUE rb_add)
+{
+    add_t *add = (add_t *) rb_add;
+    ingest_t *ingest = &add->ingest;
+    int i;
+    for (i = 0; i < ingest->ntracks; ++i) {
+        VALUE rb_fix_buffer = rb_ary_entry(add->rb_fix_buffers, i);
+        track_t *track = add->tracks + i;
+        track->length = NUM2LONG(rb_funcall(rb_fix_buffer, rb_intern("length"), 0));
+        track->lats = fix_buffer_column(rb_fix_buffer, "lats", track->length);
+        track->lons = fix_buffer_column(rb_fix_buffer, "lons", track->length);
+        track->alts = fix_buffer_column(rb_fix_buffer, "alts", track->length);
+        track->times = fix_buffer_column(rb_fix_buffer, "times", track->length);
+    }
+    for (i = 1; i < add->grids; ++i) {
+        ingest->ns[i] = ALLOC_N(double, add->cells);
+        ingest->xs[i] = ALLOC_N(double, add->cells);
+        memset(ingest->ns[i], 0, add->cells * sizeof(double));
+        memset(ingest->xs[i], 0, add->cells * sizeof(double));
+    }
+#if defined(HAVE_RB_THREAD_CALL_WITHOUT_GVL)
+    rb_thread_call_without_gvl(ingest_run, ingest, NULL, NULL);
+#elif defined(HAVE_RB_THREAD_BLOCKING_REGION)
+    rb_thread_blocking_region((rb_blocking_function_t *) ingest_run, ingest, NULL, NULL);
+#else
+    ingest_run(ingest);
+#endif
+    return Qnil;
+}
+
+static VALUE
+heatmap_add_free(VALUE rb_add)
+{
+    add_t *add = (add_t *) rb_add;
+    int i;
+    for (i = 1; i < add->grids; ++i) {
+        xfree(add->ingest.ns[i]);
+        xfree(add->ingest.xs[i]);
+    }
+    xfree(add->ingest.ns);
+    xfree(add->ingest.xs);
+    xfree(add->tracks);
+    return Qnil;
+}
+
+/* Adds the climbing fix pairs of each of fix_buffers, spreading the fix
+ * buffers across Heatmap.threads threads that each accumulate into their
+ * own grid.  Returns the number of samples added. */
+static VALUE
+rb_Heatmap_add(VALUE rb_self, VALUE rb_fix_buffers)
+{
+    heatmap_t *heatmap = rb_Heatmap_get(rb_self);
+    Check_Type(rb_fix_buffers, T_ARRAY);
+    int ntracks = RARRAY(rb_fix_buffers)->len;
+    if (!ntracks)
+        return INT2FIX(0);
+    add_t add;
+    memset(&add, 0, sizeof add);
+    add.rb_fix_buffers = rb_fix_buffers;
+    ingest_t *ingest = &add.ingest;
+    ingest->heatmap = heatmap;
+    ingest->ntracks = ntracks;
+    add.grids = heatmap_threads < ntracks ? heatmap_threads : ntracks;
+    add.cells = (long) heatmap->width * heatmap->height;
+    add.tracks = ALLOC_N(track_t, ntracks);
+    ingest->tracks = add.tracks;
+    /* the first grid is the heatmap's own */
+    ingest->ns = ALLOC_N(double *, add.grids);
+    ingest->xs = ALLOC_N(double *, add.grids);
+    memset(ingest->ns, 0, add.grids * sizeof(double *));
+    memset(ingest->xs, 0, add.grids * sizeof(double *));
+    rb_ensure(heatmap_add_run, (VALUE) &add, heatmap_add_free, (VALUE) &add);
+    RB_GC_GUARD(rb_fix_buffers);
+    heatmap->tracks += ntracks;
+    heatmap->samples += ingest->samples;
+    return ULL2NUM(ingest->samples);
+}
+
+static void
+heatmap_check_rect(const heatmap_t *heatmap, int level, long col, long row, long width, long height)
+{
+    if (level < 0 || level > 16)
+        rb_raise(rb_eArgError, "invalid level %d", level);
+    long scale = 1L << level;
+    long cols = (heatmap->width + scale - 1) / scale, rows = (heatmap->height + scale - 1) / scale;
+    if (col < 0 || row < 0 || width < 1 || height < 1 || col + width > cols || row + height > rows)
+        rb_raise(rb_eArgError, "rectangle outside heatmap at level %d", level);
+}
+
+/* Sums the counts and climbs of the cells under the pixel at col, row of
+ * level, each pixel of which covers 2**level by 2**level cells */
+static void
+heatmap_pixel(const heatmap_t *heatmap, int level, long col, long row, double *n, double *x)
+{
+    long scale = 1L << level;
+    long i0 = col * scale, i1 = i0 + scale > heatmap->width ? heatmap->width : i0 + scale;
+    long j0 = row * scale, j1 = j0 + scale > heatmap->height ? heatmap->height : j0 + scale;
+    long i, j;
+    *n = *x = 0.0;
+    for (j = j0; j < j1; ++j)
+        for (i = i0; i < i1; ++i) {
+            *n += heatmap->n[j * heatmap->width + i];
+            *x += heatmap->x[j * heatmap->width + i];
+        }
+}
+
+/* Returns the number of samples under width by height pixels of level
+ * from col, row. */
+static VALUE
+rb_Heatmap_count(VALUE rb_self, VALUE rb_level, VALUE rb_col, VALUE rb_row, VALUE rb_width, VALUE rb_height)
+{
+    heatmap_t *heatmap = rb_Heatmap_get(rb_self);
+    int level = NUM2INT(rb_level);
+    long col = NUM2LONG(rb_col), row = NUM2LONG(rb_row), width = NUM2LONG(rb_width), height = NUM2LONG(rb_height);
+    heatmap_check_rect(heatmap, level, col, row, width, height);
+    long scale = 1L << level;
+    long i0 = col * scale, i1 = (col + width) * scale > heatmap->width ? heatmap->width : (col + width) * scale;
+    long j0 = row * scale, j1 = (row + height) * scale > heatmap->height ? heatmap->height : (row + height) * scale;
+    long i, j;
+    double count = 0.0;
+    for (j = j0; j < j1; ++j)
+        for (i = i0; i < i1; ++i)
+            count += heatmap->n[j * heatmap->width + i];
+    return rb_float_new(count);
+}
+
+static inline double
+hue_channel(double h)
+{
+    h -= floor(h);
+    if (h < 1.0 / 6.0)
+        return 6.0 * h;
+    if (h < 0.5)
+        return 1.0;
+    if (h < 2.0 / 3.0)
+        return 6.0 * (2.0 / 3.0 - h);
+    return 0.0;
+}
+
+/* Returns width by height RGBA pixels of level from col, row, or nil if
+ * they are all empty.  A pixel's hue runs from red, for a mean climb of
+ * 1.5m/s or more, through green, for none, to blue, for a mean sink of
+ * 1.5m/s or more, as Gradient::Default does, and its opacity rises with the number of samples per cell, reaching half when
+ * there are opacity_scale. */
+static VALUE
+rb_Heatmap_to_rgba(VALUE rb_self, VALUE rb_level, VALUE rb_col, VALUE rb_row, VALUE rb_width, VALUE rb_height, VALUE rb_opacity_scale)
+{
+    heatmap_t *heatmap = rb_Heatmap_get(rb_self);
+    int level = NUM2INT(rb_level);
+    long col = NUM2LONG(rb_col), row = NUM2LONG(rb_row), width = NUM2LONG(rb_width), height = NUM2LONG(rb_height);
+    double opacity_scale = NUM2DBL(rb_opacity_scale);
+    heatmap_check_rect(heatmap, level, col, row, width, height);
+    if (!(opacity_scale > 0.0))
+        rb_raise(rb_eArgError, "opacity scale must be positive");
+    double cells = (double) (1L << level) * (1L << level);
+    VALUE rb_rgba = rb_str_new(NULL, 4 * width * height);
+    unsigned char *p = (unsigned char *) RSTRING(rb_rgba)->ptr;
+    int empty = 1;
+    long i, j;
+    for (j = row; j < row + height; ++j)
+        for (i = col; i < col + width; ++i, p += 4) {
+            double n, x;
+            heatmap_pixel(heatmap, level, i, j, &n, &x);
+            if (n == 0.0) {
+                memset(p, 0, 4);
+                continue;
+            }
+            empty = 0;
+            double value = x / (3.0 * n) + 0.5;
+            value = value < 0.0 ? 0.0 : value > 1.0 ? 1.0 : value;
+            double hue = 2.0 * (1.0 - value) / 3.0;
+            p[0] = (unsigned char) (255.0 * hue_channel(hue + 1.0 / 3.0) + 0.5);
+            p[1] = (unsigned char) (255.0 * hue_channel(hue) + 0.5);
+            p[2] = (unsigned char) (255.0 * hue_channel(hue - 1.0 / 3.0) + 0.5);
+            p[3] = (unsigned char) (255.0 * 2.0 * atan2(n / cells, opacity_scale) / M_PI + 0.5);
+        }
+    return empty ? Qnil : rb_rgba;
+}
+
+/* Writes the heatmap and trailer to filename. */
+static VALUE
+rb_Heatmap_write(VALUE rb_self, VALUE rb_filename, VALUE rb_trailer)
+{
+    heatmap_t *heatmap = rb_Heatmap_get(rb_self);
+    const char *filename = StringValueCStr(rb_filename);
+    StringValue(rb_trailer);
+    header_t header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, HEATMAP_MAGIC, sizeof header.magic);
+    header.width = heatmap->width;
+    header.height = heatmap->height;
+    header.west = heatmap->west;
+    header.south = heatmap->south;
+    header.east = heatmap->east;
+    header.north = heatmap->north;
+    header.tracks = heatmap->tracks;
+    header.samples = heatmap->samples;
+    header.trailer_size = RSTRING(rb_trailer)->len;
+    size_t cells = (size_t) heatmap->width * heatmap->height;
+    FILE *file = fopen(filename, "wb");
+    if (!file)
+        rb_sys_fail(filename);
+    int ok = fwrite(&header, sizeof header, 1, file) == 1
+        && fwrite(heatmap->n, sizeof(double), cells, file) == cells
+        && fwrite(heatmap->x, sizeof(double), cells, file) == cells
+        && fwrite(RSTRING(rb_trailer)->ptr, 1, header.trailer_size, file) == header.trailer_size;
+    if (fclose(file) || !ok)
+        rb_sys_fail(filename);
+    return rb_filename;
+}
+
+/* Reads the heatmap written to filename, returning it and its trailer. */
+static VALUE
+rb_Heatmap_s_read(VALUE rb_class, VALUE rb_filename)
+{
+    const char *filename = StringValueCStr(rb_filename);
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+        rb_sys_fail(filename);
+    header_t header;
+    if (fread(&header, sizeof header, 1, file) != 1 || memcmp(header.magic, HEATMAP_MAGIC, sizeof header.magic) || header.width < 1 || header.width > HEATMAP_SIZE_MAX || header.height < 1 || header.height > HEATMAP_SIZE_MAX || !(header.west < header.east) || !(header.south < header.north)) {
+        fclose(file);
+        rb_raise(rb_eRuntimeError, "%s: not a heatmap", filename);
+    }
+    VALUE rb_self = rb_Heatmap_alloc(rb_class);
+    heatmap_t *heatmap;
+    Data_Get_Struct(rb_self, heatmap_t, heatmap);
+    heatmap_init(heatmap, header.west, header.south, header.east, header.north, header.width, header.height);
+    heatmap->tracks = header.tracks;
+    heatmap->samples = header.samples;
+    size_t cells = (size_t) header.width * header.height;
+    VALUE rb_trailer = rb_str_new(NULL, header.trailer_size);
+    int ok = fread(heatmap->n, sizeof(double), cells, file) == cells
+        && fread(heatmap->x, sizeof(double), cells, file) == cells
+        && fread(RSTRING(rb_trailer)->ptr, 1, header.trailer_size, file) == header.trailer_size
+        && fgetc(file) == EOF;
+    fclose(file);
+    if (!ok)
+        rb_raise(rb_eRuntimeError, "%s: truncated heatmap", filename);
+    return rb_ary_new3(2, rb_self, rb_trailer);
+}
+
+static VALUE
+rb_Heatmap_s_threads(VALUE rb_class)
+{
+    return INT2NUM(heatmap_threads);
+}
+
+static VALUE
+rb_Heatmap_s_set_threads(VALUE rb_class, VALUE rb_threads)
+{
+    int threads = NUM2INT(rb_threads);
+    if (threads < 1 || 256 < threads)
+        rb_raise(rb_eArgError, "threads must be between 1 and 256");
+    heatmap_threads = threads;
+    return rb_threads;
+}
+
+void
+Init_cheatmap(void)
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    heatmap_threads = processors < 1 ? 1 : processors > 256 ? 256 : processors;
+    VALUE rb_cHeatmap = rb_define_class("Heatmap", rb_cObject);
+    rb_define_alloc_func(rb_cHeatmap, rb_Heatmap_alloc);
+    rb_define_singleton_method(rb_cHeatmap, "read", rb_Heatmap_s_read, 1);
+    rb_define_singleton_method(rb_cHeatmap, "threads", rb_Heatmap_s_threads, 0);
+    rb_define_singleton_method(rb_cHeatmap, "threads=", rb_Heatmap_s_set_threads, 1);
+    rb_define_method(rb_cHeatmap, "initialize", rb_Heatmap_initialize, 6);
+    rb_define_method(rb_cHeatmap, "width", rb_Heatmap_width, 0);
+    rb_define_method(rb_cHeatmap, "height", rb_Heatmap_height, 0);
+    rb_define_method(rb_cHeatmap, "bounds", rb_Heatmap_bounds, 0);
+    rb_define_method(rb_cHeatmap, "tracks", rb_Heatmap_tracks, 0);
+    rb_define_method(rb_cHeatmap, "samples", rb_Heatmap_samples, 0);
+    rb_define_method(rb_cHeatmap, "add", rb_Heatmap_add, 1);
+    rb_define_method(rb_cHeatmap, "count", rb_Heatmap_count, 5);
+    rb_define_method(rb_cHeatmap, "to_rgba", rb_Heatmap_to_rgba, 6);
+    rb_define_method(rb_cHeatmap, "write", rb_Heatmap_write, 2);
+}
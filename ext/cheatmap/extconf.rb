@@ -0,0 +1,8 @@
+require "mkmf"
+
+$CFLAGS += " -Wall -Wextra -Wmissing-prototypes"
+have_header("ruby/thread.h")
+have_func("rb_thread_call_without_gvl", "ruby/thread.h")
+have_func("rb_thread_blocking_region")
+have_header("pthread.h") and have_library("pthread", "pthread_create")
+create_makefile("cheatmap")
@@ -0,0 +1,82 @@
+require "cheatmap"
+require "igc"
+require "test/unit"
+
+class TC_CHeatmap < Test::Unit::TestCase
+
+  DEG = Math::PI / 180.0
+
+  def fix_buffer(fixes)
+    IGC::FixBuffer.new(fixes.collect { |lat, lon, alt, time| IGC::Fix.new(Time.at(time).utc, lat * DEG, lon * DEG, alt) })
+  end
+
+  # A 4 by 2 heatmap of 1 degree cells from 6E 45N
+  def heatmap
+    Heatmap.new(6 * DEG, 45 * DEG, 10 * DEG, 47 * DEG, 4, 2)
+  end
+
+  def test_add
+    h = heatmap
+    # Climbs of 2m/s halfway at 7.5E 46.5N and 9.5E 45.5N, a sink and a
+    # climb outside the heatmap
+    track = fix_buffer([[46.4, 7.5, 1000, 0], [46.6, 7.5, 1020, 10], [45.4, 9.5, 1000, 100], [45.6, 9.5, 1010, 105], [45.7, 9.5, 900, 110], [40.0, 9.5, 1000, 120]])
+    assert_equal(2, h.add([track]))
+    assert_equal([1, 2], [h.tracks, h.samples])
+    assert_equal(1.0, h.count(0, 1, 0, 1, 1))
+    assert_equal(1.0, h.count(0, 3, 1, 1, 1))
+    assert_equal(0.0, h.count(0, 0, 0, 1, 2))
+    assert_equal(2.0, h.count(1, 0, 0, 2, 1))
+    rgba = h.to_rgba(0, 0, 0, 4, 2, 1.0).unpack("C*").enum_for(:each_slice, 4).to_a
+    assert_equal([0, 0, 0, 0], rgba[0])
+    # A mean climb of 2m/s is red and one sample at an opacity scale of one
+    # is half opaque
+    assert_equal([255, 0, 0, 128], rgba[1])
+    assert_equal([255, 0, 0, 128], rgba[7])
+    assert_nil(h.to_rgba(0, 0, 0, 1, 2, 1.0))
+    # At level 1 a pixel covers four cells
+    assert_equal([255, 0, 0, 40], h.to_rgba(1, 0, 0, 1, 1, 1.0).unpack("C*"))
+  end
+
+  def test_threads
+    srand(1)
+    tracks = Array.new(32) do
+      lat, lon, alt = 45 + 2 * rand, 6 + 4 * rand, 1000.0
+      fix_buffer(Array.new(200) { |i| [lat += 0.02 * (rand - 0.5), lon += 0.02 * (rand - 0.5), alt += 10.0 * (rand - 0.4), i] })
+    end
+    counts = [1, 4].collect do |threads|
+      Heatmap.threads = threads
+      h = heatmap
+      samples = h.add(tracks[0, 5]) + h.add(tracks[5..-1])
+      assert_equal(samples, h.samples)
+      (0...2).collect { |row| (0...4).collect { |col| h.count(0, col, row, 1, 1) } }
+    end
+    assert_equal(counts[0], counts[1])
+  end
+
+  def test_write_and_read
+    h = heatmap
+    h.add([fix_buffer([[46.4, 7.5, 1000, 0], [46.6, 7.5, 1020, 10]])])
+    filename = "testcheatmap.#{$$}"
+    h.write(filename, "a\nb")
+    other, trailer = Heatmap.read(filename)
+    assert_equal("a\nb", trailer)
+    assert_equal([4, 2, h.bounds, 1, 1], [other.width, other.height, other.bounds, other.tracks, other.samples])
+    assert_equal(h.to_rgba(0, 0, 0, 4, 2, 1.0), other.to_rgba(0, 0, 0, 4, 2, 1.0))
+    File.open(filename, "ab") { |file| file.write("x") }
+    assert_raise(RuntimeError) { Heatmap.read(filename) }
+  ensure
+    File.unlink(filename) if FileTest.exist?(filename)
+  end
+
+  def test_malformed
+    assert_raise(ArgumentError) { Heatmap.new(0.0, 0.0, 1.0, 1.0, 0, 1) }
+    assert_raise(ArgumentError) { Heatmap.new(1.0, 0.0, 0.0, 1.0, 1, 1) }
+    assert_raise(ArgumentError) { heatmap.to_rgba(0, 0, 0, 5, 1, 1.0) }
+    assert_raise(ArgumentError) { heatmap.count(1, 0, 1, 1, 1) }
+    truncated = fix_buffer([[45.5, 6.5, 1000.0, 0]])
+    truncated.lats.replace("")
+    assert_raise(ArgumentError) { heatmap.add([truncated]) }
+    assert_raise(ArgumentError) { Heatmap.threads = 0 }
+  end
+
+end
@@ -0,0 +1,880 @@
+/* vim: set filetype=ragel shiftwidth=4 softtabstop=4 tabstop=8: */
+
+#include <math.h>
+#include <string.h>
+
+#include <ruby.h>
+#ifdef HAVE_RUBY_ENCODING_H
+#include <ruby/encoding.h>
+#endif
+
+#define CHUNK_SIZE 65536
+#define DIGEST_BUFFER_SIZE 65536
+#define SECONDS_PER_DAY 86400
+
+static VALUE id_hexdigest;
+static VALUE id_new;
+static VALUE id_read;
+static VALUE id_update;
+static VALUE id_utc;
+
+static VALUE rb_cExtension;
+static VALUE rb_cFix;
+static VALUE rb_cFixArray;
+static VALUE rb_cIGC;
+static VALUE rb_cTask;
+static VALUE rb_cWaypoint;
+
+void Init_cigc(void);
+
+enum {
+    RECORD_UNKNOWN,
+    RECORD_IGNORED,
+    RECORD_A,
+    RECORD_B,
+    RECORD_C_DECLARATION,
+    RECORD_C_WAYPOINT,
+    RECORD_G,
+    RECORD_H_DTE,
+    RECORD_H_DTM,
+    RECORD_H_FXA,
+    RECORD_H_TZ,
+    RECORD_H_HEADER,
+    RECORD_I
+};
+
+static const struct {
+    const char *code;
+    const char *key;
+} headers[] = {
+    { "CCL", "competition_class" },
+    { "CID", "competition_id" },
+    { "FTY", "flight_recorder_type" },
+    { "GID", "glider_id" },
+    { "GPS", "gps" },
+    { "GTY", "glider_type" },
+    { "PLT", "pilot" },
+    { "RFW", "firmware_revision" },
+    { "RHW", "hardware_revision" },
+    { "SIT", "site" },
+};
+
+%%{
+
+machine igc;
+
+action A { record = RECORD_A; }
+action B { record = RECORD_B; }
+action C_DECLARATION { record = RECORD_C_DECLARATION; }
+action C_WAYPOINT { record = RECORD_C_WAYPOINT; }
+action G { record = RECORD_G; }
+action H_DTE { record = RECORD_H_DTE; }
+action H_DTM { record = RECORD_H_DTM; }
+action H_FXA { record = RECORD_H_FXA; }
+action H_TZ { record = RECORD_H_TZ; }
+action H_HEADER { record = RECORD_H_HEADER; }
+action I { record = RECORD_I; }
+action IGNORED { record = RECORD_IGNORED; }
+
+altitude = digit{5} | '-' digit{4};
+source = [FOPfop];
+header_code = [Cc] [Cc] [Ll] | [Cc] [Ii] [Dd] | [Ff] [Tt] [Yy] | [Gg] [Ii] [Dd] | [Gg] [Pp] [Ss] | [Gg] [Tt] [Yy] | [Pp] [Ll] [Tt] | [Rr] [Ff] [Ww] | [Rr] [Hh] [Ww] | [Ss] [Ii] [Tt];
+
+a_record = 0x13? [Aa] any*;
+b_record = [Bb] digit{6} digit{7} [NSns] digit{8} [EWew] [AVav] altitude altitude any*;
+c_declaration = [Cc] digit{24} any*;
+c_waypoint = [Cc] digit{7} [NSns] digit{8} [EWew] any*;
+g_record = [Gg] any*;
+h_dte = [Hh] source [Dd] [Tt] [Ee] digit{6} space*;
+h_dtm = [Hh] source [Dd] [Tt] [Mm] digit{3} alpha* ':' any*;
+h_fxa = [Hh] source [Ff] [Xx] [Aa] digit{3} space*;
+h_tz = [Hh] source [Tt] [Zz] [NOno] ( ' ' | alpha )* ':' space* [+\-]? digit+ ( ':' digit{2} )? space*;
+h_header = [Hh] source header_code ( ' ' | alpha )* ':' any*;
+i_record = [Ii] digit{2} ( digit{4} alnum{3} )* space*;
+ignored = [DEFJKLdefjkl] any* | 0x11? space*;
+
+main := (
+    a_record %A |
+    b_record %B |
+    c_declaration %C_DECLARATION |
+    c_waypoint %C_WAYPOINT |
+    g_record %G |
+    h_dte %H_DTE |
+    h_dtm %H_DTM |
+    h_fxa %H_FXA |
+    h_tz %H_TZ |
+    h_header %H_HEADER |
+    i_record %I |
+    ignored %IGNORED
+);
+
+}%%
+
+%% write data;
+
+typedef struct {
+    int n;
+    int capacity;
+    double *times;
+    double *lats;
+    double *lons;
+    int *alts;
+    int *pressure_alts;
+    char *validities;
+    int *extension_offsets;
+    int *extension_values;
+    int extension_values_capacity;
+    int extensions_n;
+    int extensions_capacity;
+    int *extension_bytes;
+    VALUE rb_extension_codes;
+    VALUE rb_fixes;
+    VALUE rb_lats;
+    VALUE rb_lons;
+    VALUE rb_alts;
+    VALUE rb_times;
+} fix_array_t;
+
+typedef struct {
+    VALUE rb_self;
+    fix_array_t *fix_array;
+    VALUE rb_header;
+    VALUE rb_extensions;
+    VALUE rb_task;
+    VALUE rb_security_code;
+    VALUE rb_unknowns;
+    VALUE rb_digest;
+    VALUE rb_digest_buffer;
+    long date;
+    int sec0;
+} parser_t;
+
+static void
+fix_array_mark(fix_array_t *fix_array)
+{
+    rb_gc_mark(fix_array->rb_extension_codes);
+    rb_gc_mark(fix_array->rb_fixes);
+    rb_gc_mark(fix_array->rb_lats);
+    rb_gc_mark(fix_array->rb_lons);
+    rb_gc_mark(fix_array->rb_alts);
+    rb_gc_mark(fix_array->rb_times);
+}
+
+static void
+fix_array_free(fix_array_t *fix_array)
+{
+    xfree(fix_array->times);
+    xfree(fix_array->lats);
+    xfree(fix_array->lons);
+    xfree(fix_array->alts);
+    xfree(fix_array->pressure_alts);
+    xfree(fix_array->validities);
+    xfree(fix_array->extension_offsets);
+    xfree(fix_array->extension_values);
+    xfree(fix_array->extension_bytes);
+    xfree(fix_array);
+}
+
+static VALUE
+fix_array_new(fix_array_t **fix_array)
+{
+    VALUE rb_fix_array = Data_Make_Struct(rb_cFixArray, fix_array_t, fix_array_mark, fix_array_free, *fix_array);
+    (*fix_array)->extension_offsets = ALLOC_N(int, 1);
+    (*fix_array)->extension_offsets[0] = 0;
+    (*fix_array)->rb_extension_codes = rb_ary_new();
+    (*fix_array)->rb_fixes = Qnil;
+    (*fix_array)->rb_lats = Qnil;
+    (*fix_array)->rb_lons = Qnil;
+    (*fix_array)->rb_alts = Qnil;
+    (*fix_array)->rb_times = Qnil;
+    return rb_fix_array;
+}
+
+static fix_array_t *
+fix_array_get(VALUE rb_fix_array)
+{
+    fix_array_t *fix_array;
+    Data_Get_Struct(rb_fix_array, fix_array_t, fix_array);
+    return fix_array;
+}
+
+static void
+fix_array_reserve(fix_array_t *fix_array, int capacity)
+{
+    if (capacity <= fix_array->capacity)
+        return;
+    if (capacity < 2 * fix_array->capacity)
+        capacity = 2 * fix_array->capacity;
+    if (capacity < 1024)
+        capacity = 1024;
+    REALLOC_N(fix_array->times, double, capacity);
+    REALLOC_N(fix_array->lats, double, capacity);
+    REALLOC_N(fix_array->lons, double, capacity);
+    REALLOC_N(fix_array->alts, int, capacity);
+    REALLOC_N(fix_array->pressure_alts, int, capacity);
+    REALLOC_N(fix_array->validities, char, capacity);
+    REALLOC_N(fix_array->extension_offsets, int, capacity + 1);
+    fix_array->capacity = capacity;
+}
+
+/* Appends a fix with room for the current extensions, returning its index.
+ * The caller must fill in its fields and extension values. */
+static int
+fix_array_push(fix_array_t *fix_array)
+{
+    fix_array_reserve(fix_array, fix_array->n + 1);
+    int offset = fix_array->extension_offsets[fix_array->n];
+    if (offset + fix_array->extensions_n > fix_array->extension_values_capacity) {
+        int capacity = 2 * fix_array->extension_values_capacity;
+        if (capacity < offset + fix_array->extensions_n)
+            capacity = offset + fix_array->extensions_n;
+        REALLOC_N(fix_array->extension_values, int, capacity);
+        fix_array->extension_values_capacity = capacity;
+    }
+    fix_array->extension_offsets[fix_array->n + 1] = offset + fix_array->extensions_n;
+    return fix_array->n++;
+}
+
+static VALUE
+fix_array_entry(fix_array_t *fix_array, long i)
+{
+    if (i < 0)
+        i += fix_array->n;
+    if (i < 0 || i >= fix_array->n)
+        return Qnil;
+    if (NIL_P(fix_array->rb_fixes))
+        fix_array->rb_fixes = rb_ary_new2(fix_array->n);
+    VALUE rb_fix = rb_ary_entry(fix_array->rb_fixes, i);
+    if (!NIL_P(rb_fix))
+        return rb_fix;
+    char validity[2] = { fix_array->validities[i], '\0' };
+    VALUE rb_extensions = rb_hash_new();
+    int j, offset = fix_array->extension_offsets[i];
+    for (j = 0; offset + j < fix_array->extension_offsets[i + 1]; ++j)
+        rb_hash_aset(rb_extensions, rb_ary_entry(fix_array->rb_extension_codes, j), INT2NUM(fix_array->extension_values[offset + j]));
+    VALUE argv[7];
+    argv[0] = rb_funcall(rb_time_new((time_t) fix_array->times[i], 0), id_utc, 0);
+    argv[1] = rb_float_new(fix_array->lats[i]);
+    argv[2] = rb_float_new(fix_array->lons[i]);
+    argv[3] = INT2NUM(fix_array->alts[i]);
+    argv[4] = ID2SYM(rb_intern(validity));
+    argv[5] = INT2NUM(fix_array->pressure_alts[i]);
+    argv[6] = rb_extensions;
+    rb_fix = rb_class_new_instance(7, argv, rb_cFix);
+    rb_ary_store(fix_array->rb_fixes, i, rb_fix);
+    return rb_fix;
+}
+
+static VALUE
+fix_array_slice(fix_array_t *fix_array, long begin, long length)
+{
+    if (begin < 0)
+        begin += fix_array->n;
+    if (begin < 0 || begin > fix_array->n || length < 0)
+        return Qnil;
+    if (begin + length > fix_array->n)
+        length = fix_array->n - begin;
+    VALUE rb_result = rb_ary_new2(length);
+    long i;
+    for (i = 0; i < length; ++i)
+        rb_ary_push(rb_result, fix_array_entry(fix_array, begin + i));
+    return rb_result;
+}
+
+static VALUE
+rb_FixArray_aref(int argc, VALUE *argv, VALUE rb_self)
+{
+    fix_array_t *fix_array = fix_array_get(rb_self);
+    VALUE rb_index, rb_length;
+    rb_scan_args(argc, argv, "11", &rb_index, &rb_length);
+    if (!NIL_P(rb_length))
+        return fix_array_slice(fix_array, NUM2LONG(rb_index), NUM2LONG(rb_length));
+    if (FIXNUM_P(rb_index))
+        return fix_array_entry(fix_array, FIX2LONG(rb_index));
+    long begin, length;
+    VALUE rb_range = rb_range_beg_len(rb_index, &begin, &length, fix_array->n, 0);
+    if (NIL_P(rb_range))
+        return Qnil;
+    if (rb_range != Qfalse)
+        return fix_array_slice(fix_array, begin, length);
+    return fix_array_entry(fix_array, NUM2LONG(rb_index));
+}
+
+static VALUE
+rb_FixArray_each(VALUE rb_self)
+{
+    fix_array_t *fix_array = fix_array_get(rb_self);
+    int i;
+    for (i = 0; i < fix_array->n; ++i)
+        rb_yield(fix_array_entry(fix_array, i));
+    return rb_self;
+}
+
+static VALUE
+rb_FixArray_empty_p(VALUE rb_self)
+{
+    return fix_array_get(rb_self)->n ? Qfalse : Qtrue;
+}
+
+static VALUE
+rb_FixArray_last(VALUE rb_self)
+{
+    return fix_array_entry(fix_array_get(rb_self), -1);
+}
+
+static VALUE
+rb_FixArray_length(VALUE rb_self)
+{
+    return INT2NUM(fix_array_get(rb_self)->n);
+}
+
+static VALUE
+rb_FixArray_to_a(VALUE rb_self)
+{
+    fix_array_t *fix_array = fix_array_get(rb_self);
+    return fix_array_slice(fix_array, 0, fix_array->n);
+}
+
+static VALUE
+fix_array_column(fix_array_t *fix_array, VALUE *rb_column, const double *doubles, const int *ints)
+{
+    if (NIL_P(*rb_column)) {
+        *rb_column = rb_str_new(NULL, fix_array->n * sizeof(double));
+        double *column = (double *) RSTRING(*rb_column)->ptr;
+        int i;
+        for (i = 0; i < fix_array->n; ++i)
+            column[i] = doubles ? doubles[i] : ints[i];
+    }
+    return *rb_column;
+}
+
+static VALUE
+rb_FixArray_alts(VALUE rb_self)
+{
+    fix_array_t *fix_array = fix_array_get(rb_self);
+    return fix_array_column(fix_array, &fix_array->rb_alts, NULL, fix_array->alts);
+}
+
+static VALUE
+rb_FixArray_lats(VALUE rb_self)
+{
+    fix_array_t *fix_array = fix_array_get(rb_self);
+    return fix_array_column(fix_array, &fix_array->rb_lats, fix_array->lats, NULL);
+}
+
+static VALUE
+rb_FixArray_lons(VALUE rb_self)
+{
+    fix_array_t *fix_array = fix_array_get(rb_self);
+    return fix_array_column(fix_array, &fix_array->rb_lons, fix_array->lons, NULL);
+}
+
+static VALUE
+rb_FixArray_times(VALUE rb_self)
+{
+    fix_array_t *fix_array = fix_array_get(rb_self);
+    return fix_array_column(fix_array, &fix_array->rb_times, fix_array->times, NULL);
+}
+
+static int
+record_type(const char *p, const char *pe)
+{
+    int cs;
+    int record = RECORD_UNKNOWN;
+    %% write init;
+    %% write exec;
+    %% write eof;
+    if (cs == igc_error || cs < igc_first_final)
+        return RECORD_UNKNOWN;
+    return record;
+}
+
+static VALUE
+igc_str_new(const char *p, const char *pe)
+{
+    VALUE rb_str = rb_str_new(p, pe - p);
+#ifdef HAVE_RUBY_ENCODING_H
+    rb_enc_associate(rb_str, rb_default_external_encoding());
+#endif
+    return rb_str;
+}
+
+static int
+is_space(char c)
+{
+    return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+/* Returns a string without the leading and trailing whitespace and nulls
+ * that String#strip removes */
+static VALUE
+igc_str_new_strip(const char *p, const char *pe)
+{
+    while (p < pe && (is_space(*p) || *p == '\0'))
+        ++p;
+    while (p < pe && (is_space(pe[-1]) || pe[-1] == '\0'))
+        --pe;
+    return igc_str_new(p, pe);
+}
+
+static VALUE
+igc_str_new_rstrip(const char *p, const char *pe)
+{
+    while (p < pe && is_space(pe[-1]))
+        --pe;
+    return igc_str_new(p, pe);
+}
+
+static int
+digits(const char *p, int n)
+{
+    int result = 0;
+    while (n--)
+        result = 10 * result + *p++ - '0';
+    return result;
+}
+
+/* Parses an altitude matched by the alt machine */
+static int
+alt(const char *p)
+{
+    return *p == '-' ? -digits(p + 1, 4) : digits(p, 5);
+}
+
+/* Parses the leading integer of a string like String#to_i */
+static int
+to_i(const char *p, const char *pe)
+{
+    int sign = 1, result = 0;
+    while (p < pe && is_space(*p))
+        ++p;
+    if (p < pe && (*p == '+' || *p == '-'))
+        sign = *p++ == '-' ? -1 : 1;
+    const char *first = p;
+    while (p < pe) {
+        if ('0' <= *p && *p <= '9')
+            result = 10 * result + *p++ - '0';
+        else if (*p == '_' && p > first && p + 1 < pe && '0' <= p[1] && p[1] <= '9')
+            ++p;
+        else
+            break;
+    }
+    return sign * result;
+}
+
+/* Equivalent to Radians.new_from_dmsh(deg, min, 0, hemi) */
+static double
+radians(int deg, double min, char hemi)
+{
+    int sign = hemi == 'N' || hemi == 'n' || hemi == 'E' || hemi == 'e' ? 1 : -1;
+    return sign * (deg + min / 60.0 + 0 / 3600.0) * M_PI / 180.0;
+}
+
+static int
+is_leap_year(int year)
+{
+    return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+static int
+valid_date(int year, int month, int mday)
+{
+    static const int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month < 1 || month > 12 || mday < 1)
+        return 0;
+    return mday <= days_in_month[month - 1] + (month == 2 && is_leap_year(year));
+}
+
+/* Returns the number of days from 1970-01-01 to the given date */
+static long
+days_from_civil(int year, int month, int mday)
+{
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long yoe = year - era * 400;
+    long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + mday - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static VALUE
+igc_date_new(int year, int month, int mday)
+{
+    return rb_funcall(rb_path2class("Date"), id_new, 3, INT2FIX(year), INT2FIX(month), INT2FIX(mday));
+}
+
+static VALUE
+igc_task(parser_t *parser)
+{
+    if (NIL_P(parser->rb_task)) {
+        parser->rb_task = rb_class_new_instance(0, NULL, rb_cTask);
+        rb_iv_set(parser->rb_self, "@task", parser->rb_task);
+    }
+    return parser->rb_task;
+}
+
+static VALUE
+igc_time_utc(VALUE rb_args)
+{
+    return rb_funcall2(rb_cTime, id_utc, RARRAY(rb_args)->len, RARRAY(rb_args)->ptr);
+}
+
+static VALUE
+igc_date_civil(VALUE rb_args)
+{
+    return rb_funcall2(rb_path2class("Date"), id_new, RARRAY(rb_args)->len, RARRAY(rb_args)->ptr);
+}
+
+static VALUE
+igc_rescue(VALUE rb_arg, VALUE rb_error)
+{
+    return Qnil;
+}
+
+/* Calls func with an array of year, month and mday and optionally hour, min
+ * and sec, returning nil if it raises an ArgumentError */
+static VALUE
+igc_rescue_time(VALUE (*func)(VALUE), const char *p, int n)
+{
+    VALUE rb_args = rb_ary_new2(n);
+    rb_ary_push(rb_args, INT2FIX(2000 + digits(p + 4, 2)));
+    rb_ary_push(rb_args, INT2FIX(digits(p + 2, 2)));
+    rb_ary_push(rb_args, INT2FIX(digits(p, 2)));
+    int i;
+    for (i = 3; i < n; ++i)
+        rb_ary_push(rb_args, INT2FIX(digits(p + 2 * i, 2)));
+    return rb_rescue2(func, rb_args, igc_rescue, Qnil, rb_eArgError, (VALUE) 0);
+}
+
+static void
+igc_digest(parser_t *parser, const char *p, const char *pe)
+{
+    rb_str_buf_cat(parser->rb_digest_buffer, p, pe - p);
+    if (RSTRING(parser->rb_digest_buffer)->len >= DIGEST_BUFFER_SIZE) {
+        rb_funcall(parser->rb_digest, id_update, 1, parser->rb_digest_buffer);
+        rb_str_resize(parser->rb_digest_buffer, 0);
+    }
+}
+
+static void
+igc_parse_b(parser_t *parser, const char *p, const char *pe)
+{
+    igc_digest(parser, p, pe);
+    int hour = digits(p + 1, 2), min = digits(p + 3, 2), sec = digits(p + 5, 2);
+    int sec1 = 3600 * hour + 60 * min + sec;
+    if (sec1 < parser->sec0)
+        ++parser->date;
+    if (hour == 24 ? min != 0 || sec != 0 : hour > 24 || min > 59 || sec > 60)
+        return;
+    parser->sec0 = sec1;
+    fix_array_t *fix_array = parser->fix_array;
+    int i = fix_array_push(fix_array);
+    fix_array->times[i] = (double) (SECONDS_PER_DAY * parser->date + sec1);
+    fix_array->lats[i] = radians(digits(p + 7, 2), 0.001 * digits(p + 9, 5), p[14]);
+    fix_array->lons[i] = radians(digits(p + 15, 3), 0.001 * digits(p + 18, 5), p[23]);
+    fix_array->validities[i] = p[24];
+    fix_array->pressure_alts[i] = alt(p + 25);
+    fix_array->alts[i] = alt(p + 30);
+    int *values = fix_array->extension_values + fix_array->extension_offsets[i];
+    int j;
+    for (j = 0; j < fix_array->extensions_n; ++j) {
+        int begin = fix_array->extension_bytes[2 * j], end = fix_array->extension_bytes[2 * j + 1];
+        if (begin < 0 || begin >= pe - p || end <= begin)
+            values[j] = 0;
+        else
+            values[j] = to_i(p + begin, end < pe - p ? p + end : pe);
+    }
+}
+
+static void
+igc_parse_c_declaration(parser_t *parser, const char *p, const char *pe)
+{
+    VALUE rb_task = igc_task(parser);
+    VALUE rb_declaration_time = igc_rescue_time(igc_time_utc, p + 1, 6);
+    if (!NIL_P(rb_declaration_time))
+        rb_iv_set(rb_task, "@declaration_time", rb_declaration_time);
+    VALUE rb_flight_date = igc_rescue_time(igc_date_civil, p + 13, 3);
+    if (!NIL_P(rb_flight_date))
+        rb_iv_set(rb_task, "@flight_date", rb_flight_date);
+    rb_iv_set(rb_task, "@task_number", INT2FIX(digits(p + 19, 4)));
+    rb_iv_set(rb_task, "@turnpoints", INT2FIX(digits(p + 23, 2)));
+    rb_iv_set(rb_task, "@description", igc_str_new_rstrip(p + 25, pe));
+}
+
+static void
+igc_parse_c_waypoint(parser_t *parser, const char *p, const char *pe)
+{
+    VALUE rb_task = igc_task(parser);
+    VALUE argv[4];
+    argv[0] = rb_float_new(radians(digits(p + 1, 2), digits(p + 3, 2) + 0.001 * digits(p + 5, 3), p[8]));
+    argv[1] = rb_float_new(radians(digits(p + 9, 3), digits(p + 12, 2) + 0.001 * digits(p + 14, 3), p[17]));
+    argv[2] = INT2FIX(0);
+    argv[3] = igc_str_new_strip(p + 18, pe);
+    rb_ary_push(rb_funcall(rb_task, rb_intern("route"), 0), rb_class_new_instance(4, argv, rb_cWaypoint));
+}
+
+static void
+igc_parse_h_dte(parser_t *parser, const char *p)
+{
+    int year = 2000 + digits(p + 9, 2), month = digits(p + 7, 2), mday = digits(p + 5, 2);
+    if (!valid_date(year, month, mday)) {
+        year = 2000;
+        month = 1;
+        mday = 1;
+    }
+    parser->date = days_from_civil(year, month, mday);
+    VALUE rb_key = ID2SYM(rb_intern("date"));
+    if (!RTEST(rb_hash_aref(parser->rb_header, rb_key)))
+        rb_hash_aset(parser->rb_header, rb_key, igc_date_new(year, month, mday));
+}
+
+static void
+igc_parse_h_dtm(parser_t *parser, const char *p, const char *pe)
+{
+    VALUE rb_value = igc_str_new_strip((const char *) memchr(p, ':', pe - p) + 1, pe);
+    if (RSTRING(rb_value)->len == 0)
+        return;
+    VALUE rb_key = ID2SYM(rb_intern("datum"));
+    VALUE rb_datum = rb_hash_aref(parser->rb_header, rb_key);
+    if (!RTEST(rb_datum)) {
+        rb_datum = rb_hash_new();
+        rb_hash_aset(parser->rb_header, rb_key, rb_datum);
+    }
+    rb_hash_aset(rb_datum, INT2FIX(digits(p + 5, 3)), rb_value);
+}
+
+static void
+igc_parse_h_tz(parser_t *parser, const char *p, const char *pe)
+{
+    p = (const char *) memchr(p, ':', pe - p) + 1;
+    while (is_space(*p))
+        ++p;
+    int sign = 60;
+    if (*p == '+' || *p == '-')
+        sign = *p++ == '-' ? -60 : 60;
+    long hours = 0, mins = 0;
+    for (; p < pe && '0' <= *p && *p <= '9'; ++p)
+        if (hours < 1000000)
+            hours = 10 * hours + *p - '0';
+    if (p < pe && *p == ':')
+        mins = digits(p + 1, 2);
+    rb_iv_set(parser->rb_self, "@tz_offset", LONG2NUM(sign * (60 * hours + mins)));
+}
+
+/* Returns true if value matches /\A(|none|not\s+set)\z/i */
+static int
+is_unset(const char *p, const char *pe)
+{
+    if (p == pe)
+        return 1;
+    if (pe - p == 4 && strncasecmp(p, "none", 4) == 0)
+        return 1;
+    if (pe - p < 7 || strncasecmp(p, "not", 3) != 0 || strncasecmp(pe - 3, "set", 3) != 0)
+        return 0;
+    for (p += 3, pe -= 3; p < pe; ++p)
+        if (!is_space(*p))
+            return 0;
+    return 1;
+}
+
+static void
+igc_parse_h_header(parser_t *parser, const char *p, const char *pe)
+{
+    unsigned i;
+    for (i = 0; i < sizeof headers / sizeof headers[0]; ++i)
+        if (strncasecmp(p + 2, headers[i].code, 3) == 0)
+            break;
+    VALUE rb_value = igc_str_new_strip((const char *) memchr(p, ':', pe - p) + 1, pe);
+    if (!is_unset(RSTRING(rb_value)->ptr, RSTRING(rb_value)->ptr + RSTRING(rb_value)->len))
+        rb_hash_aset(parser->rb_header, ID2SYM(rb_intern(headers[i].key)), rb_value);
+}
+
+static void
+igc_parse_i(parser_t *parser, const char *p, const char *pe)
+{
+    if (digits(p + 1, 2) == 0)
+        return;
+    fix_array_t *fix_array = parser->fix_array;
+    for (p += 3; p + 7 <= pe && '0' <= *p && *p <= '9'; p += 7) {
+        if (fix_array->extensions_n == fix_array->extensions_capacity) {
+            fix_array->extensions_capacity = fix_array->extensions_capacity ? 2 * fix_array->extensions_capacity : 8;
+            REALLOC_N(fix_array->extension_bytes, int, 2 * fix_array->extensions_capacity);
+        }
+        int begin = digits(p, 2) - 1, end = digits(p + 2, 2);
+        fix_array->extension_bytes[2 * fix_array->extensions_n] = begin;
+        fix_array->extension_bytes[2 * fix_array->extensions_n + 1] = end;
+        ++fix_array->extensions_n;
+        VALUE rb_symbol = rb_funcall(rb_funcall(igc_str_new(p + 4, p + 7), rb_intern("downcase"), 0), rb_intern("to_sym"), 0);
+        rb_ary_push(fix_array->rb_extension_codes, rb_symbol);
+        VALUE rb_bytes = rb_range_new(INT2FIX(begin), INT2FIX(end), 1);
+        rb_ary_push(parser->rb_extensions, rb_funcall(rb_cExtension, id_new, 2, rb_bytes, rb_symbol));
+    }
+}
+
+static void
+igc_parse_line(parser_t *parser, const char *p, const char *pe)
+{
+    if (pe > p && pe[-1] == '\r')
+        --pe;
+    switch (record_type(p, pe)) {
+    case RECORD_IGNORED:
+        break;
+    case RECORD_A:
+        if (*p == 0x13)
+            ++p;
+        rb_iv_set(parser->rb_self, "@flight_recorder", igc_str_new_rstrip(p + 1, pe));
+        break;
+    case RECORD_B:
+        igc_parse_b(parser, p, pe);
+        break;
+    case RECORD_C_DECLARATION:
+        igc_parse_c_declaration(parser, p, pe);
+        break;
+    case RECORD_C_WAYPOINT:
+        igc_parse_c_waypoint(parser, p, pe);
+        break;
+    case RECORD_G:
+        rb_ary_push(parser->rb_security_code, igc_str_new_strip(p + 1, pe));
+        break;
+    case RECORD_H_DTE:
+        igc_parse_h_dte(parser, p);
+        break;
+    case RECORD_H_DTM:
+        igc_parse_h_dtm(parser, p, pe);
+        break;
+    case RECORD_H_FXA:
+        rb_hash_aset(parser->rb_header, ID2SYM(rb_intern("fix_accuracy")), INT2FIX(digits(p + 5, 3)));
+        break;
+    case RECORD_H_TZ:
+        igc_parse_h_tz(parser, p, pe);
+        break;
+    case RECORD_H_HEADER:
+        igc_parse_h_header(parser, p, pe);
+        break;
+    case RECORD_I:
+        igc_parse_i(parser, p, pe);
+        break;
+    default:
+        rb_ary_push(parser->rb_unknowns, igc_str_new(p, pe));
+        break;
+    }
+}
+
+/* Parses the complete lines in p...pe, appending any incomplete final line
+ * to rb_line.  rb_line holds the start of a line split across chunks. */
+static void
+igc_parse_chunk(parser_t *parser, VALUE rb_line, const char *p, const char *pe)
+{
+    while (p < pe) {
+        const char *eol = memchr(p, '\n', pe - p);
+        if (!eol) {
+            rb_str_buf_cat(rb_line, p, pe - p);
+            break;
+        }
+        if (RSTRING(rb_line)->len) {
+            rb_str_buf_cat(rb_line, p, eol - p);
+            igc_parse_line(parser, RSTRING(rb_line)->ptr, RSTRING(rb_line)->ptr + RSTRING(rb_line)->len);
+            rb_str_resize(rb_line, 0);
+        } else {
+            igc_parse_line(parser, p, eol);
+        }
+        p = eol + 1;
+    }
+}
+
+/* If no fix has a GPS altitude, use the pressure altitudes instead */
+static int
+fix_array_altitude_data(fix_array_t *fix_array)
+{
+    int i;
+    for (i = 0; i < fix_array->n; ++i)
+        if (fix_array->alts[i])
+            return 1;
+    for (i = 0; i < fix_array->n; ++i)
+        if (fix_array->pressure_alts[i])
+            break;
+    if (i == fix_array->n)
+        return 0;
+    memcpy(fix_array->alts, fix_array->pressure_alts, fix_array->n * sizeof(int));
+    return 1;
+}
+
+/* Reads an IGC file from rb_io, which may be a String or anything that
+ * responds to read, and sets the IGC's instance variables */
+static VALUE
+rb_IGC_parse(VALUE rb_self, VALUE rb_io)
+{
+    parser_t parser;
+    memset(&parser, 0, sizeof parser);
+    parser.rb_self = rb_self;
+    VALUE rb_fix_array = fix_array_new(&parser.fix_array);
+    parser.rb_header = rb_hash_new();
+    parser.rb_extensions = rb_ary_new();
+    parser.rb_task = Qnil;
+    parser.rb_security_code = rb_ary_new();
+    parser.rb_unknowns = rb_ary_new();
+    parser.rb_digest = rb_class_new_instance(0, NULL, rb_path2class("Digest::MD5"));
+    parser.rb_digest_buffer = rb_str_buf_new(DIGEST_BUFFER_SIZE);
+    parser.date = days_from_civil(2000, 1, 1);
+    parser.sec0 = -1;
+    rb_iv_set(rb_self, "@flight_recorder", rb_hash_new());
+    rb_iv_set(rb_self, "@header", parser.rb_header);
+    rb_iv_set(rb_self, "@tz_offset", INT2FIX(0));
+    rb_iv_set(rb_self, "@extensions", parser.rb_extensions);
+    rb_iv_set(rb_self, "@fixes", rb_fix_array);
+    rb_iv_set(rb_self, "@security_code", parser.rb_security_code);
+    rb_iv_set(rb_self, "@unknowns", parser.rb_unknowns);
+
+    VALUE rb_line = rb_str_buf_new(0);
+    if (TYPE(rb_io) == T_STRING) {
+        igc_parse_chunk(&parser, rb_line, RSTRING(rb_io)->ptr, RSTRING(rb_io)->ptr + RSTRING(rb_io)->len);
+    } else {
+        while (1) {
+            VALUE rb_chunk = rb_funcall(rb_io, id_read, 1, INT2FIX(CHUNK_SIZE));
+            if (NIL_P(rb_chunk) || RSTRING(rb_chunk)->len == 0)
+                break;
+            igc_parse_chunk(&parser, rb_line, RSTRING(rb_chunk)->ptr, RSTRING(rb_chunk)->ptr + RSTRING(rb_chunk)->len);
+        }
+    }
+    if (RSTRING(rb_line)->len)
+        igc_parse_line(&parser, RSTRING(rb_line)->ptr, RSTRING(rb_line)->ptr + RSTRING(rb_line)->len);
+
+    rb_funcall(parser.rb_digest, id_update, 1, parser.rb_digest_buffer);
+    rb_iv_set(rb_self, "@bsignature", rb_funcall(parser.rb_digest, id_hexdigest, 0));
+    rb_iv_set(rb_self, "@altitude_data", fix_array_altitude_data(parser.fix_array) ? Qtrue : Qfalse);
+    return rb_self;
+}
+
+void
+Init_cigc(void)
+{
+    id_hexdigest = rb_intern("hexdigest");
+    id_new = rb_intern("new");
+    id_read = rb_intern("read");
+    id_update = rb_intern("update");
+    id_utc = rb_intern("utc");
+
+    rb_cIGC = rb_const_get(rb_cObject, rb_intern("IGC"));
+    rb_define_private_method(rb_cIGC, "parse", rb_IGC_parse, 1);
+
+    rb_cExtension = rb_const_get(rb_cIGC, rb_intern("Extension"));
+    rb_cFix = rb_const_get(rb_cIGC, rb_intern("Fix"));
+    rb_cTask = rb_const_get(rb_cIGC, rb_intern("Task"));
+    rb_cWaypoint = rb_const_get(rb_cIGC, rb_intern("Waypoint"));
+
+    rb_cFixArray = rb_define_class_under(rb_cIGC, "FixArray", rb_cObject);
+    rb_include_module(rb_cFixArray, rb_mEnumerable);
+    rb_undef_alloc_func(rb_cFixArray);
+    rb_define_method(rb_cFixArray, "[]", rb_FixArray_aref, -1);
+    rb_define_method(rb_cFixArray, "alts", rb_FixArray_alts, 0);
+    rb_define_method(rb_cFixArray, "each", rb_FixArray_each, 0);
+    rb_define_method(rb_cFixArray, "empty?", rb_FixArray_empty_p, 0);
+    rb_define_method(rb_cFixArray, "last", rb_FixArray_last, 0);
+    rb_define_method(rb_cFixArray, "lats", rb_FixArray_lats, 0);
+    rb_define_method(rb_cFixArray, "length", rb_FixArray_length, 0);
+    rb_define_method(rb_cFixArray, "lons", rb_FixArray_lons, 0);
+    rb_define_method(rb_cFixArray, "size", rb_FixArray_length, 0);
+    rb_define_method(rb_cFixArray, "times", rb_FixArray_times, 0);
+    rb_define_method(rb_cFixArray, "to_a", rb_FixArray_to_a, 0);
+    rb_define_method(rb_cFixArray, "to_ary", rb_FixArray_to_a, 0);
+}
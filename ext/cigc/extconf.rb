@@ -0,0 +1,5 @@
+require "mkmf"
+
+$CFLAGS += " -Wall -Wextra -Wmissing-prototypes"
+have_header("ruby/encoding.h")
+create_makefile("cigc")
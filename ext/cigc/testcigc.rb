@@ -0,0 +1,58 @@
+require "igc"
+require "stringio"
+require "test/unit"
+
+class TC_CIGC < Test::Unit::TestCase
+
+  B_RECORDS = [
+    "B2359584553995N00618003EA014990148900507",
+    "B2359594553990N00618008EA014980148800512",
+    "B0000004553986S00618013WV-0012-0020xx",
+  ]
+
+  IGC_FILE = ["AXXXABC flight recorder  ",
+              "HFDTE150706",
+              "HFPLTPILOT:Test Pilot",
+              "HFGTYGLIDERTYPE:none",
+              "HFTZNTIMEZONE:-2:30",
+              "I023638FXA3940SIU",
+              "C4553995N00618003EGoal",
+             ].concat(B_RECORDS).push("GABCDEF", "Qunknown").join("\r\n")
+
+  def setup
+    @igc = IGC.new(StringIO.new(IGC_FILE))
+  end
+
+  def test_bsignature
+    assert_equal(Digest::MD5.hexdigest(B_RECORDS.join), @igc.bsignature)
+  end
+
+  def test_string
+    assert_equal(@igc.bsignature, IGC.new(IGC_FILE).bsignature)
+  end
+
+  def test_headers
+    assert_equal("XXXABC flight recorder", @igc.flight_recorder)
+    assert_equal({:date => Date.new(2006, 7, 15), :pilot => "Test Pilot"}, @igc.header)
+    assert_equal(-9000, @igc.tz_offset)
+    assert_equal(["ABCDEF"], @igc.security_code)
+    assert_equal(["Qunknown"], @igc.unknowns)
+    assert_equal(1, @igc.task.route.length)
+    assert_equal("Goal", @igc.task.route[0].name)
+  end
+
+  def test_fixes
+    assert_equal(3, @igc.fixes.length)
+    assert_equal(Time.utc(2006, 7, 16, 0, 0, 0), @igc.fixes[-1].time)
+    assert_equal(-12, @igc.fixes[2].pressure_alt)
+    assert_equal(-20, @igc.fixes[2].alt)
+    assert_equal(:V, @igc.fixes[2].validity)
+    assert(@igc.fixes[2].lat < 0.0)
+    assert(@igc.fixes[2].lon < 0.0)
+    assert_equal({:fxa => 5, :siu => 12}, @igc.fixes[1].extensions)
+    assert_same(@igc.fixes[1], @igc.fixes[1])
+    assert_equal(@igc.fixes[1, 2], @igc.fixes[1..2])
+    assert_equal(@igc.fixes.to_a.collect(&:alt), @igc.fix_buffer.alts.unpack("d*"))
+  end
+
+end
@@ -0,0 +1,226 @@
+#include <ruby.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* The longest text written for one number, including the fallback to
+ * snprintf for values that are too large for format_fixed6. */
+#define NUMBER_MAX 32
+
+static VALUE id_alt;
+static VALUE id_lat;
+static VALUE id_lon;
+
+void Init_ckml(void);
+
+static inline char *
+format_digits(char *p, unsigned long value, int width)
+{
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value || n < width);
+    while (n)
+        *p++ = digits[--n];
+    return p;
+}
+
+/* Trims the trailing zeros of the fractional part of the number at
+ * start...p, and a leading minus sign if nothing but zeros remain. */
+static char *
+trim_fixed(char *start, char *p)
+{
+    while (p[-1] == '0')
+        --p;
+    if (p[-1] == '.')
+        --p;
+    if (p - start == 2 && start[0] == '-' && start[1] == '0') {
+        start[0] = '0';
+        --p;
+    }
+    return p;
+}
+
+/* Writes the shortest decimal that rounds to the same micro-unit as x,
+ * which is snprintf's "%.6f" without its trailing zeros.  x is scaled and
+ * rounded in integer arithmetic, falling back to snprintf when x is too
+ * large or lies so close to a rounding boundary that the scaling could
+ * have rounded it the wrong way.  Below 1e11 the error in the scaling is
+ * well under the 1e-3 margin around the boundary. */
+static char *
+format_fixed6(char *p, double x)
+{
+    double v = fabs(x) * 1e6;
+    if (v < 1e11) {
+        double integer = floor(v);
+        double fraction = v - integer;
+        if (fabs(fraction - 0.5) > 1e-3) {
+            unsigned long value = (unsigned long) integer + (fraction > 0.5);
+            if (value && signbit(x))
+                *p++ = '-';
+            p = format_digits(p, value / 1000000, 1);
+            value %= 1000000;
+            if (!value)
+                return p;
+            int width = 6;
+            for (; value % 10 == 0; value /= 10)
+                --width;
+            *p++ = '.';
+            return format_digits(p, value, width);
+        }
+    }
+    return trim_fixed(p, p + snprintf(p, NUMBER_MAX, "%.6f", x));
+}
+
+/* Writes x as Ruby's "%d" would, truncating towards zero. */
+static char *
+format_integer(char *p, double x)
+{
+    if (fabs(x) < 1e18) {
+        long value = (long) x;
+        if (value < 0)
+            *p++ = '-';
+        return format_digits(p, value < 0 ? -(unsigned long) value : (unsigned long) value, 1);
+    }
+    return p + snprintf(p, NUMBER_MAX, "%.0f", trunc(x));
+}
+
+static inline char *
+format_coord(char *p, double lat, double lon, double alt)
+{
+    p = format_fixed6(p, lon * 180.0 / M_PI);
+    *p++ = ',';
+    p = format_fixed6(p, lat * 180.0 / M_PI);
+    *p++ = ',';
+    return format_integer(p, alt);
+}
+
+static VALUE
+rb_coord_to_kml_coord(VALUE rb_self)
+{
+    char text[3 * NUMBER_MAX + 2];
+    double lat = NUM2DBL(rb_funcall(rb_self, id_lat, 0));
+    double lon = NUM2DBL(rb_funcall(rb_self, id_lon, 0));
+    double alt = NUM2DBL(rb_funcall(rb_self, id_alt, 0));
+    return rb_str_new(text, format_coord(text, lat, lon, alt) - text);
+}
+
+static const double *
+packed_column(VALUE rb_column, long n)
+{
+    Check_Type(rb_column, T_STRING);
+    if (RSTRING(rb_column)->len < n * (long) sizeof(double))
+        rb_raise(rb_eArgError, "column has %ld bytes, expected at least %ld", (long) RSTRING(rb_column)->len, n * (long) sizeof(double));
+    return (const double *) RSTRING(rb_column)->ptr;
+}
+
+static VALUE
+coordinates_text(const double *lats, const double *lons, const double *alts, long first, long last)
+{
+    if (first == last)
+        return rb_str_new(NULL, 0);
+    char *text = ALLOC_N(char, (last - first) * (3 * NUMBER_MAX + 3));
+    char *p = text;
+    long i;
+    for (i = first; i < last; ++i) {
+        if (i != first)
+            *p++ = '\n';
+        p = format_coord(p, lats[i], lons[i], alts[i]);
+    }
+    VALUE rb_text = rb_str_new(text, p - text);
+    xfree(text);
+    return rb_text;
+}
+
+/* Returns the text of a KML coordinates element for the fixes first...last
+ * of the packed latitude, longitude (both in radians) and altitude
+ * columns, formatted like Coord#to_kml_coord and separated by newlines. */
+static VALUE
+rb_KML_coordinates_text(VALUE rb_self, VALUE rb_lats, VALUE rb_lons, VALUE rb_alts, VALUE rb_first, VALUE rb_last)
+{
+    long first = NUM2LONG(rb_first);
+    long last = NUM2LONG(rb_last);
+    if (first < 0 || last < first)
+        rb_raise(rb_eArgError, "invalid range %ld...%ld", first, last);
+    return coordinates_text(packed_column(rb_lats, last), packed_column(rb_lons, last), packed_column(rb_alts, last), first, last);
+}
+
+/* As Scale#discretize, including its integer division when the range and
+ * the values are all integers. */
+static inline long
+discretize(double value, double minimum, double maximum, int integral, long steps)
+{
+    double step;
+    if (integral) {
+        long numerator = steps * ((long) value - (long) minimum);
+        long denominator = (long) maximum - (long) minimum;
+        if (!denominator)
+            return 0;
+        long quotient = numerator / denominator;
+        if (numerator % denominator && (numerator < 0) != (denominator < 0))
+            --quotient;
+        step = quotient;
+    } else {
+        step = round(steps * (value - minimum) / (maximum - minimum));
+        if (isnan(step))
+            return 0;
+    }
+    return step < 0.0 ? 0 : step > steps - 1 ? steps - 1 : (long) step;
+}
+
+/* Discretizes the packed values into steps over minimum..maximum and
+ * splits the fixes into runs with the same step, each run sharing its
+ * last fix with the next, like Enumerable#segment(false).  integral
+ * tells whether the values were Integers before they were packed.  Yields,
+ * or returns as an array of pairs, the step and coordinates text of each
+ * run. */
+static VALUE
+rb_KML_segment_coordinates(VALUE rb_self, VALUE rb_lats, VALUE rb_lons, VALUE rb_alts, VALUE rb_values, VALUE rb_integral, VALUE rb_minimum, VALUE rb_maximum, VALUE rb_steps)
+{
+    Check_Type(rb_values, T_STRING);
+    long n = RSTRING(rb_values)->len / sizeof(double);
+    const double *values = packed_column(rb_values, n);
+    const double *lats = packed_column(rb_lats, n);
+    const double *lons = packed_column(rb_lons, n);
+    const double *alts = packed_column(rb_alts, n);
+    /* Scale#discretize divides integers only if the value is one too */
+    int integral = RTEST(rb_integral) && FIXNUM_P(rb_minimum) && FIXNUM_P(rb_maximum);
+    double minimum = NUM2DBL(rb_minimum);
+    double maximum = NUM2DBL(rb_maximum);
+    long steps = NUM2LONG(rb_steps);
+    if (steps < 1)
+        rb_raise(rb_eArgError, "invalid number of steps %ld", steps);
+    int block_given = rb_block_given_p();
+    VALUE rb_segments = block_given ? rb_self : rb_ary_new();
+    if (n == 0)
+        return rb_segments;
+    long first = 0, step = discretize(values[0], minimum, maximum, integral, steps), i;
+    for (i = 1; i <= n; ++i) {
+        long next_step = i < n ? discretize(values[i], minimum, maximum, integral, steps) : -1;
+        if (next_step == step)
+            continue;
+        VALUE rb_text = coordinates_text(lats, lons, alts, first, i < n ? i + 1 : n);
+        if (block_given)
+            rb_yield_values(2, LONG2NUM(step), rb_text);
+        else
+            rb_ary_push(rb_segments, rb_assoc_new(LONG2NUM(step), rb_text));
+        first = i;
+        step = next_step;
+    }
+    return rb_segments;
+}
+
+void
+Init_ckml(void)
+{
+    VALUE rb_cKML = rb_define_class("KML", rb_cObject);
+    VALUE rb_cCoord = rb_define_class("Coord", rb_cObject);
+    id_alt = rb_intern("alt");
+    id_lat = rb_intern("lat");
+    id_lon = rb_intern("lon");
+    rb_define_method(rb_cCoord, "to_kml_coord", rb_coord_to_kml_coord, 0);
+    rb_define_singleton_method(rb_cKML, "coordinates_text", rb_KML_coordinates_text, 5);
+    rb_define_singleton_method(rb_cKML, "segment_coordinates", rb_KML_segment_coordinates, 8);
+}
@@ -0,0 +1,361 @@
+#include <ruby.h>
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define MEMOFILE_MAGIC "MEMOFIL1"
+#define MEMOFILE_BUCKETS 65536
+
+/* A memo file is a header, a table of buckets each holding the offset of
+ * the most recently appended record whose key hashes to it, and the
+ * records themselves.  Records are only ever appended, and each links to
+ * the record that was previously at the head of its bucket, so a reader
+ * that finds a bucket head always finds a complete record.  Writers hold
+ * an exclusive flock while appending; readers take no lock. */
+
+typedef struct {
+    char magic[8];
+    uint32_t buckets;
+    uint32_t reserved;
+    uint64_t records;
+} header_t;
+
+typedef struct {
+    uint64_t next;
+    uint64_t hash;
+    uint32_t key_length;
+    uint32_t value_length;
+} record_t;
+
+typedef struct {
+    VALUE rb_path;
+    int fd;
+    pid_t pid;
+    dev_t dev;
+    ino_t ino;
+    char *map;
+    size_t size;
+} memofile_t;
+
+void Init_cmemofile(void);
+
+static inline uint64_t
+memofile_hash(const char *key, long length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    long i;
+    for (i = 0; i < length; ++i) {
+        hash ^= (unsigned char) key[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static inline size_t
+record_size(const record_t *record)
+{
+    return (sizeof(record_t) + record->key_length + record->value_length + 7) & ~(size_t) 7;
+}
+
+static inline const header_t *
+memofile_header(const memofile_t *memofile)
+{
+    return (const header_t *) memofile->map;
+}
+
+static inline size_t
+memofile_records_offset(const memofile_t *memofile)
+{
+    return sizeof(header_t) + memofile_header(memofile)->buckets * sizeof(uint64_t);
+}
+
+static void
+memofile_unmap(memofile_t *memofile)
+{
+    if (memofile->map)
+        munmap(memofile->map, memofile->size);
+    memofile->map = 0;
+    memofile->size = 0;
+}
+
+/* Map the whole file, remapping it if it has grown */
+static void
+memofile_map(memofile_t *memofile)
+{
+    struct stat st;
+    if (fstat(memofile->fd, &st) == -1)
+        rb_sys_fail(RSTRING(memofile->rb_path)->ptr);
+    if ((size_t) st.st_size == memofile->size)
+        return;
+    memofile_unmap(memofile);
+    void *map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, memofile->fd, 0);
+    if (map == MAP_FAILED)
+        rb_sys_fail(RSTRING(memofile->rb_path)->ptr);
+    memofile->map = map;
+    memofile->size = st.st_size;
+}
+
+static void
+memofile_close(memofile_t *memofile)
+{
+    memofile_unmap(memofile);
+    if (memofile->fd != -1)
+        close(memofile->fd);
+    memofile->fd = -1;
+}
+
+static void
+memofile_open(memofile_t *memofile, int buckets)
+{
+    const char *path = RSTRING(memofile->rb_path)->ptr;
+    memofile->fd = open(path, O_RDWR | O_CREAT, 0666);
+    if (memofile->fd == -1)
+        rb_sys_fail(path);
+    memofile->pid = getpid();
+    flock(memofile->fd, LOCK_EX);
+    struct stat st;
+    if (fstat(memofile->fd, &st) == -1)
+        rb_sys_fail(path);
+    memofile->dev = st.st_dev;
+    memofile->ino = st.st_ino;
+    if (st.st_size == 0) {
+        header_t header;
+        memset(&header, 0, sizeof header);
+        memcpy(header.magic, MEMOFILE_MAGIC, sizeof header.magic);
+        header.buckets = buckets;
+        if (ftruncate(memofile->fd, sizeof header + buckets * sizeof(uint64_t)) == -1 || pwrite(memofile->fd, &header, sizeof header, 0) != sizeof header) {
+            flock(memofile->fd, LOCK_UN);
+            rb_sys_fail(path);
+        }
+    }
+    flock(memofile->fd, LOCK_UN);
+    memofile_map(memofile);
+    const header_t *header = memofile_header(memofile);
+    if (memofile->size < sizeof(header_t) || memcmp(header->magic, MEMOFILE_MAGIC, sizeof header->magic) || memofile->size < memofile_records_offset(memofile)) {
+        memofile_close(memofile);
+        rb_raise(rb_eRuntimeError, "%s: not a memo file", path);
+    }
+}
+
+/* Reopen the file if it has been replaced, for example by compaction, or
+ * if this process has forked since it was opened, so that flock excludes
+ * other processes */
+static void
+memofile_check(memofile_t *memofile)
+{
+    if (memofile->fd == -1)
+        rb_raise(rb_eIOError, "closed memo file");
+    struct stat st;
+    if (memofile->pid == getpid() && (stat(RSTRING(memofile->rb_path)->ptr, &st) == -1 || (st.st_dev == memofile->dev && st.st_ino == memofile->ino)))
+        return;
+    int buckets = memofile_header(memofile)->buckets;
+    memofile_close(memofile);
+    memofile_open(memofile, buckets);
+}
+
+/* Returns the offset of the newest record with the given key, or zero */
+static uint64_t
+memofile_find(memofile_t *memofile, const char *key, long length)
+{
+    uint64_t hash = memofile_hash(key, length);
+    const header_t *header = memofile_header(memofile);
+    const uint64_t *heads = (const uint64_t *) (header + 1);
+    uint64_t offset = heads[hash & (header->buckets - 1)];
+    while (offset) {
+        if (offset + sizeof(record_t) > memofile->size) {
+            memofile_map(memofile);
+            header = memofile_header(memofile);
+            if (offset + sizeof(record_t) > memofile->size)
+                return 0;
+        }
+        const record_t *record = (const record_t *) (memofile->map + offset);
+        if (offset + record_size(record) > memofile->size) {
+            memofile_map(memofile);
+            record = (const record_t *) (memofile->map + offset);
+        }
+        if (record->hash == hash && record->key_length == length && !memcmp(record + 1, key, length))
+            return offset;
+        offset = record->next;
+    }
+    return 0;
+}
+
+static void
+memofile_append(memofile_t *memofile, const char *key, long key_length, const char *value, long value_length)
+{
+    const char *path = RSTRING(memofile->rb_path)->ptr;
+    while (1) {
+        memofile_check(memofile);
+        flock(memofile->fd, LOCK_EX);
+        struct stat st;
+        if (stat(path, &st) != -1 && (st.st_dev != memofile->dev || st.st_ino != memofile->ino)) {
+            flock(memofile->fd, LOCK_UN);
+            continue;
+        }
+        break;
+    }
+    memofile_map(memofile);
+    header_t header = *memofile_header(memofile);
+    uint64_t *heads = (uint64_t *) (memofile->map + sizeof(header_t));
+    record_t record;
+    record.hash = memofile_hash(key, key_length);
+    uint64_t bucket = record.hash & (header.buckets - 1);
+    record.next = heads[bucket];
+    record.key_length = key_length;
+    record.value_length = value_length;
+    size_t size = record_size(&record);
+    char *buffer = ALLOC_N(char, size);
+    memset(buffer, 0, size);
+    memcpy(buffer, &record, sizeof record);
+    memcpy(buffer + sizeof record, key, key_length);
+    memcpy(buffer + sizeof record + key_length, value, value_length);
+    uint64_t offset = memofile->size;
+    int ok = pwrite(memofile->fd, buffer, size, offset) == (ssize_t) size;
+    xfree(buffer);
+    if (ok) {
+        ++header.records;
+        ok = pwrite(memofile->fd, &offset, sizeof offset, sizeof(header_t) + bucket * sizeof(uint64_t)) == sizeof offset
+            && pwrite(memofile->fd, &header, sizeof header, 0) == sizeof header;
+    }
+    flock(memofile->fd, LOCK_UN);
+    if (!ok)
+        rb_sys_fail(path);
+}
+
+static void
+memofile_mark(memofile_t *memofile)
+{
+    rb_gc_mark(memofile->rb_path);
+}
+
+static void
+memofile_free(memofile_t *memofile)
+{
+    memofile_close(memofile);
+    xfree(memofile);
+}
+
+static VALUE
+rb_MemoFile_alloc(VALUE rb_class)
+{
+    memofile_t *memofile;
+    VALUE rb_self = Data_Make_Struct(rb_class, memofile_t, memofile_mark, memofile_free, memofile);
+    memofile->rb_path = Qnil;
+    memofile->fd = -1;
+    return rb_self;
+}
+
+static memofile_t *
+rb_MemoFile_get(VALUE rb_self)
+{
+    memofile_t *memofile;
+    Data_Get_Struct(rb_self, memofile_t, memofile);
+    memofile_check(memofile);
+    return memofile;
+}
+
+static VALUE
+rb_MemoFile_initialize(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_path, rb_buckets;
+    rb_scan_args(argc, argv, "11", &rb_path, &rb_buckets);
+    int buckets = NIL_P(rb_buckets) ? MEMOFILE_BUCKETS : NUM2INT(rb_buckets);
+    if (buckets < 1 || (buckets & (buckets - 1)))
+        rb_raise(rb_eArgError, "buckets must be a power of two");
+    memofile_t *memofile;
+    Data_Get_Struct(rb_self, memofile_t, memofile);
+    memofile_close(memofile);
+    memofile->rb_path = rb_str_dup(StringValue(rb_path));
+    memofile_open(memofile, buckets);
+    return rb_self;
+}
+
+static VALUE
+rb_MemoFile_get_value(VALUE rb_self, VALUE rb_key)
+{
+    memofile_t *memofile = rb_MemoFile_get(rb_self);
+    StringValue(rb_key);
+    uint64_t offset = memofile_find(memofile, RSTRING(rb_key)->ptr, RSTRING(rb_key)->len);
+    if (!offset)
+        return Qnil;
+    const record_t *record = (const record_t *) (memofile->map + offset);
+    return rb_str_new((const char *) (record + 1) + record->key_length, record->value_length);
+}
+
+static VALUE
+rb_MemoFile_set_value(VALUE rb_self, VALUE rb_key, VALUE rb_value)
+{
+    memofile_t *memofile = rb_MemoFile_get(rb_self);
+    StringValue(rb_key);
+    StringValue(rb_value);
+    memofile_append(memofile, RSTRING(rb_key)->ptr, RSTRING(rb_key)->len, RSTRING(rb_value)->ptr, RSTRING(rb_value)->len);
+    return rb_value;
+}
+
+/* Yields the newest value of each key, in the order the keys were first
+ * written */
+static VALUE
+rb_MemoFile_each(VALUE rb_self)
+{
+    memofile_t *memofile = rb_MemoFile_get(rb_self);
+    memofile_map(memofile);
+    uint64_t offset = memofile_records_offset(memofile), end = memofile->size;
+    while (offset + sizeof(record_t) <= end) {
+        const record_t *record = (const record_t *) (memofile->map + offset);
+        size_t size = record_size(record);
+        if (offset + size > end)
+            break;
+        VALUE rb_key = rb_str_new((const char *) (record + 1), record->key_length);
+        uint64_t newest = memofile_find(memofile, RSTRING(rb_key)->ptr, RSTRING(rb_key)->len);
+        if (newest == offset) {
+            record = (const record_t *) (memofile->map + offset);
+            rb_yield_values(2, rb_key, rb_str_new((const char *) (record + 1) + record->key_length, record->value_length));
+        }
+        offset += size;
+    }
+    return rb_self;
+}
+
+static VALUE
+rb_MemoFile_records(VALUE rb_self)
+{
+    memofile_t *memofile = rb_MemoFile_get(rb_self);
+    return ULL2NUM(memofile_header(memofile)->records);
+}
+
+static VALUE
+rb_MemoFile_path(VALUE rb_self)
+{
+    memofile_t *memofile;
+    Data_Get_Struct(rb_self, memofile_t, memofile);
+    return memofile->rb_path;
+}
+
+static VALUE
+rb_MemoFile_close(VALUE rb_self)
+{
+    memofile_t *memofile;
+    Data_Get_Struct(rb_self, memofile_t, memofile);
+    memofile_close(memofile);
+    return Qnil;
+}
+
+void
+Init_cmemofile(void)
+{
+    VALUE rb_cMemoFile = rb_define_class("MemoFile", rb_cObject);
+    rb_define_alloc_func(rb_cMemoFile, rb_MemoFile_alloc);
+    rb_define_method(rb_cMemoFile, "initialize", rb_MemoFile_initialize, -1);
+    rb_define_method(rb_cMemoFile, "[]", rb_MemoFile_get_value, 1);
+    rb_define_method(rb_cMemoFile, "[]=", rb_MemoFile_set_value, 2);
+    rb_define_method(rb_cMemoFile, "each", rb_MemoFile_each, 0);
+    rb_define_method(rb_cMemoFile, "records", rb_MemoFile_records, 0);
+    rb_define_method(rb_cMemoFile, "path", rb_MemoFile_path, 0);
+    rb_define_method(rb_cMemoFile, "close", rb_MemoFile_close, 0);
+}
@@ -0,0 +1,6 @@
+require "mkmf"
+
+$CFLAGS += " -Wall -Wextra -Wmissing-prototypes"
+have_header("sys/mman.h")
+have_func("flock")
+create_makefile("cmemofile")
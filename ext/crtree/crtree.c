@@ -0,0 +1,407 @@
+#include <ruby.h>
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RTREE_MAGIC "RTREE001"
+#define RTREE_DIMENSIONS 3
+#define RTREE_LEVELS_MAX 64
+#define RTREE_NODE_SIZE_MAX 256
+
+/* A packed Hilbert R-tree file is a header followed by the levels of the
+ * tree, leaves first.  The leaves are the items' boxes sorted by the
+ * Hilbert value of their centres in the first two dimensions.  Each entry
+ * of a higher level bounds node_size consecutive entries of the level
+ * below, so children are found by their position and only the leaves
+ * need to store the ids of their items. */
+
+typedef struct {
+    char magic[8];
+    uint32_t node_size;
+    uint32_t reserved;
+    uint64_t count;
+} header_t;
+
+typedef struct {
+    double min[RTREE_DIMENSIONS];
+    double max[RTREE_DIMENSIONS];
+    uint64_t id;
+} entry_t;
+
+typedef struct {
+    VALUE rb_path;
+    char *map;
+    size_t size;
+    int node_size;
+    int levels;
+    uint64_t counts[RTREE_LEVELS_MAX];
+    const entry_t *entries[RTREE_LEVELS_MAX];
+} rtree_t;
+
+typedef struct {
+    uint64_t key;
+    uint64_t id;
+} hilbert_t;
+
+typedef struct {
+    double area;
+    uint64_t id;
+} match_t;
+
+void Init_crtree(void);
+
+/* Returns the number of levels of a tree of count items and the number of
+ * entries in each */
+static int
+rtree_levels(uint64_t count, int node_size, uint64_t *counts)
+{
+    int levels = 0;
+    counts[levels++] = count;
+    while (counts[levels - 1] > 1) {
+        if (levels == RTREE_LEVELS_MAX)
+            rb_raise(rb_eArgError, "too many levels");
+        counts[levels] = (counts[levels - 1] + node_size - 1) / node_size;
+        ++levels;
+    }
+    return levels;
+}
+
+/* Returns the distance of x, y along the Hilbert curve filling the 65536
+ * by 65536 grid */
+static uint64_t
+hilbert_key(uint32_t x, uint32_t y)
+{
+    const uint32_t n = 1 << 16;
+    uint64_t key = 0;
+    uint32_t s;
+    for (s = n / 2; s; s /= 2) {
+        uint32_t rx = (x & s) != 0, ry = (y & s) != 0;
+        key += (uint64_t) s * s * ((3 * rx) ^ ry);
+        if (!ry) {
+            if (rx) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            uint32_t t = x;
+            x = y;
+            y = t;
+        }
+    }
+    return key;
+}
+
+static int
+hilbert_compare(const void *a, const void *b)
+{
+    const hilbert_t *ha = a, *hb = b;
+    if (ha->key != hb->key)
+        return ha->key < hb->key ? -1 : 1;
+    return ha->id < hb->id ? -1 : ha->id > hb->id;
+}
+
+/* Larger boxes first, then in order of id */
+static int
+match_compare(const void *a, const void *b)
+{
+    const match_t *ma = a, *mb = b;
+    if (ma->area != mb->area)
+        return ma->area > mb->area ? -1 : 1;
+    return ma->id < mb->id ? -1 : ma->id > mb->id;
+}
+
+static inline uint32_t
+grid(double value, double min, double max)
+{
+    if (max <= min)
+        return 0;
+    double g = 65535.0 * (value - min) / (max - min);
+    return g < 0.0 ? 0 : g > 65535.0 ? 65535 : (uint32_t) g;
+}
+
+static void
+rtree_unmap(rtree_t *rtree)
+{
+    if (rtree->map)
+        munmap(rtree->map, rtree->size);
+    rtree->map = 0;
+    rtree->size = 0;
+}
+
+static void
+rtree_mark(rtree_t *rtree)
+{
+    rb_gc_mark(rtree->rb_path);
+}
+
+static void
+rtree_free(rtree_t *rtree)
+{
+    rtree_unmap(rtree);
+    xfree(rtree);
+}
+
+/* Writes a tree of the items whose boxes are in the packed doubles boxes,
+ * the minimums then the maximums of the three dimensions of each in
+ * order of id, to filename */
+static VALUE
+rb_RTree_s_write(VALUE rb_self, VALUE rb_filename, VALUE rb_boxes, VALUE rb_node_size)
+{
+    const char *filename = StringValueCStr(rb_filename);
+    StringValue(rb_boxes);
+    int node_size = NUM2INT(rb_node_size);
+    if (node_size < 2 || node_size > RTREE_NODE_SIZE_MAX)
+        rb_raise(rb_eArgError, "invalid node size");
+    if (RSTRING(rb_boxes)->len % (2 * RTREE_DIMENSIONS * sizeof(double)))
+        rb_raise(rb_eArgError, "boxes must be packed doubles, six per box");
+    uint64_t count = RSTRING(rb_boxes)->len / (2 * RTREE_DIMENSIONS * sizeof(double)), i;
+    const double *boxes = (const double *) RSTRING(rb_boxes)->ptr;
+    uint64_t counts[RTREE_LEVELS_MAX];
+    int levels = rtree_levels(count, node_size, counts), l, d;
+    double min[2] = { HUGE_VAL, HUGE_VAL }, max[2] = { -HUGE_VAL, -HUGE_VAL };
+    for (i = 0; i < count; ++i) {
+        const double *box = boxes + 2 * RTREE_DIMENSIONS * i;
+        for (d = 0; d < RTREE_DIMENSIONS; ++d)
+            if (!(box[d] <= box[RTREE_DIMENSIONS + d]))
+                rb_raise(rb_eArgError, "box %lu is empty", (unsigned long) i);
+        for (d = 0; d < 2; ++d) {
+            double centre = (box[d] + box[RTREE_DIMENSIONS + d]) / 2.0;
+            if (centre < min[d])
+                min[d] = centre;
+            if (centre > max[d])
+                max[d] = centre;
+        }
+    }
+    hilbert_t *order = ALLOC_N(hilbert_t, count ? count : 1);
+    for (i = 0; i < count; ++i) {
+        const double *box = boxes + 2 * RTREE_DIMENSIONS * i;
+        order[i].key = hilbert_key(grid((box[0] + box[RTREE_DIMENSIONS]) / 2.0, min[0], max[0]), grid((box[1] + box[RTREE_DIMENSIONS + 1]) / 2.0, min[1], max[1]));
+        order[i].id = i;
+    }
+    qsort(order, count, sizeof *order, hilbert_compare);
+    entry_t *level = ALLOC_N(entry_t, count ? count : 1);
+    for (i = 0; i < count; ++i) {
+        const double *box = boxes + 2 * RTREE_DIMENSIONS * order[i].id;
+        memcpy(level[i].min, box, sizeof level[i].min);
+        memcpy(level[i].max, box + RTREE_DIMENSIONS, sizeof level[i].max);
+        level[i].id = order[i].id;
+    }
+    xfree(order);
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        xfree(level);
+        rb_sys_fail(filename);
+    }
+    header_t header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, RTREE_MAGIC, sizeof header.magic);
+    header.node_size = node_size;
+    header.count = count;
+    int ok = fwrite(&header, sizeof header, 1, file) == 1;
+    for (l = 0; ok && l < levels; ++l) {
+        ok = fwrite(level, sizeof *level, counts[l], file) == counts[l];
+        if (l + 1 == levels)
+            break;
+        for (i = 0; i < counts[l + 1]; ++i) {
+            entry_t parent = level[node_size * i];
+            uint64_t j, last = node_size * (i + 1) < counts[l] ? node_size * (i + 1) : counts[l];
+            for (j = node_size * i + 1; j < last; ++j) {
+                for (d = 0; d < RTREE_DIMENSIONS; ++d) {
+                    if (level[j].min[d] < parent.min[d])
+                        parent.min[d] = level[j].min[d];
+                    if (level[j].max[d] > parent.max[d])
+                        parent.max[d] = level[j].max[d];
+                }
+            }
+            parent.id = 0;
+            level[i] = parent;
+        }
+    }
+    xfree(level);
+    if (fclose(file) || !ok)
+        rb_sys_fail(filename);
+    (void) rb_self;
+    return ULL2NUM(count);
+}
+
+static VALUE
+rb_RTree_alloc(VALUE rb_class)
+{
+    rtree_t *rtree;
+    VALUE rb_self = Data_Make_Struct(rb_class, rtree_t, rtree_mark, rtree_free, rtree);
+    memset(rtree, 0, sizeof *rtree);
+    rtree->rb_path = Qnil;
+    return rb_self;
+}
+
+static rtree_t *
+rb_RTree_get(VALUE rb_self)
+{
+    rtree_t *rtree;
+    Data_Get_Struct(rb_self, rtree_t, rtree);
+    if (!rtree->map)
+        rb_raise(rb_eIOError, "closed R-tree");
+    return rtree;
+}
+
+static VALUE
+rb_RTree_initialize(VALUE rb_self, VALUE rb_path)
+{
+    rtree_t *rtree;
+    Data_Get_Struct(rb_self, rtree_t, rtree);
+    rtree_unmap(rtree);
+    rtree->rb_path = rb_str_dup(StringValue(rb_path));
+    const char *path = StringValueCStr(rtree->rb_path);
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+        rb_sys_fail(path);
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        rb_sys_fail(path);
+    }
+    void *map = st.st_size ? mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED)
+        rb_sys_fail(path);
+    rtree->map = map;
+    rtree->size = st.st_size;
+    const header_t *header = map;
+    if (rtree->size < sizeof *header || memcmp(header->magic, RTREE_MAGIC, sizeof header->magic) || header->node_size < 2 || header->node_size > RTREE_NODE_SIZE_MAX) {
+        rtree_unmap(rtree);
+        rb_raise(rb_eRuntimeError, "%s: not an R-tree", path);
+    }
+    rtree->node_size = header->node_size;
+    rtree->levels = rtree_levels(header->count, rtree->node_size, rtree->counts);
+    size_t offset = sizeof *header;
+    int l;
+    for (l = 0; l < rtree->levels; ++l) {
+        rtree->entries[l] = (const entry_t *) (rtree->map + offset);
+        offset += rtree->counts[l] * sizeof(entry_t);
+    }
+    if (offset != rtree->size) {
+        rtree_unmap(rtree);
+        rb_raise(rb_eRuntimeError, "%s: truncated R-tree", path);
+    }
+    madvise(rtree->map, rtree->size, MADV_RANDOM);
+    return rb_self;
+}
+
+static VALUE
+rb_RTree_length(VALUE rb_self)
+{
+    return ULL2NUM(rb_RTree_get(rb_self)->counts[0]);
+}
+
+static VALUE
+rb_RTree_path(VALUE rb_self)
+{
+    rtree_t *rtree;
+    Data_Get_Struct(rb_self, rtree_t, rtree);
+    return rtree->rb_path;
+}
+
+static VALUE
+rb_RTree_close(VALUE rb_self)
+{
+    rtree_t *rtree;
+    Data_Get_Struct(rb_self, rtree_t, rtree);
+    rtree_unmap(rtree);
+    return Qnil;
+}
+
+static inline int
+entry_intersects(const entry_t *entry, const double *min, const double *max)
+{
+    int d;
+    for (d = 0; d < RTREE_DIMENSIONS; ++d)
+        if (entry->min[d] > max[d] || entry->max[d] < min[d])
+            return 0;
+    return 1;
+}
+
+/* Returns the ids of the items whose boxes intersect bbox, an array of
+ * the minimums then the maximums of the first two dimensions, and the
+ * range times in the third, largest first by their area in the first two
+ * dimensions.  Returns at most limit ids if limit is not nil. */
+static VALUE
+rb_RTree_search(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_bbox, rb_times, rb_limit;
+    rb_scan_args(argc, argv, "12", &rb_bbox, &rb_times, &rb_limit);
+    rtree_t *rtree = rb_RTree_get(rb_self);
+    Check_Type(rb_bbox, T_ARRAY);
+    if (RARRAY(rb_bbox)->len != 4)
+        rb_raise(rb_eArgError, "bbox must have four elements");
+    double min[RTREE_DIMENSIONS], max[RTREE_DIMENSIONS];
+    min[0] = NUM2DBL(rb_ary_entry(rb_bbox, 0));
+    min[1] = NUM2DBL(rb_ary_entry(rb_bbox, 1));
+    max[0] = NUM2DBL(rb_ary_entry(rb_bbox, 2));
+    max[1] = NUM2DBL(rb_ary_entry(rb_bbox, 3));
+    if (NIL_P(rb_times)) {
+        min[2] = -HUGE_VAL;
+        max[2] = HUGE_VAL;
+    } else {
+        min[2] = NUM2DBL(rb_funcall(rb_times, rb_intern("first"), 0));
+        max[2] = NUM2DBL(rb_funcall(rb_times, rb_intern("last"), 0));
+    }
+    long limit = NIL_P(rb_limit) ? -1 : NUM2LONG(rb_limit);
+    VALUE rb_result = rb_ary_new();
+    if (!rtree->counts[0] || !limit)
+        return rb_result;
+    uint64_t *stack = ALLOC_N(uint64_t, 2 * (rtree->levels * rtree->node_size + 1));
+    long top = 0, matches = 0, capacity = 64;
+    match_t *match = ALLOC_N(match_t, capacity);
+    stack[top++] = rtree->levels - 1;
+    stack[top++] = 0;
+    while (top) {
+        uint64_t i = stack[--top];
+        int l = stack[--top];
+        const entry_t *entry = &rtree->entries[l][i];
+        if (!entry_intersects(entry, min, max))
+            continue;
+        if (l == 0) {
+            if (matches == capacity) {
+                capacity *= 2;
+                REALLOC_N(match, match_t, capacity);
+            }
+            match[matches].area = (entry->max[0] - entry->min[0]) * (entry->max[1] - entry->min[1]);
+            match[matches].id = entry->id;
+            ++matches;
+            continue;
+        }
+        uint64_t first = rtree->node_size * i, last = first + rtree->node_size, j;
+        if (last > rtree->counts[l - 1])
+            last = rtree->counts[l - 1];
+        for (j = last; j-- > first; ) {
+            stack[top++] = l - 1;
+            stack[top++] = j;
+        }
+    }
+    xfree(stack);
+    qsort(match, matches, sizeof *match, match_compare);
+    long k;
+    for (k = 0; k < matches && k != limit; ++k)
+        rb_ary_push(rb_result, ULL2NUM(match[k].id));
+    xfree(match);
+    return rb_result;
+}
+
+void
+Init_crtree(void)
+{
+    VALUE rb_cRTree = rb_define_class("RTree", rb_cObject);
+    rb_define_alloc_func(rb_cRTree, rb_RTree_alloc);
+    rb_define_singleton_method(rb_cRTree, "write", rb_RTree_s_write, 3);
+    rb_define_method(rb_cRTree, "initialize", rb_RTree_initialize, 1);
+    rb_define_method(rb_cRTree, "length", rb_RTree_length, 0);
+    rb_define_method(rb_cRTree, "path", rb_RTree_path, 0);
+    rb_define_method(rb_cRTree, "close", rb_RTree_close, 0);
+    rb_define_method(rb_cRTree, "search", rb_RTree_search, -1);
+}
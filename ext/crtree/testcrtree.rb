@@ -0,0 +1,64 @@
+require "fileutils"
+require "rtree"
+require "test/unit"
+require "tmpdir"
+
+class TC_CRTree < Test::Unit::TestCase
+
+  def setup
+    @dir = Dir.mktmpdir
+    @filename = File.join(@dir, "test.rtree")
+    srand(1)
+    @boxes = (0...1000).collect do
+      x, y, t = rand * 100.0, rand * 50.0, rand * 1000.0
+      [x, y, t, x + rand * 5.0, y + rand * 5.0, t + rand * 100.0]
+    end
+  end
+
+  def teardown
+    FileUtils.rm_rf(@dir)
+  end
+
+  def brute_force(bbox, times = nil)
+    ids = (0...@boxes.length).select do |id|
+      box = @boxes[id]
+      box[0] <= bbox[2] and box[3] >= bbox[0] and box[1] <= bbox[3] and box[4] >= bbox[1] and (times.nil? or (box[2] <= times.last and box[5] >= times.first))
+    end
+    ids.sort_by { |id| [-(@boxes[id][3] - @boxes[id][0]) * (@boxes[id][4] - @boxes[id][1]), id] }
+  end
+
+  def test_search
+    [2, 3, 16].each do |node_size|
+      assert_equal(1000, RTree.build(@filename, @boxes, node_size))
+      rtree = RTree.new(@filename)
+      assert_equal(1000, rtree.length)
+      20.times do
+        x, y = rand * 100.0, rand * 50.0
+        bbox = [x, y, x + rand * 20.0, y + rand * 10.0]
+        assert_equal(brute_force(bbox), rtree.search(bbox))
+        times = 400.0..600.0
+        assert_equal(brute_force(bbox, times), rtree.search(bbox, times))
+        assert_equal(brute_force(bbox)[0, 3], rtree.search(bbox, nil, 3))
+      end
+      assert_equal(1000, rtree.search([-1.0, -1.0, 200.0, 200.0]).length)
+      assert_equal([], rtree.search([200.0, 200.0, 300.0, 300.0]))
+      rtree.close
+      assert_raise(IOError) { rtree.search([0.0, 0.0, 1.0, 1.0]) }
+    end
+  end
+
+  def test_small
+    RTree.build(@filename, [])
+    assert_equal([], RTree.new(@filename).search([0.0, 0.0, 1.0, 1.0]))
+    RTree.build(@filename, [[0.0, 0.0, 0.0, 1.0, 1.0, 1.0]])
+    assert_equal([0], RTree.new(@filename).search([0.5, 0.5, 2.0, 2.0]))
+  end
+
+  def test_malformed
+    assert_raise(ArgumentError) { RTree.build(@filename, [[1.0, 0.0, 0.0, 0.0, 1.0, 1.0]]) }
+    assert(!FileTest.exist?(@filename))
+    File.open(@filename, "wb") { |io| io.write("x" * 64) }
+    assert_raise(RuntimeError) { RTree.new(@filename) }
+  end
+
+end
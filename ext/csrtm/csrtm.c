@@ -0,0 +1,1377 @@
+#include <ruby.h>
+#ifdef HAVE_RUBY_THREAD_H
+#include <ruby/thread.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <zlib.h>
+
+/* Tiles are 5 degrees square with 1200 samples per degree.  Tile x, y has
+ * its north west corner at longitude 5 * x - 185 and latitude 65 - 5 * y,
+ * and sample i, j of a tile lies i / 1200 degrees east and j / 1200 degrees
+ * south of it.  Uncompressed tiles hold the samples row by row as native
+ * shorts. */
+#define TILE_SIZE 6000
+#define TILES_X 72
+#define TILES_Y 24
+#define SAMPLES_PER_DEGREE 1200
+#define NODATA_VALUE -9999
+
+/* Compressed tiles start with a dem_header_t and a table of the offsets of
+ * their blocks, followed by one more offset for the end of the last.  Level
+ * l has one sample for every 4^l by 4^l samples of the tile.  Level 0 has a
+ * single grid of samples, and the overview levels a grid of the minimum
+ * and a grid of the maximum of the samples they cover, ignoring
+ * NODATA_VALUEs.  Each grid is divided into DEM_BLOCK_SIZE square blocks,
+ * narrower at its right and bottom edges, stored row by row.  A block is
+ * stored as the zigzag encoded difference of each sample from the sample
+ * to its left, or above it for the first column, with the low bytes of
+ * all the differences before the high bytes, deflated with zlib. */
+#define DEM_MAGIC "SRTMDEM1"
+#define DEM_BLOCK_SIZE 256
+#define DEM_LEVELS 5
+#define DEM_BLOCK_CACHE_SIZE 128
+
+typedef struct {
+    char magic[8];
+    uint32_t width;
+    uint32_t height;
+    uint32_t block_size;
+    uint32_t levels;
+} dem_header_t;
+
+typedef struct {
+    int width;
+    int height;
+    int blocks_x;
+    int blocks_y;
+    int grids;
+    int first;
+} dem_level_t;
+
+enum { TILE_UNKNOWN, TILE_NONE, TILE_MAPPED, TILE_COMPRESSED };
+
+typedef struct {
+    int state;
+    const int16_t *samples;
+    const unsigned char *map;
+    size_t size;
+    const uint64_t *offsets;
+    dem_level_t levels[DEM_LEVELS];
+} tile_t;
+
+typedef struct {
+    const tile_t *tile;
+    int block;
+    int16_t samples[DEM_BLOCK_SIZE * DEM_BLOCK_SIZE];
+} dem_block_t;
+
+static tile_t tiles[TILES_X * TILES_Y];
+static dem_block_t *dem_block_cache[DEM_BLOCK_CACHE_SIZE];
+
+static VALUE id_bilinear;
+static VALUE id_max;
+static VALUE id_min;
+static VALUE id_nearest;
+static VALUE id_tile_filename;
+
+static VALUE rb_eFormatError;
+static VALUE rb_mSRTM90mDEM;
+
+static int srtm_threads = 1;
+
+void Init_csrtm(void);
+
+/* Fills in the levels of a width by height tile, returning the total
+ * number of blocks */
+static int
+dem_levels(int width, int height, dem_level_t *levels)
+{
+    int l, blocks = 0;
+    for (l = 0; l < DEM_LEVELS; ++l) {
+        int factor = 1 << (2 * l);
+        levels[l].width = (width + factor - 1) / factor;
+        levels[l].height = (height + factor - 1) / factor;
+        levels[l].blocks_x = (levels[l].width + DEM_BLOCK_SIZE - 1) / DEM_BLOCK_SIZE;
+        levels[l].blocks_y = (levels[l].height + DEM_BLOCK_SIZE - 1) / DEM_BLOCK_SIZE;
+        levels[l].grids = l ? 2 : 1;
+        levels[l].first = blocks;
+        blocks += levels[l].grids * levels[l].blocks_x * levels[l].blocks_y;
+    }
+    return blocks;
+}
+
+static void
+tile_map(tile_t *tile, VALUE rb_filename)
+{
+    const char *filename = StringValueCStr(rb_filename);
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+        rb_sys_fail(filename);
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        rb_sys_fail(filename);
+    }
+    size_t size = st.st_size;
+    void *map = size ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED)
+        rb_sys_fail(filename);
+    madvise(map, size, MADV_RANDOM);
+    const dem_header_t *header = map;
+    if (size >= sizeof *header && !memcmp(header->magic, DEM_MAGIC, sizeof header->magic)) {
+        int blocks = dem_levels(TILE_SIZE, TILE_SIZE, tile->levels);
+        if (header->width != TILE_SIZE || header->height != TILE_SIZE || header->block_size != DEM_BLOCK_SIZE || header->levels != DEM_LEVELS || size < sizeof *header + (blocks + 1) * sizeof(uint64_t)) {
+            munmap(map, size);
+            rb_raise(rb_eFormatError, "%s: unsupported compressed tile", filename);
+        }
+        tile->map = map;
+        tile->size = size;
+        tile->offsets = (const uint64_t *) (header + 1);
+        tile->state = TILE_COMPRESSED;
+    } else if (size == TILE_SIZE * TILE_SIZE * sizeof(int16_t)) {
+        tile->samples = map;
+        tile->state = TILE_MAPPED;
+    } else {
+        munmap(map, size);
+        rb_raise(rb_eFormatError, "%s: expected %ld bytes, got %ld", filename, (long) (TILE_SIZE * TILE_SIZE * sizeof(int16_t)), (long) size);
+    }
+}
+
+/* Returns tile x, y, asking SRTM90mDEM.tile_filename to fetch it if it has
+ * not been seen before.  Returns NULL if the tile has not been downloaded
+ * and download is false. */
+static const tile_t *
+tile_get(int x, int y, int download)
+{
+    static const tile_t none = { TILE_NONE, NULL, NULL, 0, NULL, { { 0, 0, 0, 0, 0, 0 } } };
+    if (x < 1 || TILES_X < x || y < 1 || TILES_Y < y)
+        return &none;
+    tile_t *tile = &tiles[TILES_X * (y - 1) + (x - 1)];
+    if (tile->state == TILE_UNKNOWN) {
+        VALUE rb_filename = rb_funcall(rb_mSRTM90mDEM, id_tile_filename, 3, INT2FIX(x), INT2FIX(y), download ? Qtrue : Qfalse);
+        if (NIL_P(rb_filename))
+            return NULL;
+        if (rb_filename == Qfalse)
+            tile->state = TILE_NONE;
+        else
+            tile_map(tile, rb_filename);
+    }
+    return tile;
+}
+
+static inline uint16_t
+zigzag_encode(uint16_t delta)
+{
+    return (uint16_t) (delta << 1) ^ (uint16_t) -(delta >> 15);
+}
+
+static inline uint16_t
+zigzag_decode(uint16_t zigzag)
+{
+    return (zigzag >> 1) ^ (uint16_t) -(zigzag & 1);
+}
+
+/* Returns block bi, bj of grid of level, which is width samples wide,
+ * decompressing it into the block cache if necessary */
+static const int16_t *
+tile_block(const tile_t *tile, int level, int grid, int bi, int bj, int *width)
+{
+    const dem_level_t *l = &tile->levels[level];
+    int block = l->first + (grid * l->blocks_y + bj) * l->blocks_x + bi;
+    int height = l->height - DEM_BLOCK_SIZE * bj < DEM_BLOCK_SIZE ? l->height - DEM_BLOCK_SIZE * bj : DEM_BLOCK_SIZE;
+    *width = l->width - DEM_BLOCK_SIZE * bi < DEM_BLOCK_SIZE ? l->width - DEM_BLOCK_SIZE * bi : DEM_BLOCK_SIZE;
+    dem_block_t **slot = &dem_block_cache[(31 * (tile - tiles) + block) % DEM_BLOCK_CACHE_SIZE];
+    if (!*slot) {
+        *slot = ALLOC(dem_block_t);
+        (*slot)->tile = NULL;
+    }
+    dem_block_t *cached = *slot;
+    if (cached->tile == tile && cached->block == block)
+        return cached->samples;
+    static unsigned char planes[2 * DEM_BLOCK_SIZE * DEM_BLOCK_SIZE];
+    int n = *width * height, k;
+    uLongf length = sizeof planes;
+    uint64_t begin = tile->offsets[block], end = tile->offsets[block + 1];
+    cached->tile = NULL;
+    if (begin > end || end > tile->size || uncompress(planes, &length, tile->map + begin, end - begin) != Z_OK || length != 2 * (uLongf) n)
+        rb_raise(rb_eFormatError, "corrupt compressed tile");
+    int16_t *samples = cached->samples;
+    for (k = 0; k < n; ++k) {
+        uint16_t prediction = k % *width ? samples[k - 1] : k ? samples[k - *width] : 0;
+        samples[k] = (int16_t) (uint16_t) (prediction + zigzag_decode(planes[k] | planes[n + k] << 8));
+    }
+    cached->tile = tile;
+    cached->block = block;
+    return samples;
+}
+
+/* Returns sample i, j of level of a tile, which for overview levels is
+ * the minimum if grid is 0 and the maximum if it is 1.  Missing tiles are
+ * at sea level. */
+static int
+tile_sample(const tile_t *tile, int level, int grid, int i, int j)
+{
+    if (tile->state == TILE_COMPRESSED) {
+        int width;
+        const int16_t *block = tile_block(tile, level, grid, i / DEM_BLOCK_SIZE, j / DEM_BLOCK_SIZE, &width);
+        return block[width * (j % DEM_BLOCK_SIZE) + i % DEM_BLOCK_SIZE];
+    }
+    if (tile->state != TILE_MAPPED)
+        return 0;
+    if (level == 0)
+        return tile->samples[TILE_SIZE * j + i];
+    /* Uncompressed tiles have no overviews */
+    int factor = 1 << (2 * level), result = NODATA_VALUE, ii, jj;
+    for (jj = factor * j; jj < factor * (j + 1) && jj < TILE_SIZE; ++jj)
+        for (ii = factor * i; ii < factor * (i + 1) && ii < TILE_SIZE; ++ii) {
+            int value = tile->samples[TILE_SIZE * jj + ii];
+            if (value != NODATA_VALUE && (result == NODATA_VALUE || (grid ? value > result : value < result)))
+                result = value;
+        }
+    return result;
+}
+
+/* Returns the sample at global column i and row j, counting from longitude
+ * -180 and latitude 60, or NODATA_VALUE */
+static int
+sample(int i, int j)
+{
+    if (i < 0 || j < 0)
+        return 0;
+    return tile_sample(tile_get(i / TILE_SIZE + 1, j / TILE_SIZE + 1, 1), 0, 0, i % TILE_SIZE, j % TILE_SIZE);
+}
+
+/* Like Float#divmod */
+static double
+divmod(double x, double y, double *mod)
+{
+    *mod = fmod(x, y);
+    double div = round((x - *mod) / y);
+    if (y * *mod < 0.0) {
+        *mod += y;
+        div -= 1.0;
+    }
+    return div;
+}
+
+/* Finds tile x, y and the sample i, j in it nearest to lat, lon in
+ * degrees, computed exactly as the original Ruby implementation did */
+static void
+nearest(double lat, double lon, int *x, int *y, int *i, int *j)
+{
+    double u, v;
+    *x = (int) divmod(lon + 185 + 0.5 / SAMPLES_PER_DEGREE, 5, &u);
+    *y = (int) divmod(65 - lat + 0.5 / SAMPLES_PER_DEGREE, 5, &v);
+    *i = (int) (SAMPLES_PER_DEGREE * u);
+    *j = (int) (SAMPLES_PER_DEGREE * v);
+}
+
+/* Returns the minimum if grid is 0, or maximum if grid is 1, of the level
+ * overview sample that covers the nearest sample to lat, lon in degrees.
+ * Level 0 gives the nearest sample itself, from its only grid. */
+static int
+elevation_overview(double lat, double lon, int level, int grid)
+{
+    int x, y, i, j;
+    nearest(lat, lon, &x, &y, &i, &j);
+    return tile_sample(tile_get(x, y, 1), level, level ? grid : 0, i >> (2 * level), j >> (2 * level));
+}
+
+/* Interpolates between the four samples around lat, lon in degrees,
+ * ignoring any that are NODATA_VALUE.  Returns 0 and sets *elevation if
+ * any are valid. */
+static int
+elevation_bilinear(double lat, double lon, double *elevation)
+{
+    double u = SAMPLES_PER_DEGREE * (lon + 180.0), v = SAMPLES_PER_DEGREE * (60.0 - lat);
+    double i0 = floor(u), j0 = floor(v);
+    double du = u - i0, dv = v - j0;
+    double weights[4] = { (1.0 - du) * (1.0 - dv), du * (1.0 - dv), (1.0 - du) * dv, du * dv };
+    double sum = 0.0, weight = 0.0;
+    int k;
+    for (k = 0; k < 4; ++k) {
+        int value = sample((int) i0 + (k & 1), (int) j0 + (k >> 1));
+        if (value == NODATA_VALUE)
+            continue;
+        sum += weights[k] * value;
+        weight += weights[k];
+    }
+    if (weight == 0.0)
+        return -1;
+    *elevation = sum / weight;
+    return 0;
+}
+
+/* Returns the finest level whose samples are no larger than resolution
+ * degrees */
+static int
+resolution_level(VALUE rb_resolution)
+{
+    double resolution = NIL_P(rb_resolution) ? 0.0 : NUM2DBL(rb_resolution);
+    int level = 0;
+    while (level + 1 < DEM_LEVELS && (1 << (2 * (level + 1))) <= resolution * SAMPLES_PER_DEGREE)
+        ++level;
+    return level;
+}
+
+static const double *
+packed_doubles(VALUE rb_doubles, long *n)
+{
+    Check_Type(rb_doubles, T_STRING);
+    *n = RSTRING(rb_doubles)->len / sizeof(double);
+    return (const double *) RSTRING(rb_doubles)->ptr;
+}
+
+/* Returns the elevation at lat, lon in degrees, or nil if there is no
+ * data there */
+static VALUE
+rb_SRTM90mDEM_aref(VALUE rb_self, VALUE rb_lat, VALUE rb_lon)
+{
+    int elevation = elevation_overview(NUM2DBL(rb_lat), NUM2DBL(rb_lon), 0, 0);
+    return elevation == NODATA_VALUE ? Qnil : INT2FIX(elevation);
+}
+
+/* Returns true if the elevation at lat, lon in degrees can be found
+ * without downloading a tile */
+static VALUE
+rb_SRTM90mDEM_available_p(VALUE rb_self, VALUE rb_lat, VALUE rb_lon)
+{
+    int x, y, i, j;
+    nearest(NUM2DBL(rb_lat), NUM2DBL(rb_lon), &x, &y, &i, &j);
+    return tile_get(x, y, 0) ? Qtrue : Qfalse;
+}
+
+/* Returns an array of the elevations at the points in the packed arrays
+ * of doubles lats and lons, in radians like those of an IGC::FixBuffer.
+ * interpolation is :nearest, which returns integers, :bilinear, which
+ * returns floats, or :min or :max, which return the lowest or highest
+ * sample of the overview covering each point whose samples are no larger
+ * than resolution degrees.  Points with no data give nil. */
+static VALUE
+rb_SRTM90mDEM_elevations(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_lats, rb_lons, rb_interpolation, rb_resolution;
+    rb_scan_args(argc, argv, "22", &rb_lats, &rb_lons, &rb_interpolation, &rb_resolution);
+    ID interpolation = NIL_P(rb_interpolation) ? id_nearest : SYM2ID(rb_interpolation);
+    if (interpolation != id_nearest && interpolation != id_bilinear && interpolation != id_min && interpolation != id_max)
+        rb_raise(rb_eArgError, "unsupported interpolation");
+    int level = interpolation == id_nearest ? 0 : resolution_level(rb_resolution);
+    long n, n_lons, i;
+    const double *lats = packed_doubles(rb_lats, &n);
+    const double *lons = packed_doubles(rb_lons, &n_lons);
+    if (n != n_lons)
+        rb_raise(rb_eArgError, "lats and lons have different lengths");
+    VALUE rb_elevations = rb_ary_new2(n);
+    for (i = 0; i < n; ++i) {
+        double lat = lats[i] * 180.0 / M_PI, lon = lons[i] * 180.0 / M_PI;
+        if (interpolation == id_bilinear) {
+            double elevation;
+            rb_ary_push(rb_elevations, elevation_bilinear(lat, lon, &elevation) ? Qnil : rb_float_new(elevation));
+        } else {
+            int elevation = elevation_overview(lat, lon, level, interpolation == id_max);
+            rb_ary_push(rb_elevations, elevation == NODATA_VALUE ? Qnil : INT2FIX(elevation));
+        }
+    }
+    return rb_elevations;
+}
+
+/* Returns the lowest and highest elevations in the box from lat0, lon0 to
+ * lat1, lon1 in degrees, or nil if there is no data there.  The range is
+ * that of the overview samples covering the box, taken from the finest
+ * level needing at most 64 by 64 of them, or from the finest level whose
+ * samples are no larger than resolution degrees. */
+static VALUE
+rb_SRTM90mDEM_range(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_lat0, rb_lon0, rb_lat1, rb_lon1, rb_resolution;
+    rb_scan_args(argc, argv, "41", &rb_lat0, &rb_lon0, &rb_lat1, &rb_lon1, &rb_resolution);
+    int x0, y0, i0, j0, x1, y1, i1, j1;
+    nearest(NUM2DBL(rb_lat0), NUM2DBL(rb_lon0), &x0, &y0, &i0, &j0);
+    nearest(NUM2DBL(rb_lat1), NUM2DBL(rb_lon1), &x1, &y1, &i1, &j1);
+    /* Global samples, west to east and north to south */
+    long u0 = (long) TILE_SIZE * x0 + i0, v0 = (long) TILE_SIZE * y0 + j0;
+    long u1 = (long) TILE_SIZE * x1 + i1, v1 = (long) TILE_SIZE * y1 + j1, t;
+    if (u1 < u0)
+        t = u0, u0 = u1, u1 = t;
+    if (v1 < v0)
+        t = v0, v0 = v1, v1 = t;
+    int level = 0;
+    if (!NIL_P(rb_resolution))
+        level = resolution_level(rb_resolution);
+    else
+        while (level + 1 < DEM_LEVELS && ((u1 - u0) >> (2 * level) > 64 || (v1 - v0) >> (2 * level) > 64))
+            ++level;
+    int minimum = NODATA_VALUE, maximum = NODATA_VALUE, x, y, i, j;
+    for (y = v0 / TILE_SIZE; y <= v1 / TILE_SIZE; ++y)
+        for (x = u0 / TILE_SIZE; x <= u1 / TILE_SIZE; ++x) {
+            const tile_t *tile = tile_get(x, y, 1);
+            int ia = x == u0 / TILE_SIZE ? u0 % TILE_SIZE : 0, ib = x == u1 / TILE_SIZE ? u1 % TILE_SIZE : TILE_SIZE - 1;
+            int ja = y == v0 / TILE_SIZE ? v0 % TILE_SIZE : 0, jb = y == v1 / TILE_SIZE ? v1 % TILE_SIZE : TILE_SIZE - 1;
+            for (j = ja >> (2 * level); j <= jb >> (2 * level); ++j)
+                for (i = ia >> (2 * level); i <= ib >> (2 * level); ++i) {
+                    int low = tile_sample(tile, level, 0, i, j);
+                    int high = level ? tile_sample(tile, level, 1, i, j) : low;
+                    if (low != NODATA_VALUE && (minimum == NODATA_VALUE || low < minimum))
+                        minimum = low;
+                    if (high != NODATA_VALUE && (maximum == NODATA_VALUE || high > maximum))
+                        maximum = high;
+                }
+        }
+    if (minimum == NODATA_VALUE)
+        return Qnil;
+    return rb_ary_new3(2, INT2FIX(minimum), INT2FIX(maximum));
+}
+
+/* Conversion of CGIAR-CSI ArcASCII grids, optionally zipped, into tiles.
+ * The source is read in chunks, and the rows of each chunk are parsed by
+ * srtm_threads threads while the next chunk is read or inflated.  Rows go
+ * straight into the mmapped tile, which replaces any existing one only
+ * once it is complete. */
+
+#define CONVERT_CHUNK_SIZE (4 << 20)
+#define CONVERT_ROWS_CHUNK 16
+#define ZIP_STORED 0
+#define ZIP_DEFLATED 8
+
+enum { ROW_OK, ROW_CHARACTER, ROW_RANGE, ROW_COUNT };
+
+static const char *const row_errors[] = {
+    NULL,
+    "unexpected character",
+    "value out of range",
+    "wrong number of values",
+};
+
+typedef struct {
+    int fd;
+    const unsigned char *map;
+    size_t map_size;
+    const unsigned char *data;
+    size_t remaining;
+    int method;
+    int inflating;
+    z_stream stream;
+} source_t;
+
+typedef struct {
+    const char *src;
+    const char *dst;
+    const char *entry;
+    int compressed;
+    source_t source;
+    int ncols;
+    int nrows;
+    int row;
+    int16_t *samples;
+    size_t size;
+    const char **spans;
+    int spans_capacity;
+    int error_errno;
+    char error[256];
+} converter_t;
+
+typedef struct {
+    const dem_level_t *levels;
+    const int16_t *grids[DEM_LEVELS][2];
+    int blocks;
+    int next;
+    unsigned char **data;
+    uLongf *lengths;
+    int failed;
+} dem_writer_t;
+
+typedef struct {
+#ifdef HAVE_PTHREAD_H
+    pthread_t threads[256];
+#endif
+    int started;
+} workers_t;
+
+typedef struct {
+    converter_t *converter;
+    const char *const *spans;
+    int n;
+    int next;
+    int error;
+} rows_t;
+
+static int convert_fail(converter_t *converter, int error_errno, const char *format, ...) __attribute__ ((format(printf, 3, 4)));
+
+static int
+convert_fail(converter_t *converter, int error_errno, const char *format, ...)
+{
+    if (!converter->error[0]) {
+        int n = snprintf(converter->error, sizeof converter->error, format ? "%s: " : "%s", converter->src);
+        if (format) {
+            va_list ap;
+            va_start(ap, format);
+            vsnprintf(converter->error + n, sizeof converter->error - n, format, ap);
+            va_end(ap);
+        }
+        converter->error_errno = error_errno;
+    }
+    return -1;
+}
+
+static inline int
+is_blank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+static inline const char *
+skip_blanks(const char *p, const char *pe)
+{
+    while (p < pe && is_blank(*p))
+        ++p;
+    return p;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SWAR 1
+
+/* Returns the number of leading digits in the eight characters in chunk */
+static inline int
+swar_count_digits(uint64_t chunk)
+{
+    uint64_t nondigits = ((chunk & 0xf0f0f0f0f0f0f0f0ULL) | (((chunk + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4)) ^ 0x3333333333333333ULL;
+    return nondigits ? __builtin_ctzll(nondigits) >> 3 : 8;
+}
+
+/* Returns the value of the first len, from one to eight, digits in chunk */
+static inline int
+swar_parse_digits(uint64_t chunk, int len)
+{
+    chunk <<= 8 * (8 - len);
+    chunk = ((chunk & 0x0f0f0f0f0f0f0f0fULL) * 2561) >> 8;
+    chunk = ((chunk & 0x00ff00ff00ff00ffULL) * 6553601) >> 16;
+    return (int) (((chunk & 0x0000ffff0000ffffULL) * 42949672960001ULL) >> 32);
+}
+
+#endif
+
+/* Parses the value at *p, returning ROW_OK and advancing *p past it */
+static inline int
+parse_value(const char **p, const char *pe, int *value)
+{
+    const char *q = *p;
+    int negative = *q == '-';
+    q += negative;
+    int len;
+#ifdef SWAR
+    if (pe - q >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, q, sizeof chunk);
+        len = swar_count_digits(chunk);
+        if (len == 0)
+            return ROW_CHARACTER;
+        *value = swar_parse_digits(chunk, len);
+    } else
+#endif
+    {
+        for (len = 0, *value = 0; q + len < pe && (unsigned) (q[len] - '0') < 10; ++len)
+            *value = 10 * *value + q[len] - '0';
+        if (len == 0)
+            return ROW_CHARACTER;
+    }
+    if (len > 5)
+        return ROW_RANGE;
+    if (negative)
+        *value = -*value;
+    if (*value < INT16_MIN || INT16_MAX < *value)
+        return ROW_RANGE;
+    q += len;
+    if (q < pe && !is_blank(*q))
+        return ROW_CHARACTER;
+    *p = q;
+    return ROW_OK;
+}
+
+/* Parses the blank separated values from p to pe into samples, of which n
+ * have already been parsed */
+static int
+parse_values(const char *p, const char *pe, int16_t *samples, int n, int ncols)
+{
+    for (p = skip_blanks(p, pe); p < pe; p = skip_blanks(p, pe)) {
+        if (n == ncols)
+            return ROW_COUNT;
+        int value, error = parse_value(&p, pe, &value);
+        if (error)
+            return error;
+        samples[n++] = value;
+    }
+    return n == ncols ? ROW_OK : ROW_COUNT;
+}
+
+#if defined(__SSE2__) && defined(SWAR)
+
+/* Sets bit i of *values if p[i] is a digit or a minus sign, and of *blanks
+ * if it is blank, for i from 0 to 63 */
+static inline void
+classify64(const char *p, uint64_t *values, uint64_t *blanks)
+{
+    *values = *blanks = 0;
+    int i;
+    for (i = 0; i < 4; ++i) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (p + 16 * i));
+        __m128i digit = _mm_cmplt_epi8(_mm_xor_si128(_mm_sub_epi8(v, _mm_set1_epi8('0')), _mm_set1_epi8((char) 0x80)), _mm_set1_epi8((char) (0x80 + 10)));
+        __m128i minus = _mm_cmpeq_epi8(v, _mm_set1_epi8('-'));
+        __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+        *values |= (uint64_t) (unsigned) _mm_movemask_epi8(_mm_or_si128(digit, minus)) << (16 * i);
+        *blanks |= (uint64_t) (unsigned) _mm_movemask_epi8(blank) << (16 * i);
+    }
+}
+
+/* Parses a row 64 characters at a time, finding the starts of all the
+ * values in them at once so that they can be parsed independently.  Any
+ * error is diagnosed by parse_values. */
+static int
+parse_row(const char *p, const char *pe, int16_t *samples, int ncols)
+{
+    const char *row = p, *resume = p;
+    uint64_t carry = 0;
+    int n = 0;
+    for (; pe - p >= 64 + 8; p += 64) {
+        uint64_t values, blanks;
+        classify64(p, &values, &blanks);
+        uint64_t starts = values & ~((values << 1) | carry);
+        carry = values >> 63;
+        if (~(values | blanks) || n + __builtin_popcountll(starts) > ncols)
+            return parse_values(row, pe, samples, 0, ncols);
+        for (; starts; starts &= starts - 1) {
+            const char *q = p + __builtin_ctzll(starts);
+            int value;
+            if (parse_value(&q, pe, &value))
+                return parse_values(row, pe, samples, 0, ncols);
+            samples[n++] = value;
+            resume = q;
+        }
+    }
+    return parse_values(resume > p ? resume : p, pe, samples, n, ncols);
+}
+
+#else
+
+static int
+parse_row(const char *p, const char *pe, int16_t *samples, int ncols)
+{
+    return parse_values(p, pe, samples, 0, ncols);
+}
+
+#endif
+
+/* Starts threads running worker(arg) alongside the caller, up to
+ * srtm_threads in all and no more than there are chunks of n items */
+static void
+workers_start(workers_t *workers, void *(*worker)(void *), void *arg, int n, int chunk)
+{
+    workers->started = 0;
+#ifdef HAVE_PTHREAD_H
+    int i;
+    for (i = 1; i < srtm_threads && i * chunk < n; ++i)
+        if (pthread_create(&workers->threads[workers->started], NULL, worker, arg) == 0)
+            ++workers->started;
+#endif
+}
+
+static void
+workers_join(workers_t *workers)
+{
+#ifdef HAVE_PTHREAD_H
+    int i;
+    for (i = 0; i < workers->started; ++i)
+        pthread_join(workers->threads[i], NULL);
+#endif
+}
+
+static void *
+rows_worker(void *arg)
+{
+    rows_t *rows = arg;
+    const converter_t *converter = rows->converter;
+    while (1) {
+        int begin = __atomic_fetch_add(&rows->next, CONVERT_ROWS_CHUNK, __ATOMIC_RELAXED);
+        if (begin >= rows->n)
+            break;
+        int end = begin + CONVERT_ROWS_CHUNK < rows->n ? begin + CONVERT_ROWS_CHUNK : rows->n;
+        int i;
+        for (i = begin; i < end; ++i) {
+            int16_t *samples = converter->samples + (size_t) converter->ncols * (converter->row + i);
+            int error = parse_row(rows->spans[2 * i], rows->spans[2 * i + 1], samples, converter->ncols);
+            if (error == ROW_OK)
+                continue;
+            /* Keep the error in the earliest row */
+            int current = __atomic_load_n(&rows->error, __ATOMIC_RELAXED);
+            error += 4 * i;
+            while (error < current && !__atomic_compare_exchange_n(&rows->error, &current, error, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                ;
+            break;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t
+le16(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t
+le32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/* Finds entry, or the first .asc file if entry is NULL, in the zip file
+ * mapped by source */
+static int
+source_open_zip(converter_t *converter)
+{
+    source_t *source = &converter->source;
+    const unsigned char *map = source->map, *eocd;
+    size_t size = source->map_size;
+    if (size < 22)
+        return convert_fail(converter, 0, "truncated zip file");
+    for (eocd = map + size - 22; le32(eocd) != 0x06054b50; --eocd)
+        if (eocd == map || map + size - eocd > 22 + 65535)
+            return convert_fail(converter, 0, "zip end of central directory not found");
+    int entries = le16(eocd + 10);
+    const unsigned char *p = map + le32(eocd + 16);
+    const unsigned char *pe = eocd;
+    for (; entries > 0; --entries) {
+        if (p < map || pe - p < 46 || le32(p) != 0x02014b50)
+            return convert_fail(converter, 0, "corrupt zip central directory");
+        size_t name_len = le16(p + 28);
+        const char *name = (const char *) p + 46;
+        if ((size_t) (pe - p) < 46 + name_len)
+            return convert_fail(converter, 0, "corrupt zip central directory");
+        int match = converter->entry ? strlen(converter->entry) == name_len && !memcmp(name, converter->entry, name_len) : name_len >= 4 && !strncasecmp(name + name_len - 4, ".asc", 4);
+        if (match) {
+            source->method = le16(p + 10);
+            size_t compressed = le32(p + 20);
+            size_t offset = le32(p + 42);
+            if (source->method != ZIP_STORED && source->method != ZIP_DEFLATED)
+                return convert_fail(converter, 0, "unsupported zip compression method %d", source->method);
+            if (offset > size - 30 || le32(map + offset) != 0x04034b50)
+                return convert_fail(converter, 0, "corrupt zip local header");
+            offset += 30 + le16(map + offset + 26) + le16(map + offset + 28);
+            if (offset > size || compressed > size - offset)
+                return convert_fail(converter, 0, "truncated zip entry");
+            source->data = map + offset;
+            source->remaining = compressed;
+            if (source->method == ZIP_DEFLATED) {
+                if (inflateInit2(&source->stream, -MAX_WBITS) != Z_OK)
+                    return convert_fail(converter, 0, "inflateInit2 failed");
+                source->inflating = 1;
+                source->stream.next_in = (Bytef *) source->data;
+                source->stream.avail_in = compressed;
+            }
+            return 0;
+        }
+        p += 46 + name_len + le16(p + 30) + le16(p + 32);
+    }
+    if (converter->entry)
+        return convert_fail(converter, 0, "zip entry %s not found", converter->entry);
+    return convert_fail(converter, 0, "no .asc file in zip");
+}
+
+/* Opens the source, which is a zip file if it starts with a local header
+ * and an ArcASCII grid otherwise */
+static int
+source_open(converter_t *converter)
+{
+    source_t *source = &converter->source;
+    source->fd = open(converter->src, O_RDONLY);
+    if (source->fd == -1)
+        return convert_fail(converter, errno, NULL);
+    unsigned char magic[4];
+    ssize_t n = pread(source->fd, magic, sizeof magic, 0);
+    if (n == -1)
+        return convert_fail(converter, errno, "read");
+    if (n < 4 || le32(magic) != 0x04034b50)
+        return 0;
+    struct stat st;
+    if (fstat(source->fd, &st) == -1)
+        return convert_fail(converter, errno, "fstat");
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, source->fd, 0);
+    if (map == MAP_FAILED)
+        return convert_fail(converter, errno, "mmap");
+    source->map = map;
+    source->map_size = st.st_size;
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    return source_open_zip(converter);
+}
+
+/* Fills buffer with up to size bytes of the grid, returning the number of
+ * bytes read, which is zero only at the end */
+static ssize_t
+source_read(converter_t *converter, char *buffer, size_t size)
+{
+    source_t *source = &converter->source;
+    size_t n = 0;
+    if (source->inflating) {
+        source->stream.next_out = (Bytef *) buffer;
+        source->stream.avail_out = size;
+        while (source->stream.avail_out > 0) {
+            int status = inflate(&source->stream, Z_NO_FLUSH);
+            if (status == Z_STREAM_END)
+                break;
+            if (status != Z_OK)
+                return convert_fail(converter, 0, "inflate: %s", source->stream.msg ? source->stream.msg : "truncated data");
+        }
+        n = size - source->stream.avail_out;
+    } else if (source->map) {
+        n = size < source->remaining ? size : source->remaining;
+        memcpy(buffer, source->data, n);
+        source->data += n;
+        source->remaining -= n;
+    } else {
+        while (n < size) {
+            ssize_t result = read(source->fd, buffer + n, size - n);
+            if (result == -1 && errno == EINTR)
+                continue;
+            if (result == -1)
+                return convert_fail(converter, errno, "read");
+            if (result == 0)
+                break;
+            n += result;
+        }
+    }
+    return n;
+}
+
+static void
+source_close(source_t *source)
+{
+    if (source->inflating)
+        inflateEnd(&source->stream);
+    if (source->map)
+        munmap((void *) source->map, source->map_size);
+    if (source->fd != -1)
+        close(source->fd);
+}
+
+/* Parses the header line "key value", setting *value */
+static const char *
+parse_header_line(converter_t *converter, const char *p, const char *pe, const char *key, double *value)
+{
+    size_t len = strlen(key);
+    const char *eol = memchr(p, '\n', pe - p);
+    if (!eol || (size_t) (eol - p) <= len || strncasecmp(p, key, len) || !is_blank(p[len])) {
+        convert_fail(converter, 0, "expected %s", key);
+        return NULL;
+    }
+    char buffer[64], *end;
+    const char *q = skip_blanks(p + len, eol);
+    if ((size_t) (eol - q) >= sizeof buffer) {
+        convert_fail(converter, 0, "invalid %s", key);
+        return NULL;
+    }
+    memcpy(buffer, q, eol - q);
+    buffer[eol - q] = '\0';
+    *value = strtod(buffer, &end);
+    while (*end && isspace((unsigned char) *end))
+        ++end;
+    if (end == buffer || *end) {
+        convert_fail(converter, 0, "invalid %s", key);
+        return NULL;
+    }
+    return eol + 1;
+}
+
+static const char *
+parse_header(converter_t *converter, const char *p, const char *pe)
+{
+    double ncols, nrows, xllcorner, yllcorner, cellsize, NODATA_value;
+    if (!(p = parse_header_line(converter, p, pe, "ncols", &ncols))
+        || !(p = parse_header_line(converter, p, pe, "nrows", &nrows))
+        || !(p = parse_header_line(converter, p, pe, "xllcorner", &xllcorner))
+        || !(p = parse_header_line(converter, p, pe, "yllcorner", &yllcorner))
+        || !(p = parse_header_line(converter, p, pe, "cellsize", &cellsize))
+        || !(p = parse_header_line(converter, p, pe, "NODATA_value", &NODATA_value)))
+        return NULL;
+    if (ncols < 1 || 65536 < ncols || ncols != floor(ncols) || nrows < 1 || 65536 < nrows || nrows != floor(nrows)) {
+        convert_fail(converter, 0, "invalid grid size");
+        return NULL;
+    }
+    /* Only whole tiles can be looked up */
+    if (ncols != TILE_SIZE || nrows != TILE_SIZE) {
+        convert_fail(converter, 0, "grid is %dx%d, expected %dx%d", (int) ncols, (int) nrows, TILE_SIZE, TILE_SIZE);
+        return NULL;
+    }
+    if (!(-180.0 <= xllcorner && xllcorner < 180.0) || !(-180.0 <= yllcorner && yllcorner < 180.0)) {
+        convert_fail(converter, 0, "invalid grid position");
+        return NULL;
+    }
+    if (!(cellsize > 0.0)) {
+        convert_fail(converter, 0, "invalid cellsize");
+        return NULL;
+    }
+    if (NODATA_value < INT16_MIN || INT16_MAX < NODATA_value || NODATA_value != floor(NODATA_value)) {
+        convert_fail(converter, 0, "invalid NODATA_value");
+        return NULL;
+    }
+    converter->ncols = ncols;
+    converter->nrows = nrows;
+    return p;
+}
+
+/* Collects the spans of the complete rows from p to pe, and of the last
+ * incomplete row if final, returning a pointer to the first unused byte */
+static const char *
+split_rows(converter_t *converter, const char *p, const char *pe, int final, int *n)
+{
+    *n = 0;
+    while (p < pe) {
+        const char *eol = memchr(p, '\n', pe - p);
+        if (!eol && !final)
+            break;
+        const char *next = eol ? eol + 1 : pe;
+        if (!eol)
+            eol = pe;
+        if (eol > p && eol[-1] == '\r')
+            --eol;
+        if (converter->row + *n == converter->nrows) {
+            if (skip_blanks(p, eol) != eol) {
+                convert_fail(converter, 0, "line %d: more than %d rows", converter->row + *n + 7, converter->nrows);
+                return NULL;
+            }
+        } else {
+            if (*n == converter->spans_capacity) {
+                int capacity = converter->spans_capacity ? 2 * converter->spans_capacity : 1024;
+                const char **spans = realloc(converter->spans, 2 * capacity * sizeof(const char *));
+                if (!spans) {
+                    convert_fail(converter, ENOMEM, "realloc");
+                    return NULL;
+                }
+                converter->spans = spans;
+                converter->spans_capacity = capacity;
+            }
+            converter->spans[2 * *n] = p;
+            converter->spans[2 * *n + 1] = eol;
+            ++*n;
+        }
+        p = next;
+    }
+    return p;
+}
+
+/* Reduces the min and max grids of a level, sw by sh samples, to those of
+ * the next, dw by dh */
+static void
+dem_reduce(const int16_t *src_min, const int16_t *src_max, int sw, int sh, int16_t *dst_min, int16_t *dst_max, int dw, int dh)
+{
+    int i, j, ii, jj;
+    for (j = 0; j < dh; ++j)
+        for (i = 0; i < dw; ++i) {
+            int minimum = NODATA_VALUE, maximum = NODATA_VALUE;
+            for (jj = 4 * j; jj < 4 * j + 4 && jj < sh; ++jj)
+                for (ii = 4 * i; ii < 4 * i + 4 && ii < sw; ++ii) {
+                    int low = src_min[(size_t) sw * jj + ii], high = src_max[(size_t) sw * jj + ii];
+                    if (low != NODATA_VALUE && (minimum == NODATA_VALUE || low < minimum))
+                        minimum = low;
+                    if (high != NODATA_VALUE && (maximum == NODATA_VALUE || high > maximum))
+                        maximum = high;
+                }
+            dst_min[(size_t) dw * j + i] = minimum;
+            dst_max[(size_t) dw * j + i] = maximum;
+        }
+}
+
+static void *
+dem_worker(void *arg)
+{
+    dem_writer_t *writer = arg;
+    unsigned char *planes = malloc(2 * DEM_BLOCK_SIZE * DEM_BLOCK_SIZE);
+    if (!planes)
+        writer->failed = 1;
+    while (planes) {
+        int block = __atomic_fetch_add(&writer->next, 1, __ATOMIC_RELAXED);
+        if (block >= writer->blocks)
+            break;
+        int level = DEM_LEVELS - 1;
+        while (writer->levels[level].first > block)
+            --level;
+        const dem_level_t *l = &writer->levels[level];
+        int index = block - l->first;
+        int grid = index / (l->blocks_x * l->blocks_y);
+        index %= l->blocks_x * l->blocks_y;
+        int x0 = DEM_BLOCK_SIZE * (index % l->blocks_x), y0 = DEM_BLOCK_SIZE * (index / l->blocks_x);
+        int width = l->width - x0 < DEM_BLOCK_SIZE ? l->width - x0 : DEM_BLOCK_SIZE;
+        int height = l->height - y0 < DEM_BLOCK_SIZE ? l->height - y0 : DEM_BLOCK_SIZE;
+        int n = width * height, k = 0, x, y;
+        for (y = 0; y < height; ++y) {
+            const int16_t *row = writer->grids[level][grid] + (size_t) l->width * (y0 + y) + x0;
+            uint16_t prediction = y ? row[-l->width] : 0;
+            for (x = 0; x < width; ++x, ++k) {
+                uint16_t zigzag = zigzag_encode((uint16_t) (row[x] - prediction));
+                planes[k] = zigzag & 0xff;
+                planes[n + k] = zigzag >> 8;
+                prediction = row[x];
+            }
+        }
+        uLongf length = compressBound(2 * n);
+        writer->data[block] = malloc(length);
+        if (!writer->data[block] || compress2(writer->data[block], &length, planes, 2 * n, Z_DEFAULT_COMPRESSION) != Z_OK) {
+            writer->failed = 1;
+            break;
+        }
+        writer->lengths[block] = length;
+    }
+    free(planes);
+    return NULL;
+}
+
+static int
+write_all(int fd, const void *buffer, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = write(fd, buffer, size);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n == -1)
+            return -1;
+        buffer = (const char *) buffer + n;
+        size -= n;
+    }
+    return 0;
+}
+
+/* Writes the samples, ncols by nrows, as a compressed tile to the new file
+ * tmp */
+static int
+dem_write(converter_t *converter, const int16_t *samples, const char *tmp)
+{
+    dem_writer_t writer;
+    dem_level_t levels[DEM_LEVELS];
+    memset(&writer, 0, sizeof writer);
+    writer.levels = levels;
+    writer.blocks = dem_levels(converter->ncols, converter->nrows, levels);
+    writer.grids[0][0] = writer.grids[0][1] = samples;
+    uint64_t *offsets = NULL;
+    int l, b, result = -1, fd = -1;
+    for (l = 1; l < DEM_LEVELS; ++l) {
+        size_t size = (size_t) levels[l].width * levels[l].height * sizeof(int16_t);
+        int16_t *minimums = malloc(size), *maximums = malloc(size);
+        writer.grids[l][0] = minimums;
+        writer.grids[l][1] = maximums;
+        if (!minimums || !maximums) {
+            convert_fail(converter, ENOMEM, "malloc");
+            goto done;
+        }
+        dem_reduce(writer.grids[l - 1][0], writer.grids[l - 1][1], levels[l - 1].width, levels[l - 1].height, minimums, maximums, levels[l].width, levels[l].height);
+    }
+    writer.data = calloc(writer.blocks, sizeof *writer.data);
+    writer.lengths = calloc(writer.blocks, sizeof *writer.lengths);
+    offsets = calloc(writer.blocks + 1, sizeof *offsets);
+    if (!writer.data || !writer.lengths || !offsets) {
+        convert_fail(converter, ENOMEM, "malloc");
+        goto done;
+    }
+    workers_t workers;
+    workers_start(&workers, dem_worker, &writer, writer.blocks, 1);
+    dem_worker(&writer);
+    workers_join(&workers);
+    if (writer.failed) {
+        convert_fail(converter, ENOMEM, "compress");
+        goto done;
+    }
+    dem_header_t header;
+    memcpy(header.magic, DEM_MAGIC, sizeof header.magic);
+    header.width = converter->ncols;
+    header.height = converter->nrows;
+    header.block_size = DEM_BLOCK_SIZE;
+    header.levels = DEM_LEVELS;
+    offsets[0] = sizeof header + (writer.blocks + 1) * sizeof *offsets;
+    for (b = 0; b < writer.blocks; ++b)
+        offsets[b + 1] = offsets[b] + writer.lengths[b];
+    fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1 || write_all(fd, &header, sizeof header) || write_all(fd, offsets, (writer.blocks + 1) * sizeof *offsets)) {
+        convert_fail(converter, errno, "%s", tmp);
+        goto done;
+    }
+    for (b = 0; b < writer.blocks; ++b)
+        if (write_all(fd, writer.data[b], writer.lengths[b])) {
+            convert_fail(converter, errno, "%s", tmp);
+            goto done;
+        }
+    if (close(fd) == -1) {
+        fd = -1;
+        convert_fail(converter, errno, "%s", tmp);
+        goto done;
+    }
+    fd = -1;
+    result = 0;
+done:
+    if (fd != -1)
+        close(fd);
+    for (l = 1; l < DEM_LEVELS; ++l) {
+        free((void *) writer.grids[l][0]);
+        free((void *) writer.grids[l][1]);
+    }
+    if (writer.data)
+        for (b = 0; b < writer.blocks; ++b)
+            free(writer.data[b]);
+    free(writer.data);
+    free(writer.lengths);
+    free(offsets);
+    return result;
+}
+
+/* Maps the samples of the tile, directly for uncompressed tiles */
+static int
+tile_create(converter_t *converter, const char *tmp, int *fd)
+{
+    converter->size = (size_t) converter->ncols * converter->nrows * sizeof(int16_t);
+    void *map;
+    if (converter->compressed) {
+        map = mmap(NULL, converter->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED)
+            return convert_fail(converter, errno, "mmap");
+    } else {
+        *fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (*fd == -1)
+            return convert_fail(converter, errno, "%s", tmp);
+        if (ftruncate(*fd, converter->size) == -1)
+            return convert_fail(converter, errno, "%s", tmp);
+        map = mmap(NULL, converter->size, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+        if (map == MAP_FAILED)
+            return convert_fail(converter, errno, "%s", tmp);
+    }
+    converter->samples = map;
+    return 0;
+}
+
+static void *
+convert_run(void *arg)
+{
+    converter_t *converter = arg;
+    char tmp[PATH_MAX];
+    int fd = -1;
+    char *buffers[2] = { malloc(CONVERT_CHUNK_SIZE), malloc(CONVERT_CHUNK_SIZE) };
+    converter->source.fd = -1;
+    snprintf(tmp, sizeof tmp, "%s.%d", converter->dst, (int) getpid());
+    if (!buffers[0] || !buffers[1]) {
+        convert_fail(converter, ENOMEM, "malloc");
+        goto done;
+    }
+    if (source_open(converter))
+        goto done;
+    ssize_t len = source_read(converter, buffers[0], CONVERT_CHUNK_SIZE);
+    if (len == -1)
+        goto done;
+    int current = 0, final = len == 0;
+    const char *p = buffers[0], *pe = p + len;
+    if (!(p = parse_header(converter, p, pe)))
+        goto done;
+    if (tile_create(converter, tmp, &fd))
+        goto done;
+    while (1) {
+        rows_t rows;
+        rows.converter = converter;
+        rows.next = 0;
+        rows.error = INT_MAX;
+        const char *tail = split_rows(converter, p, pe, final, &rows.n);
+        if (!tail)
+            goto done;
+        rows.spans = converter->spans;
+        size_t tail_len = pe - tail;
+        if (!final && tail_len == CONVERT_CHUNK_SIZE) {
+            convert_fail(converter, 0, "line %d: line too long", converter->row + 7);
+            goto done;
+        }
+        char *next = buffers[!current];
+        memcpy(next, tail, tail_len);
+        workers_t workers;
+        workers_start(&workers, rows_worker, &rows, rows.n, CONVERT_ROWS_CHUNK);
+        ssize_t n_read = final ? 0 : source_read(converter, next + tail_len, CONVERT_CHUNK_SIZE - tail_len);
+        rows_worker(&rows);
+        workers_join(&workers);
+        if (rows.error != INT_MAX) {
+            convert_fail(converter, 0, "line %d: %s", converter->row + rows.error / 4 + 7, row_errors[rows.error % 4]);
+            goto done;
+        }
+        converter->row += rows.n;
+        if (final)
+            break;
+        if (n_read == -1)
+            goto done;
+        final = n_read == 0;
+        current = !current;
+        p = next;
+        pe = next + tail_len + n_read;
+    }
+    if (converter->row != converter->nrows) {
+        convert_fail(converter, 0, "expected %d rows, got %d", converter->nrows, converter->row);
+        goto done;
+    }
+    if (converter->compressed && dem_write(converter, converter->samples, tmp))
+        goto done;
+    if (munmap(converter->samples, converter->size) == -1)
+        convert_fail(converter, errno, "munmap");
+    converter->samples = NULL;
+    if (fd != -1 && close(fd) == -1 && !converter->error[0])
+        convert_fail(converter, errno, "close");
+    fd = -1;
+    if (!converter->error[0] && rename(tmp, converter->dst) == -1)
+        convert_fail(converter, errno, "rename");
+done:
+    if (converter->samples)
+        munmap(converter->samples, converter->size);
+    if (fd != -1)
+        close(fd);
+    if (converter->error[0])
+        unlink(tmp);
+    source_close(&converter->source);
+    free(converter->spans);
+    free(buffers[0]);
+    free(buffers[1]);
+    return NULL;
+}
+
+static void *
+compress_run(void *arg)
+{
+    converter_t *converter = arg;
+    char tmp[PATH_MAX];
+    snprintf(tmp, sizeof tmp, "%s.%d", converter->dst, (int) getpid());
+    converter->ncols = converter->nrows = TILE_SIZE;
+    size_t size = TILE_SIZE * TILE_SIZE * sizeof(int16_t);
+    int fd = open(converter->src, O_RDONLY);
+    if (fd == -1) {
+        convert_fail(converter, errno, NULL);
+        return NULL;
+    }
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == -1)
+        convert_fail(converter, errno, "fstat");
+    else if ((size_t) st.st_size != size)
+        convert_fail(converter, 0, "expected %ld bytes, got %ld", (long) size, (long) st.st_size);
+    else if ((map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED)
+        convert_fail(converter, errno, "mmap");
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+    madvise(map, size, MADV_SEQUENTIAL);
+    if (dem_write(converter, map, tmp) || rename(tmp, converter->dst) == -1) {
+        convert_fail(converter, errno, "rename");
+        unlink(tmp);
+    }
+    munmap(map, size);
+    return NULL;
+}
+
+static VALUE
+converter_run(converter_t *converter, void *(*run)(void *))
+{
+#if defined(HAVE_RB_THREAD_CALL_WITHOUT_GVL)
+    rb_thread_call_without_gvl(run, converter, NULL, NULL);
+#elif defined(HAVE_RB_THREAD_BLOCKING_REGION)
+    rb_thread_blocking_region((rb_blocking_function_t *) run, converter, NULL, NULL);
+#else
+    run(converter);
+#endif
+    if (converter->error_errno) {
+        errno = converter->error_errno;
+        rb_sys_fail(converter->error);
+    }
+    if (converter->error[0])
+        rb_raise(rb_eFormatError, "%s", converter->error);
+    return Qnil;
+}
+
+/* Converts src, an ArcASCII grid or a zip file containing one, into the
+ * tile dst, which is compressed if its name ends in .dem.  entry names the
+ * grid in the zip file, by default its first .asc file.  Raises
+ * CGIARCSI::FormatError if src is malformed. */
+static VALUE
+rb_SRTM90mDEM_convert(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_src, rb_dst, rb_entry;
+    rb_scan_args(argc, argv, "21", &rb_src, &rb_dst, &rb_entry);
+    converter_t converter;
+    memset(&converter, 0, sizeof converter);
+    converter.src = StringValueCStr(rb_src);
+    converter.dst = StringValueCStr(rb_dst);
+    converter.entry = NIL_P(rb_entry) ? NULL : StringValueCStr(rb_entry);
+    size_t len = strlen(converter.dst);
+    converter.compressed = len >= 4 && !strcmp(converter.dst + len - 4, ".dem");
+    converter_run(&converter, convert_run);
+    return rb_dst;
+}
+
+/* Compresses the uncompressed tile src into dst */
+static VALUE
+rb_SRTM90mDEM_compress(VALUE rb_self, VALUE rb_src, VALUE rb_dst)
+{
+    converter_t converter;
+    memset(&converter, 0, sizeof converter);
+    converter.src = StringValueCStr(rb_src);
+    converter.dst = StringValueCStr(rb_dst);
+    converter_run(&converter, compress_run);
+    return rb_dst;
+}
+
+static VALUE
+rb_SRTM90mDEM_threads(VALUE rb_self)
+{
+    return INT2NUM(srtm_threads);
+}
+
+static VALUE
+rb_SRTM90mDEM_set_threads(VALUE rb_self, VALUE rb_threads)
+{
+    int threads = NUM2INT(rb_threads);
+    if (threads < 1 || 256 < threads)
+        rb_raise(rb_eArgError, "threads must be between 1 and 256");
+    srtm_threads = threads;
+    return rb_threads;
+}
+
+void
+Init_csrtm(void)
+{
+    id_bilinear = rb_intern("bilinear");
+    id_max = rb_intern("max");
+    id_min = rb_intern("min");
+    id_nearest = rb_intern("nearest");
+    id_tile_filename = rb_intern("tile_filename");
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    srtm_threads = processors < 1 ? 1 : processors > 256 ? 256 : processors;
+    VALUE rb_mCGIARCSI = rb_define_module("CGIARCSI");
+    rb_eFormatError = rb_define_class_under(rb_mCGIARCSI, "FormatError", rb_eStandardError);
+    rb_mSRTM90mDEM = rb_define_module_under(rb_mCGIARCSI, "SRTM90mDEM");
+    rb_define_const(rb_mSRTM90mDEM, "OVERVIEW_RESOLUTION", rb_float_new(4.0 / SAMPLES_PER_DEGREE));
+    rb_define_module_function(rb_mSRTM90mDEM, "[]", rb_SRTM90mDEM_aref, 2);
+    rb_define_module_function(rb_mSRTM90mDEM, "available?", rb_SRTM90mDEM_available_p, 2);
+    rb_define_module_function(rb_mSRTM90mDEM, "compress", rb_SRTM90mDEM_compress, 2);
+    rb_define_module_function(rb_mSRTM90mDEM, "convert", rb_SRTM90mDEM_convert, -1);
+    rb_define_module_function(rb_mSRTM90mDEM, "elevations", rb_SRTM90mDEM_elevations, -1);
+    rb_define_module_function(rb_mSRTM90mDEM, "range", rb_SRTM90mDEM_range, -1);
+    rb_define_module_function(rb_mSRTM90mDEM, "threads", rb_SRTM90mDEM_threads, 0);
+    rb_define_module_function(rb_mSRTM90mDEM, "threads=", rb_SRTM90mDEM_set_threads, 1);
+}
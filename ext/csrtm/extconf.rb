@@ -0,0 +1,9 @@
+require "mkmf"
+
+$CFLAGS += " -Wall -Wextra -Wmissing-prototypes"
+have_header("ruby/thread.h")
+have_func("rb_thread_call_without_gvl", "ruby/thread.h")
+have_func("rb_thread_blocking_region")
+have_header("pthread.h") and have_library("pthread", "pthread_create")
+have_header("zlib.h") and have_library("z", "inflate")
+create_makefile("csrtm")
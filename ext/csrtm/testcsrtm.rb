@@ -0,0 +1,114 @@
+require "csrtm"
+require "fileutils"
+require "test/unit"
+require "tmpdir"
+require "zlib"
+
+class TC_CSRTM < Test::Unit::TestCase
+
+  SIZE = 6000
+  HEADER = "ncols 6000\r\nnrows 6000\r\nxllcorner 5\r\nyllcorner 40\r\ncellsize 0.0008333333333\r\nNODATA_value -9999\r\n"
+  ROWS = [[1, -2, 3], [-9999, 32767, 0]]
+  ZERO_ROW = Array.new(SIZE, 0).join(" ") + "\r\n"
+
+  def setup
+    @dir = Dir.mktmpdir
+    @tile = File.join(@dir, "test.tile")
+  end
+
+  def teardown
+    FileUtils.rm_rf(@dir)
+  end
+
+  def write(filename, data)
+    filename = File.join(@dir, filename)
+    File.open(filename, "wb") { |io| io.write(data) }
+    filename
+  end
+
+  def read_tile
+    File.open(@tile, "rb") { |io| io.read }
+  end
+
+  def pad(row)
+    row + Array.new(SIZE - row.length, 0)
+  end
+
+  # A whole tile with rows in its top left corner and zeros elsewhere
+  def asc(rows = ROWS)
+    HEADER + rows.collect { |row| pad(row).join(" ") + "\r\n" }.join + ZERO_ROW * (SIZE - rows.length)
+  end
+
+  def tile(rows = ROWS)
+    rows.collect { |row| pad(row).pack("s*") }.join + "\0" * (2 * SIZE * (SIZE - rows.length))
+  end
+
+  # A zip file containing a readme and data
+  def zip(name, data)
+    locals, centrals = "", ""
+    [["readme.txt", ""], [name, data]].each do |entry, content|
+      deflated = Zlib::Deflate.new(Zlib::DEFAULT_COMPRESSION, -Zlib::MAX_WBITS).deflate(content, Zlib::FINISH)
+      fields = [8, 0, 0, Zlib.crc32(content), deflated.length, content.length, entry.length, 0].pack("vvvVVVvv")
+      centrals << [0x02014b50, 20, 20, 0].pack("Vvvv") + fields + [0, 0, 0, 0, locals.length].pack("vvvVV") + entry
+      locals << [0x04034b50, 20, 0].pack("Vvv") + fields + entry + deflated
+    end
+    locals + centrals + [0x06054b50, 0, 0, 2, 2, centrals.length, locals.length, 0].pack("VvvvvVVv")
+  end
+
+  def test_asc
+    CGIARCSI::SRTM90mDEM.convert(write("test.asc", asc), @tile)
+    assert(tile == read_tile)
+  end
+
+  def test_zip
+    CGIARCSI::SRTM90mDEM.convert(write("test.zip", zip("Z_1_1.ASC", asc)), @tile)
+    assert(tile == read_tile)
+  end
+
+  def test_long_rows
+    rows = Array.new(5) { |i| Array.new(SIZE) { |j| (7 * i + 13 * j) % 20000 - 10000 } }
+    CGIARCSI::SRTM90mDEM.convert(write("test.asc", asc(rows)), @tile)
+    assert(tile(rows) == read_tile)
+  end
+
+  def test_compressed
+    rows = Array.new(16) { |k| Array.new(6000) { |i| k == 5 && i < 100 ? -9999 : (i * (k + 1)) % 4000 - 100 } }
+    write("test.tile", Array.new(6000) { |j| rows[j % 16].pack("s*") }.join)
+    dem = File.join(@dir, "test.dem")
+    CGIARCSI::SRTM90mDEM.compress(@tile, dem)
+    assert(File.size(dem) < File.size(@tile) / 4)
+    (class << CGIARCSI::SRTM90mDEM; self; end).send(:define_method, :tile_filename) do |x, y, download|
+      [x, y] == [38, 3] && dem
+    end
+    lat, lon = 50.0 - 1000.0 / 1200, 5.0 + 1234.0 / 1200
+    assert_equal(rows[1000 % 16][1234], CGIARCSI::SRTM90mDEM[lat, lon])
+    assert_nil(CGIARCSI::SRTM90mDEM[50.0 - 5.0 / 1200, 5.0 + 10.0 / 1200])
+    lats, lons = [lat * Math::PI / 180.0].pack("d"), [lon * Math::PI / 180.0].pack("d")
+    # The level 2 sample covering 1234, 1000 covers columns 1232 to 1247 of rows 992 to 1007
+    values = rows.collect { |row| row[1232...1248] }.flatten
+    assert_equal([values.min], CGIARCSI::SRTM90mDEM.elevations(lats, lons, :min, 16.0 / 1200))
+    assert_equal([values.max], CGIARCSI::SRTM90mDEM.elevations(lats, lons, :max, 16.0 / 1200))
+    # Without a resolution both give the sample itself
+    (0...16).each do |k|
+      lats, lons = [(50.0 - (1000.0 + k) / 1200) * Math::PI / 180.0].pack("d"), [(5.0 + (1234.0 + 7 * k) / 1200) * Math::PI / 180.0].pack("d")
+      [:min, :max].each do |interpolation|
+        assert_equal([rows[(1000 + k) % 16][1234 + 7 * k]], CGIARCSI::SRTM90mDEM.elevations(lats, lons, interpolation))
+      end
+    end
+    assert_equal([-100, 3899], CGIARCSI::SRTM90mDEM.range(45.1, 5.1, 49.9, 9.9))
+    assert_nil(CGIARCSI::SRTM90mDEM.range(50.0 - 5.0 / 1200, 5.0, 50.0 - 5.0 / 1200, 5.0 + 99.0 / 1200, 0))
+  end
+
+  def test_malformed
+    write("test.tile", "old")
+    # A grid smaller than a tile
+    small = HEADER.sub("ncols 6000", "ncols 3").sub("nrows 6000", "nrows 2") + ROWS.collect { |row| row.join(" ") + "\r\n" }.join
+    [asc.sub("-2", "-x"), asc.sub("32767", "32768"), asc.sub(" 0\r\n", "\r\n"), asc[0...-ZERO_ROW.length], asc.sub("ncols", "cols"), small].each do |data|
+      assert_raise(CGIARCSI::FormatError) { CGIARCSI::SRTM90mDEM.convert(write("test.asc", data), @tile) }
+    end
+    assert_raise(CGIARCSI::FormatError) { CGIARCSI::SRTM90mDEM.convert(write("test.zip", zip("test.asc", asc)), @tile, "other.asc") }
+    assert_equal("old", read_tile)
+    assert_equal(["test.asc", "test.tile", "test.zip"], Dir.entries(@dir).sort - [".", ".."])
+  end
+
+end
@@ -0,0 +1,238 @@
+#include <ruby.h>
+#include <math.h>
+
+#define R 6371000.0
+
+/* The great circle distance is compiled like that of ccoord so that it
+ * matches Coord#distance_to exactly. */
+#ifdef __GNUC__
+#define COORD_MATH __attribute__ ((optimize("fast-math")))
+#else
+#define COORD_MATH
+#endif
+
+/* The kinds of course object, as packed by Task#packed_course */
+enum {
+    KIND_NONE = 0,
+    KIND_CIRCLE = 1,
+    KIND_START = 2,
+    KIND_TAKEOFF = 3,
+    KIND_LINE = 4
+};
+
+/* Each course object is packed as COURSE_STRIDE doubles: its kind, the
+ * latitude and longitude of its centre, its radius, its start time, the
+ * ends of a line, and the distance along the course from its centre to
+ * goal */
+#define COURSE_STRIDE 10
+
+typedef struct {
+    int kind;
+    double lat, lon;
+    double radius;
+    double start_time;
+    double left_lat, left_lon, right_lat, right_lon;
+    double remaining;
+    /* The box outside which a fix cannot be inside a circle, or within
+     * which a segment must pass to cross a line */
+    double min_lat, max_lat, min_lon, max_lon;
+} object_t;
+
+typedef struct {
+    long n;
+    const double *lats;
+    const double *lons;
+    const double *times;
+} track_t;
+
+void Init_ctask(void);
+
+static double COORD_MATH
+distance(double lat1, double lon1, double lat2, double lon2)
+{
+    double d = sin(lat1) * sin(lat2) + cos(lat1) * cos(lat2) * cos(lon2 - lon1);
+    return d < 1.0 ? acos(d) : 0.0;
+}
+
+static void
+object_init(object_t *object, const double *packed)
+{
+    object->kind = (int) packed[0];
+    object->lat = packed[1];
+    object->lon = packed[2];
+    object->radius = packed[3];
+    object->start_time = packed[4];
+    object->left_lat = packed[5];
+    object->left_lon = packed[6];
+    object->right_lat = packed[7];
+    object->right_lon = packed[8];
+    object->remaining = packed[9];
+    if (object->kind == KIND_LINE) {
+        object->min_lat = fmin(object->left_lat, object->right_lat);
+        object->max_lat = fmax(object->left_lat, object->right_lat);
+        object->min_lon = fmin(object->left_lon, object->right_lon);
+        object->max_lon = fmax(object->left_lon, object->right_lon);
+    } else {
+        /* Pad the box slightly so that rounding never excludes a fix that
+         * Coord#distance_to puts on the circle */
+        double dlat = 1.001 * object->radius / R + 1e-9;
+        double max_abs_lat = fabs(object->lat) + dlat;
+        object->min_lat = object->lat - dlat;
+        object->max_lat = object->lat + dlat;
+        double dlon = max_abs_lat < 0.5 * M_PI - 1e-6 ? dlat / cos(max_abs_lat) : INFINITY;
+        /* Near the poles, or where the box would wrap around the
+         * antimeridian, any longitude may be within the radius */
+        if (object->lon - dlon >= -M_PI && object->lon + dlon <= M_PI) {
+            object->min_lon = object->lon - dlon;
+            object->max_lon = object->lon + dlon;
+        } else {
+            object->min_lon = -INFINITY;
+            object->max_lon = INFINITY;
+        }
+    }
+}
+
+static inline int
+object_box_contains(const object_t *object, double lat, double lon)
+{
+    return object->min_lat <= lat && lat <= object->max_lat && object->min_lon <= lon && lon <= object->max_lon;
+}
+
+/* As Coord.line_segment_intersection, returns the fraction along the
+ * segment from fix i to fix i + 1 at which it crosses object's line, or
+ * -1.0 if it does not */
+static double
+line_crossing(const object_t *object, const track_t *track, long i)
+{
+    double lat0 = object->left_lat, lon0 = object->left_lon;
+    double lat1 = object->right_lat, lon1 = object->right_lon;
+    double lat2 = track->lats[i], lon2 = track->lons[i];
+    double lat3 = track->lats[i + 1], lon3 = track->lons[i + 1];
+    double n0 = (lon1 - lon0) * (lat2 - lat0) - (lat1 - lat0) * (lon2 - lon0);
+    if (n0 == 0.0)
+        return -1.0;
+    double d = (lat1 - lat0) * (lon3 - lon2) - (lon1 - lon0) * (lat3 - lat2);
+    if (d == 0.0)
+        return -1.0;
+    if (!(0.0 <= n0 / d && n0 / d <= 1.0))
+        return -1.0;
+    double n1 = (lon3 - lon2) * (lat2 - lat0) - (lat3 - lat2) * (lon2 - lon0);
+    if (n1 == 0.0)
+        return -1.0;
+    if (!(0.0 <= n1 / d && n1 / d <= 1.0))
+        return -1.0;
+    return n0 / d;
+}
+
+/* Returns the fraction along the segment from fix i to fix i + 1 at which
+ * it reaches object, or -1.0 if it does not.  Circles are reached by
+ * entering them, the start of the speed section only once it is open, and
+ * a take off only by a segment starting after it opens. */
+static double
+object_crossing(const object_t *object, const track_t *track, long i)
+{
+    switch (object->kind) {
+    case KIND_CIRCLE:
+    case KIND_START:
+    case KIND_TAKEOFF:
+        {
+            if (!object_box_contains(object, track->lats[i + 1], track->lons[i + 1]))
+                return -1.0;
+            if (object->kind == KIND_TAKEOFF && track->times[i] < object->start_time)
+                return -1.0;
+            double distance0 = R * distance(object->lat, object->lon, track->lats[i], track->lons[i]);
+            double distance1 = R * distance(object->lat, object->lon, track->lats[i + 1], track->lons[i + 1]);
+            if (!(distance0 > object->radius && object->radius >= distance1))
+                return -1.0;
+            double delta = (distance0 - object->radius) / (distance0 - distance1);
+            /* Fix#interpolate rounds times up to the next second */
+            if (object->kind == KIND_START && ceil((1.0 - delta) * track->times[i] + delta * track->times[i + 1]) < object->start_time)
+                return -1.0;
+            return delta;
+        }
+    case KIND_LINE:
+        {
+            if (fmax(track->lats[i], track->lats[i + 1]) < object->min_lat || fmin(track->lats[i], track->lats[i + 1]) > object->max_lat)
+                return -1.0;
+            if (fmax(track->lons[i], track->lons[i + 1]) < object->min_lon || fmin(track->lons[i], track->lons[i + 1]) > object->max_lon)
+                return -1.0;
+            return line_crossing(object, track, i);
+        }
+    default:
+        return -1.0;
+    }
+}
+
+static const double *
+fix_buffer_column(VALUE rb_fix_buffer, const char *name, long n)
+{
+    VALUE rb_column = rb_funcall(rb_fix_buffer, rb_intern(name), 0);
+    Check_Type(rb_column, T_STRING);
+    if (RSTRING(rb_column)->len != n * (long) sizeof(double))
+        rb_raise(rb_eArgError, "fix buffer %s has %ld bytes, expected %ld", name, (long) RSTRING(rb_column)->len, n * (long) sizeof(double));
+    return (const double *) RSTRING(rb_column)->ptr;
+}
+
+/* Follows the track in fix_buffer around course, packed as by
+ * Task#packed_course, from its object first.  Each object is looked for
+ * from the segment after the one that reached the previous object.
+ * Returns [crossings, remaining], where crossings are the [object index,
+ * fix index, fraction] at which each object was reached, in order, and
+ * remaining is the least distance from any fix after the last crossing to
+ * the first object not reached, plus that object's distance to goal, or
+ * nil if every object was reached. */
+static VALUE
+rb_Task_s_find_crossings(VALUE rb_self, VALUE rb_fix_buffer, VALUE rb_course, VALUE rb_first)
+{
+    StringValue(rb_course);
+    if (RSTRING(rb_course)->len % (COURSE_STRIDE * sizeof(double)))
+        rb_raise(rb_eArgError, "malformed course");
+    long n_objects = RSTRING(rb_course)->len / (COURSE_STRIDE * sizeof(double));
+    long index = NUM2LONG(rb_first);
+    if (index < 0 || index > n_objects)
+        rb_raise(rb_eArgError, "first object out of range");
+    track_t track;
+    track.n = NUM2LONG(rb_funcall(rb_fix_buffer, rb_intern("length"), 0));
+    track.lats = fix_buffer_column(rb_fix_buffer, "lats", track.n);
+    track.lons = fix_buffer_column(rb_fix_buffer, "lons", track.n);
+    track.times = fix_buffer_column(rb_fix_buffer, "times", track.n);
+    const double *packed = (const double *) RSTRING(rb_course)->ptr;
+    object_t object;
+    if (index < n_objects)
+        object_init(&object, packed + COURSE_STRIDE * index);
+    VALUE rb_crossings = rb_ary_new();
+    long i, after = 0;
+    for (i = 0; index < n_objects && i + 1 < track.n; ++i) {
+        double delta = object_crossing(&object, &track, i);
+        if (delta < 0.0)
+            continue;
+        rb_ary_push(rb_crossings, rb_ary_new3(3, LONG2NUM(index), LONG2NUM(i), rb_float_new(delta)));
+        after = i + 1;
+        if (++index < n_objects)
+            object_init(&object, packed + COURSE_STRIDE * index);
+    }
+    VALUE rb_remaining = Qnil;
+    if (index < n_objects) {
+        double best = INFINITY;
+        for (i = after; i < track.n; ++i) {
+            double d = R * distance(object.lat, object.lon, track.lats[i], track.lons[i]) - object.radius;
+            if (d < best)
+                best = d;
+        }
+        rb_remaining = rb_float_new((best > 0.0 && best < INFINITY ? best : 0.0) + object.remaining);
+    }
+    RB_GC_GUARD(rb_course);
+    return rb_ary_new3(2, rb_crossings, rb_remaining);
+}
+
+void
+Init_ctask(void)
+{
+    VALUE rb_cTask = rb_define_class("Task", rb_cObject);
+    rb_define_const(rb_cTask, "KIND_NONE", INT2FIX(KIND_NONE));
+    rb_define_const(rb_cTask, "KIND_CIRCLE", INT2FIX(KIND_CIRCLE));
+    rb_define_const(rb_cTask, "KIND_START", INT2FIX(KIND_START));
+    rb_define_const(rb_cTask, "KIND_TAKEOFF", INT2FIX(KIND_TAKEOFF));
+    rb_define_const(rb_cTask, "KIND_LINE", INT2FIX(KIND_LINE));
+    rb_define_singleton_method(rb_cTask, "find_crossings", rb_Task_s_find_crossings, 3);
+}
@@ -0,0 +1,4 @@
+require "mkmf"
+
+$CFLAGS += " -Wall -Wextra -Wmissing-prototypes"
+create_makefile("ctask")
@@ -0,0 +1,170 @@
+require "igc"
+require "task"
+require "test/unit"
+
+class TC_CTask < Test::Unit::TestCase
+
+  DEG = Math::PI / 180.0
+
+  class Fix < Coord
+
+    attr_reader :time
+
+    def initialize(time, lat, lon, alt)
+      super(lat, lon, alt)
+      @time = time
+    end
+
+    def interpolate(fix, delta)
+      coord = super(fix, delta)
+      Fix.new(Time.at(((1.0 - delta) * @time.to_f + delta * fix.time.to_f).ceil).utc, coord.lat, coord.lon, coord.alt)
+    end
+
+  end
+
+  # An Array of fixes with the packed columns of IGC::FixArray
+  class FixArray < Array
+
+    %w(lat lon time).each do |column|
+      define_method("#{column}s") { collect { |fix| fix.send(column).to_f }.pack("d*") }
+    end
+
+  end
+
+  T0 = Time.utc(2008, 7, 1, 12, 0, 0)
+
+  def fixes(points)
+    FixArray.new(points.collect { |t, lat, lon| Fix.new(T0 + t, lat * DEG, lon * DEG, 1000) })
+  end
+
+  # A take off, a start opening at 12:10, a turnpoint, the end of the speed
+  # section and a goal line across the course
+  def task
+    course = [
+      Task::TakeOff.new(46.00 * DEG, 7.00 * DEG, 0, "TO", 1000, T0),
+      Task::StartOfSpeedSection.new(46.00 * DEG, 7.10 * DEG, 0, "SS", 3000, T0 + 600),
+      Task::Turnpoint.new(46.20 * DEG, 7.30 * DEG, 0, "TP", 400),
+      Task::EndOfSpeedSection.new(46.00 * DEG, 7.50 * DEG, 0, "ES", 1000),
+      Task::GoalLine.new(46.00 * DEG, 7.60 * DEG, 0, "GL", 1000, 90 * DEG),
+    ]
+    Task.new(nil, 1, :racetogoal, course)
+  end
+
+  # The track leaves the start circle before it opens, re-enters it, tags the
+  # turnpoint and flies east through the end of the speed section and goal
+  def track
+    points = [[0, 46.00, 7.00], [300, 46.00, 7.10], [500, 46.00, 7.20], [700, 46.00, 7.12]]
+    (1..10).each { |i| points << [700 + 60 * i, 46.00 + 0.02 * i, 7.12 + 0.018 * i] }
+    (1..10).each { |i| points << [1300 + 60 * i, 46.20 - 0.02 * i, 7.30 + 0.02 * i] }
+    (1..5).each { |i| points << [1900 + 60 * i, 46.00, 7.50 + 0.04 * i] }
+    fixes(points)
+  end
+
+  # The crossings found by trying each object in turn on each pair of fixes
+  def reference_crossings(task, fixes)
+    index = 0
+    index += 1 while task.course[index].is_a?(Task::TakeOff)
+    crossings = []
+    fixes.each_cons(2) do |fix0, fix1|
+      break if index == task.course.length
+      object = task.course[index]
+      fix = object.intersect?(fix0, fix1)
+      next unless fix
+      crossings << [object, fix]
+      index += 1
+    end
+    crossings
+  end
+
+  def assert_same_crossings(expected, actual)
+    assert_equal(expected.collect(&:first), actual.collect(&:first))
+    expected.zip(actual).each do |(object0, fix0), (object1, fix1)|
+      assert_equal(fix0.time, fix1.time)
+      assert_in_delta(fix0.lat, fix1.lat, 1e-12)
+      assert_in_delta(fix0.lon, fix1.lon, 1e-12)
+    end
+  end
+
+  def test_goal
+    t, f = task, track
+    flight = t.follow(f)
+    assert_equal(%w(SS TP ES GL), flight.crossings.collect { |object, fix| object.name })
+    assert_same_crossings(reference_crossings(t, f), flight.crossings)
+    assert(flight.goal?)
+    assert(flight.start_time >= T0 + 600)
+    assert_equal(flight.crossings[2][1].time - flight.start_time, flight.speed_section_time)
+  end
+
+  def test_not_in_goal
+    t, f = task, fixes(track[0, 12].collect { |fix| [fix.time - T0, fix.lat / DEG, fix.lon / DEG] })
+    flight = t.follow(f)
+    assert_same_crossings(reference_crossings(t, f), flight.crossings)
+    assert_equal(%w(SS), flight.crossings.collect { |object, fix| object.name })
+    assert(!flight.goal?)
+    assert_nil(flight.speed_section_time)
+    # The last fix is the closest to the turnpoint
+    turnpoint = t.course[2]
+    expected = f.last.distance_to(turnpoint) - turnpoint.radius + (2..3).inject(0.0) { |sum, i| sum + t.course[i].distance_to(t.course[i + 1]) }
+    assert_in_delta(expected, flight.distance_to_goal, 1e-6)
+  end
+
+  # A turnpoint whose circle wraps around the antimeridian is entered from
+  # the east side of it
+  def test_antimeridian
+    course = [
+      Task::TakeOff.new(0.0, 179.90 * DEG, 0, "TO", 1000, T0),
+      Task::StartOfSpeedSection.new(0.0, 179.96 * DEG, 0, "SS", 1000, T0),
+      Task::Turnpoint.new(0.0, -179.99 * DEG, 0, "TP", 3000),
+      Task::EndOfSpeedSection.new(0.0, -179.90 * DEG, 0, "ES", 1000),
+      Task::GoalLine.new(0.0, -179.85 * DEG, 0, "GL", 1000, 90 * DEG),
+    ]
+    t = Task.new(nil, 1, :racetogoal, course)
+    f = fixes([179.90, 179.93, 179.96, 179.995, -179.97, -179.93, -179.90, -179.87, -179.83].each_with_index.collect { |lon, i| [60 * i, 0.0, lon] })
+    flight = t.follow(f)
+    assert_equal(%w(SS TP ES GL), flight.crossings.collect { |object, fix| object.name })
+    assert_same_crossings(reference_crossings(t, f), flight.crossings)
+    assert(flight.crossings[1][1].lon > 0.0)
+  end
+
+  def test_random
+    srand(1)
+    t = task
+    # The track with a few hundred metres of noise added to each fix
+    20.times do
+      f = fixes(track.collect { |fix| [fix.time - T0, fix.lat / DEG + 0.006 * (rand - 0.5), fix.lon / DEG + 0.006 * (rand - 0.5)] })
+      assert_same_crossings(reference_crossings(t, f), t.follow(f).crossings)
+    end
+  end
+
+  # A plain Array of fixes, as IGC#fixes is after filtering, with its
+  # columns in a separate buffer
+  def test_array_and_fix_buffer
+    t, f = task, track
+    fix_buffer = IGC::FixBuffer.new(f)
+    flight = t.follow(Array.new(f), fix_buffer)
+    assert_same_crossings(t.follow(f).crossings, flight.crossings)
+    assert(flight.goal?)
+  end
+
+  # The distance to goal is found with the same great circle distance as
+  # Coord#distance_to, summed in the same order
+  def test_distance_to_goal_matches_coord
+    t, f = task, fixes(track[0, 12].collect { |fix| [fix.time - T0, fix.lat / DEG, fix.lon / DEG] })
+    turnpoint = t.course[2]
+    remaining = 0.0 + t.course[3].distance_to(t.course[4])
+    remaining += turnpoint.distance_to(t.course[3])
+    assert_equal(f.last.distance_to(turnpoint) - turnpoint.radius + remaining, t.follow(f).distance_to_goal)
+  end
+
+  def test_empty
+    flight = task.follow(fixes([]))
+    assert_equal([], flight.crossings)
+    assert_in_delta(task.distance - task.course[0].distance_to(task.course[1]), flight.distance_to_goal, 1e-6)
+  end
+
+  def test_malformed
+    assert_raise(ArgumentError) { Task.find_crossings(fixes([]), "x", 0) }
+    assert_raise(ArgumentError) { Task.find_crossings(fixes([]), task.packed_course, 6) }
+  end
+
+end
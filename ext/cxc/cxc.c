@@ -1,6 +1,17 @@
 #include <ruby.h>
+#ifdef HAVE_RUBY_THREAD_H
+#include <ruby/thread.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 #include <math.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/times.h>
 #include <time.h>
 #include <unistd.h>
@@ -9,19 +20,25 @@
 
 #define R 6371.0
 #define CIRCUIT_WEIGHT 256.0
+#define PARALLEL_CHUNK 16
+#define PARALLEL_TIE 1.0e-9
+#define BBOX_MAX_POINTS 6
+#define BBOX_SLACK 1.0e-7
+/* 64MB of candidates, beyond which the search gives way to the sweep */
+#define BBOX_MAX_CANDIDATES (1 << 21)
+#define DOT_BLOCK 16
+#define DOT_MARGIN 1.0e-12
+#define MAX_LEAGUES 8
+#define BUDGET_CHECK 1024
+#define PYRAMID_LEVELS 3
 
 static VALUE id_alt;
+static VALUE id_aref;
 static VALUE id_lat;
+static VALUE id_length;
 static VALUE id_lon;
 static VALUE id_new;
-static VALUE id_time;
-static VALUE id_to_i;
-
-typedef struct {
-    double cos_lat;
-    double sin_lat;
-    double lon;
-} fix_t;
+static VALUE id_set_bound;
 
 typedef struct {
     int index;
@@ -29,16 +46,34 @@ typedef struct {
 } limit_t;
 
 typedef struct {
-    VALUE rb_league;
+    int begin;
+    int end;
+    int left;
+    int right;
+    double x;
+    double y;
+    double z;
+    double radius;
+} node_t;
+
+typedef struct {
     VALUE rb_fixes;
     int n;
-    fix_t *fixes;
-    time_t *times;
+    int capacity;
+    double *x;
+    double *y;
+    double *z;
+    int *indexes;
     double *sigma_delta;
     limit_t *before;
     limit_t *after;
+    int limits_n;
     int *last_finish;
     int *best_start;
+    int circuit_n;
+    double circuit_bound;
+    node_t *nodes;
+    int tree_n;
     double max_delta;
 } track_t;
 
@@ -47,6 +82,143 @@ typedef struct {
     double max;
 } bound_t;
 
+typedef union {
+    double value;
+    uint64_t bits;
+} shared_bound_t;
+
+typedef void (*track_dots_t)(const track_t *track, int i, int begin, int end, double *dots);
+
+typedef double (*track_search_t)(const track_t *track, int begin, int end, double bound, shared_bound_t *shared, int *indexes);
+
+typedef struct {
+    const track_t *track;
+    track_search_t search;
+    int next;
+    int end;
+    int workers;
+    int n;
+    double bound;
+    shared_bound_t shared;
+    double *bounds;
+    int *indexes;
+} parallel_t;
+
+typedef struct {
+    int n;
+    int circuit;
+    double ratio;
+} shape_t;
+
+typedef struct {
+    double bound;
+    int nodes[BBOX_MAX_POINTS];
+} candidate_t;
+
+typedef struct {
+    int n;
+    int capacity;
+    candidate_t *candidates;
+} heap_t;
+
+/* The best flight of the previous search and, if that search ran out of
+ * time, an upper bound on the distance of any flight */
+typedef struct {
+    int indexes[BBOX_MAX_POINTS];
+    double upper;
+} warm_t;
+
+typedef struct {
+    struct timespec deadline;
+    int expired;
+    int checks;
+} budget_t;
+
+/* Flight types, in an order in which the best flight of each type bounds
+ * the search for the types after it */
+enum {
+    FLIGHT_OPEN0,
+    FLIGHT_OPEN1,
+    FLIGHT_OPEN2,
+    FLIGHT_OPEN3,
+    FLIGHT_CIRCUIT2,
+    FLIGHT_CIRCUIT3FAI,
+    FLIGHT_CIRCUIT3,
+    FLIGHT_CIRCUIT4,
+    FLIGHTS
+};
+
+typedef struct {
+    const char *name;
+    int turnpoints;
+    int circuit;
+    double ratio;
+} flight_spec_t;
+
+typedef struct {
+    const char *name;
+    int n;
+    int flights[FLIGHTS];
+} league_spec_t;
+
+typedef struct {
+    int n;
+    const league_spec_t *specs[MAX_LEAGUES];
+    VALUE rb_leagues[MAX_LEAGUES];
+    VALUE rb_results[MAX_LEAGUES];
+} leagues_t;
+
+typedef struct {
+    track_t *track;
+    int bbox;
+    warm_t *warm;
+    budget_t *budget;
+    unsigned done;
+    double bounds[FLIGHTS];
+    int fixes[FLIGHTS][BBOX_MAX_POINTS];
+    track_t *downsampled;
+} scoring_t;
+
+typedef struct {
+    VALUE rb_league;
+    track_t *track;
+    warm_t warm[FLIGHTS];
+} optimizer_t;
+
+/* The threads used by the sweep engine's outer turnpoint loops.  The bbox
+ * engine's best-first search is serial and ignores this. */
+static int xc_threads = 1;
+static ID xc_simd;
+static ID id_avx2;
+static ID id_scalar;
+static ID id_sse2;
+static ID xc_engine;
+static ID id_bbox;
+static ID id_sweep;
+
+static const flight_spec_t flight_specs[FLIGHTS] = {
+    { "Open0",       0, 0, 0.0  },
+    { "Open1",       1, 0, 0.0  },
+    { "Open2",       2, 0, 0.0  },
+    { "Open3",       3, 0, 0.0  },
+    { "Circuit2",    2, 1, 0.0  },
+    { "Circuit3FAI", 3, 1, 0.28 },
+    { "Circuit3",    3, 1, 0.0  },
+    { "Circuit4",    4, 1, 0.15 },
+};
+
+/* The flights scored by each league, in the order they are returned */
+static const league_spec_t league_specs[] = {
+    { "Open",  1, { FLIGHT_OPEN0 } },
+    { "FRCFD", 7, { FLIGHT_OPEN0, FLIGHT_OPEN1, FLIGHT_OPEN2, FLIGHT_CIRCUIT2, FLIGHT_CIRCUIT3, FLIGHT_CIRCUIT3FAI, FLIGHT_CIRCUIT4 } },
+    { "UKXCL", 4, { FLIGHT_OPEN0, FLIGHT_OPEN1, FLIGHT_OPEN2, FLIGHT_OPEN3 } },
+};
+
+#define LEAGUES ((int) (sizeof league_specs / sizeof league_specs[0]))
+
+/* Downsampling thresholds of the levels of the anytime pyramid, finest first */
+static const double pyramid_thresholds[PYRAMID_LEVELS] = { 0.125 / R, 0.5 / R, 2.0 / R };
+
 static inline double track_delta(const track_t *track, int i, int j) __attribute__ ((nonnull(1))) __attribute__ ((pure));
 static inline int track_forward(const track_t *track, int i, double d) __attribute__ ((nonnull(1))) __attribute__ ((pure));
 static inline int track_fast_forward(const track_t *track, int i, double d) __attribute__ ((nonnull(1))) __attribute__ ((pure));
@@ -54,7 +226,7 @@ static inline int track_backward(const track_t *track, int i, double d) __attrib
 static inline int track_fast_backward(const track_t *track, int i, double d) __attribute__ ((nonnull(1))) __attribute__ ((pure));
 static inline int track_first_at_least(const track_t *track, int i, int begin, int end, double bound) __attribute__ ((nonnull(1))) __attribute__ ((pure));
 static inline int track_last_at_least(const track_t *track, int i, int begin, int end, double bound) __attribute__ ((nonnull(1))) __attribute__ ((pure));
-static track_t *track_new(VALUE rb_league, VALUE rb_fixes) __attribute__ ((malloc));
+static track_t *track_new(VALUE rb_fixes, VALUE rb_fix_buffer) __attribute__ ((malloc));
 static track_t *track_downsample(track_t *track, double threshold) __attribute__ ((malloc));
 void Init_cxc(void);
 
@@ -84,15 +256,71 @@ rb_ary_push_unless_nil(VALUE rb_self, VALUE rb_value)
     return rb_self;
 }
 
+static inline double
+dot_to_delta(double dot)
+{
+    return dot < 1.0 ? dot > -1.0 ? acos(dot) : M_PI : 0.0;
+}
+
+static inline double
+delta_to_dot(double delta)
+{
+    /* Anything nearer than a negative bound is out of reach, anything
+     * beyond pi is unreachable */
+    return delta < 0.0 ? 2.0 : delta < M_PI ? cos(delta) + DOT_MARGIN : -1.0 + DOT_MARGIN;
+}
+
 static inline double
 track_delta(const track_t *track, int i, int j)
 {
-    const fix_t *fix_i = track->fixes + i;
-    const fix_t *fix_j = track->fixes + j;
-    double x = fix_i->sin_lat * fix_j->sin_lat + fix_i->cos_lat * fix_j->cos_lat * cos(fix_i->lon - fix_j->lon);
-    return x < 1.0 ? acos(x) : 0.0;
+    return dot_to_delta(track->x[i] * track->x[j] + track->y[i] * track->y[j] + track->z[i] * track->z[j]);
+}
+
+static void
+track_dots_scalar(const track_t *track, int i, int begin, int end, double *dots)
+{
+    double x = track->x[i], y = track->y[i], z = track->z[i];
+    int j;
+    for (j = begin; j < end; ++j)
+        *dots++ = x * track->x[j] + y * track->y[j] + z * track->z[j];
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+static void __attribute__ ((target("sse2")))
+track_dots_sse2(const track_t *track, int i, int begin, int end, double *dots)
+{
+    __m128d x = _mm_set1_pd(track->x[i]), y = _mm_set1_pd(track->y[i]), z = _mm_set1_pd(track->z[i]);
+    int j;
+    for (j = begin; j + 2 <= end; j += 2, dots += 2) {
+        __m128d dot = _mm_mul_pd(x, _mm_loadu_pd(track->x + j));
+        dot = _mm_add_pd(dot, _mm_mul_pd(y, _mm_loadu_pd(track->y + j)));
+        dot = _mm_add_pd(dot, _mm_mul_pd(z, _mm_loadu_pd(track->z + j)));
+        _mm_storeu_pd(dots, dot);
+    }
+    if (j < end)
+        *dots = track->x[i] * track->x[j] + track->y[i] * track->y[j] + track->z[i] * track->z[j];
+}
+
+static void __attribute__ ((target("avx2")))
+track_dots_avx2(const track_t *track, int i, int begin, int end, double *dots)
+{
+    __m256d x = _mm256_set1_pd(track->x[i]), y = _mm256_set1_pd(track->y[i]), z = _mm256_set1_pd(track->z[i]);
+    int j;
+    for (j = begin; j + 4 <= end; j += 4, dots += 4) {
+        __m256d dot = _mm256_mul_pd(x, _mm256_loadu_pd(track->x + j));
+        dot = _mm256_add_pd(dot, _mm256_mul_pd(y, _mm256_loadu_pd(track->y + j)));
+        dot = _mm256_add_pd(dot, _mm256_mul_pd(z, _mm256_loadu_pd(track->z + j)));
+        _mm256_storeu_pd(dots, dot);
+    }
+    for (; j < end; ++j)
+        *dots++ = track->x[i] * track->x[j] + track->y[i] * track->y[j] + track->z[i] * track->z[j];
 }
 
+#endif
+
+static track_dots_t track_dots = track_dots_scalar;
+
 static inline int
 track_forward(const track_t *track, int i, double d)
 {
@@ -144,16 +372,24 @@ track_fast_backward(const track_t *track, int i, double d)
 static inline int
 track_furthest_from(const track_t *track, int i, int begin, int end, double bound, double *out)
 {
+    double dots[DOT_BLOCK];
+    double dot_bound = delta_to_dot(bound);
     int result = -1, j;
     for (j = begin; j < end; ) {
-        double d = track_delta(track, i, j);
-        if (d > bound) {
-            bound = *out = d;
-            result = j;
-            ++j;
-        } else {
-            j = track_fast_forward(track, j, bound - d);
+        int n = end - j < DOT_BLOCK ? end - j : DOT_BLOCK, k;
+        track_dots(track, i, j, j + n, dots);
+        for (k = 0; k < n; ++k) {
+            if (dots[k] < dot_bound) {
+                double d = dot_to_delta(dots[k]);
+                if (d > bound) {
+                    bound = *out = d;
+                    dot_bound = delta_to_dot(bound);
+                    result = j + k;
+                }
+            }
         }
+        j += n - 1;
+        j = track_fast_forward(track, j, bound - dot_to_delta(dots[n - 1]));
     }
     return result;
 }
@@ -218,63 +454,172 @@ track_last_at_least(const track_t *track, int i, int begin, int end, double boun
     return -1;
 }
 
-static track_t *
-track_new_common(track_t *track)
+static inline double
+shared_bound_get(shared_bound_t *shared, double bound)
 {
-    /* Compute before lookup table */
-    track->before = ALLOC_N(limit_t, track->n);
-    track->before[0].index = 0;
-    track->before[0].distance = 0.0;
-    int i;
-    for (i = 1; i < track->n; ++i)
-        track->before[i].index = track_furthest_from(track, i, 0, i, track->before[i - 1].distance - track->max_delta, &track->before[i].distance);
-
-    /* Compute after lookup table */
-    track->after = ALLOC_N(limit_t, track->n);
-    for (i = 0; i < track->n - 1; ++i)
-        track->after[i].index = track_furthest_from(track, i, i + 1, track->n, track->after[i - 1].distance - track->max_delta, &track->after[i].distance);
-    track->after[track->n - 1].index = track->n - 1;
-    track->after[track->n - 1].distance = 0.0;
-
-    return track;
+    shared_bound_t current;
+    current.bits = __atomic_load_n(&shared->bits, __ATOMIC_RELAXED);
+    /* Stay fractionally below the shared bound so that ties are still found
+     * in every chunk and resolved by turnpoint order when merging */
+    double tied = current.value * (1.0 - PARALLEL_TIE);
+    return tied > bound ? tied : bound;
 }
 
-static track_t *
-track_new(VALUE rb_league, VALUE rb_fixes)
+static inline void
+shared_bound_raise(shared_bound_t *shared, double bound)
 {
-    Check_Type(rb_fixes, T_ARRAY);
+    shared_bound_t current, next;
+    current.bits = __atomic_load_n(&shared->bits, __ATOMIC_RELAXED);
+    next.value = bound;
+    while (bound > current.value)
+        if (__atomic_compare_exchange_n(&shared->bits, &current.bits, next.bits, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+}
 
-    track_t *track = ALLOC(track_t);
-    memset(track, 0, sizeof(track_t));
-    track->rb_league = rb_league;
-    track->rb_fixes = rb_fixes;
-    track->n = RARRAY(rb_fixes)->len;
+static void
+track_reserve(track_t *track, int n)
+{
+    if (n <= track->capacity)
+        return;
+    int capacity = track->capacity ? track->capacity : 1024;
+    while (capacity < n)
+        capacity *= 2;
+    REALLOC_N(track->x, double, capacity);
+    REALLOC_N(track->y, double, capacity);
+    REALLOC_N(track->z, double, capacity);
+    REALLOC_N(track->sigma_delta, double, capacity);
+    REALLOC_N(track->before, limit_t, capacity);
+    REALLOC_N(track->after, limit_t, capacity);
+    track->capacity = capacity;
+}
 
-    /* Compute cos_lat, sin_lat and lon lookup tables */
-    track->fixes = ALLOC_N(fix_t, track->n);
-    track->times = ALLOC_N(time_t, track->n);
+/* Extend the sigma_delta lookup table over the fixes appended since the
+ * track had n_old fixes */
+static void
+track_extend(track_t *track, int n_old)
+{
     int i;
-    for (i = 0; i < track->n; ++i) {
-        VALUE rb_fix = RARRAY(rb_fixes)->ptr[i];
-        double lat = NUM2DBL(rb_funcall(rb_fix, id_lat, 0));
-        track->fixes[i].cos_lat = cos(lat);
-        track->fixes[i].sin_lat = sin(lat);
-        track->fixes[i].lon = NUM2DBL(rb_funcall(rb_fix, id_lon, 0));
-        track->times[i] = NUM2INT(rb_funcall(rb_funcall(rb_fix, id_time, 0), id_to_i, 0));
-    }
-
-    /* Compute max_delta and sigma_delta lookup table */
-    track->max_delta = 0.0;
-    track->sigma_delta = ALLOC_N(double, track->n);
-    track->sigma_delta[0] = 0.0;
-    for (i = 1; i < track->n; ++i) {
+
+    /* Extend max_delta and sigma_delta lookup table */
+    if (n_old == 0 && track->n > 0) {
+        track->max_delta = 0.0;
+        track->sigma_delta[0] = 0.0;
+    }
+    for (i = n_old > 0 ? n_old : 1; i < track->n; ++i) {
         double delta = track_delta(track, i - 1, i);
         track->sigma_delta[i] = track->sigma_delta[i - 1] + delta;
         if (delta > track->max_delta)
             track->max_delta = delta;
     }
+}
+
+/* Extend the before and after lookup tables, which only the sweep uses,
+ * over the fixes appended since they were last computed.  Existing entries
+ * only change where an appended fix is further away than the previous
+ * after limit. */
+static void
+track_compute_limits(track_t *track)
+{
+    int n_old = track->limits_n, i;
+
+    /* Extend before lookup table */
+    for (i = n_old; i < track->n; ++i) {
+        if (i == 0) {
+            track->before[0].index = 0;
+            track->before[0].distance = 0.0;
+        } else {
+            track->before[i].index = track_furthest_from(track, i, 0, i, track->before[i - 1].distance - track->max_delta, &track->before[i].distance);
+        }
+    }
+
+    /* Extend after lookup table */
+    for (i = 0; i < n_old; ++i) {
+        double distance = 0.0;
+        int j = track_furthest_from(track, i, n_old, track->n, track->after[i].distance, &distance);
+        if (j != -1) {
+            track->after[i].index = j;
+            track->after[i].distance = distance;
+        }
+    }
+    for (i = n_old; i < track->n - 1; ++i)
+        track->after[i].index = track_furthest_from(track, i, i + 1, track->n, i ? track->after[i - 1].distance - track->max_delta : -1.0, &track->after[i].distance);
+    if (track->n > n_old) {
+        track->after[track->n - 1].index = track->n - 1;
+        track->after[track->n - 1].distance = 0.0;
+    }
+    track->limits_n = track->n;
+}
+
+static inline void
+track_set_fix(track_t *track, int i, double lat, double lon)
+{
+    double cos_lat = cos(lat);
+    track->x[i] = cos_lat * cos(lon);
+    track->y[i] = cos_lat * sin(lon);
+    track->z[i] = sin(lat);
+}
+
+static const double *
+fix_buffer_column(VALUE rb_fix_buffer, const char *name, int n)
+{
+    VALUE rb_column = rb_funcall(rb_fix_buffer, rb_intern(name), 0);
+    Check_Type(rb_column, T_STRING);
+    if (RSTRING(rb_column)->len != n * (long) sizeof(double))
+        rb_raise(rb_eArgError, "fix buffer %s has %ld bytes, expected %ld", name, (long) RSTRING(rb_column)->len, n * (long) sizeof(double));
+    return (const double *) RSTRING(rb_column)->ptr;
+}
+
+/* Fixes may be an Array or anything else that responds to length and [],
+ * such as an IGC::FixArray, which only creates the fixes that are used */
+static int
+fixes_length(VALUE rb_fixes)
+{
+    if (TYPE(rb_fixes) == T_ARRAY)
+        return RARRAY(rb_fixes)->len;
+    return NUM2INT(rb_funcall(rb_fixes, id_length, 0));
+}
+
+static VALUE
+fixes_entry(VALUE rb_fixes, int i)
+{
+    if (TYPE(rb_fixes) == T_ARRAY)
+        return RARRAY(rb_fixes)->ptr[i];
+    return rb_funcall(rb_fixes, id_aref, 1, INT2FIX(i));
+}
+
+/* Append the fixes in rb_fixes, reading their positions from rb_fix_buffer
+ * if it is not nil */
+static void
+track_append(track_t *track, VALUE rb_fixes, VALUE rb_fix_buffer)
+{
+    int n_old = track->n, n = fixes_length(rb_fixes), i;
+    track_reserve(track, n_old + n);
+
+    /* Compute unit vector lookup tables */
+    if (NIL_P(rb_fix_buffer)) {
+        for (i = 0; i < n; ++i) {
+            VALUE rb_fix = fixes_entry(rb_fixes, i);
+            track_set_fix(track, n_old + i, NUM2DBL(rb_funcall(rb_fix, id_lat, 0)), NUM2DBL(rb_funcall(rb_fix, id_lon, 0)));
+        }
+    } else {
+        const double *lats = fix_buffer_column(rb_fix_buffer, "lats", n);
+        const double *lons = fix_buffer_column(rb_fix_buffer, "lons", n);
+        for (i = 0; i < n; ++i)
+            track_set_fix(track, n_old + i, lats[i], lons[i]);
+    }
+
+    track->n += n;
+    track_extend(track, n_old);
+}
 
-    return track_new_common(track);
+static track_t *
+track_new(VALUE rb_fixes, VALUE rb_fix_buffer)
+{
+    track_t *track = ALLOC(track_t);
+    memset(track, 0, sizeof(track_t));
+    track->rb_fixes = rb_fixes;
+    track_append(track, rb_fixes, rb_fix_buffer);
+    return track;
 }
 
 static track_t *
@@ -282,22 +627,30 @@ track_downsample(track_t *track, double threshold)
 {
     track_t *result = ALLOC(track_t);
     memset(result, 0, sizeof(track_t));
-    result->rb_league = track->rb_league;
     result->rb_fixes = Qnil;
-    result->fixes = ALLOC_N(fix_t, track->n);
-    result->times = ALLOC_N(time_t, track->n);
+    result->capacity = track->n;
+    result->x = ALLOC_N(double, track->n);
+    result->y = ALLOC_N(double, track->n);
+    result->z = ALLOC_N(double, track->n);
+    result->indexes = ALLOC_N(int, track->n);
     result->max_delta = 0.0;
     result->sigma_delta = ALLOC_N(double, track->n);
-    result->fixes[0] = track->fixes[0];
-    result->times[0] = track->times[0];
+    result->before = ALLOC_N(limit_t, track->n);
+    result->after = ALLOC_N(limit_t, track->n);
+    result->x[0] = track->x[0];
+    result->y[0] = track->y[0];
+    result->z[0] = track->z[0];
+    result->indexes[0] = track->indexes ? track->indexes[0] : 0;
     result->sigma_delta[0] = 0.0;
     result->n = 1;
     int i = 0, j;
     for (j = 1; j < track->n; ++j) {
         double delta = track_delta(track, i, j);
         if (delta > threshold) {
-            result->fixes[result->n] = track->fixes[j];
-            result->times[result->n] = track->times[j];
+            result->x[result->n] = track->x[j];
+            result->y[result->n] = track->y[j];
+            result->z[result->n] = track->z[j];
+            result->indexes[result->n] = track->indexes ? track->indexes[j] : j;
             result->sigma_delta[result->n] = result->sigma_delta[result->n - 1] + delta;
             if (delta > result->max_delta)
                 result->max_delta = delta;
@@ -305,62 +658,241 @@ track_downsample(track_t *track, double threshold)
             i = j;
         }
     }
-    return track_new_common(result);
+    track_extend(result, 0);
+    return result;
+}
+
+static int
+track_compute_node(track_t *track, int *n, int begin, int end, double *sum)
+{
+    int index = (*n)++;
+    node_t *node = track->nodes + index;
+    node->begin = begin;
+    node->end = end;
+    if (end - begin == 1) {
+        node->left = node->right = -1;
+        node->x = sum[0] = track->x[begin];
+        node->y = sum[1] = track->y[begin];
+        node->z = sum[2] = track->z[begin];
+        node->radius = 0.0;
+        return index;
+    }
+    double left_sum[3], right_sum[3];
+    int middle = (begin + end) / 2;
+    int left = track_compute_node(track, n, begin, middle, left_sum);
+    int right = track_compute_node(track, n, middle, end, right_sum);
+    node = track->nodes + index;
+    node->left = left;
+    node->right = right;
+    sum[0] = left_sum[0] + right_sum[0];
+    sum[1] = left_sum[1] + right_sum[1];
+    sum[2] = left_sum[2] + right_sum[2];
+    double r = sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+    node->x = sum[0] / r;
+    node->y = sum[1] / r;
+    node->z = sum[2] / r;
+    /* The cap around the centre must contain every fix in the range */
+    double min_dot = 1.0;
+    int i;
+    for (i = begin; i < end; ++i) {
+        double dot = node->x * track->x[i] + node->y * track->y[i] + node->z * track->z[i];
+        if (dot < min_dot)
+            min_dot = dot;
+    }
+    node->radius = min_dot < 1.0 ? acos(min_dot) : 0.0;
+    return index;
+}
+
+static void
+track_compute_tree(track_t *track)
+{
+    if (track->tree_n == track->n || track->n == 0)
+        return;
+    REALLOC_N(track->nodes, node_t, 2 * track->n - 1);
+    track->tree_n = track->n;
+    int n = 0;
+    double sum[3];
+    track_compute_node(track, &n, 0, track->n, sum);
+}
+
+static inline double
+track_node_delta_min(const track_t *track, int node, int i)
+{
+    const node_t *n = track->nodes + node;
+    double d = dot_to_delta(n->x * track->x[i] + n->y * track->y[i] + n->z * track->z[i]) - n->radius - BBOX_SLACK;
+    return d > 0.0 ? d : 0.0;
+}
+
+/* Return the last fix in [begin, end) nearer than bound to fix i, visiting
+ * the tree right to left and skipping caps that are entirely too far away */
+static int
+track_node_last_nearer_than(const track_t *track, int node, int i, int begin, int end, double bound)
+{
+    const node_t *n = track->nodes + node;
+    if (n->end <= begin || end <= n->begin || track_node_delta_min(track, node, i) >= bound)
+        return -1;
+    if (n->end - n->begin <= DOT_BLOCK) {
+        double dots[DOT_BLOCK];
+        double dot_bound = cos(bound) - DOT_MARGIN;
+        int first = n->begin > begin ? n->begin : begin;
+        int last = n->end < end ? n->end : end;
+        int j;
+        track_dots(track, i, first, last, dots);
+        for (j = last - 1; j >= first; --j)
+            if (dots[j - first] > dot_bound && dot_to_delta(dots[j - first]) < bound)
+                return j;
+        return -1;
+    }
+    int j = track_node_last_nearer_than(track, n->right, i, begin, end, bound);
+    return j != -1 ? j : track_node_last_nearer_than(track, n->left, i, begin, end, bound);
 }
 
 static void
 track_compute_circuit_tables(track_t *track, double circuit_bound)
 {
-    track->last_finish = ALLOC_N(int, track->n);
-    track->best_start = ALLOC_N(int, track->n);
-    int current_best_start = 0, i, j;
+    if (track->circuit_n == track->n && track->circuit_bound == circuit_bound)
+        return;
+    int n_old = track->circuit_bound == circuit_bound ? track->circuit_n : 0, i;
+    track_compute_tree(track);
+    REALLOC_N(track->last_finish, int, track->n);
+    REALLOC_N(track->best_start, int, track->n);
+    /* Earlier starts can only gain later finishes among the appended fixes */
+    for (i = 0; i < n_old; ++i) {
+        int j = track_node_last_nearer_than(track, 0, i, n_old, track->n, circuit_bound);
+        if (j != -1)
+            track->last_finish[i] = j;
+    }
+    for (i = n_old; i < track->n; ++i)
+        track->last_finish[i] = track_node_last_nearer_than(track, 0, i, i, track->n, circuit_bound);
+    /* Every fix closes a circuit with itself, so last_finish[i] >= i and the
+     * best start so far is always still in range */
+    int current_best_start = 0;
     for (i = 0; i < track->n; ++i) {
-        for (j = track->n - 1; j >= i; ) {
-            double error = track_delta(track, i, j);
-            if (error < circuit_bound) {
-                track->last_finish[i] = j;
-                break;
-            } else {
-                j = track_fast_backward(track, j, error - circuit_bound);
-            }
-        }
         if (track->last_finish[i] > track->last_finish[current_best_start])
             current_best_start = i;
-        if (track->last_finish[current_best_start] < i) {
-            current_best_start = 0;
-            for (j = 1; j <= i; ++j)
-                if (track->last_finish[j] > track->last_finish[current_best_start])
-                    current_best_start = j;
-        }
         track->best_start[i] = current_best_start;
     }
+    track->circuit_n = track->n;
+    track->circuit_bound = circuit_bound;
 }
 
 static void
 track_delete(track_t *track)
 {
     if (track) {
-        xfree(track->fixes);
-        xfree(track->times);
+        xfree(track->x);
+        xfree(track->y);
+        xfree(track->z);
+        xfree(track->indexes);
         xfree(track->sigma_delta);
         xfree(track->before);
         xfree(track->after);
         xfree(track->last_finish);
         xfree(track->best_start);
+        xfree(track->nodes);
         xfree(track);
     }
 }
 
 static void
-track_indexes_to_times(const track_t *track, int n, const int *indexes, time_t *times)
+track_indexes_to_fixes(const track_t *track, int n, const int *indexes, int *fixes)
 {
     int i;
     for (i = 0; i < n; ++i)
-        times[i] = indexes[i] == -1 ? -1 : track->times[indexes[i]];
+        fixes[i] = indexes[i] == -1 || !track->indexes ? indexes[i] : track->indexes[indexes[i]];
+}
+
+static void *
+track_parallel_worker(void *arg)
+{
+    parallel_t *parallel = arg;
+    int slot = __atomic_fetch_add(&parallel->workers, 1, __ATOMIC_RELAXED);
+    int *indexes = parallel->indexes + slot * parallel->n;
+    int found[parallel->n];
+    double bound = parallel->bound;
+    parallel->bounds[slot] = bound;
+    while (1) {
+        int begin = __atomic_fetch_add(&parallel->next, PARALLEL_CHUNK, __ATOMIC_RELAXED);
+        if (begin >= parallel->end)
+            break;
+        int end = begin + PARALLEL_CHUNK < parallel->end ? begin + PARALLEL_CHUNK : parallel->end;
+        memcpy(found, indexes, sizeof found);
+        bound = parallel->search(parallel->track, begin, end, shared_bound_get(&parallel->shared, bound), &parallel->shared, indexes);
+        if (memcmp(found, indexes, sizeof found))
+            parallel->bounds[slot] = bound;
+    }
+    return NULL;
+}
+
+static void *
+track_parallel_run(void *arg)
+{
+    parallel_t *parallel = arg;
+#ifdef HAVE_PTHREAD_H
+    pthread_t threads[xc_threads];
+    int i, started = 0;
+    for (i = 1; i < xc_threads; ++i)
+        if (pthread_create(&threads[started], NULL, track_parallel_worker, parallel) == 0)
+            ++started;
+    track_parallel_worker(parallel);
+    for (i = 0; i < started; ++i)
+        pthread_join(threads[i], NULL);
+#else
+    track_parallel_worker(parallel);
+#endif
+    return NULL;
+}
+
+static double
+track_search(const track_t *track, track_search_t search, int begin, int end, double bound, int n, int *indexes)
+{
+    if (xc_threads <= 1 || end - begin <= PARALLEL_CHUNK)
+        return search(track, begin, end, bound, NULL, indexes);
+    parallel_t parallel;
+    parallel.track = track;
+    parallel.search = search;
+    parallel.next = begin;
+    parallel.end = end;
+    parallel.workers = 0;
+    parallel.n = n;
+    parallel.bound = bound;
+    parallel.shared.value = bound;
+    parallel.bounds = ALLOCA_N(double, xc_threads);
+    parallel.indexes = ALLOCA_N(int, xc_threads * n);
+    int i, j;
+    for (i = 0; i < xc_threads * n; ++i)
+        parallel.indexes[i] = -1;
+#if defined(HAVE_RB_THREAD_CALL_WITHOUT_GVL)
+    rb_thread_call_without_gvl(track_parallel_run, &parallel, NULL, NULL);
+#elif defined(HAVE_RB_THREAD_BLOCKING_REGION)
+    rb_thread_blocking_region((rb_blocking_function_t *) track_parallel_run, &parallel, NULL, NULL);
+#else
+    track_parallel_run(&parallel);
+#endif
+    /* Pick the longest, and of equally long the one found first in track order */
+    int best = -1;
+    for (i = 0; i < parallel.workers; ++i) {
+        const int *candidate = parallel.indexes + i * n;
+        if (candidate[0] == -1)
+            continue;
+        if (best == -1 || parallel.bounds[i] > parallel.bounds[best])
+            best = i;
+        else if (parallel.bounds[i] == parallel.bounds[best])
+            for (j = 1; j < n; ++j)
+                if (candidate[j] != parallel.indexes[best * n + j]) {
+                    if (candidate[j] < parallel.indexes[best * n + j])
+                        best = i;
+                    break;
+                }
+    }
+    if (best == -1)
+        return bound;
+    memcpy(indexes, parallel.indexes + best * n, n * sizeof(int));
+    return parallel.bounds[best];
 }
 
 static double
-track_open_distance(const track_t *track, double bound, time_t *times)
+track_open_distance(const track_t *track, double bound, int *fixes)
 {
     int indexes[2] = { -1, -1 };
     int start;
@@ -371,12 +903,12 @@ track_open_distance(const track_t *track, double bound, time_t *times)
             indexes[1] = finish;
         }
     }
-    track_indexes_to_times(track, 2, indexes, times);
+    track_indexes_to_fixes(track, 2, indexes, fixes);
     return bound;
 }
 
 static double
-track_open_distance_one_point(const track_t *track, double bound, time_t *times)
+track_open_distance_one_point(const track_t *track, double bound, int *fixes)
 {
     int indexes[3] = { -1, -1, -1 };
     int tp1;
@@ -392,16 +924,17 @@ track_open_distance_one_point(const track_t *track, double bound, time_t *times)
             tp1 = track_fast_forward(track, tp1, 0.5 * (bound - total));
         }
     }
-    track_indexes_to_times(track, 3, indexes, times);
+    track_indexes_to_fixes(track, 3, indexes, fixes);
     return bound;
 }
 
 static double
-track_open_distance_two_points(const track_t *track, double bound, time_t *times)
+track_open_distance_two_points_range(const track_t *track, int begin, int end, double bound, shared_bound_t *shared, int *indexes)
 {
-    int indexes[4] = { -1, -1, -1, -1 };
     int tp1, tp2;
-    for (tp1 = 1; tp1 < track->n - 2; ++tp1) {
+    for (tp1 = begin; tp1 < end; ++tp1) {
+        if (shared)
+            bound = shared_bound_get(shared, bound);
         double leg1 = track->before[tp1].distance;
         double bound23 = bound - leg1;
         for (tp2 = tp1 + 1; tp2 < track->n - 1; ) {
@@ -412,6 +945,8 @@ track_open_distance_two_points(const track_t *track, double bound, time_t *times
                 indexes[2] = tp2;
                 indexes[3] = track->after[tp2].index;
                 bound23 = leg23;
+                if (shared)
+                    shared_bound_raise(shared, leg1 + bound23);
                 ++tp2;
             } else {
                 tp2 = track_fast_forward(track, tp2, 0.5 * (bound23 - leg23));
@@ -419,16 +954,25 @@ track_open_distance_two_points(const track_t *track, double bound, time_t *times
         }
         bound = leg1 + bound23;
     }
-    track_indexes_to_times(track, 4, indexes, times);
     return bound;
 }
 
 static double
-track_open_distance_three_points(const track_t *track, double bound, time_t *times)
+track_open_distance_two_points(const track_t *track, double bound, int *fixes)
+{
+    int indexes[4] = { -1, -1, -1, -1 };
+    bound = track_search(track, track_open_distance_two_points_range, 1, track->n - 2, bound, 4, indexes);
+    track_indexes_to_fixes(track, 4, indexes, fixes);
+    return bound;
+}
+
+static double
+track_open_distance_three_points_range(const track_t *track, int begin, int end, double bound, shared_bound_t *shared, int *indexes)
 {
-    int indexes[5] = { -1, -1, -1, -1, -1 };
     int tp1, tp2, tp3;
-    for (tp1 = 1; tp1 < track->n - 3; ++tp1) {
+    for (tp1 = begin; tp1 < end; ++tp1) {
+        if (shared)
+            bound = shared_bound_get(shared, bound);
         double leg1 = track->before[tp1].distance;
         double bound234 = bound - leg1;
         for (tp2 = tp1 + 1; tp2 < track->n - 2; ++tp2) {
@@ -443,6 +987,8 @@ track_open_distance_three_points(const track_t *track, double bound, time_t *tim
                     indexes[3] = tp3;
                     indexes[4] = track->after[tp3].index;
                     bound34 = legs34;
+                    if (shared)
+                        shared_bound_raise(shared, leg1 + leg2 + bound34);
                     ++tp3;
                 } else {
                     tp3 = track_fast_forward(track, tp3, 0.5 * (bound34 - legs34));
@@ -452,36 +998,63 @@ track_open_distance_three_points(const track_t *track, double bound, time_t *tim
         }
         bound = leg1 + bound234;
     }
-    track_indexes_to_times(track, 5, indexes, times);
     return bound;
 }
 
+static double
+track_open_distance_three_points(const track_t *track, double bound, int *fixes)
+{
+    int indexes[5] = { -1, -1, -1, -1, -1 };
+    bound = track_search(track, track_open_distance_three_points_range, 1, track->n - 3, bound, 5, indexes);
+    track_indexes_to_fixes(track, 5, indexes, fixes);
+    return bound;
+}
+
+/* Search the finishes in [begin, end) from last to first for the one that
+ * best closes a circuit from start, pruning caps whose score cannot beat
+ * the current best */
+static void
+track_node_circuit_close(const track_t *track, int node, int start, int tp, int begin, int end, double leg1, double circuit_bound, double *bound, int *indexes, int n)
+{
+    const node_t *nd = track->nodes + node;
+    if (nd->end <= begin || end <= nd->begin)
+        return;
+    double leg2_min = track_node_delta_min(track, node, start);
+    if (leg2_min >= circuit_bound || leg1 + CIRCUIT_WEIGHT * leg2_min + track_node_delta_min(track, node, tp) >= *bound)
+        return;
+    if (nd->left == -1) {
+        double leg2 = track_delta(track, start, nd->begin);
+        if (leg2 < circuit_bound) {
+            double leg3 = track_delta(track, nd->begin, tp);
+            double score = leg1 + CIRCUIT_WEIGHT * leg2 + leg3;
+            if (score < *bound) {
+                indexes[0] = start;
+                indexes[n - 1] = nd->begin;
+                *bound = score;
+            }
+        }
+        return;
+    }
+    track_node_circuit_close(track, nd->right, start, tp, begin, end, leg1, circuit_bound, bound, indexes, n);
+    track_node_circuit_close(track, nd->left, start, tp, begin, end, leg1, circuit_bound, bound, indexes, n);
+}
+
 static void
 track_circuit_close(const track_t *track, int n, int *indexes, double circuit_bound)
 {
     if (indexes[0] == -1)
         return;
-    int start, finish;
+    int start;
     double bound = track_delta(track, indexes[1], indexes[0]) + CIRCUIT_WEIGHT * track_delta(track, indexes[0], indexes[n - 1]) + track_delta(track, indexes[n - 1], indexes[n - 2]);
     for (start = indexes[0]; start <= indexes[1]; ++start) {
         double leg1 = track_delta(track, indexes[1], start);
-        for (finish = indexes[n - 1]; finish >= indexes[n - 2]; --finish) {
-            double leg2 = track_delta(track, start, finish);
-            if (leg2 < circuit_bound) {
-                double leg3 = track_delta(track, finish, indexes[n - 2]);
-                double score = leg1 + CIRCUIT_WEIGHT * leg2 + leg3;
-                if (score < bound) {
-                    indexes[0] = start;
-                    indexes[n - 1] = finish;
-                    bound = score;
-                }
-            }
-        }
+        if (leg1 < bound)
+            track_node_circuit_close(track, 0, start, indexes[n - 2], indexes[n - 2], indexes[n - 1] + 1, leg1, circuit_bound, &bound, indexes, n);
     }
 }
 
 static double
-track_out_and_return(const track_t *track, double bound, time_t *times)
+track_out_and_return(const track_t *track, double bound, int *fixes)
 {
     int indexes[4] = { -1, -1, -1, -1 };
     int tp1;
@@ -501,16 +1074,17 @@ track_out_and_return(const track_t *track, double bound, time_t *times)
         }
     }
     track_circuit_close(track, 4, indexes, 3.0 / R);
-    track_indexes_to_times(track, 4, indexes, times);
+    track_indexes_to_fixes(track, 4, indexes, fixes);
     return bound;
 }
 
 static double
-track_triangle(const track_t *track, double bound, time_t *times)
+track_triangle_range(const track_t *track, int begin, int end, double bound, shared_bound_t *shared, int *indexes)
 {
-    int indexes[5] = { -1, -1, -1, -1, -1 };
     int tp1;
-    for (tp1 = 0; tp1 < track->n - 1; ++tp1) {
+    for (tp1 = begin; tp1 < end; ++tp1) {
+        if (shared)
+            bound = shared_bound_get(shared, bound);
         if (track->sigma_delta[track->n - 1] - track->sigma_delta[tp1] < bound)
             break;
         int start = track->best_start[tp1];
@@ -525,6 +1099,8 @@ track_triangle(const track_t *track, double bound, time_t *times)
             int tp2 = track_furthest_from2(track, tp1, tp3, tp1 + 1, tp3, bound123, &legs123);
             if (tp2 > 0) {
                 bound = leg31 + legs123;
+                if (shared)
+                    shared_bound_raise(shared, bound);
                 indexes[0] = start;
                 indexes[1] = tp1;
                 indexes[2] = tp2;
@@ -533,18 +1109,30 @@ track_triangle(const track_t *track, double bound, time_t *times)
             }
         }
     }
-    track_circuit_close(track, 5, indexes, 3.0 / R);
-    track_indexes_to_times(track, 5, indexes, times);
     return bound;
 }
 
 static double
-track_triangle_fai(const track_t *track, double bound, time_t *times)
+track_triangle(const track_t *track, double bound, int *fixes)
 {
     int indexes[5] = { -1, -1, -1, -1, -1 };
+    bound = track_search(track, track_triangle_range, 0, track->n - 1, bound, 5, indexes);
+    track_circuit_close(track, 5, indexes, 3.0 / R);
+    track_indexes_to_fixes(track, 5, indexes, fixes);
+    return bound;
+}
+
+static double
+track_triangle_fai_range(const track_t *track, int begin, int end, double bound, shared_bound_t *shared, int *indexes)
+{
     double legbound = 0.28 * bound;
     int tp1;
-    for (tp1 = 0; tp1 < track->n - 2; ++tp1) {
+    for (tp1 = begin; tp1 < end; ++tp1) {
+        if (shared) {
+            bound = shared_bound_get(shared, bound);
+            if (0.28 * bound > legbound)
+                legbound = 0.28 * bound;
+        }
         int start = track->best_start[tp1];
         int finish = track->last_finish[start];
         if (finish < 0)
@@ -609,6 +1197,8 @@ track_triangle_fai(const track_t *track, double bound, time_t *times)
                 }
                 bound = total;
                 legbound = thislegbound;
+                if (shared)
+                    shared_bound_raise(shared, bound);
                 indexes[0] = start;
                 indexes[1] = tp1;
                 indexes[2] = tp2;
@@ -619,255 +1209,859 @@ track_triangle_fai(const track_t *track, double bound, time_t *times)
             --tp3;
         }
     }
+    return bound;
+}
+
+static double
+track_triangle_fai(const track_t *track, double bound, int *fixes)
+{
+    int indexes[5] = { -1, -1, -1, -1, -1 };
+    bound = track_search(track, track_triangle_fai_range, 0, track->n - 2, bound, 5, indexes);
     track_circuit_close(track, 5, indexes, 3.0 / R);
-    track_indexes_to_times(track, 5, indexes, times);
+    track_indexes_to_fixes(track, 5, indexes, fixes);
     return bound;
 }
 
+static void
+budget_init(budget_t *budget, double seconds)
+{
+    clock_gettime(CLOCK_MONOTONIC, &budget->deadline);
+    budget->deadline.tv_sec += (time_t) seconds;
+    budget->deadline.tv_nsec += (long) (1.0e9 * (seconds - floor(seconds)));
+    if (budget->deadline.tv_nsec >= 1000000000L) {
+        budget->deadline.tv_nsec -= 1000000000L;
+        ++budget->deadline.tv_sec;
+    }
+    budget->expired = 0;
+    budget->checks = 0;
+}
+
+static int
+budget_poll(budget_t *budget)
+{
+    if (!budget->expired) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec > budget->deadline.tv_sec || (now.tv_sec == budget->deadline.tv_sec && now.tv_nsec >= budget->deadline.tv_nsec))
+            budget->expired = 1;
+    }
+    return budget->expired;
+}
+
+/* Returns true once the deadline has passed, only reading the clock every
+ * BUDGET_CHECK calls */
+static inline int
+budget_expired(budget_t *budget)
+{
+    if (!budget)
+        return 0;
+    if (budget->checks++ % BUDGET_CHECK == 0)
+        return budget_poll(budget);
+    return budget->expired;
+}
+
+static inline double
+track_node_delta_max(const track_t *track, int i, int j)
+{
+    const node_t *node_i = track->nodes + i;
+    const node_t *node_j = track->nodes + j;
+    double d;
+    if (i == j) {
+        d = 2.0 * node_i->radius;
+    } else {
+        double x = node_i->x * node_j->x + node_i->y * node_j->y + node_i->z * node_j->z;
+        d = (x < 1.0 ? acos(x) : 0.0) + node_i->radius + node_j->radius;
+    }
+    d += BBOX_SLACK;
+    return d < M_PI ? d : M_PI;
+}
+
+static inline double
+track_node_delta_min_nodes(const track_t *track, int i, int j)
+{
+    if (i == j)
+        return 0.0;
+    const node_t *node_i = track->nodes + i;
+    const node_t *node_j = track->nodes + j;
+    double x = node_i->x * node_j->x + node_i->y * node_j->y + node_i->z * node_j->z;
+    double d = (x < 1.0 ? acos(x) : 0.0) - node_i->radius - node_j->radius - BBOX_SLACK;
+    return d > 0.0 ? d : 0.0;
+}
+
 static double
-track_quadrilateral(const track_t *track, double bound, time_t *times)
+track_bbox_bound(const track_t *track, const shape_t *shape, const int *nodes)
 {
-    int n = 0;
-    int indexes[6] = { -1, -1, -1, -1, -1, -1 };
-    int tp1;
-    double legbound = 0.15 * bound;
-    for (tp1 = 0; tp1 < track->n - 3; ++tp1) {
-        int start = track->best_start[tp1];
-        int finish = track->last_finish[start];
-        if (finish < 0)
-            continue;
-        int tp4first = track_first_at_least(track, tp1, tp1 + 2, finish + 1, legbound);
-        if (tp4first < 0)
-            continue;
-        int tp4last = track_last_at_least(track, tp1, tp4first, finish + 1, legbound);
-        if (tp4last < 0)
-            continue;
-        int tp4;
-        for (tp4 = tp4last; tp4 >= tp4first; ) {
-            double leg4 = track_delta(track, tp4, tp1);
-            if (leg4 < legbound) {
-                tp4 = track_fast_backward(track, tp4, legbound - leg4);
-                continue;
-            }
-            double shortestlegbound = 0.15 * leg4 / (1.0 - 3 * 0.15);
-            int tp2first = track_first_at_least(track, tp1, tp1 + 1, tp4 - 1, shortestlegbound);
-            if (tp2first < 0) {
-                --tp4;
-                continue;
-            }
-            int tp3last = track_last_at_least(track, tp4, tp2first + 1, tp4, shortestlegbound);
-            if (tp3last < 0) {
-                --tp4;
+    /* Check that strictly increasing fix indexes can be drawn from the nodes */
+    int lowest[BBOX_MAX_POINTS], highest[BBOX_MAX_POINTS];
+    int i;
+    lowest[0] = track->nodes[nodes[0]].begin;
+    for (i = 1; i < shape->n; ++i) {
+        const node_t *node = track->nodes + nodes[i];
+        lowest[i] = lowest[i - 1] + 1 > node->begin ? lowest[i - 1] + 1 : node->begin;
+        if (lowest[i] >= node->end)
+            return -1.0;
+    }
+    highest[shape->n - 1] = track->nodes[nodes[shape->n - 1]].end - 1;
+    for (i = shape->n - 2; i >= 0; --i) {
+        const node_t *node = track->nodes + nodes[i];
+        highest[i] = highest[i + 1] - 1 < node->end - 1 ? highest[i + 1] - 1 : node->end - 1;
+    }
+    if (shape->circuit && track->last_finish[track->best_start[highest[0]]] < lowest[shape->n - 1])
+        return -1.0;
+    double total = 0.0, total_min = 0.0, shortest = M_PI;
+    for (i = 0; i < shape->n; ++i) {
+        int j = i + 1;
+        if (j == shape->n) {
+            if (!shape->circuit)
+                break;
+            j = 0;
+        }
+        double leg = track_node_delta_max(track, nodes[i], nodes[j]);
+        total += leg;
+        if (leg < shortest)
+            shortest = leg;
+        if (shape->ratio > 0.0)
+            total_min += track_node_delta_min_nodes(track, nodes[i], nodes[j]);
+    }
+    if (shape->ratio > 0.0) {
+        /* Even the longest possible shortest leg is too short for the
+         * shortest possible flight */
+        if (shortest < shape->ratio * total_min)
+            return -1.0;
+        if (shortest / shape->ratio < total)
+            total = shortest / shape->ratio;
+    }
+    return total;
+}
+
+static double
+track_bbox_score(const track_t *track, const shape_t *shape, const int *indexes)
+{
+    double total = 0.0, shortest = M_PI;
+    int i;
+    for (i = 0; i < shape->n; ++i) {
+        int j = i + 1;
+        if (j == shape->n) {
+            if (!shape->circuit)
+                break;
+            j = 0;
+        }
+        double leg = track_delta(track, indexes[i], indexes[j]);
+        total += leg;
+        if (leg < shortest)
+            shortest = leg;
+    }
+    if (shape->ratio > 0.0 && shortest < shape->ratio * total)
+        return -1.0;
+    return total;
+}
+
+static void
+heap_push(heap_t *heap, const candidate_t *candidate)
+{
+    if (heap->n == heap->capacity) {
+        heap->capacity = heap->capacity ? 2 * heap->capacity : 1024;
+        REALLOC_N(heap->candidates, candidate_t, heap->capacity);
+    }
+    int i = heap->n++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap->candidates[parent].bound >= candidate->bound)
+            break;
+        heap->candidates[i] = heap->candidates[parent];
+        i = parent;
+    }
+    heap->candidates[i] = *candidate;
+}
+
+static void
+heap_pop(heap_t *heap, candidate_t *candidate)
+{
+    *candidate = heap->candidates[0];
+    candidate_t *last = heap->candidates + --heap->n;
+    int i = 0;
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= heap->n)
+            break;
+        if (child + 1 < heap->n && heap->candidates[child + 1].bound > heap->candidates[child].bound)
+            ++child;
+        if (last->bound >= heap->candidates[child].bound)
+            break;
+        heap->candidates[i] = heap->candidates[child];
+        i = child;
+    }
+    heap->candidates[i] = *last;
+}
+
+/* Best-first branch and bound over tuples of index ranges.  Each candidate
+ * holds one tree node per point and an upper bound on the distance of any
+ * flight drawn from those nodes.  The candidate with the highest bound is
+ * split on its widest node until all its nodes are single fixes.  If the
+ * budget runs out after the first flight has been scored the search stops
+ * early and upper receives the highest bound of the unexplored candidates.
+ * If the heap outgrows BBOX_MAX_CANDIDATES the search is abandoned and
+ * returns -1.0, unless there is a budget, which the sweep it would fall
+ * back to could overrun, when it stops early as if the budget had run
+ * out. */
+static double
+track_bbox_search(const track_t *track, const shape_t *shape, double bound, int *indexes, budget_t *budget, double *upper)
+{
+    heap_t heap = { 0, 0, NULL };
+    candidate_t candidate;
+    memset(&candidate, 0, sizeof candidate);
+    int i, scored = 0;
+    candidate.bound = track_bbox_bound(track, shape, candidate.nodes);
+    if (candidate.bound > bound)
+        heap_push(&heap, &candidate);
+    while (heap.n && heap.candidates[0].bound > bound) {
+        if (scored && budget_expired(budget))
+            break;
+        heap_pop(&heap, &candidate);
+        int widest = -1;
+        for (i = 0; i < shape->n; ++i) {
+            const node_t *node = track->nodes + candidate.nodes[i];
+            if (node->left == -1)
                 continue;
+            if (widest != -1) {
+                const node_t *other = track->nodes + candidate.nodes[widest];
+                if (node->radius < other->radius || (node->radius == other->radius && node->end - node->begin <= other->end - other->begin))
+                    continue;
             }
-            int tp2last = track_last_at_least(track, tp4, tp2first + 1, tp3last - 1, shortestlegbound);
-            if (tp2last < 0) {
-                --tp4;
-                continue;
+            widest = i;
+        }
+        if (widest == -1) {
+            int tps[BBOX_MAX_POINTS];
+            for (i = 0; i < shape->n; ++i)
+                tps[i] = track->nodes[candidate.nodes[i]].begin;
+            double score = track_bbox_score(track, shape, tps);
+            scored = 1;
+            if (score > bound) {
+                bound = score;
+                memcpy(indexes, tps, shape->n * sizeof(int));
             }
-            double longestlegbound = (1.0 - 3 * 0.15) * leg4 / 0.15;
-            int tp2;
-            for (tp2 = tp2first; tp2 <= tp2last; ) {
-                double leg1 = track_delta(track, tp1, tp2);
-                double shortestlegbound2 = 0.15 * (leg1 + leg4) / (1.0 - 2 * 0.15);
-                if (shortestlegbound2 > shortestlegbound)
-                    shortestlegbound2 = shortestlegbound;
-                double longestlegbound2 = (1.0 - 3 * 0.15) * (leg1 + leg4) / (2 * 0.15);
-                if (longestlegbound2 < longestlegbound)
-                    longestlegbound2 = longestlegbound;
-                int tp3first = track_first_at_least(track, tp2, tp2 + 1, tp3last + 1, shortestlegbound2);
-                if (tp3first < 0) {
-                    ++tp2;
-                    continue;
-                }
-                int tp3;
-                for (tp3 = tp3last; tp3 >= tp3first; ) {
-                    if (--n < 0) {
-                        fprintf(stderr, "tp1=%4d tp2=%4d tp3=%4d tp4=%4d\r", tp1, tp2, tp3, tp4);
-                        n = 50000;
-                    }
-                    double d = 0.0;
-                    double leg2 = track_delta(track, tp2, tp3);
-                    if (leg2 < shortestlegbound2)
-                        d = shortestlegbound2 - leg2;
-                    if (leg2 > longestlegbound2 && leg2 - longestlegbound2 > d)
-                        d = leg2 - longestlegbound2;
-                    double leg3 = track_delta(track, tp3, tp4);
-                    if (leg3 < shortestlegbound2 && shortestlegbound2 - leg3 > d)
-                        d = shortestlegbound2 - leg3;
-                    if (leg3 > longestlegbound2 && leg3 - longestlegbound2 > d)
-                        d = leg3 - longestlegbound2;
-                    if (d > 0.0) {
-                        tp3 = track_fast_backward(track, tp3, d);
-                        continue;
-                    }
-                    double total = leg1 + leg2 + leg3 + leg4;
-                    double thislegbound = 0.15 * total;
-                    if (leg1 < thislegbound)
-                        d = thislegbound - leg1;
-                    if (leg2 < thislegbound && thislegbound - leg2 > d)
-                        d = thislegbound - leg2;
-                    if (leg3 < thislegbound && thislegbound - leg3 > d)
-                        d = thislegbound - leg3;
-                    if (leg4 < thislegbound && thislegbound - leg4 > d)
-                        d = thislegbound - leg4;
-                    if (d > 0.0) {
-                        tp3 = track_fast_backward(track, tp3, 0.5 * d);
-                        continue;
-                    }
-                    if (total < bound) {
-                        tp3 = track_fast_backward(track, tp3, 0.5 * (bound - total));
-                        continue;
-                    }
-                    bound = total;
-                    legbound = thislegbound;
-                    indexes[0] = start;
-                    indexes[1] = tp1;
-                    indexes[2] = tp2;
-                    indexes[3] = tp3;
-                    indexes[4] = tp4;
-                    indexes[5] = finish;
-                    --tp3;
+            continue;
+        }
+        const node_t *node = track->nodes + candidate.nodes[widest];
+        int children[2] = { node->left, node->right };
+        for (i = 0; i < 2; ++i) {
+            candidate_t child = candidate;
+            child.nodes[widest] = children[i];
+            child.bound = track_bbox_bound(track, shape, child.nodes);
+            if (child.bound > bound)
+                heap_push(&heap, &child);
+        }
+        if (heap.n > BBOX_MAX_CANDIDATES) {
+            if (budget)
+                break;
+            xfree(heap.candidates);
+            return -1.0;
+        }
+    }
+    *upper = heap.n && heap.candidates[0].bound > bound ? heap.candidates[0].bound : bound;
+    xfree(heap.candidates);
+    return bound;
+}
+
+/* Search for a better flight than bound, starting from the flight kept in
+ * warm by the previous search over a shorter prefix of the track */
+static double
+track_bbox_warm_search(const track_t *track, const shape_t *shape, double bound, int *indexes, warm_t *warm, budget_t *budget)
+{
+    if (warm && warm->indexes[0] != -1) {
+        double score = track_bbox_score(track, shape, warm->indexes);
+        if (score > bound) {
+            bound = score;
+            memcpy(indexes, warm->indexes, shape->n * sizeof(int));
+        }
+    }
+    double upper;
+    bound = track_bbox_search(track, shape, bound, indexes, budget, &upper);
+    if (bound < 0.0)
+        return bound;
+    if (warm) {
+        memcpy(warm->indexes, indexes, shape->n * sizeof(int));
+        warm->upper = upper > bound + BBOX_SLACK ? upper : 0.0;
+    }
+    return bound;
+}
+
+static double
+track_bbox_open_distance(const track_t *track, int turnpoints, double bound, int *fixes, warm_t *warm, budget_t *budget)
+{
+    shape_t shape = { turnpoints + 2, 0, 0.0 };
+    int indexes[BBOX_MAX_POINTS] = { -1, -1, -1, -1, -1, -1 };
+    bound = track_bbox_warm_search(track, &shape, bound, indexes, warm, budget);
+    if (bound >= 0.0)
+        track_indexes_to_fixes(track, shape.n, indexes, fixes);
+    return bound;
+}
+
+static double
+track_bbox_circuit(const track_t *track, int turnpoints, double ratio, double bound, int *fixes, warm_t *warm, budget_t *budget)
+{
+    shape_t shape = { turnpoints, 1, ratio };
+    int tps[BBOX_MAX_POINTS] = { -1, -1, -1, -1, -1, -1 };
+    int indexes[BBOX_MAX_POINTS + 2] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+    bound = track_bbox_warm_search(track, &shape, bound, tps, warm, budget);
+    if (bound < 0.0)
+        return bound;
+    if (tps[0] != -1) {
+        indexes[0] = track->best_start[tps[0]];
+        memcpy(indexes + 1, tps, turnpoints * sizeof(int));
+        indexes[turnpoints + 1] = track->last_finish[indexes[0]];
+        track_circuit_close(track, turnpoints + 2, indexes, 3.0 / R);
+    }
+    track_indexes_to_fixes(track, turnpoints + 2, indexes, fixes);
+    return bound;
+}
+
+static inline warm_t *
+warm_slot(warm_t *warm, int flight)
+{
+    return warm ? warm + flight : NULL;
+}
+
+static void
+warm_init(warm_t *warm)
+{
+    int i, j;
+    for (i = 0; i < FLIGHTS; ++i) {
+        for (j = 0; j < BBOX_MAX_POINTS; ++j)
+            warm[i].indexes[j] = -1;
+        warm[i].upper = 0.0;
+    }
+}
+
+/* Translate the flights in warm from indexes into a downsampled track to
+ * indexes into a finer track that contains all of its fixes */
+static void
+warm_refine(warm_t *warm, const track_t *coarse, const track_t *fine)
+{
+    int i, j;
+    for (i = 0; i < FLIGHTS; ++i) {
+        for (j = 0; j < BBOX_MAX_POINTS && warm[i].indexes[j] != -1; ++j) {
+            int index = coarse->indexes[warm[i].indexes[j]];
+            if (fine->indexes) {
+                int begin = 0, end = fine->n;
+                while (end - begin > 1) {
+                    int middle = (begin + end) / 2;
+                    if (fine->indexes[middle] <= index)
+                        begin = middle;
+                    else
+                        end = middle;
                 }
-                ++tp2;
+                index = begin;
             }
-            --tp4;
+            warm[i].indexes[j] = index;
         }
     }
-    track_circuit_close(track, 6, indexes, 3.0 / R);
-    track_indexes_to_times(track, 6, indexes, times);
-    return bound;
 }
 
-static int
-track_time_to_index(const track_t *track, time_t time, int left, int right)
-{
-    while (left <= right) {
-        int middle = (left + right) / 2;
-        if (track->times[middle] > time)
-            right = middle - 1;
-        else if (track->times[middle] == time)
-            return middle;
+static void
+scoring_init(scoring_t *scoring, track_t *track, warm_t *warm, budget_t *budget)
+{
+    memset(scoring, 0, sizeof(scoring_t));
+    scoring->track = track;
+    scoring->bbox = warm || budget || xc_engine == id_bbox;
+    scoring->warm = warm;
+    scoring->budget = budget;
+}
+
+static void
+scoring_free(scoring_t *scoring)
+{
+    if (scoring->downsampled)
+        track_delete(scoring->downsampled);
+}
+
+static track_t *
+scoring_downsampled(scoring_t *scoring)
+{
+    if (!scoring->downsampled) {
+        scoring->downsampled = track_downsample(scoring->track, 0.5 / R);
+        track_compute_circuit_tables(scoring->downsampled, 3.0 / R);
+        track_compute_limits(scoring->downsampled);
+    }
+    return scoring->downsampled;
+}
+
+static double
+scoring_sweep(scoring_t *scoring, int flight, double bound, int *fixes)
+{
+    track_t *track = scoring->track;
+    int downsampled_fixes[5] = { -1 };
+    track_compute_limits(track);
+    switch (flight) {
+    case FLIGHT_OPEN0:
+        return track_open_distance(track, bound, fixes);
+    case FLIGHT_OPEN1:
+        return track_open_distance_one_point(track, bound, fixes);
+    case FLIGHT_OPEN2:
+        return track_open_distance_two_points(track, bound, fixes);
+    case FLIGHT_OPEN3:
+        return track_open_distance_three_points(track, bound, fixes);
+    case FLIGHT_CIRCUIT2:
+        return track_out_and_return(track, bound, fixes);
+    case FLIGHT_CIRCUIT3FAI:
+        bound = track_triangle_fai(scoring_downsampled(scoring), bound, downsampled_fixes);
+        bound = track_triangle_fai(track, bound, fixes);
+        if (fixes[0] == -1)
+            memcpy(fixes, downsampled_fixes, sizeof downsampled_fixes);
+        return bound;
+    case FLIGHT_CIRCUIT3:
+        bound = track_triangle(scoring_downsampled(scoring), bound, downsampled_fixes);
+        bound = track_triangle(track, bound, fixes);
+        if (fixes[0] == -1)
+            memcpy(fixes, downsampled_fixes[0] == -1 ? scoring->fixes[FLIGHT_CIRCUIT3FAI] : downsampled_fixes, sizeof downsampled_fixes);
+        return bound;
+    default:
+        return bound;
+    }
+}
+
+/* Search for the best flight of the given type unless an earlier league
+ * already has, first searching for the flights whose distances bound it */
+static void
+scoring_search(scoring_t *scoring, int flight)
+{
+    if (scoring->done & (1 << flight))
+        return;
+    const flight_spec_t *spec = flight_specs + flight;
+    track_t *track = scoring->track;
+    int *fixes = scoring->fixes[flight];
+    int i;
+    for (i = 0; i < BBOX_MAX_POINTS; ++i)
+        fixes[i] = -1;
+    double bound = 15.0 / R;
+    switch (flight) {
+    case FLIGHT_OPEN0:
+        bound = 0.0;
+        break;
+    case FLIGHT_OPEN1:
+        scoring_search(scoring, FLIGHT_OPEN0);
+        if (scoring->bounds[FLIGHT_OPEN0] > bound)
+            bound = scoring->bounds[FLIGHT_OPEN0];
+        break;
+    case FLIGHT_OPEN2:
+    case FLIGHT_OPEN3:
+        scoring_search(scoring, flight - 1);
+        bound = scoring->bounds[flight - 1];
+        break;
+    case FLIGHT_CIRCUIT2:
+        if (scoring->bbox)
+            bound = 2.0 * 15.0 / R;
+        break;
+    case FLIGHT_CIRCUIT3:
+        scoring_search(scoring, FLIGHT_CIRCUIT3FAI);
+        bound = scoring->bounds[FLIGHT_CIRCUIT3FAI];
+        break;
+    }
+    if (spec->circuit)
+        track_compute_circuit_tables(track, 3.0 / R);
+    if (!scoring->bbox) {
+        bound = scoring_sweep(scoring, flight, bound, fixes);
+    } else {
+        track_compute_tree(track);
+        double result;
+        if (spec->circuit)
+            result = track_bbox_circuit(track, spec->turnpoints, spec->ratio, bound, fixes, warm_slot(scoring->warm, flight), scoring->budget);
         else
-            left = middle + 1;
+            result = track_bbox_open_distance(track, spec->turnpoints, bound, fixes, warm_slot(scoring->warm, flight), scoring->budget);
+        /* Too many candidates to keep, so sweep instead */
+        bound = result < 0.0 ? scoring_sweep(scoring, flight, bound, fixes) : result;
+        if (flight == FLIGHT_CIRCUIT3 && fixes[0] == -1)
+            memcpy(fixes, scoring->fixes[FLIGHT_CIRCUIT3FAI], 5 * sizeof(int));
     }
-    return -1;
+    scoring->bounds[flight] = bound;
+    scoring->done |= 1 << flight;
+}
+
+static const league_spec_t *
+league_spec_get(VALUE rb_league)
+{
+    VALUE rb_XC = rb_const_get(rb_cObject, rb_intern("XC"));
+    int i;
+    for (i = 0; i < LEAGUES; ++i)
+        if (rb_league == rb_const_get(rb_XC, rb_intern(league_specs[i].name)))
+            return league_specs + i;
+    rb_raise(rb_eArgError, "unsupported league");
+    return NULL;
+}
+
+static void
+leagues_add(leagues_t *leagues, VALUE rb_league)
+{
+    if (leagues->n == MAX_LEAGUES)
+        rb_raise(rb_eArgError, "too many leagues");
+    leagues->specs[leagues->n] = league_spec_get(rb_league);
+    leagues->rb_leagues[leagues->n] = rb_league;
+    leagues->rb_results[leagues->n] = rb_ary_new2(FLIGHTS);
+    ++leagues->n;
 }
 
 static VALUE
-track_rb_new_xc(const track_t *track, const char *flight, int n, time_t *times)
+track_rb_new_xc(const track_t *track, VALUE rb_league, int flight, const int *fixes, const warm_t *warm)
 {
-    if (times[0] == -1)
+    if (fixes[0] == -1 || NIL_P(track->rb_fixes))
         return Qnil;
+    int n = flight_specs[flight].turnpoints + 2;
     VALUE rb_fixes = rb_ary_new2(n);
-    int left = 0;
     int i;
-    for (i = 0; i < n; ++i) {
-        int index = track_time_to_index(track, times[i], left, track->n);
-        rb_ary_push(rb_fixes, RARRAY(track->rb_fixes)->ptr[index]);
-        left = index;
+    for (i = 0; i < n; ++i)
+        rb_ary_push(rb_fixes, fixes_entry(track->rb_fixes, fixes[i]));
+    VALUE rb_indexes = rb_ary_new2(n);
+    for (i = 0; i < n; ++i)
+        rb_ary_push(rb_indexes, INT2FIX(fixes[i]));
+    VALUE rb_xc = rb_funcall(rb_const_get(rb_league, rb_intern(flight_specs[flight].name)), id_new, 2, rb_fixes, rb_indexes);
+    /* Record the upper bound on the distance if the search ran out of time */
+    if (warm && warm->upper > 0.0)
+        rb_funcall(rb_xc, id_set_bound, 1, rb_float_new(1000.0 * R * warm->upper));
+    return rb_xc;
+}
+
+/* Search for the flights of every league, searching only once for flight
+ * types shared by several leagues, and append them to each league's
+ * result */
+static void
+track_optimize(track_t *track, leagues_t *leagues, warm_t *warm, budget_t *budget)
+{
+    if (track->n < 2)
+        return;
+    scoring_t scoring;
+    scoring_init(&scoring, track, warm, budget);
+    int i, j;
+    for (i = 0; i < leagues->n; ++i)
+        for (j = 0; j < leagues->specs[i]->n; ++j)
+            scoring_search(&scoring, leagues->specs[i]->flights[j]);
+    /* Free the downsampled track before creating the flights, which can
+     * raise */
+    scoring_free(&scoring);
+    for (i = 0; i < leagues->n; ++i) {
+        const league_spec_t *spec = leagues->specs[i];
+        for (j = 0; j < spec->n; ++j) {
+            int flight = spec->flights[j];
+            rb_ary_push_unless_nil(leagues->rb_results[i], track_rb_new_xc(track, leagues->rb_leagues[i], flight, scoring.fixes[flight], warm_slot(warm, flight)));
+        }
     }
-    return rb_funcall(rb_const_get(track->rb_league, rb_intern(flight)), id_new, 1, rb_fixes);
+}
+
+/* Optimize on each level of a pyramid of downsampled tracks in turn, from
+ * coarsest to finest, starting each level from the flights found on the
+ * level above.  The coarsest level with at least two fixes is always
+ * searched in full, so that there are flights however small the budget.
+ * Finer levels are skipped once the budget has run out, but the full
+ * track is always searched so that the bounds hold for it. */
+static void
+track_optimize_within(track_t *track, track_t **levels, leagues_t *leagues, budget_t *budget)
+{
+    if (track->n < 2)
+        return;
+    warm_t warm[FLIGHTS];
+    warm_init(warm);
+    levels[0] = track;
+    int i;
+    for (i = 1; i <= PYRAMID_LEVELS; ++i)
+        levels[i] = track_downsample(levels[i - 1], pyramid_thresholds[i - 1]);
+    int coarsest = PYRAMID_LEVELS;
+    while (coarsest > 0 && levels[coarsest]->n < 2)
+        --coarsest;
+    for (i = PYRAMID_LEVELS; i >= 0; --i) {
+        if (i == coarsest && i != 0)
+            track_optimize(levels[i], leagues, warm, NULL);
+        else if (i == 0 || (i < coarsest && !budget_poll(budget)))
+            track_optimize(levels[i], leagues, warm, budget);
+        if (i != 0)
+            warm_refine(warm, levels[i], levels[i - 1]);
+        if (rb_block_given_p())
+            rb_yield_values(3, INT2NUM(PYRAMID_LEVELS + 1 - i), INT2NUM(PYRAMID_LEVELS + 1), INT2NUM(levels[i]->n));
+    }
+}
+
+/* The tracks of an optimization, freed even if the progress block or a
+ * flight's constructor raises */
+typedef struct {
+    track_t *track;
+    track_t *levels[PYRAMID_LEVELS + 1];
+    leagues_t *leagues;
+    budget_t *budget;
+} optimization_t;
+
+static VALUE
+optimization_run(VALUE rb_optimization)
+{
+    optimization_t *optimization = (optimization_t *) rb_optimization;
+    if (optimization->budget)
+        track_optimize_within(optimization->track, optimization->levels, optimization->leagues, optimization->budget);
+    else
+        track_optimize(optimization->track, optimization->leagues, NULL, NULL);
+    return Qnil;
+}
+
+static VALUE
+optimization_free(VALUE rb_optimization)
+{
+    optimization_t *optimization = (optimization_t *) rb_optimization;
+    int i;
+    for (i = 1; i <= PYRAMID_LEVELS; ++i)
+        track_delete(optimization->levels[i]);
+    track_delete(optimization->track);
+    return Qnil;
+}
+
+/* Optimizes track, which is deleted afterwards, for leagues, within
+ * budget if it is not NULL */
+static void
+track_optimize_and_delete(track_t *track, leagues_t *leagues, budget_t *budget)
+{
+    optimization_t optimization;
+    memset(&optimization, 0, sizeof optimization);
+    optimization.track = track;
+    optimization.leagues = leagues;
+    optimization.budget = budget;
+    rb_ensure(optimization_run, (VALUE) &optimization, optimization_free, (VALUE) &optimization);
 }
 
 static VALUE
-rb_XC_Open_optimize(VALUE rb_self, VALUE rb_fixes)
-{
-    VALUE rb_result = rb_ary_new2(1);
-    track_t *track = track_new(rb_self, rb_fixes);
-    time_t times[2];
-    track_open_distance(track, 0.0, times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Open0", 2, times));
-    track_delete(track);
+rb_XC_League_optimize(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_fixes, rb_fix_buffer;
+    rb_scan_args(argc, argv, "11", &rb_fixes, &rb_fix_buffer);
+    leagues_t leagues = { 0 };
+    leagues_add(&leagues, rb_self);
+    track_optimize_and_delete(track_new(rb_fixes, rb_fix_buffer), &leagues, NULL);
+    return leagues.rb_results[0];
+}
+
+static VALUE
+rb_XC_League_optimize_within(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_seconds, rb_fixes, rb_fix_buffer;
+    rb_scan_args(argc, argv, "21", &rb_seconds, &rb_fixes, &rb_fix_buffer);
+    budget_t budget;
+    budget_init(&budget, NUM2DBL(rb_seconds));
+    leagues_t leagues = { 0 };
+    leagues_add(&leagues, rb_self);
+    track_optimize_and_delete(track_new(rb_fixes, rb_fix_buffer), &leagues, &budget);
+    return leagues.rb_results[0];
+}
+
+static VALUE
+rb_XC_optimize_leagues(int argc, VALUE *argv, VALUE rb_self)
+{
+    VALUE rb_leagues, rb_fixes, rb_fix_buffer, rb_seconds;
+    rb_scan_args(argc, argv, "22", &rb_leagues, &rb_fixes, &rb_fix_buffer, &rb_seconds);
+    Check_Type(rb_leagues, T_ARRAY);
+    leagues_t leagues = { 0 };
+    int i;
+    for (i = 0; i < RARRAY(rb_leagues)->len; ++i)
+        leagues_add(&leagues, RARRAY(rb_leagues)->ptr[i]);
+    budget_t budget;
+    if (!NIL_P(rb_seconds))
+        budget_init(&budget, NUM2DBL(rb_seconds));
+    track_optimize_and_delete(track_new(rb_fixes, rb_fix_buffer), &leagues, NIL_P(rb_seconds) ? NULL : &budget);
+    VALUE rb_result = rb_hash_new();
+    for (i = 0; i < leagues.n; ++i)
+        rb_hash_aset(rb_result, leagues.rb_leagues[i], leagues.rb_results[i]);
     return rb_result;
 }
 
+static void
+optimizer_mark(optimizer_t *optimizer)
+{
+    rb_gc_mark(optimizer->rb_league);
+    if (optimizer->track)
+        rb_gc_mark(optimizer->track->rb_fixes);
+}
+
+static void
+optimizer_free(optimizer_t *optimizer)
+{
+    track_delete(optimizer->track);
+    xfree(optimizer);
+}
+
 static VALUE
-rb_XC_FRCFD_optimize(VALUE rb_self, VALUE rb_fixes)
-{
-    VALUE rb_result = rb_ary_new2(7);
-    track_t *track = track_new(rb_self, rb_fixes);
-    time_t times[6];
-    double bound = 0.0;
-    bound = track_open_distance(track, bound, times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Open0", 2, times));
-    if (bound < 15.0 / R)
-        bound = 15.0 / R;
-    bound = track_open_distance_one_point(track, bound, times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Open1", 3, times));
-    bound = track_open_distance_two_points(track, bound, times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Open2", 4, times));
-    track_compute_circuit_tables(track, 3.0 / R);
-    track_out_and_return(track, 15.0 / R, times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Circuit2", 4, times));
-    time_t times_fai[5] = { -1 };
-    time_t downsampled_times_fai[5] = { -1 };
-    time_t downsampled_times[5] = { -1 };
-    track_t *downsampled_track = track_downsample(track, 0.5 / R);
-    track_compute_circuit_tables(downsampled_track, 3.0 / R);
-    bound = track_triangle_fai(downsampled_track, 15.0 / R, downsampled_times_fai);
-    bound = track_triangle_fai(track, bound, times_fai);
-    if (times_fai[0] == -1)
-        memcpy(times_fai, downsampled_times_fai, sizeof times_fai);
-    VALUE rb_circuit3fai = track_rb_new_xc(track, "Circuit3FAI", 5, times_fai);
-    bound = track_triangle(downsampled_track, bound, downsampled_times);
-    bound = track_triangle(track, bound, times);
-    if (times[0] == -1)
-        memcpy(times, downsampled_times[0] == -1 ? times_fai : downsampled_times, sizeof times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Circuit3", 5, times));
-    rb_ary_push_unless_nil(rb_result, rb_circuit3fai);
-#if 0
-    bound = track_quadrilateral(downsampled_track, 15.0 / R, downsampled_times);
-#if 0
-    bound = track_quadrilateral(track, bound, times);
-#else
-    times[0] = -1;
+rb_XC_Optimizer_alloc(VALUE rb_class)
+{
+    optimizer_t *optimizer;
+    VALUE rb_self = Data_Make_Struct(rb_class, optimizer_t, optimizer_mark, optimizer_free, optimizer);
+    optimizer->rb_league = Qnil;
+    return rb_self;
+}
+
+static optimizer_t *
+rb_XC_Optimizer_get(VALUE rb_self)
+{
+    optimizer_t *optimizer;
+    Data_Get_Struct(rb_self, optimizer_t, optimizer);
+    if (!optimizer->track)
+        rb_raise(rb_eRuntimeError, "uninitialized optimizer");
+    return optimizer;
+}
+
+static VALUE
+rb_XC_Optimizer_initialize(VALUE rb_self, VALUE rb_league)
+{
+    optimizer_t *optimizer;
+    Data_Get_Struct(rb_self, optimizer_t, optimizer);
+    league_spec_get(rb_league);
+    optimizer->rb_league = rb_league;
+    track_delete(optimizer->track);
+    optimizer->track = ALLOC(track_t);
+    memset(optimizer->track, 0, sizeof(track_t));
+    optimizer->track->rb_fixes = rb_ary_new();
+    warm_init(optimizer->warm);
+    return rb_self;
+}
+
+static VALUE
+rb_XC_Optimizer_append(int argc, VALUE *argv, VALUE rb_self)
+{
+    optimizer_t *optimizer = rb_XC_Optimizer_get(rb_self);
+    VALUE rb_fixes, rb_fix_buffer;
+    rb_scan_args(argc, argv, "11", &rb_fixes, &rb_fix_buffer);
+    /* convert the fixes before the track grows, so that the track and its
+     * fixes always grow together */
+    if (TYPE(rb_fixes) != T_ARRAY)
+        rb_fixes = rb_convert_type(rb_fixes, T_ARRAY, "Array", "to_a");
+    Check_Type(rb_fixes, T_ARRAY);
+    track_append(optimizer->track, rb_fixes, rb_fix_buffer);
+    rb_ary_concat(optimizer->track->rb_fixes, rb_fixes);
+    return rb_self;
+}
+
+static VALUE
+rb_XC_Optimizer_length(VALUE rb_self)
+{
+    return INT2NUM(rb_XC_Optimizer_get(rb_self)->track->n);
+}
+
+static VALUE
+rb_XC_Optimizer_optimize(VALUE rb_self)
+{
+    optimizer_t *optimizer = rb_XC_Optimizer_get(rb_self);
+    leagues_t leagues = { 0 };
+    leagues_add(&leagues, optimizer->rb_league);
+    track_optimize(optimizer->track, &leagues, optimizer->warm, NULL);
+    return leagues.rb_results[0];
+}
+
+static VALUE
+rb_XC_engine(VALUE rb_self)
+{
+    return ID2SYM(xc_engine);
+}
+
+static VALUE
+rb_XC_set_engine(VALUE rb_self, VALUE rb_engine)
+{
+    ID engine = rb_to_id(rb_engine);
+    if (engine != id_bbox && engine != id_sweep)
+        rb_raise(rb_eArgError, "unknown engine %s", rb_id2name(engine));
+    xc_engine = engine;
+    return rb_engine;
+}
+
+static VALUE
+rb_XC_simd(VALUE rb_self)
+{
+    return ID2SYM(xc_simd);
+}
+
+static int
+xc_simd_supported(ID simd)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (simd == id_avx2)
+        return __builtin_cpu_supports("avx2");
+    if (simd == id_sse2)
+        return __builtin_cpu_supports("sse2");
 #endif
-    if (times[0] == -1)
-        memcpy(times, downsampled_times, sizeof times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Circuit4", 6, times));
+    return simd == id_scalar;
+}
+
+static void
+xc_simd_select(ID simd)
+{
+    xc_simd = simd;
+#if defined(__x86_64__) || defined(__i386__)
+    if (simd == id_avx2) {
+        track_dots = track_dots_avx2;
+        return;
+    }
+    if (simd == id_sse2) {
+        track_dots = track_dots_sse2;
+        return;
+    }
 #endif
-    track_delete(downsampled_track);
-    track_delete(track);
-    return rb_result;
+    track_dots = track_dots_scalar;
 }
 
 static VALUE
-rb_XC_UKXCL_optimize(VALUE rb_self, VALUE rb_fixes)
-{
-    VALUE rb_result = rb_ary_new2(4);
-    track_t *track = track_new(rb_self, rb_fixes);
-    time_t times[5];
-    double bound = 0.0;
-    bound = track_open_distance(track, bound, times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Open0", 2, times));
-    if (bound < 15.0 / R)
-        bound = 15.0 / R;
-    bound = track_open_distance_one_point(track, bound, times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Open1", 3, times));
-    bound = track_open_distance_two_points(track, bound, times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Open2", 4, times));
-    bound = track_open_distance_three_points(track, bound, times);
-    rb_ary_push_unless_nil(rb_result, track_rb_new_xc(track, "Open3", 5, times));
-    track_delete(track);
-    return rb_result;
+rb_XC_set_simd(VALUE rb_self, VALUE rb_simd)
+{
+    ID simd = rb_to_id(rb_simd);
+    if (simd != id_avx2 && simd != id_sse2 && simd != id_scalar)
+        rb_raise(rb_eArgError, "unknown SIMD kernel %s", rb_id2name(simd));
+    if (!xc_simd_supported(simd))
+        rb_raise(rb_eArgError, "SIMD kernel %s is not supported by this CPU", rb_id2name(simd));
+    xc_simd_select(simd);
+    return rb_simd;
+}
+
+static VALUE
+rb_XC_threads(VALUE rb_self)
+{
+    return INT2NUM(xc_threads);
+}
+
+static VALUE
+rb_XC_set_threads(VALUE rb_self, VALUE rb_threads)
+{
+    int threads = NUM2INT(rb_threads);
+    if (threads < 1 || 256 < threads)
+        rb_raise(rb_eArgError, "threads must be between 1 and 256");
+    xc_threads = threads;
+    return rb_threads;
 }
 
 void
 Init_cxc(void)
 {
     id_alt = rb_intern("alt");
+    id_aref = rb_intern("[]");
     id_lat = rb_intern("lat");
+    id_length = rb_intern("length");
     id_lon = rb_intern("lon");
     id_new = rb_intern("new");
-    id_time = rb_intern("time");
-    id_to_i = rb_intern("to_i");
+    id_set_bound = rb_intern("bound=");
+    id_bbox = rb_intern("bbox");
+    id_sweep = rb_intern("sweep");
+    xc_engine = id_bbox;
+    id_avx2 = rb_intern("avx2");
+    id_scalar = rb_intern("scalar");
+    id_sse2 = rb_intern("sse2");
+    xc_simd_select(xc_simd_supported(id_avx2) ? id_avx2 : xc_simd_supported(id_sse2) ? id_sse2 : id_scalar);
     VALUE rb_XC = rb_define_module("XC");
+    rb_define_module_function(rb_XC, "engine", rb_XC_engine, 0);
+    rb_define_module_function(rb_XC, "engine=", rb_XC_set_engine, 1);
+    rb_define_module_function(rb_XC, "simd", rb_XC_simd, 0);
+    rb_define_module_function(rb_XC, "simd=", rb_XC_set_simd, 1);
+    rb_define_module_function(rb_XC, "threads", rb_XC_threads, 0);
+    rb_define_module_function(rb_XC, "threads=", rb_XC_set_threads, 1);
+    rb_define_module_function(rb_XC, "optimize_leagues", rb_XC_optimize_leagues, -1);
     VALUE rb_XC_League = rb_define_class_under(rb_XC, "League", rb_cObject);
-    VALUE rb_XC_Open = rb_define_class_under(rb_XC, "Open", rb_XC_League);
-    rb_define_module_function(rb_XC_Open, "optimize", rb_XC_Open_optimize, 1);
-    VALUE rb_XC_FRCFD = rb_define_class_under(rb_XC, "FRCFD", rb_XC_League);
-    rb_define_module_function(rb_XC_FRCFD, "optimize", rb_XC_FRCFD_optimize, 1);
-    VALUE rb_XC_UKXCL = rb_define_class_under(rb_XC, "UKXCL", rb_XC_League);
-    rb_define_module_function(rb_XC_UKXCL, "optimize", rb_XC_UKXCL_optimize, 1);
+    rb_define_singleton_method(rb_XC_League, "optimize", rb_XC_League_optimize, -1);
+    rb_define_singleton_method(rb_XC_League, "optimize_within", rb_XC_League_optimize_within, -1);
+    rb_define_class_under(rb_XC, "Open", rb_XC_League);
+    rb_define_class_under(rb_XC, "FRCFD", rb_XC_League);
+    rb_define_class_under(rb_XC, "UKXCL", rb_XC_League);
+    VALUE rb_XC_Optimizer = rb_define_class_under(rb_XC, "Optimizer", rb_cObject);
+    rb_define_alloc_func(rb_XC_Optimizer, rb_XC_Optimizer_alloc);
+    rb_define_method(rb_XC_Optimizer, "initialize", rb_XC_Optimizer_initialize, 1);
+    rb_define_method(rb_XC_Optimizer, "append", rb_XC_Optimizer_append, -1);
+    rb_define_method(rb_XC_Optimizer, "length", rb_XC_Optimizer_length, 0);
+    rb_define_method(rb_XC_Optimizer, "optimize", rb_XC_Optimizer_optimize, 0);
 }
@@ -1,7 +1,14 @@
 #include <ruby.h>
 
+/* Returns the number of characters matched by the Ratcliff/Obershelp
+ * algorithm: the longest common substring, the leftmost in the first
+ * string and then in the second if there are several, plus the matches to
+ * its left and to its right.  Each longest common substring is found by
+ * dynamic programming over the common prefix lengths starting at each
+ * pair of positions, computed from the ends backwards one row at a time
+ * in row, which holds at least end2 - begin2 + 1 ints. */
 static int
-ratcliff_obershelp(const char *begin1, const char *end1, const char *begin2, const char *end2)
+ratcliff_obershelp(const char *begin1, const char *end1, const char *begin2, const char *end2, int *row)
 {
     if (begin1 == end1 || begin2 == end2)
         return 0;
@@ -9,26 +16,38 @@ ratcliff_obershelp(const char *begin1, const char *end1, const char *begin2, con
         return 0;
     int length = 0;
     const char *i1, *i2;
-    const char *start1, *start2;
-    const char *limit1 = end1;
-    const char *limit2 = end2;
-    for (i1 = begin1; i1 < limit1; ++i1) {
-        for (i2 = begin2; i2 < limit2; ++i2) {
-            if (*i1 == *i2) {
-                int j = 1;
-                while (i1 + j < end1 && i2 + j < end2 && i1[j] == i2[j])
-                    ++j;
-                if (j > length) {
-                    length = j;
-                    start1 = i1;
-                    start2 = i2;
-                    limit1 = end1 - length;
-                    limit2 = end2 - length;
-                }
+    const char *start1 = begin1, *start2 = begin2;
+    long n2 = end2 - begin2, j;
+    for (j = 0; j <= n2; ++j)
+        row[j] = 0;
+    for (i1 = end1 - 1; i1 >= begin1; --i1) {
+        /* row[j] holds the common prefix length at i1 + 1, j + 1 until it
+         * is overwritten with that at i1, j */
+        int diagonal = 0;
+        for (j = n2 - 1; j >= 0; --j) {
+            i2 = begin2 + j;
+            int prefix = *i1 == *i2 ? diagonal + 1 : 0;
+            diagonal = row[j];
+            row[j] = prefix;
+            if (prefix && prefix >= length) {
+                length = prefix;
+                start1 = i1;
+                start2 = i2;
             }
         }
     }
-    return length ? ratcliff_obershelp(begin1, start1, begin2, start2) + length + ratcliff_obershelp(start1 + length, end1, start2 + length, end2) : 0;
+    return length ? ratcliff_obershelp(begin1, start1, begin2, start2, row) + length + ratcliff_obershelp(start1 + length, end1, start2 + length, end2, row) : 0;
+}
+
+/* Returns the similarity of s1 to s2, twice the number of characters
+ * matched over their total length, with row as in ratcliff_obershelp */
+static double
+ratcliff(VALUE s1, VALUE s2, int *row)
+{
+    if (RSTRING(s1)->len == 1 && RSTRING(s2)->len == 1)
+        return RSTRING(s1)->ptr[0] == RSTRING(s2)->ptr[0] ? 1.0 : 0.0;
+    int matches = ratcliff_obershelp(RSTRING(s1)->ptr, RSTRING(s1)->ptr + RSTRING(s1)->len, RSTRING(s2)->ptr, RSTRING(s2)->ptr + RSTRING(s2)->len, row);
+    return 2.0 * matches / (RSTRING(s1)->len + RSTRING(s2)->len);
 }
 
 static VALUE
@@ -37,11 +56,53 @@ String_ratcliff(VALUE self, VALUE s)
     Check_Type(s, T_STRING);
     if (RSTRING(self)->len == 1 && RSTRING(s)->len == 1)
         return INT2FIX(RSTRING(self)->ptr[0] == RSTRING(s)->ptr[0] ? 1 : 0);
-    else
-        return rb_float_new(2.0 * ratcliff_obershelp(RSTRING(self)->ptr, RSTRING(self)->ptr + RSTRING(self)->len, RSTRING(s)->ptr, RSTRING(s)->ptr + RSTRING(s)->len) / (RSTRING(self)->len + RSTRING(s)->len));
+    int *row = ALLOC_N(int, RSTRING(s)->len + 1);
+    double similarity = ratcliff(self, s, row);
+    xfree(row);
+    return rb_float_new(similarity);
+}
+
+/* Returns, for each of strings, the sum of its similarities to all of
+ * them and of theirs to it, itself included.  The similarity is not
+ * symmetric, since the leftmost longest match depends on the order of the
+ * strings, so each pair is compared both ways. */
+static VALUE
+Ratcliff_popularities(VALUE self, VALUE strings)
+{
+    Check_Type(strings, T_ARRAY);
+    long n = RARRAY(strings)->len, i, j;
+    long max_len = 0;
+    for (i = 0; i < n; ++i) {
+        Check_Type(RARRAY(strings)->ptr[i], T_STRING);
+        if (RSTRING(RARRAY(strings)->ptr[i])->len > max_len)
+            max_len = RSTRING(RARRAY(strings)->ptr[i])->len;
+    }
+    int *row = ALLOC_N(int, max_len + 1);
+    double *sums = ALLOC_N(double, n ? n : 1);
+    for (i = 0; i < n; ++i)
+        sums[i] = 0.0;
+    for (i = 0; i < n; ++i)
+        for (j = i; j < n; ++j) {
+            double similarity = ratcliff(RARRAY(strings)->ptr[i], RARRAY(strings)->ptr[j], row);
+            if (j != i)
+                similarity += ratcliff(RARRAY(strings)->ptr[j], RARRAY(strings)->ptr[i], row);
+            else
+                similarity *= 2.0;
+            sums[i] += similarity;
+            if (j != i)
+                sums[j] += similarity;
+        }
+    VALUE popularities = rb_ary_new2(n);
+    for (i = 0; i < n; ++i)
+        rb_ary_push(popularities, rb_float_new(sums[i]));
+    xfree(sums);
+    xfree(row);
+    return popularities;
 }
 
 void Init_ratcliff(void)
 {
     rb_define_method(rb_cString, "ratcliff", String_ratcliff, 1);
+    VALUE mRatcliff = rb_define_module("Ratcliff");
+    rb_define_module_function(mRatcliff, "popularities", Ratcliff_popularities, 1);
 }
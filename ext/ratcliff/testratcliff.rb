@@ -23,4 +23,36 @@ class TC_Ratcliff < Test::Unit::TestCase
     assert_equal(0.5, "ab".ratcliff("ba"))
   end
 
+  # The original recursive matcher, scanning every pair of positions for
+  # the leftmost longest common substring
+  def reference(s1, s2)
+    return 0 if s1.empty? or s2.empty? or (s1.length == 1 and s2.length == 1)
+    length, start1, start2 = 0, nil, nil
+    (0...s1.length).each do |i1|
+      (0...s2.length).each do |i2|
+        j = 0
+        j += 1 while i1 + j < s1.length and i2 + j < s2.length and s1[i1 + j] == s2[i2 + j]
+        length, start1, start2 = j, i1, i2 if j > length
+      end
+    end
+    return 0 if length.zero?
+    reference(s1[0, start1], s2[0, start2]) + length + reference(s1[start1 + length..-1], s2[start2 + length..-1])
+  end
+
+  def test_reference
+    srand(1)
+    200.times do
+      s1, s2 = Array.new(2) { Array.new(rand(12)) { "abc"[rand(3), 1] }.join }
+      next if s1.length + s2.length < 2 or (s1.length == 1 and s2.length == 1)
+      assert_equal(2.0 * reference(s1, s2) / (s1.length + s2.length), s1.ratcliff(s2), "#{s1} #{s2}")
+    end
+  end
+
+  def test_popularities
+    names = ["st hilaire", "st hilaire du touvet", "lumbin", "st hilaire"]
+    expected = names.collect { |n1| names.inject(0.0) { |sum, n2| sum + n1.ratcliff(n2) + n2.ratcliff(n1) } }
+    Ratcliff.popularities(names).zip(expected).each { |popularity, e| assert_in_delta(e, popularity, 1e-9) }
+    assert_equal([], Ratcliff.popularities([]))
+  end
+
 end
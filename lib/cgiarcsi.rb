@@ -1,10 +1,7 @@
 require "fileutils"
 require "lib"
-require "mmap"
 require "net/http"
-require "singleton"
 require "tempfile"
-require "zip/zip"
 
 module CGIARCSI
 
@@ -21,89 +18,57 @@ module CGIARCSI
     ZIP_CACHE_DIRECTORY = File.join(CACHE_DIRECTORY, "zip")
     TILE_CACHE_DIRECTORY = File.join(CACHE_DIRECTORY, "tile")
 
-    @@tiles = {}
-
-    class NoTile
-
-      include Singleton
-
-      def [](i, j)
-        0
-      end
-
-    end
-
-    class Tile
-
-      def initialize(mmap)
-        @mmap = mmap
-        @mmap.madvise(Mmap::MADV_RANDOM)
-      end
-
-      def [](i, j)
-        @mmap[2 * (6000 * j + i), 2].unpack("s")[0]
-      end
-
-      class << self
+    class << self
 
-        def new(x, y, download = true)
-          return NoTile.instance unless (1..72).include?(x) and (1..24).include?(y)
-          FileUtils.mkpath([TILE_CACHE_DIRECTORY, ZIP_CACHE_DIRECTORY])
-          tile = File.join(TILE_CACHE_DIRECTORY, "srtm_%02d_%02d.tile" % [x, y])
-          return super(Mmap.new(tile)) if FileTest.exist?(tile) and !FileTest.zero?(tile)
-          return NoTile.instance if FileTest.exist?("#{tile}.404")
-          zip = "srtm_%02d_%02d.zip" % [x, y]
-          zip_cache_filename = File.join(ZIP_CACHE_DIRECTORY, zip)
-          unless FileTest.exist?(zip_cache_filename) and !FileTest.zero?(zip_cache_filename)
-            return nil unless download
-            uri = URI.parse("#{MIRROR}#{zip}")
-            Tempfile.open(zip) do |tempfile|
-              Net::HTTP.start(uri.host, uri.port) do |http|
-                http.request_get(uri.request_uri) do |request|
-                  case request
-                  when Net::HTTPOK
-                    request.read_body do |segment|
-                      tempfile.write(segment)
-                    end
-                  when Net::HTTPNotFound
-                    FileUtils.touch("#{tile}.404")
-                    return NoTile.instance
-                  else
-                    raise request
+      # Returns the filename of tile x, y, downloading and converting it if
+      # necessary.  Returns false if there is no such tile, or nil if it
+      # has not been downloaded and download is false.  Tiles cached before
+      # compressed tiles were introduced are used as they are.
+      def tile_filename(x, y, download = true)
+        return false unless (1..72).include?(x) and (1..24).include?(y)
+        FileUtils.mkpath([TILE_CACHE_DIRECTORY, ZIP_CACHE_DIRECTORY])
+        dem = File.join(TILE_CACHE_DIRECTORY, "srtm_%02d_%02d.dem" % [x, y])
+        return dem if FileTest.exist?(dem) and !FileTest.zero?(dem)
+        tile = File.join(TILE_CACHE_DIRECTORY, "srtm_%02d_%02d.tile" % [x, y])
+        return tile if FileTest.exist?(tile) and !FileTest.zero?(tile)
+        return false if FileTest.exist?("#{tile}.404")
+        zip = "srtm_%02d_%02d.zip" % [x, y]
+        zip_cache_filename = File.join(ZIP_CACHE_DIRECTORY, zip)
+        unless FileTest.exist?(zip_cache_filename) and !FileTest.zero?(zip_cache_filename)
+          return nil unless download
+          uri = URI.parse("#{MIRROR}#{zip}")
+          Tempfile.open(zip) do |tempfile|
+            Net::HTTP.start(uri.host, uri.port) do |http|
+              http.request_get(uri.request_uri) do |request|
+                case request
+                when Net::HTTPOK
+                  request.read_body do |segment|
+                    tempfile.write(segment)
                   end
+                when Net::HTTPNotFound
+                  FileUtils.touch("#{tile}.404")
+                  return false
+                else
+                  raise request
                 end
               end
-              FileUtils.mv(tempfile.path, zip_cache_filename)
-            end
-          end
-          Zip::ZipInputStream.open(zip_cache_filename) do |zis|
-            asc = "Z_%d_%d.ASC" % [x, y]
-            while entry = zis.get_next_entry
-              next unless entry.name == asc
-              File.open(tile, "w+") do |io|
-                CGIARCSI.parse_ASC(entry.get_input_stream, io)
-              end
             end
+            FileUtils.mv(tempfile.path, zip_cache_filename)
           end
-          return super(Mmap.new(tile))
         end
+        convert(zip_cache_filename, dem)
+        dem
       end
 
-    end
-
-    class << self
-
-      def available?(lat, lon)
-        x, i = (lon + 185 + 0.5 / 1200).divmod(5)
-        y, j = (65 - lat + 0.5 / 1200).divmod(5)
-        @@tiles[72 * (y - 1) + (x - 1)] ||= Tile.new(x, y, false)
-      end
-
-      def [](lat, lon)
-        x, i = (lon + 185 + 0.5 / 1200).divmod(5)
-        y, j = (65 - lat + 0.5 / 1200).divmod(5)
-        tile = @@tiles[72 * (y - 1) + (x - 1)] ||= Tile.new(x, y)
-        tile[(1200 * i).to_i, (1200 * j).to_i]
+      # Maps every tile already in the cache, so that processes forked
+      # afterwards share the mappings rather than each mapping the tiles
+      # it needs.  Returns the number of tiles mapped.
+      def map_cached_tiles
+        Dir[File.join(TILE_CACHE_DIRECTORY, "srtm_[0-9][0-9]_[0-9][0-9].{dem,tile}")].collect do |filename|
+          File.basename(filename)[/\d+_\d+/].split(/_/).collect(&:to_i)
+        end.uniq.select do |x, y|
+          available?(62.5 - 5 * y, 5 * x - 182.5)
+        end.length
       end
 
     end
@@ -113,3 +78,4 @@ module CGIARCSI
 end
 
 require "ccgiarcsi"
+require "csrtm"
@@ -0,0 +1,20 @@
+require "lib"
+
+# A native RGBA canvas for drawing graphs and scales straight into a PNG.
+# Colors are integers of the form 0xRRGGBBAA.
+class Chart
+
+  BLACK = 0x000000ff
+  WHITE = 0xffffffff
+
+  class << self
+
+    def color(red, green, blue, alpha = 255)
+      [red, green, blue, alpha].inject(0) { |color, channel| (color << 8) | channel.round.constrain(0, 255) }
+    end
+
+  end
+
+end
+
+require "cchart"
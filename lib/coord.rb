@@ -66,4 +66,44 @@ class Coord
 
 end
 
+# Coordinates stored as packed doubles, one string per column, like those
+# of an IGC::FixBuffer.  times may be nil.  Batch methods write their
+# results into packed strings, resizing an optional output argument in
+# place so that it can be reused, rather than creating a Coord per fix.
+class CoordArray
+
+  attr_reader :lats
+  attr_reader :lons
+  attr_reader :alts
+  attr_reader :times
+
+  def initialize(lats, lons, alts, times = nil)
+    @lats = lats
+    @lons = lons
+    @alts = alts
+    @times = times
+  end
+
+  class << self
+
+    def new_from_fix_buffer(fix_buffer)
+      new(fix_buffer.lats, fix_buffer.lons, fix_buffer.alts, fix_buffer.times)
+    end
+
+  end
+
+  def length
+    @lats.length / 8
+  end
+
+  alias size length
+
+  def [](index)
+    index += length if index < 0
+    return nil unless (0...length).include?(index)
+    Coord.new(*[@lats, @lons, @alts].collect { |column| column.unpack("@#{8 * index}d")[0] })
+  end
+
+end
+
 require "ccoord"
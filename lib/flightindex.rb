@@ -0,0 +1,125 @@
+require "bounds"
+require "cmemofile"
+require "kml"
+require "kml/rmagick"
+require "rtree"
+
+# An archive of flights indexed by the bounds of their tracks and their
+# times.  The index is an R-tree in path.rtree and the flights' names and
+# tracks are kept in the memo file path.memo, so opening an index only
+# maps the two files and each flight's KML is generated when it is
+# requested.
+class FlightIndex
+
+  # The columns of a stored track, like those of an IGC::FixBuffer
+  Track = Struct.new(:lats, :lons, :alts, :length)
+
+  class Builder
+
+    def initialize(path)
+      @path = path
+      @boxes = []
+      @memo_filename = "#{path}.memo.#{$$}"
+      @rtree_filename = "#{path}.rtree.#{$$}"
+      @store = MemoFile.new(@memo_filename)
+    end
+
+    # Adds the flight in igc, returning its id or nil if it has no fixes
+    def add(name, igc)
+      fix_buffer = igc.fix_buffer
+      return nil if fix_buffer.length.zero?
+      id = @boxes.length
+      lat, lon, time = [:lats, :lons, :times].collect { |column| fix_buffer.send(column).unpack("d*").bounds }
+      @boxes << [lon.first, lat.first, time.first, lon.last, lat.last, time.last]
+      @store["flight:#{id}"] = Marshal.dump([name, igc.bsignature.hex.to_f / 2 ** 128])
+      @store["track:#{id}"] = Marshal.dump([fix_buffer.lats, fix_buffer.lons, fix_buffer.alts])
+      id
+    end
+
+    def length
+      @boxes.length
+    end
+
+    # Replaces the index at path once both its R-tree and memo file are
+    # complete
+    def close
+      @store.close
+      RTree.build(@rtree_filename, @boxes)
+      File.rename(@rtree_filename, "#{@path}.rtree")
+      File.rename(@memo_filename, "#{@path}.memo")
+    ensure
+      abort
+    end
+
+    # Discards the flights added, leaving the index at path as it was
+    def abort
+      @store.close
+    ensure
+      [@rtree_filename, @memo_filename].each do |filename|
+        File.unlink(filename) if FileTest.exist?(filename)
+      end
+    end
+
+  end
+
+  def initialize(path)
+    @rtree = RTree.new("#{path}.rtree")
+    @store = MemoFile.new("#{path}.memo")
+  end
+
+  def length
+    @rtree.length
+  end
+
+  # Returns the ids of the flights whose tracks' bounds intersect bbox,
+  # [west, south, east, north] in radians, and whose times intersect the
+  # range times if given, largest first.
+  def search(bbox, times = nil, limit = nil)
+    @rtree.search(bbox, times, limit)
+  end
+
+  def name(id)
+    flight(id)[0]
+  end
+
+  def to_kml(id)
+    name, hue = flight(id)
+    lats, lons, alts = Marshal.load(@store["track:#{id}"])
+    track = Track.new(lats, lons, alts, lats.length / 8)
+    line_string = KML::LineString.new(KML::Coordinates.new_from_fix_buffer(track), :altitudeMode => :absolute)
+    line_style = KML::LineStyle.new(KML::Color.pixel(Magick::Pixel.from_HSL([hue, 1.0, 0.5])))
+    placemark = KML::Placemark.new(KML::Name.new(name), line_string, KML::Style.new(line_style))
+    KML.new(placemark).to_s
+  end
+
+  def close
+    @rtree.close
+    @store.close
+  end
+
+  class << self
+
+    # Yields a Builder to which flights are added, replacing the index at
+    # path once they all have been
+    def build(path)
+      builder = Builder.new(path)
+      begin
+        yield builder
+      rescue Exception
+        builder.abort
+        raise
+      end
+      builder.close
+      builder
+    end
+
+  end
+
+  private
+
+  def flight(id)
+    value = @store["flight:#{id}"] or raise IndexError, "no flight #{id}"
+    Marshal.load(value)
+  end
+
+end
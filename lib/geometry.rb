@@ -12,6 +12,34 @@ class Point
 
 end
 
+# Points stored as packed doubles, one string per column, like a
+# CoordArray.
+class PointArray
+
+  attr_reader :xs
+  attr_reader :ys
+  attr_reader :zs
+
+  def initialize(xs, ys, zs)
+    @xs = xs
+    @ys = ys
+    @zs = zs
+  end
+
+  def length
+    @xs.length / 8
+  end
+
+  alias size length
+
+  def [](index)
+    index += length if index < 0
+    return nil unless (0...length).include?(index)
+    Point.new(*[@xs, @ys, @zs].collect { |column| column.unpack("@#{8 * index}d")[0] })
+  end
+
+end
+
 class Line
 
   attr_accessor :a
@@ -0,0 +1,157 @@
+require "chart"
+require "coord"
+require "kml"
+require "kmz"
+
+# A grid of the climbs of many flights.  Heatmaps are written as KMZ files
+# holding either a single GroundOverlay or a super-overlay of tiles, each
+# pixel of which covers 2**level by 2**level cells, loaded by Regions as
+# they are needed.  A heatmap saved to an accumulator file records the
+# signatures of its flights so that it can be updated with only new
+# flights.
+class Heatmap
+
+  # The number of samples per cell at which a cell is half opaque
+  OPACITY_SCALE = 1000.0
+  TILE_SIZE = 256
+
+  class << self
+
+    # Loads the heatmap saved to filename
+    def load(filename)
+      heatmap, trailer = read(filename)
+      trailer.split("\n").each { |key| heatmap.keys[key] = true }
+      heatmap
+    end
+
+  end
+
+  # The signatures of the flights added
+  def keys
+    @keys ||= {}
+  end
+
+  # Adds the flights in igcs that have fixes and have not already been
+  # added, returning the number added
+  def add_igcs(igcs)
+    fix_buffers = []
+    igcs.each do |igc|
+      next if igc.fixes.empty? or keys[igc.bsignature]
+      keys[igc.bsignature] = true
+      fix_buffers << igc.fix_buffer
+    end
+    add(fix_buffers)
+    fix_buffers.length
+  end
+
+  # Saves the heatmap to filename, replacing it only once it is complete
+  def save(filename)
+    tmpfilename = "#{filename}.#{$$}"
+    write(tmpfilename, keys.keys.sort.join("\n"))
+    File.rename(tmpfilename, filename)
+  ensure
+    File.unlink(tmpfilename) if tmpfilename and FileTest.exist?(tmpfilename)
+  end
+
+  # Returns the number of pixels across and down at level
+  def size(level)
+    [width, height].collect { |cells| (cells + (1 << level) - 1) >> level }
+  end
+
+  # Returns the lowest level at which the heatmap fits in a single tile
+  def top_level
+    level = 0
+    level += 1 while size(level).max > TILE_SIZE
+    level
+  end
+
+  def to_png(level, col, row, width, height, opacity_scale = OPACITY_SCALE)
+    rgba = to_rgba(level, col, row, width, height, opacity_scale) or return nil
+    chart = Chart.new(width, height)
+    chart.pixels = rgba
+    chart.to_png
+  end
+
+  def write_kmz(filename, options = {})
+    opacity_scale = options[:opacity_scale] || OPACITY_SCALE
+    name = options[:name] || "Thermals"
+    KMZ::ZipWriter.open(filename) do |zip|
+      if options[:super_overlay]
+        write_tile(zip, name, top_level, 0, 0, opacity_scale, "doc.kml", "tiles/")
+      else
+        width, height = size(0)
+        png = to_png(0, 0, 0, width, height, opacity_scale)
+        document = KML::Document.new(KML::Name.new(name))
+        document.add(ground_overlay(0, 0, 0, width, height, "heatmap.png")) if png
+        zip.entry("doc.kml") { |io| KML.new(document).pretty_write(io) }
+        zip.add("heatmap.png", png) if png
+      end
+    end
+  end
+
+  private
+
+  # Returns the rectangle of pixels of tile i, j of level
+  def tile_rect(level, i, j)
+    cols, rows = size(level)
+    col, row = TILE_SIZE * i, TILE_SIZE * j
+    [col, row, [TILE_SIZE, cols - col].min, [TILE_SIZE, rows - row].min]
+  end
+
+  def lat_lon_box(klass, level, col, row, width, height)
+    west, south, east, north = bounds
+    dlon = (east - west) * (1 << level) / self.width
+    dlat = (north - south) * (1 << level) / self.height
+    north, south, east, west = [north - row * dlat, north - (row + height) * dlat, west + (col + width) * dlon, west + col * dlon].collect do |angle|
+      "%.6f" % angle.to_deg
+    end
+    klass.new(KML::North.new(north), KML::South.new(south), KML::East.new(east), KML::West.new(west))
+  end
+
+  def region(level, col, row, width, height, min_lod_pixels, max_lod_pixels)
+    lod = KML::Lod.new(KML::MinLodPixels.new(min_lod_pixels), KML::MaxLodPixels.new(max_lod_pixels))
+    KML::Region.new(lat_lon_box(KML::LatLonAltBox, level, col, row, width, height), lod)
+  end
+
+  def ground_overlay(level, col, row, width, height, href, *children)
+    icon = KML::Icon.new(KML::Href.new(href))
+    KML::GroundOverlay.new(KML::DrawOrder.new(top_level - level), icon, lat_lon_box(KML::LatLonBox, level, col, row, width, height), *children)
+  end
+
+  # Writes tile i, j of level to filename in zip followed by its image and
+  # its non-empty children, whose files are in directory relative to
+  # filename.  Each tile is shown from when it is half a tile across until
+  # its children, at the level below, are as large.
+  def write_tile(zip, name, level, i, j, opacity_scale, filename, directory)
+    col, row, width, height = tile_rect(level, i, j)
+    children = []
+    if level > 0
+      cols, rows = size(level - 1)
+      [2 * j, 2 * j + 1].each do |cj|
+        [2 * i, 2 * i + 1].each do |ci|
+          next unless TILE_SIZE * ci < cols and TILE_SIZE * cj < rows
+          children << [ci, cj] if count(level - 1, *tile_rect(level - 1, ci, cj)) > 0
+        end
+      end
+    end
+    tile_name = "#{level}_#{i}_#{j}"
+    png = to_png(level, col, row, width, height, opacity_scale)
+    min_lod_pixels = level == top_level ? 0 : TILE_SIZE / 2
+    max_lod_pixels = children.empty? ? -1 : 2 * TILE_SIZE
+    document = KML::Document.new
+    document.add(KML::Name.new(name)) if name
+    document.add(ground_overlay(level, col, row, width, height, "#{directory}#{tile_name}.png", region(level, col, row, width, height, min_lod_pixels, max_lod_pixels))) if png
+    children.each do |ci, cj|
+      link = KML::Link.new(KML::Href.new("#{directory}#{level - 1}_#{ci}_#{cj}.kml"), KML::ViewRefreshMode.new(:onRegion))
+      document.add(KML::NetworkLink.new(region(level - 1, *tile_rect(level - 1, ci, cj) + [TILE_SIZE / 2, -1]), link))
+    end
+    zip.entry(filename) { |io| KML.new(document).pretty_write(io) }
+    zip.add("tiles/#{tile_name}.png", png) if png
+    children.each do |ci, cj|
+      write_tile(zip, nil, level - 1, ci, cj, opacity_scale, "tiles/#{level - 1}_#{ci}_#{cj}.kml", "")
+    end
+  end
+
+end
+
+require "cheatmap"
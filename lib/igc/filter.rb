@@ -3,13 +3,19 @@ require "igc"
 
 class IGC
 
+  # Drops each fix at the same position as the one before it.  Afterwards
+  # fixes is an Array of IGC::Fix rather than an IGC::FixArray, so code
+  # that needs the packed lats, lons, alts and times columns must take them
+  # from fix_buffer, which is rebuilt as an IGC::FixBuffer.
   def filter_duplicate_fixes!
+    return self if @fixes.empty?
     filtered_fixes = [@fixes.first]
     @fixes.each_cons(2) do |fix0, fix1|
       filtered_fixes << fix1 unless fix0.lat == fix1.lat and fix0.lon == fix1.lon
     end
     @fixes = filtered_fixes
     @times = @fixes.collect(&:time).collect!(&:to_i)
+    @fix_buffer = FixBuffer.new(@fixes)
     self
   end
 
@@ -0,0 +1,19 @@
+require "gpx"
+require "igc"
+require "xc/gpx"
+
+class IGC
+
+  # Returns a GPX document of the flights in xcs, a hash of leagues to
+  # flights, best scoring first.
+  def to_xc_gpx(leagues, xcs)
+    name = GPX::Name.new(@header[:pilot])
+    desc = GPX::Desc.new(leagues.collect(&:description).compact.join(", "))
+    bounds = GPX::Bounds.new({"minlat" => @bounds.lat.first.to_deg, "minlon" => @bounds.lon.first.to_deg, "maxlat" => @bounds.lat.last.to_deg, "maxlon" => @bounds.lon.last.to_deg})
+    time = GPX::Time.new(@fixes[0].time.to_gpx)
+    metadata = GPX::Metadata.new(name, desc, bounds, time)
+    rtes = leagues.collect { |league| xcs[league] }.flatten.sort_by(&:score).reverse.collect(&:to_gpx)
+    GPX.new(metadata, *rtes)
+  end
+
+end
@@ -9,16 +9,22 @@ require "ostruct"
 require "photo/kmz"
 require "magick"
 require "cgiarcsi"
+require "chart"
 require "sponsor/kmz"
 require "task"
 require "task/kmz"
 require "units"
-require "rvg/rvg"
 require "xc"
 require "xc/kmz"
 
 class Scale
 
+  GRAPH_WIDTH = 640
+  GRAPH_HEIGHT = 240
+  GRAPH_MINOR_GRID = 0xddddddff
+  GRAPH_MAJOR_GRID = 0xbbbbbbff
+  GRAPH_GROUND = 0x00000040
+
   class Border
 
     attr_reader :top
@@ -69,8 +75,9 @@ class Scale
     @gradient = gradient
   end
 
-  def color_of(value)
-    pixel_of(value).to_color(Magick::SVGCompliance)
+  def rgba_of(value)
+    pixel = pixel_of(value)
+    Chart.color(*[:red, :green, :blue].collect { |channel| 255.0 * pixel.send(channel) / Magick::MaxRGB })
   end
 
   def pixel_of(value)
@@ -91,6 +98,13 @@ class Scale
     (steps * (value - @range.first) / (@range.last - @range.first)).round.constrain(0, steps - 1)
   end
 
+  # Yields the step and coordinates text of each run of fixes in fix_buffer
+  # whose packed values discretize to the same step.  integral tells whether
+  # the values were Integers, as discretize divides them differently.
+  def each_segment(fix_buffer, values, integral = false, steps = 32, &block)
+    KML.segment_coordinates(fix_buffer.lats, fix_buffer.lons, fix_buffer.alts, values, integral, @range.first, @range.last, steps, &block)
+  end
+
   def make_step(n, steps = [[0.5, 5], [1.0, 5]])
     width = @unit.multiplier.to_f * (@range.last - @range.first) / n
     i = steps.length * (Math.log10(width).floor - 1)
@@ -133,35 +147,29 @@ class Scale
   def to_image
     border = Border.new(8)
     width, height = 64, 256
-    Magick::RVG.new(width + border.width, height + border.height) do |canvas|
-      canvas.g.translate(border.left, border.top) do |scale|
-        scale.styles(:font_family => "Verdana", :font_size => 9, :font_weight => "bold", :stroke => "none")
-        step = make_scale_step(7)
-        unit = (step * @unit.multiplier) == (step * @unit.multiplier).to_i ? @unit.integer_unit : @unit
-        i = (@range.first / step).ceil
-        value = step * i
-        while value < @range.last
-          y = (height * (1.0 - (value - @range.first) / (@range.last - @range.first))).round
-          color = color_of(value)
-          scale.line(0, y, 8, y).styles(:stroke => color)
-          scale.text(12, y, unit[value]).d(0, 4).styles(:fill => color)
-          i += 1
-          value = step * i
-        end
-        (0...height).each do |y|
-          value = @range.last - (y + 0.5) * (@range.last - @range.first) / height
-          color = color_of(value)
-          scale.line(0, y, 4, y).styles(:stroke => color)
-        end
-      end
-    end.draw.outline do
-      self.background_color = "transparent"
+    chart = Chart.new(width + border.width, height + border.height)
+    step = make_scale_step(7)
+    unit = (step * @unit.multiplier) == (step * @unit.multiplier).to_i ? @unit.integer_unit : @unit
+    i = (@range.first / step).ceil
+    value = step * i
+    while value < @range.last
+      y = border.top + (height * (1.0 - (value - @range.first) / (@range.last - @range.first))).round
+      color = rgba_of(value)
+      chart.line(border.left, y, border.left + 8, y, color)
+      chart.text(border.left + 12, y + 4, unit[value], 9, color, :start)
+      i += 1
+      value = step * i
     end
+    (0...height).each do |y|
+      value = @range.last - (y + 0.5) * (@range.last - @range.first) / height
+      chart.line(border.left, border.top + y, border.left + 4, border.top + y, rgba_of(value))
+    end
+    chart.outline(Chart::BLACK)
   end
 
   def to_graph_image(hints, times, values, background)
     border = Border.new(16, 4, 16, 36)
-    width, height = 640 - border.width, 240 - border.height
+    width, height = GRAPH_WIDTH - border.width, GRAPH_HEIGHT - border.height
     tstep, tdivisions = make_time_step(times[-1] - times[0], 6)
     time_format = tstep < 60 ? "%H:%M:%S" : "%H:%M"
     xticks = (((tdivisions * times[0] + tstep - 1) / tstep)..(tdivisions * times[-1] / tstep)).collect do |i|
@@ -178,50 +186,29 @@ class Scale
       label = (i % vdivisions).zero? ? vunit.convert(v) : nil
       [(height.to_f * (v - vmin) / (vmax - vmin)).round, label]
     end
-    graph_image = Magick::RVG.new(width + border.width, height + border.height) do |canvas|
-      canvas.g.translate(border.left, border.top + height).scale(1, -1) do |graph|
-        graph.styles(:stroke => "black")
-        graph.rect(width, height).styles(:fill => "white", :stroke => "none")
-        graph.g.styles(:stroke => "#ddd") do |minor_grid|
-          xticks.each { |x, label| minor_grid.line(x, 0, x, height) unless label }
-          yticks.each { |y, label| minor_grid.line(0, y, width, y) unless label }
-        end
-        graph.g.styles(:stroke => "#bbb") do |major_grid|
-          xticks.each { |x, label| major_grid.line(x, 0, x, height) if label }
-          yticks.each { |y, label| major_grid.line(0, y, width, y) if label }
-        end
-        if background
-          xs = times.collect { |t| width.to_f * (t - times[0]) / (times[-1] - times[0]) }
-          ys = background.collect { |v| height.to_f * (v - vmin) / (vmax - vmin) }
-          xs << [width, 0]
-          ys << [0, 0]
-          graph.polygon(xs, ys).styles(:fill => "#00000040", :stroke => "none")
-        end
-        xticks.each { |x, label| graph.line(x, 0, x, label ? -4 : -2) }
-        yticks.each { |y, label| graph.line(0, y, label ? -4 : -2, y) }
-        graph.rect(width, height).styles(:fill => "none")
-        xs = times.collect { |t| width.to_f * (t - times[0]) / (times[-1] - times[0]) }
-        ys = values.collect { |v| height.to_f * (v - vmin) / (vmax - vmin) }
-        graph.polyline(xs, ys).styles(:fill => "none")
-      end
-    end.draw
-    Magick::RVG.new(width + border.width, height + border.height) do |canvas|
-      canvas.g.translate(border.left, border.top + height) do |labels|
-        labels.styles(:fill => "white", :font_family => "Verdana", :font_weight => "bold", :stroke => "none")
-        labels.g.styles(:font_size => 9) do |axes|
-          axes.g.styles(:text_anchor => "middle") do |xaxis|
-            xticks.each { |x, label| xaxis.text(x, 4, label).d(0, 9) if label }
-          end
-          axes.g.styles(:text_anchor => "end") do |yaxis|
-            yticks.each { |y, label| yaxis.text(-4, -y, label).d(0, 4) if label }
-          end
-        end
-        title = "#{@title.capitalize} (#{@unit.unit})"
-        labels.text(0, -height - 4, title).styles(:font_size => 11, :text_anchor => "start")
-      end
-    end.draw.outline do
-      self.background_color = "transparent"
-    end.composite!(graph_image, 0, 0, Magick::OverCompositeOp)
+    left, right, top, bottom = border.left, border.left + width, border.top, border.top + height
+    graph = Chart.new(width + border.width, height + border.height)
+    graph.fill_rect(left, top, width + 1, height + 1, Chart::WHITE)
+    xticks.each { |x, label| graph.line(left + x, top, left + x, bottom, GRAPH_MINOR_GRID) unless label }
+    yticks.each { |y, label| graph.line(left, bottom - y, right, bottom - y, GRAPH_MINOR_GRID) unless label }
+    xticks.each { |x, label| graph.line(left + x, top, left + x, bottom, GRAPH_MAJOR_GRID) if label }
+    yticks.each { |y, label| graph.line(left, bottom - y, right, bottom - y, GRAPH_MAJOR_GRID) if label }
+    packed_times = times.pack("d*")
+    graph.viewport(left, top, width, height, times[0], times[-1], vmin, vmax)
+    graph.fill_below(packed_times, background.pack("d*"), GRAPH_GROUND) if background
+    xticks.each { |x, label| graph.line(left + x, bottom, left + x, bottom + (label ? 4 : 2), Chart::BLACK) }
+    yticks.each { |y, label| graph.line(left, bottom - y, left - (label ? 4 : 2), bottom - y, Chart::BLACK) }
+    graph.line(left, top, right, top, Chart::BLACK)
+    graph.line(left, bottom, right, bottom, Chart::BLACK)
+    graph.line(left, top, left, bottom, Chart::BLACK)
+    graph.line(right, top, right, bottom, Chart::BLACK)
+    graph.polyline(packed_times, values.pack("d*"), Chart::BLACK)
+    labels = Chart.new(width + border.width, height + border.height)
+    xticks.each { |x, label| labels.text(left + x, bottom + 4 + 9, label, 9, Chart::WHITE, :middle) if label }
+    yticks.each { |y, label| labels.text(left - 4, bottom - y + 4, label, 9, Chart::WHITE, :end) if label }
+    title = "#{@title.capitalize} (#{@unit.unit})"
+    labels.text(left, top - 4, title, 11, Chart::WHITE, :start)
+    labels.outline(Chart::BLACK).composite(graph, 0, 0)
   end
 
 end
@@ -243,6 +230,61 @@ class IGC
   ICON_SCALE = 0.5
   LABEL_SCALES = [1.0, 0.8, 0.6, 0.4].collect(&Math.method(:sqrt))
 
+  # Chunks of at most REGION_FIXES fixes are drawn in full, larger chunks
+  # are split in two once they are REGION_PIXELS across and show at most
+  # about REGION_MARKS time marks each
+  REGION_FIXES = 256
+  REGION_PIXELS = 512
+  REGION_MARKS = 16
+
+  attr_reader :track_log_fix_buffer
+
+  # The fixes first..last and a box around them.  The box is widened so
+  # that it is at least half as wide as it is high and vice versa, as
+  # Google Earth measures a Region by its area.
+  class Chunk
+
+    R = 6371000.0
+    MIN_SIZE = 100.0
+
+    attr_reader :first
+    attr_reader :last
+    attr_reader :extent
+
+    def initialize(fix_buffer, first, last)
+      @first = first
+      @last = last
+      lats, lons, alts = [fix_buffer.lats, fix_buffer.lons, fix_buffer.alts].collect do |column|
+        column.unpack("@#{8 * first}d#{last - first + 1}")
+      end
+      @north, @south = lats.max, lats.min
+      @east, @west = lons.max, lons.min
+      @min_alt, @max_alt = alts.min, alts.max
+      cos_lat = Math.cos(0.5 * (@north + @south))
+      height = R * (@north - @south)
+      width = R * cos_lat * (@east - @west)
+      size = [width, height, MIN_SIZE].max
+      if height < 0.5 * size
+        delta = 0.25 * size / R - 0.5 * (@north - @south)
+        @north, @south, height = @north + delta, @south - delta, 0.5 * size
+      end
+      if width < 0.5 * size
+        delta = 0.25 * size / (R * cos_lat) - 0.5 * (@east - @west)
+        @east, @west, width = @east + delta, @west - delta, 0.5 * size
+      end
+      @extent = Math.sqrt(width * height)
+    end
+
+    def to_kml(hints, min_lod_pixels, max_lod_pixels)
+      north, south, east, west = [@north, @south, @east, @west].collect { |angle| "%.6f" % angle.to_deg }
+      box = KML::LatLonAltBox.new(KML::North.new(north), KML::South.new(south), KML::East.new(east), KML::West.new(west))
+      box.add(KML::MinAltitude.new(@min_alt.to_i), KML::MaxAltitude.new(@max_alt.to_i), KML::AltitudeMode.new(:absolute)) if hints.altitude_mode == :absolute
+      lod = KML::Lod.new(KML::MinLodPixels.new(min_lod_pixels), KML::MaxLodPixels.new(max_lod_pixels))
+      KML::Region.new(box, lod)
+    end
+
+  end
+
   class Fix
 
     def to_kml(hints, name, point_options, *children)
@@ -314,13 +356,17 @@ class IGC
       hints.color = KML::Color.color("red")
       hints.ground = false
       hints.league = nil
+      hints.leagues = nil
       hints.photo_max_width = 4096
       hints.photo_max_height = 4096
       hints.photo_tz_offset = 0
       hints.photos = []
+      hints.regions = false
+      hints.simplify = nil
       hints.stock = stock
       hints.units = Units::GROUPS[:metric]
       hints.width = 2
+      hints.xc_budget = nil
       hints
     end
 
@@ -342,6 +388,7 @@ class IGC
       rows << ["Cross country league", xc.league.description] if xc.league.description
       rows << ["Cross country type", xc.type]
       rows << ["Cross country distance", (xc.multiplier.zero? ? "%s" : "%s (%.1f points)") % [hints.units[:distance][xc.distance], xc.score]]
+      rows << ["Cross country upper bound", hints.units[:distance][xc.bound]] unless xc.gap.zero?
     end
     rows << ["Take off time", @fixes[0].time.to_time(hints)]
     rows << ["Landing time", @fixes[-1].time.to_time(hints)]
@@ -369,8 +416,8 @@ class IGC
       end
       rows << ["Minimum altitude", hints.units[:altitude][@bounds.alt.first]]
       rows << ["Accumulated altitude gain", hints.units[:altitude][sum_alt_gain]]
-      rows << ["Maximum climb", hints.units[:climb][@averages.collect(&:climb).max]]
-      rows << ["Maximum sink", hints.units[:climb][@averages.collect(&:climb).min]]
+      rows << ["Maximum climb", hints.units[:climb][@climbs.max]]
+      rows << ["Maximum sink", hints.units[:climb][@climbs.min]]
     end
     rows << ["Created by", "<a href=\"http://maximumxc.com/\">maximumxc.com</a>"]
     KML::Description.new(KML::CData.new(rows.to_html_table))
@@ -379,7 +426,7 @@ class IGC
   def to_kmz(hints = nil)
     hints = hints ? hints.clone : self.class.default_hints
     hints.tz_offset ||= @tz_offset
-    analyse
+    analyse unless analysed?
     if hints.bounds
       hints.bounds.merge(@bounds)
     else
@@ -387,7 +434,9 @@ class IGC
     end
     hints.igc = self
     hints.altitude_mode ||= altitude_data? ? :absolute : nil
-    hints.xcs = hints.league.memoized_optimize(@bsignature, @fixes) if !hints.task and hints.league
+    leagues = hints.leagues || [hints.league].compact
+    hints.xcs = XC.memoized_optimize(@bsignature, leagues, @fixes, @fix_buffer, hints.xc_budget).values.flatten if !hints.task and !leagues.empty?
+    simplify_track_log(hints)
     hints.scales = OpenStruct.new
     hints.scales.altitude = Scale.new("altitude", hints.bounds.alt, hints.units[:altitude])
     hints.scales.climb = ZeroCenteredScale.new("climb", hints.bounds.climb, hints.units[:climb])
@@ -419,37 +468,120 @@ class IGC
     kmz
   end
 
+  # Splits the fixes in chunk into a binary tree of chunks of at most
+  # leaf_fixes fixes, each but the root written to its own file in the
+  # KMZ behind a NetworkLink whose Region loads it only once it covers
+  # enough of the screen.  Each chunk is shown until its children appear,
+  # when it is REGION_PIXELS across, except for the smallest chunks which
+  # are always shown.  The block writes the contents of each chunk given a
+  # writer, the chunk and the size of a pixel in metres when the chunk is
+  # at its largest (nil for the smallest chunks).  Returns a KMZ of the
+  # root chunk's contents and NetworkLinks.
+  def make_regions(hints, name, leaf_fixes = REGION_FIXES, chunk = Chunk.new(@fix_buffer, 0, @fix_buffer.length - 1), min_lod_pixels = 0, directory = "regions/", &block)
+    leaf = chunk.last - chunk.first < leaf_fixes
+    max_lod_pixels = leaf ? -1 : [2 * min_lod_pixels, REGION_PIXELS].max
+    pixel = leaf ? nil : chunk.extent / max_lod_pixels
+    contents = KML::Folder.new(chunk.to_kml(hints, min_lod_pixels, max_lod_pixels), KML::Generator.new { |writer| block.call(writer, chunk, pixel) })
+    links = []
+    files = {}
+    unless leaf
+      middle = (chunk.first + chunk.last) / 2
+      [[chunk.first, middle], [middle, chunk.last]].each_with_index do |(first, last), index|
+        child = Chunk.new(@fix_buffer, first, last)
+        child_name = "#{name}_#{index}"
+        child_min_lod_pixels = (max_lod_pixels * child.extent / chunk.extent).ceil
+        child_kmz = make_regions(hints, child_name, leaf_fixes, child, child_min_lod_pixels, "", &block)
+        files["regions/#{child_name}.kml"] = KML.new(KML::Document.new(*child_kmz.elements))
+        files.merge!(child_kmz.files)
+        link = KML::Link.new(KML::Href.new("#{directory}#{child_name}.kml"), KML::ViewRefreshMode.new(:onRegion))
+        links << KML::NetworkLink.new(child.to_kml(hints, child_min_lod_pixels, -1), link)
+      end
+    end
+    KMZ.new(contents, *links).merge_files(files)
+  end
+
+  # Chooses the fixes drawn in the track logs.  If hints.simplify is set
+  # then the track is simplified to within that many metres, keeping the
+  # altitude extremes and the XC turnpoints.
+  def simplify_track_log(hints)
+    @track_log_keep = @alt_extremes.collect(&:index)
+    hints.xcs.each { |xc| @track_log_keep.concat(xc.indexes) if xc.indexes } if hints.xcs
+    @track_log_keep = @track_log_keep.find_all { |index| (0...@fix_buffer.length).include?(index) }
+    if hints.simplify
+      @track_log_indexes = IGC.simplify_fix_buffer(@fix_buffer, hints.simplify, @track_log_keep)
+      @track_log_fix_buffer = FixBuffer.new(@track_log_indexes.collect { |index| @fixes[index] })
+    else
+      @track_log_indexes = nil
+      @track_log_fix_buffer = @fix_buffer
+    end
+  end
+
+  def track_log_values(values)
+    (@track_log_indexes ? values.values_at(*@track_log_indexes) : values).pack("d*")
+  end
+
+  # Returns the indexes of the fixes drawn in chunk, simplified to within
+  # pixel metres for all but the smallest chunks
+  def chunk_indexes(hints, chunk, pixel)
+    tolerance = [pixel, hints.simplify].compact.max
+    if tolerance
+      IGC.simplify_fix_buffer(@fix_buffer, tolerance, @track_log_keep, chunk.first, chunk.last)
+    else
+      (chunk.first..chunk.last).to_a
+    end
+  end
+
   def make_monochromatic_track_log(hints, color, width, altitude_mode, folder_options = {})
     style = KML::Style.new(KML::LineStyle.new(color, :width => width))
-    line_string = KML::LineString.new(:coordinates => @fixes, :altitudeMode => altitude_mode)
-    placemark = KML::Placemark.new(style, line_string)
-    KMZ.new(KML::Folder.new(placemark, KML::StyleUrl.new(hints.stock.check_hide_children_style.url), folder_options))
+    folder = KML::Folder.new(KML::StyleUrl.new(hints.stock.check_hide_children_style.url), folder_options)
+    if hints.regions
+      KMZ.new(folder).merge(make_regions(hints, folder.kml_id) do |writer, chunk, pixel|
+        fix_buffer = FixBuffer.new(chunk_indexes(hints, chunk, pixel).collect { |index| @fixes[index] })
+        line_string = KML::LineString.new(KML::Coordinates.new_from_fix_buffer(fix_buffer), :altitudeMode => altitude_mode)
+        writer.add(style, KML::Placemark.new(line_string, :styleUrl => style.url))
+      end)
+    else
+      line_string = KML::LineString.new(KML::Coordinates.new_from_fix_buffer(@track_log_fix_buffer), :altitudeMode => altitude_mode)
+      folder.add(KML::Placemark.new(style, line_string))
+      KMZ.new(folder)
+    end
   end
 
-  def make_colored_track_log(hints, values, scale, folder_options = {})
+  def make_colored_track_log(hints, values, scale, integral, folder_options = {})
     name = KML::Name.new("Coloured by #{scale.title}")
     folder = KML::Folder.new(name, KML::StyleUrl.new(hints.stock.check_hide_children_style.url), folder_options)
     styles = scale.pixels.collect do |pixel|
       KML::Style.new(KML::LineStyle.new(KML::Color.pixel(pixel), :width => hints.width))
     end
-    discrete_values = values.collect(&scale.method(:discretize))
-    discrete_values.segment(false).each do |range|
-      line_string = KML::LineString.new(:coordinates => @fixes[range], :altitudeMode => hints.altitude_mode)
-      style_url = KML::StyleUrl.new(styles[discrete_values[range.first]].url)
-      placemark = KML::Placemark.new(style_url, line_string)
-      folder.add(placemark)
+    make_placemark = lambda do |step, text|
+      line_string = KML::LineString.new(KML::Coordinates.new_from_text(text), :altitudeMode => hints.altitude_mode)
+      KML::Placemark.new(KML::StyleUrl.new(styles[step].url), line_string)
+    end
+    if hints.regions
+      regions = make_regions(hints, folder.kml_id) do |writer, chunk, pixel|
+        indexes = chunk_indexes(hints, chunk, pixel)
+        fix_buffer = FixBuffer.new(indexes.collect { |index| @fixes[index] })
+        segments = scale.each_segment(fix_buffer, values.values_at(*indexes).pack("d*"), integral)
+        writer.add(*segments.collect(&:first).uniq.collect { |step| styles[step] })
+        segments.each { |step, text| writer.add(make_placemark[step, text]) }
+      end
+    else
+      folder.add(KML::Generator.new do |writer|
+        scale.each_segment(@track_log_fix_buffer, track_log_values(values), integral) do |step, text|
+          writer.add(make_placemark[step, text])
+        end
+      end)
     end
     image = scale.to_image
-    image.set_channel_depth(Magick::AllChannels, 8)
-    image.format = "png"
-    href = "images/scales/#{scale.title}.#{image.format.downcase}"
+    href = "images/scales/#{scale.title}.png"
     icon = KML::Icon.new(:href => href)
     overlay_xy = KML::OverlayXY.new(:x => 0, :y => 1, :xunits => :fraction, :yunits => :fraction)
     screen_xy = KML::ScreenXY.new(:x => 0, :y => 1, :xunits => :fraction, :yunits => :fraction)
     size = KML::Size.new(:x => 0, :y => 0, :xunits => :fraction, :yunits => :fraction)
     screen_overlay = KML::ScreenOverlay.new(icon, overlay_xy, screen_xy, size)
     folder.add(screen_overlay)
-    KMZ.new(folder, :roots => styles, :files => {href => image.to_blob})
+    kmz = KMZ.new(folder, :roots => styles, :files => {href => image.to_png})
+    hints.regions ? kmz.merge(regions) : kmz
   end
 
   def animation(hints)
@@ -477,13 +609,13 @@ class IGC
     kmz = KMZ.new(KML::Folder.new(:name => "Track log", :open => 1, :styleUrl => hints.stock.radio_folder_style.url))
     kmz.merge(hints.stock.invisible_none_folder)
     if altitude_data?
-      kmz.merge(make_colored_track_log(hints, @fixes.collect(&:alt), hints.scales.altitude))
-      kmz.merge(make_colored_track_log(hints, @averages.collect(&:climb), hints.scales.climb, :visibility => 0))
-      kmz.merge(make_colored_track_log(hints, @averages.collect(&:speed), hints.scales.speed, :visibility => 0))
+      kmz.merge(make_colored_track_log(hints, @fix_buffer.alts.unpack("d*"), hints.scales.altitude, true))
+      kmz.merge(make_colored_track_log(hints, @climbs, hints.scales.climb, false, :visibility => 0))
+      kmz.merge(make_colored_track_log(hints, @speeds, hints.scales.speed, false, :visibility => 0))
     else
-      kmz.merge(make_colored_track_log(hints, @averages.collect(&:speed), hints.scales.speed))
+      kmz.merge(make_colored_track_log(hints, @speeds, hints.scales.speed, false))
     end
-    kmz.merge(make_colored_track_log(hints, @averages.collect(&:progress), hints.scales.progress, :visibility => 0))
+    kmz.merge(make_colored_track_log(hints, @progresses, hints.scales.progress, false, :visibility => 0))
     kmz.merge(make_monochromatic_track_log(hints, hints.color, hints.width, hints.altitude_mode, :name => "Solid color", :visibility => 0))
   end
 
@@ -544,18 +676,7 @@ class IGC
     if hints.xcs
       turnpoints = hints.xcs.sort_by(&:score)[-1].turnpoints
     elsif hints.task
-      index = 0
-      index += 1 while hints.task.course[index].is_a?(Task::TakeOff)
-      object = hints.task.course[index]
-      turnpoints = []
-      @fixes.each_cons(2) do |fix0, fix1|
-        fix = object.intersect?(fix0, fix1)
-        next unless fix
-        turnpoints << fix
-        index += 1
-        break if index == hints.task.course.length
-        object = hints.task.course[index]
-      end
+      turnpoints = hints.task.follow(@fixes, @fix_buffer).crossings.collect { |object, fix| fix }
     else
       turnpoints = []
     end
@@ -599,9 +720,9 @@ class IGC
       min_climb = max_climb = max_speed = 0.0
       sum_alt_gain = sum_alt_loss = 0
       (@times.find_first_ge(extreme0.fix.time.to_i)...@times.find_first_ge(extreme1.fix.time.to_i)).each do |i|
-        min_climb = @averages[i].climb if @averages[i].climb < min_climb
-        max_climb = @averages[i].climb if @averages[i].climb > max_climb
-        max_speed = @averages[i].speed if @averages[i].speed > max_speed
+        min_climb = @climbs[i] if @climbs[i] < min_climb
+        max_climb = @climbs[i] if @climbs[i] > max_climb
+        max_speed = @speeds[i] if @speeds[i] > max_speed
         change = @fixes[i + 1].alt - @fixes[i].alt
         case change <=> 0
         when  1 then sum_alt_gain += change
@@ -636,44 +757,72 @@ class IGC
     KMZ.new(folder, :roots => [thermal_style, glide_style])
   end
 
-  def make_time_marks_folder(hints, periods)
+  # Returns the fix index, time and period of each time mark
+  def time_marks(periods)
     marks = []
     time = @fixes[0].time
     min_period = periods[-1].period
     time += min_period - (60 * time.min + time.sec) % min_period
+    index = 0
     @fixes.each do |fix|
       if time < fix.time
         periods.each do |period|
           if (60 * time.min + time.sec) % period.period == 0
-            name = time.to_time(hints,"%H:%M")
-            marks << fix.to_kml(hints, name, {:altitudeMode => hints.altitude_mode}, *period.children)
+            marks << [index, time, period]
             break
           end
         end
         time += min_period
       end
+      index += 1
     end
+    marks
+  end
+
+  def make_time_mark(hints, index, time, period)
+    @fixes[index].to_kml(hints, time.to_time(hints, "%H:%M"), {:altitudeMode => hints.altitude_mode}, *period.children)
+  end
+
+  def make_time_marks_folder(hints, periods)
+    marks = time_marks(periods)
     if marks.empty?
       KMZ.new
     else
       folder = KML::Folder.new(:name => "#{periods[-1].period / 60} minute", :visibility => 0, :styleUrl => hints.stock.check_hide_children_style.url)
       folder.add(@fixes[0].to_kml(hints, :time, {:altitudeMode => hints.altitude_mode}, *periods[0].children))
-      marks.each(&folder.method(:add))
       folder.add(@fixes[-1].to_kml(hints, :time, {:altitudeMode => hints.altitude_mode}, *periods[0].children))
-      KMZ.new(folder)
+      kmz = KMZ.new(folder)
+      if hints.regions and marks.length > REGION_MARKS
+        kmz.merge(make_regions(hints, folder.kml_id, REGION_MARKS * @fixes.length / marks.length) do |writer, chunk, pixel|
+          last = chunk.last == @fixes.length - 1 ? chunk.last : chunk.last - 1
+          duration = @times[chunk.last] - @times[chunk.first]
+          chunk_marks = marks.find_all do |index, time, period|
+            (chunk.first..last).include?(index) and (pixel.nil? or duration <= REGION_MARKS * period.period)
+          end
+          writer.add(*chunk_marks.collect { |index, time, period| period.style }.uniq)
+          chunk_marks.each do |index, time, period|
+            writer.add(make_time_mark(hints, index, time, period))
+          end
+        end)
+      else
+        marks.each do |index, time, period|
+          folder.add(make_time_mark(hints, index, time, period))
+        end
+      end
+      kmz
     end
   end
 
   def time_marks_folder(hints)
     styles = []
-    period_struct = Struct.new(:period, :children)
+    period_struct = Struct.new(:period, :children, :style)
     periods = [[3600, 27, 0], [1800, 27, 0], [900, 26, 1], [300, 25, 2], [60, 24, 3]].collect do |period, icon, label_scale_index|
       balloon_style = KML::BalloonStyle.new(:text => "$[description]")
       icon_style = KML::IconStyle.new(KML::Icon.palette(4, icon), :scale => ICON_SCALE)
       label_style = KML::LabelStyle.new(KML::Color.new("ff00ffff"), :scale => LABEL_SCALES[label_scale_index])
       style = KML::Style.new(balloon_style, icon_style, label_style)
       styles << style
-      period_struct.new(period, [{:styleUrl => style.url}])
+      period_struct.new(period, [{:styleUrl => style.url}], style)
     end
     kmz = KMZ.new(KML::Folder.new(:name => "Time marks", :styleUrl => hints.stock.radio_folder_style.url), :roots => styles)
     kmz.merge(hints.stock.visible_none_folder)
@@ -694,15 +843,9 @@ class IGC
   end
 
   def task_marks_folder(hints)
-    task = hints.task
     folder = KML::Folder.new(:name => "Task marks", :visibility => 0)
-    index = 0
-    index += 1 while task.course[index].is_a?(Task::TakeOff)
     turnpoint_number = 0
-    @fixes.each_cons(2) do |fix0, fix1|
-      object = task.course[index]
-      fix = object.intersect?(fix0, fix1)
-      next unless fix
+    hints.task.follow(@fixes, @fix_buffer).crossings.each do |object, fix|
       if object.is_a?(Task::Turnpoint)
         turnpoint_number += 1
         label = "T#{turnpoint_number}"
@@ -711,8 +854,6 @@ class IGC
       end
       name = "#{label} #{(fix.time + hints.tz_offset).strftime("%H:%M:%S")}"
       folder.add(fix.to_kml(hints, name, {:altitudeMode => hints.altitude_mode, :extrude => 1}, :styleUrl => hints.stock.task_style.url, :visibility => 0))
-      index += 1
-      break if index == task.course.length
     end
     KMZ.new(folder)
   end
@@ -727,34 +868,38 @@ class IGC
     name = KML::Name.new(scale.title.capitalize)
     folder = KML::Folder.new(name, KML::StyleUrl.new(hints.stock.check_hide_children_style.url), folder_options)
     image = scale.to_graph_image(hints, @times, values, background)
-    image.set_channel_depth(Magick::AllChannels, 8)
-    image.format = "png"
-    href = "images/graphs/#{scale.title}.#{image.format.downcase}"
+    href = "images/graphs/#{scale.title}.png"
     icon = KML::Icon.new(:href => href)
     overlay_xy = KML::OverlayXY.new(:x => 0, :y => 0, :xunits => :fraction, :yunits => :fraction)
     screen_xy = KML::ScreenXY.new(:x => 0, :y => 16, :xunits => :fraction, :yunits => :pixels)
     size = KML::Size.new(:x => 0, :y => 0, :xunits => :fraction, :yunits => :fraction)
     screen_overlay = KML::ScreenOverlay.new(icon, overlay_xy, screen_xy, size)
     folder.add(screen_overlay)
-    KMZ.new(folder, :files => {href => image.to_blob})
+    KMZ.new(folder, :files => {href => image.to_png})
   end
 
   def graphs_folder(hints)
     kmz = KMZ.new(KML::Folder.new(:name => "Graphs", :styleUrl => hints.stock.radio_folder_style.url))
     kmz.merge(hints.stock.visible_none_folder)
     if altitude_data?
+      alts = @fixes.collect(&:alt)
       if hints.ground
-        gl = @fixes.collect do |fix|
-          CGIARCSI::SRTM90mDEM[Radians.to_deg(fix.lat), Radians.to_deg(fix.lon)].constrain(hints.bounds.alt).constrain(nil, fix.alt)
+        # A pixel of the graph covers at least this many degrees, so long
+        # tracks can take the highest ground from the DEM's overviews
+        resolution = [@bounds.lat.size, @bounds.lon.size].max.to_deg / Scale::GRAPH_WIDTH
+        interpolation = resolution < CGIARCSI::SRTM90mDEM::OVERVIEW_RESOLUTION ? :bilinear : :max
+        elevations = CGIARCSI::SRTM90mDEM.elevations(@fix_buffer.lats, @fix_buffer.lons, interpolation, resolution)
+        gl = elevations.zip(alts).collect do |elevation, alt|
+          (elevation || hints.bounds.alt.first).constrain(hints.bounds.alt).constrain(nil, alt)
         end
       else
         gl = nil
       end
-      kmz.merge(make_graph(hints, @fixes.collect(&:alt), gl, hints.scales.altitude, :visibility => 0))
-      kmz.merge(make_graph(hints, @averages.collect(&:climb), nil, hints.scales.climb, :visibility => 0))
+      kmz.merge(make_graph(hints, alts, gl, hints.scales.altitude, :visibility => 0))
+      kmz.merge(make_graph(hints, @climbs, nil, hints.scales.climb, :visibility => 0))
     end
-    kmz.merge(make_graph(hints, @averages.collect(&:speed), nil, hints.scales.speed, :visibility => 0))
-    kmz.merge(make_graph(hints, @averages.collect(&:progress), nil, hints.scales.progress, :visibility => 0))
+    kmz.merge(make_graph(hints, @speeds, nil, hints.scales.speed, :visibility => 0))
+    kmz.merge(make_graph(hints, @progresses, nil, hints.scales.progress, :visibility => 0))
   end
 
 end
@@ -1,14 +1,6 @@
 require "coord"
 require "stringio"
 
-class Coord
-
-  def to_kml_coord
-    "%.6f,%.6f,%d" % [Radians.to_deg(lon), Radians.to_deg(lat), alt]
-  end
-
-end
-
 class Time
 
   def to_kml
@@ -20,10 +12,11 @@ end
 class KML
 
   VERSION = [2, 1].extend(Comparable)
+  XMLNS = "http://earth.google.com/kml/#{VERSION.join(".")}"
 
   def initialize(*args)
     @kml = KML::Kml.new
-    @kml.add_attributes(:xmlns => "http://earth.google.com/kml/#{VERSION.join(".")}")
+    @kml.add_attributes(:xmlns => XMLNS)
     args.each(&@kml.method(:add))
   end
 
@@ -164,7 +157,7 @@ class KML
           when Hash
             arg.each do |key, value|
               next if value.nil?
-              value = [value] unless value.is_a?(Array)
+              value = [value] unless value.respond_to?(:to_ary)
               class_name = key.to_s.sub(/\A./) { |s| s.upcase }.to_sym
               element.add(KML.const_get(class_name).new(*value))
             end
@@ -179,6 +172,86 @@ class KML
 
   end
 
+  # Writes KML to io as it is generated.  Elements are either opened and
+  # closed explicitly with begin_element and end_element or written whole
+  # with add, so only the element being written need be held in memory.  A
+  # nil indent writes compact KML.
+  class Writer
+
+    def initialize(io, indent = "\t", leader = "")
+      @io = io
+      @indent = indent
+      @leader = leader
+      @names = []
+    end
+
+    def begin_kml
+      @io.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>")
+      @io.write("\n") if @indent
+      begin_element(:kml, :xmlns => XMLNS)
+    end
+
+    def begin_element(name, attributes = {})
+      @io.write("#{@leader}<#{name}")
+      attributes.each do |attribute, value|
+        @io.write(" #{attribute}=\"#{value}\"")
+      end
+      @io.write(@indent ? ">\n" : ">")
+      @leader += @indent if @indent
+      @names.push(name)
+      self
+    end
+
+    def end_element
+      name = @names.pop or raise "no open element"
+      @leader = @leader[0, @leader.length - @indent.length] if @indent
+      @io.write(@indent ? "#{@leader}</#{name}>\n" : "</#{name}>")
+      self
+    end
+
+    def element(name, attributes = {})
+      begin_element(name, attributes)
+      yield self
+      end_element
+    end
+
+    def add(*elements)
+      elements.each do |element|
+        @indent ? element.pretty_write(@io, @indent, @leader) : element.write(@io)
+      end
+      self
+    end
+
+    def close
+      end_element until @names.empty?
+      self
+    end
+
+  end
+
+  # A child whose contents are only generated when it is written, so that
+  # large folders need not be built in memory.  The block is called with a
+  # Writer each time the child is written.
+  class Generator
+
+    def initialize(&block)
+      @block = block
+    end
+
+    def write(io)
+      writer = Writer.new(io, nil)
+      @block.call(writer)
+      writer.close
+    end
+
+    def pretty_write(io, indent, leader)
+      writer = Writer.new(io, indent, leader)
+      @block.call(writer)
+      writer.close
+    end
+
+  end
+
   class CData
 
     def initialize(*texts)
@@ -239,6 +312,17 @@ class KML
         super(args.collect(&:to_kml_coord).join("\n"))
       end
 
+      def new_from_text(text)
+        element = new
+        element.text = text
+        element
+      end
+
+      def new_from_fix_buffer(fix_buffer, range = 0...fix_buffer.length)
+        last = range.exclude_end? ? range.last : range.last + 1
+        new_from_text(KML.coordinates_text(fix_buffer.lats, fix_buffer.lons, fix_buffer.alts, range.first, last))
+      end
+
       def arc(center, radius, start, stop, error = 0.1)
         decimation = (Math::PI / Math.acos((radius - error) / (radius + error))).ceil
         stop += 2 * Math::PI while stop < start
@@ -426,3 +510,5 @@ class KML
   simple :y
 
 end
+
+require "ckml"
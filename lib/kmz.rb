@@ -1,5 +1,5 @@
 require "kml"
-require "zip/zip"
+require "zlib"
 
 class KMZ
 
@@ -63,17 +63,105 @@ class KMZ
   end
 
   def write(filename)
-    doc = KML::Document.new
-    doc.add(*@roots)
-    doc.add(*@elements)
-    Zip::ZipOutputStream.open(filename) do |kmz|
-      kmz.put_next_entry("doc.kml")
-      KML.new(doc).pretty_write(kmz)
+    ZipWriter.open(filename) do |zip|
+      zip.entry("doc.kml") do |io|
+        writer = KML::Writer.new(io)
+        writer.begin_kml
+        writer.begin_element(:Document)
+        writer.add(*@roots)
+        writer.add(*@elements)
+        writer.close
+      end
       @files.each do |filename, contents|
-        kmz.put_next_entry(filename)
-        kmz.write(contents.respond_to?(:read) ? contents.read : contents)
+        if contents.is_a?(KML)
+          zip.entry(filename) { |io| contents.pretty_write(io) }
+        else
+          zip.add(filename, contents.respond_to?(:read) ? contents.read : contents)
+        end
+      end
+    end
+  end
+
+  # A minimal ZIP writer.  Streamed entries are deflated as they are written
+  # and followed by a data descriptor holding their checksum and sizes, so
+  # neither the entry nor the archive is ever held in memory or rewritten.
+  class ZipWriter
+
+    Entry = Struct.new(:name, :flags, :method, :crc, :compressed_size, :size, :offset)
+
+    class << self
+
+      def open(filename)
+        File.open(filename, "wb") do |io|
+          zip = new(io)
+          yield zip
+          zip.close
+        end
+      end
+
+    end
+
+    def initialize(io)
+      @io = io
+      @offset = 0
+      @entries = []
+      time = Time.now
+      @dos_time = (time.hour << 11) | (time.min << 5) | (time.sec / 2)
+      @dos_date = ((time.year - 1980) << 9) | (time.month << 5) | time.day
+    end
+
+    def entry(name)
+      @entry = Entry.new(name, 0x0008, 8, 0, 0, 0, @offset)
+      write_local_header(@entry)
+      @deflate = Zlib::Deflate.new(Zlib::DEFAULT_COMPRESSION, -Zlib::MAX_WBITS)
+      yield self
+      output(@deflate.finish)
+      @deflate.close
+      @deflate = nil
+      output([0x08074b50, @entry.crc, @entry.compressed_size, @entry.size].pack("VVVV"))
+      @entries << @entry
+      @entry = nil
+    end
+
+    def write(string)
+      @entry.crc = Zlib.crc32(string, @entry.crc)
+      @entry.size += string.bytesize
+      output(@deflate.deflate(string))
+      string.bytesize
+    end
+
+    def add(name, contents)
+      data, method = Zlib::Deflate.new(Zlib::DEFAULT_COMPRESSION, -Zlib::MAX_WBITS).deflate(contents, Zlib::FINISH), 8
+      data, method = contents, 0 if data.bytesize >= contents.bytesize
+      entry = Entry.new(name, 0, method, Zlib.crc32(contents), data.bytesize, contents.bytesize, @offset)
+      write_local_header(entry)
+      output(data)
+      @entries << entry
+    end
+
+    def close
+      offset = @offset
+      @entries.each do |entry|
+        output([0x02014b50, 20, 20, entry.flags, entry.method, @dos_time, @dos_date, entry.crc, entry.compressed_size, entry.size, entry.name.bytesize, 0, 0, 0, 0, 0, entry.offset].pack("VvvvvvvVVVvvvvvVV"))
+        output(entry.name)
       end
+      output([0x06054b50, 0, 0, @entries.length, @entries.length, @offset - offset, offset, 0].pack("VvvvvVVv"))
+    end
+
+    private
+
+    def write_local_header(entry)
+      output([0x04034b50, 20, entry.flags, entry.method, @dos_time, @dos_date, entry.crc, entry.compressed_size, entry.size, entry.name.bytesize, 0].pack("VvvvvvVVVvv"))
+      output(entry.name)
     end
+
+    def output(data)
+      return if data.empty?
+      @io.write(data)
+      @entry.compressed_size += data.bytesize if @deflate
+      @offset += data.bytesize
+    end
+
   end
 
 end
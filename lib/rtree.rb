@@ -0,0 +1,23 @@
+class RTree
+
+  NODE_SIZE = 16
+
+  class << self
+
+    # Builds a tree of boxes, an array of [min_x, min_y, min_t, max_x,
+    # max_y, max_t] indexed by id, replacing filename only once the tree
+    # is complete.  Returns the number of boxes.
+    def build(filename, boxes, node_size = NODE_SIZE)
+      tmpfilename = "#{filename}.#{$$}"
+      count = write(tmpfilename, boxes.flatten.pack("d*"), node_size)
+      File.rename(tmpfilename, filename)
+      count
+    ensure
+      File.unlink(tmpfilename) if tmpfilename and FileTest.exist?(tmpfilename)
+    end
+
+  end
+
+end
+
+require "crtree"
@@ -27,6 +27,12 @@ class Task
       false
     end
 
+    # The kind of object, radius, start time and line ends packed for
+    # Task.find_crossings
+    def crossing_params
+      [KIND_NONE, @lat, @lon, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0]
+    end
+
   end
 
   class Circle < Point
@@ -54,6 +60,10 @@ class Task
       fix0.interpolate(fix1, (distance0 - radius) / (distance0 - distance1))
     end
 
+    def crossing_params
+      [KIND_CIRCLE, @lat, @lon, radius.to_f, 0.0, 0.0, 0.0, 0.0, 0.0]
+    end
+
   end
 
   class Turnpoint < Circle
@@ -64,6 +74,8 @@ class Task
 
   class StartCircle < Circle
 
+    attr_reader :start_time
+
     def initialize(lat, lon, alt, name, radius, start_time)
       super(lat, lon, alt, name, radius)
       @start_time = start_time
@@ -79,6 +91,10 @@ class Task
       @start_time <= fix0.time and distance_to(fix0) > radius and radius >= distance_to(fix1)
     end
 
+    def crossing_params
+      [KIND_TAKEOFF, @lat, @lon, radius.to_f, @start_time.to_f, 0.0, 0.0, 0.0, 0.0]
+    end
+
   end
 
   class StartOfSpeedSection < StartCircle
@@ -93,6 +109,10 @@ class Task
       fix
     end
 
+    def crossing_params
+      [KIND_START, @lat, @lon, radius.to_f, @start_time.to_f, 0.0, 0.0, 0.0, 0.0]
+    end
+
   end
 
   class EndOfSpeedSection < Circle
@@ -127,6 +147,29 @@ class Task
       fix0.interpolate(fix1, intersection[1])
     end
 
+    def crossing_params
+      [KIND_LINE, @lat, @lon, 0.0, 0.0, @left.lat, @left.lon, @right.lat, @right.lon]
+    end
+
+  end
+
+  # The result of following a course: the objects reached, in order, with
+  # the fixes at which they were reached, the start and end times of the
+  # speed section, and the distance left to goal, measured between the
+  # centres of the objects like Task#distance, which is zero if goal was
+  # reached
+  Flight = Struct.new(:crossings, :start_time, :end_time, :distance_to_goal)
+
+  class Flight
+
+    def goal?
+      distance_to_goal.zero?
+    end
+
+    def speed_section_time
+      end_time - start_time if start_time and end_time
+    end
+
   end
 
   attr_reader :competition
@@ -155,4 +198,47 @@ class Task
     result
   end
 
+  # Returns the index of the goal, or of the last object if there is none
+  def goal_index
+    @course.index { |object| object.is_a?(GoalCircle) or object.is_a?(GoalLine) } || @course.length - 1
+  end
+
+  # The objects of the course packed for Task.find_crossings, each followed
+  # by its distance along the course to goal
+  def packed_course
+    @packed_course ||= begin
+      remaining = Array.new(@course.length, 0.0)
+      (goal_index - 1).downto(0) do |index|
+        remaining[index] = remaining[index + 1] + @course[index].distance_to(@course[index + 1])
+      end
+      @course.zip(remaining).collect { |object, distance| object.crossing_params << distance }.flatten.pack("d*")
+    end
+  end
+
+  # Follows fixes around the course in a single pass, starting after any
+  # take offs, and returns a Flight.  fix_buffer holds the packed columns
+  # of fixes, which may be a plain Array of fixes as IGC#fixes is after
+  # filtering.  Each object is reached where the track enters its circle
+  # or crosses its line, and is only looked for after the previous object
+  # has been reached.
+  def follow(fixes, fix_buffer = fixes)
+    first = 0
+    first += 1 while @course[first].is_a?(TakeOff)
+    crossings, remaining = Task.find_crossings(fix_buffer, packed_course, first)
+    # The speed section ends at goal if there is no end of speed section
+    end_index = @course.index { |object| object.is_a?(EndOfSpeedSection) } || goal_index
+    flight = Flight.new([], nil, nil, remaining || 0.0)
+    crossings.each do |index, i, delta|
+      object = @course[index]
+      fix = fixes[i].interpolate(fixes[i + 1], delta)
+      flight.crossings << [object, fix]
+      flight.start_time = fix.time if object.is_a?(StartOfSpeedSection)
+      flight.end_time = fix.time if index == end_index
+      flight.distance_to_goal = 0.0 if index == goal_index
+    end
+    flight
+  end
+
 end
+
+require "ctask"
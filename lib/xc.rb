@@ -1,15 +1,19 @@
+require "cmemofile"
 require "coord"
 require "enumerator"
 require "fileutils"
-require "yaml"
 
 module XC
 
   LEAGUES = []
 
-  class League
+  # Cached results are keyed on this, so increment it whenever a change to
+  # the optimizer or to a league's flight types changes its results.
+  OPTIMIZER_VERSION = 2
+
+  CACHE_FILENAME = File.join("tmp", "xc.memo")
 
-    CACHE_DIRECTORY = File.join("tmp", "xc");
+  class League
 
     class << self
 
@@ -33,33 +37,75 @@ module XC
         end
       end
 
-      def memoized_optimize(key, fixes)
-        memofile = File.join(CACHE_DIRECTORY, name.split(/::/)[-1], key)
-        if FileTest.exist?(memofile) and !FileTest.zero?(memofile)
-          File.open(memofile) do |file|
-            hash = YAML.load(file)
-            ts = fixes.collect(&:time).collect!(&:to_i)
-            hash.collect do |type, times|
-              turnpoints = times.collect do |time|
-                fixes[ts.find_first_ge(time)]
-              end
-              const_get(type).new(turnpoints)
-            end
-          end
+      # Returns an Optimizer that accepts fixes as they arrive and
+      # re-optimizes starting from its previous best flights.
+      def optimizer
+        Optimizer.new(self)
+      end
+
+      # If budget is given, spends at most that many seconds optimizing and
+      # does not cache the result, which may not be optimal.
+      def memoized_optimize(key, fixes, fix_buffer = nil, budget = nil, &block)
+        memoized(key, fixes) do
+          return optimize_within(budget, fixes, fix_buffer, &block) if budget
+          optimize(fixes, fix_buffer)
+        end
+      end
+
+      # Flight type names, sorted so that the cache can store their indexes.
+      def flight_types
+        @flight_types ||= constants.select do |constant|
+          value = const_get(constant)
+          value.is_a?(Class) and value < Flight
+        end.collect(&:to_s).sort
+      end
+
+      # The engines find different flights, so each has its own entries.
+      def cache_key(key, fixes)
+        [key, name.split(/::/)[-1], OPTIMIZER_VERSION, XC.engine, fixes.length].join(":")
+      end
+
+      def cached?(key, fixes)
+        !XC.cache[cache_key(key, fixes)].nil?
+      end
+
+      def memoized(key, fixes)
+        cache_key = cache_key(key, fixes)
+        if value = XC.cache[cache_key]
+          decode(value, fixes)
         else
-          xcs = optimize(fixes)
-          hash = {}
-          xcs.each do |xc|
-            hash[xc.class.name.split(/::/)[-1]] = xc.turnpoints.collect(&:time).collect!(&:to_i)
-          end
-          FileUtils.mkdir_p(File.dirname(memofile))
-          File.open(memofile, "w") do |file|
-            file.write(hash.to_yaml)
-          end
+          xcs = yield
+          XC.cache[cache_key] = encode(xcs)
           xcs
         end
       end
 
+      # Flights are stored as BER-compressed integers: the number of flights
+      # then, for each flight, the index of its type in flight_types and
+      # the differences between its successive fix indexes.
+      def encode(xcs)
+        values = [xcs.length]
+        xcs.each do |xc|
+          values << flight_types.index(xc.class.name.split(/::/)[-1])
+          index0 = 0
+          xc.indexes.each do |index|
+            values << index - index0
+            index0 = index
+          end
+        end
+        values.pack("w*")
+      end
+
+      def decode(value, fixes)
+        values = value.unpack("w*")
+        Array.new(values.shift) do
+          flight = const_get(flight_types[values.shift])
+          index = 0
+          indexes = Array.new(flight::TURNPOINTS + 2) { index += values.shift }
+          flight.new(indexes.collect { |i| fixes[i] }, indexes)
+        end
+      end
+
     end
 
   end
@@ -83,12 +129,15 @@ module XC
     CIRCUIT = false
 
     attr_reader :distance
+    attr_reader :indexes
+    attr_writer :bound
     attr_reader :league
     attr_reader :score
     attr_reader :turnpoints
 
-    def initialize(fixes)
+    def initialize(fixes, indexes = nil)
       raise unless fixes.length == self.class.const_get(:TURNPOINTS) + 2
+      @indexes = indexes
       @league = self.class.module_heirarchy[1]
       @turnpoints = fixes.collect_with_index do |fix, index|
         Turnpoint.new(fix.lat, fix.lon, fix.alt, fix.time, @league.turnpoint_name(index, fixes.length))
@@ -107,6 +156,16 @@ module XC
       @score = multiplier * @distance / 1000.0
     end
 
+    # Upper bound on the distance of any flight of this type, which is
+    # greater than distance when an optimize_within ran out of time.
+    def bound
+      @bound || @distance
+    end
+
+    def gap
+      bound.zero? ? 0.0 : (bound - @distance) / bound
+    end
+
     def circuit?
       self.class.const_get(:CIRCUIT)
     end
@@ -175,6 +234,53 @@ module XC
 
   class << self
 
+    # Like League.memoized_optimize, but scores all leagues not already in
+    # the cache in one pass over the track.  Returns a hash of leagues to
+    # flights.
+    def memoized_optimize(key, leagues, fixes, fix_buffer = nil, budget = nil, &block)
+      uncached = leagues.reject { |league| league.cached?(key, fixes) }
+      result = uncached.empty? ? {} : optimize_leagues(uncached, fixes, fix_buffer, budget, &block)
+      leagues.each do |league|
+        next if budget and result[league]
+        result[league] = league.memoized(key, fixes) { result[league] }
+      end
+      result
+    end
+
+    def cache
+      @cache ||= begin
+        FileUtils.mkdir_p(File.dirname(CACHE_FILENAME))
+        MemoFile.new(CACHE_FILENAME)
+      end
+    end
+
+    # Rewrites the cache keeping only the newest value of each key from the
+    # current optimizer version.  Writers wait until the rewritten cache
+    # has replaced the old one.  Returns the number of records before and
+    # after.
+    def compact_cache(filename = CACHE_FILENAME)
+      memofile = MemoFile.new(filename)
+      File.open(filename) do |file|
+        file.flock(File::LOCK_EX)
+        entries = []
+        memofile.each do |key, value|
+          entries << [key, value] if key.split(/:/)[2] == OPTIMIZER_VERSION.to_s
+        end
+        buckets = 1024
+        buckets *= 2 while buckets < entries.length
+        tmpfilename = "#{filename}.#{$$}"
+        compacted = MemoFile.new(tmpfilename, buckets)
+        entries.each do |key, value|
+          compacted[key] = value
+        end
+        compacted.close
+        File.rename(tmpfilename, filename)
+        [memofile.records, entries.length]
+      end
+    ensure
+      memofile.close if memofile
+    end
+
     def leagues_hash
       result = {}
       LEAGUES.each do |league|
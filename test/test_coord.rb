@@ -0,0 +1,133 @@
+$:.unshift(File.join(File.dirname(__FILE__), "..", "lib"))
+require "coord"
+require "geometry"
+require "test/unit"
+
+class TC_CoordArray < Test::Unit::TestCase
+
+  def setup
+    @coords = (0...8).collect do |i|
+      Coord.new(Radians.new_from_deg(45.0 + 0.01 * i * i), Radians.new_from_deg(6.0 - 0.02 * i), 1000.0 + 10 * i)
+    end
+    @times = (0...8).collect { |i| 100.0 + 10 * i }
+    @coord_array = CoordArray.new(*[:lat, :lon, :alt].collect { |m| @coords.collect(&m).pack("d*") }.push(@times.pack("d*")))
+  end
+
+  def assert_coord_equal(expected, actual)
+    [:lat, :lon, :alt].each do |m|
+      assert_in_delta(expected.send(m), actual.send(m), m == :alt ? 1e-6 : 1e-12)
+    end
+  end
+
+  def test_aref
+    assert_equal(8, @coord_array.length)
+    assert_coord_equal(@coords[-1], @coord_array[-1])
+    assert_nil(@coord_array[8])
+  end
+
+  def test_distances
+    distances = @coords[0...-1].zip(@coords[1..-1]).collect { |c0, c1| c0.distance_to(c1) }
+    @coord_array.distances.unpack("d*").zip(distances).each do |actual, expected|
+      assert_in_delta(expected, actual, 1e-6)
+    end
+    out = "reused"
+    assert_same(out, @coord_array.distances(out))
+    assert_equal(7, out.unpack("d*").length)
+    cumulative_distances = @coord_array.cumulative_distances.unpack("d*")
+    assert_equal(0.0, cumulative_distances[0])
+    assert_in_delta(distances.inject(0.0) { |sum, d| sum + d }, cumulative_distances[-1], 1e-6)
+  end
+
+  def test_initial_bearings
+    @coord_array.initial_bearings.unpack("d*").each_with_index do |bearing, i|
+      assert_in_delta(@coords[i].initial_bearing_to(@coords[i + 1]), bearing, 1e-12)
+    end
+  end
+
+  def test_halfway_points
+    halfway_points = @coord_array.halfway_points
+    assert_equal(7, halfway_points.length)
+    assert_coord_equal(@coords[2].halfway_to(@coords[3]), halfway_points[2])
+    assert_equal(125.0, halfway_points.times.unpack("d*")[2])
+  end
+
+  def test_interpolate
+    times = [0.0, 100.0, 112.5, 112.5, 105.0, 170.0, 200.0]
+    out = CoordArray.new("", "", "", "")
+    assert_same(out, @coord_array.interpolate(times.pack("d*"), out))
+    assert_equal(times, out.times.unpack("d*"))
+    assert_coord_equal(@coords[0], out[0])
+    assert_coord_equal(@coords[0], out[1])
+    assert_coord_equal(@coords[1].interpolate(@coords[2], 0.25), out[2])
+    assert_coord_equal(out[2], out[3])
+    assert_coord_equal(@coords[0].interpolate(@coords[1], 0.5), out[4])
+    assert_coord_equal(@coords[7], out[5])
+    assert_coord_equal(@coords[7], out[6])
+  end
+
+  def test_output_aliases_input
+    times = [0.0, 100.0].pack("d*")
+    assert_raise(ArgumentError) { @coord_array.interpolate(times, @coord_array) }
+    shared = CoordArray.new("", "", @coord_array.alts, "")
+    assert_raise(ArgumentError) { @coord_array.interpolate(times, shared) }
+    assert_raise(ArgumentError) { @coord_array.halfway_points(shared) }
+    assert_raise(ArgumentError) { @coord_array.distances(@coord_array.lats) }
+    assert_equal(8, @coord_array.length)
+    assert_coord_equal(@coords[7], @coord_array[7])
+  end
+
+  def test_points
+    points = @coord_array.to_points
+    assert_equal(8, points.length)
+    assert_equal(@coords[5].to_point, points[5])
+    coords = points.to_coords
+    assert_nil(coords.times)
+    assert_coord_equal(@coords[5], coords[5])
+    normal = points[0].cross(points[1])
+    points.dots(normal).unpack("d*").each_with_index do |dot, i|
+      assert_in_delta(points[i].dot(normal), dot, 1e-6 * normal.mag)
+    end
+  end
+
+  def test_cluster
+    srand(1)
+    coords = Array.new(300) do
+      Coord.new(Radians.new_from_deg(45.0 + 0.05 * rand), Radians.new_from_deg(6.0 + 0.05 * rand), rand(4).zero? ? 0.0 : 1000.0 + 100 * rand)
+    end
+    weights = Array.new(coords.length) { 1.0 + rand(3) }
+    # Merge each coordinate with every earlier cluster within 500m, oldest first
+    clusters = []
+    coords.each_with_index do |coord, index|
+      neighbours = clusters.find_all { |c, w, members| c.distance_to(coord) < 500.0 }
+      clusters -= neighbours
+      clusters << neighbours.inject([coord, weights[index], [index]]) do |(c1, w1, m1), (c2, w2, m2)|
+        c = c1.interpolate(c2, w2 / (w1 + w2))
+        c.alt = c1.alt if c2.alt.zero?
+        c.alt = c2.alt if c1.alt.zero?
+        [c, w1 + w2, m1 + m2]
+      end
+    end
+    coord_array = CoordArray.new(*[:lat, :lon, :alt].collect { |m| coords.collect(&m).pack("d*") })
+    centres, cluster_weights, indexes = coord_array.cluster(500.0, weights.pack("d*"))
+    assert_equal(clusters.length, centres.length)
+    assert(clusters.length < coords.length)
+    clusters.each_with_index do |(c, w, members), i|
+      # Repeated interpolation between nearby points loses a few digits
+      assert_in_delta(c.lat, centres[i].lat, 1e-9)
+      assert_in_delta(c.lon, centres[i].lon, 1e-9)
+      assert_in_delta(c.alt, centres[i].alt, 1e-6)
+      assert_in_delta(w, cluster_weights.unpack("d*")[i], 1e-9)
+      members.each { |member| assert_equal(i, indexes[member]) }
+    end
+    assert_equal([1.0, 1.0], coord_array.cluster(0.001)[1].unpack("d*")[0, 2])
+  end
+
+  def test_malformed
+    assert_raise(ArgumentError) { CoordArray.new("x" * 16, "x" * 8, "x" * 16).distances }
+    assert_raise(ArgumentError) { CoordArray.new("x" * 7, "x" * 7, "x" * 7).distances }
+    assert_raise(ArgumentError) { CoordArray.new("x" * 8, "x" * 8, "x" * 8).interpolate([0.0].pack("d")) }
+    assert_raise(ArgumentError) { CoordArray.new("", "", "").cluster(0.0) }
+    assert_raise(ArgumentError) { CoordArray.new("x" * 8, "x" * 8, "x" * 8).cluster(1.0, "") }
+  end
+
+end
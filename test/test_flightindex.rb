@@ -0,0 +1,82 @@
+$:.unshift(File.join(File.dirname(__FILE__), "..", "lib"))
+require "fileutils"
+require "flightindex"
+require "igc"
+require "test/unit"
+require "tmpdir"
+
+class TC_FlightIndex < Test::Unit::TestCase
+
+  Flight = Struct.new(:fix_buffer, :bsignature)
+
+  def setup
+    @dir = Dir.mktmpdir
+    @path = File.join(@dir, "index")
+  end
+
+  def teardown
+    FileUtils.rm_rf(@dir)
+  end
+
+  # A straight flight of n fixes from lat0, lon0 in degrees, starting at
+  # time t0
+  def flight(lat0, lon0, t0, n = 10)
+    fixes = Array.new(n) do |i|
+      IGC::Fix.new(Time.at(t0 + 60 * i).utc, Radians.new_from_deg(lat0 + 0.01 * i), Radians.new_from_deg(lon0 + 0.02 * i), 1000.0 + i)
+    end
+    Flight.new(IGC::FixBuffer.new(fixes), "%032x" % (lat0 * 1000).to_i)
+  end
+
+  def build
+    FlightIndex.build(@path) do |builder|
+      assert_equal(0, builder.add("Alps", flight(46.0, 7.0, 1.0e9)))
+      assert_nil(builder.add("Empty", flight(0.0, 0.0, 0.0, 0)))
+      assert_equal(1, builder.add("Pyrenees", flight(42.7, 0.5, 1.1e9, 20)))
+    end
+  end
+
+  def bbox(west, south, east, north)
+    [west, south, east, north].collect { |deg| Radians.new_from_deg(deg) }
+  end
+
+  def test_build_and_search
+    assert_equal(2, build.length)
+    assert_equal(["index.memo", "index.rtree"], Dir.entries(@dir).reject { |entry| entry =~ /\A\./ }.sort)
+    index = FlightIndex.new(@path)
+    assert_equal(2, index.length)
+    assert_equal([1, 0], index.search(bbox(-10.0, 40.0, 10.0, 50.0)))
+    assert_equal([0], index.search(bbox(6.0, 45.0, 8.0, 47.0)))
+    assert_equal([0], index.search(bbox(-10.0, 40.0, 10.0, 50.0), 0.9e9..1.05e9))
+    assert_equal([], index.search(bbox(20.0, 40.0, 30.0, 50.0)))
+    assert_equal("Alps", index.name(0))
+    assert_equal("Pyrenees", index.name(1))
+    assert_raise(IndexError) { index.name(2) }
+    index.close
+  end
+
+  def test_to_kml
+    build
+    index = FlightIndex.new(@path)
+    kml = index.to_kml(1)
+    assert_match(/<name>Pyrenees<\/name>/, kml)
+    assert_match(/<altitudeMode>absolute<\/altitudeMode>/, kml)
+    assert_equal(20, kml[/<coordinates>(.*?)<\/coordinates>/m, 1].split.length)
+    index.close
+  end
+
+  def test_failed_build_keeps_index
+    build
+    assert_raise(RuntimeError) do
+      FlightIndex.build(@path) do |builder|
+        builder.add("Other", flight(10.0, 10.0, 1.2e9))
+        raise "failed"
+      end
+    end
+    assert_equal(["index.memo", "index.rtree"], Dir.entries(@dir).reject { |entry| entry =~ /\A\./ }.sort)
+    index = FlightIndex.new(@path)
+    assert_equal(2, index.length)
+    assert_equal("Alps", index.name(0))
+    index.close
+  end
+
+end
@@ -0,0 +1,104 @@
+$:.unshift(File.join(File.dirname(__FILE__), "..", "lib"))
+require "fileutils"
+require "heatmap"
+require "igc"
+require "test/unit"
+require "tmpdir"
+
+class TC_Heatmap < Test::Unit::TestCase
+
+  Flight = Struct.new(:fixes, :bsignature, :fix_buffer)
+
+  def setup
+    @dir = Dir.mktmpdir
+  end
+
+  def teardown
+    FileUtils.rm_rf(@dir)
+  end
+
+  # A flight climbing at 2m/s in a straight line north from lat, lon in
+  # degrees
+  def igc(bsignature, lat, lon, n = 5)
+    fixes = Array.new(n) do |i|
+      IGC::Fix.new(Time.at(1000000000 + 10 * i).utc, Radians.new_from_deg(lat + 0.001 * i), Radians.new_from_deg(lon), 1000.0 + 20 * i)
+    end
+    Flight.new(fixes, bsignature, IGC::FixBuffer.new(fixes))
+  end
+
+  # A heatmap of 0.01 degree cells from 6E 45N to 12E 48N, which takes
+  # three levels of tiles
+  def heatmap
+    Heatmap.new(*[6.0, 45.0, 12.0, 48.0].collect { |deg| Radians.new_from_deg(deg) }.push(600, 300))
+  end
+
+  # Reads the entries named in the central directory
+  def read_zip(filename)
+    data = File.open(filename, "rb") { |io| io.read }
+    entries = {}
+    n, offset = data[-22, 22].unpack("@10vx4V")
+    n.times do
+      method, compressed_size, name_length, extra_length, comment_length, local_offset = data[offset, 46].unpack("@10vx8Vx4vvvx8V")
+      name = data[offset + 46, name_length]
+      local_name_length, local_extra_length = data[local_offset + 26, 4].unpack("vv")
+      compressed = data[local_offset + 30 + local_name_length + local_extra_length, compressed_size]
+      entries[name] = method == 8 ? Zlib::Inflate.new(-Zlib::MAX_WBITS).inflate(compressed) : compressed
+      offset += 46 + name_length + extra_length + comment_length
+    end
+    entries
+  end
+
+  def hrefs(kml)
+    kml.scan(/<href>(.*?)<\/href>/).flatten
+  end
+
+  def test_save_and_load
+    h = heatmap
+    assert_equal(2, h.add_igcs([igc("a", 47.95, 6.05), igc("b", 45.5, 11.5), igc("c", 46.0, 7.0, 0)]))
+    assert_equal(0, h.add_igcs([igc("a", 47.95, 6.05)]))
+    filename = File.join(@dir, "heatmap")
+    h.save(filename)
+    assert_equal(["heatmap"], Dir.entries(@dir).reject { |entry| entry =~ /\A\./ })
+    loaded = Heatmap.load(filename)
+    assert_equal(%w(a b), loaded.keys.keys.sort)
+    assert_equal(h.bounds, loaded.bounds)
+    assert_equal([600, 300], [loaded.width, loaded.height])
+    assert_equal([2, h.samples], [loaded.tracks, loaded.samples])
+    assert_equal(h.count(0, 0, 0, 600, 300), loaded.count(0, 0, 0, 600, 300))
+    assert_equal(h.to_rgba(0, 0, 0, 600, 300, 1.0), loaded.to_rgba(0, 0, 0, 600, 300, 1.0))
+    assert_equal(0, loaded.add_igcs([igc("b", 45.5, 11.5)]))
+  end
+
+  def test_single_overlay
+    h = heatmap
+    filename = File.join(@dir, "heatmap.kmz")
+    h.write_kmz(filename)
+    assert_equal(["doc.kml"], read_zip(filename).keys)
+    h.add_igcs([igc("a", 47.95, 6.05)])
+    h.write_kmz(filename, :name => "Climbs")
+    entries = read_zip(filename)
+    assert_equal(["doc.kml", "heatmap.png"], entries.keys.sort)
+    assert_match(/<name>Climbs<\/name>/, entries["doc.kml"])
+    assert_equal(["heatmap.png"], hrefs(entries["doc.kml"]))
+  end
+
+  def test_super_overlay
+    h = heatmap
+    assert_equal(2, h.top_level)
+    h.add_igcs([igc("a", 47.95, 6.05)])
+    filename = File.join(@dir, "heatmap.kmz")
+    h.write_kmz(filename, :super_overlay => true)
+    entries = read_zip(filename)
+    # Only the tiles over the climb are written
+    assert_equal(%w(doc.kml tiles/0_0_0.kml tiles/0_0_0.png tiles/1_0_0.kml tiles/1_0_0.png tiles/2_0_0.png), entries.keys.sort)
+    assert_equal(["tiles/2_0_0.png", "tiles/1_0_0.kml"], hrefs(entries["doc.kml"]))
+    assert_equal(["1_0_0.png", "0_0_0.kml"], hrefs(entries["tiles/1_0_0.kml"]))
+    assert_equal(["0_0_0.png"], hrefs(entries["tiles/0_0_0.kml"]))
+    entries.each do |name, contents|
+      next unless name =~ /\.kml\z/
+      directory = File.dirname(name) == "." ? "" : "#{File.dirname(name)}/"
+      hrefs(contents).each { |href| assert(entries.has_key?("#{directory}#{href}"), href) }
+    end
+  end
+
+end
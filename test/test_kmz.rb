@@ -0,0 +1,132 @@
+$:.unshift(File.join(File.dirname(__FILE__), "..", "lib"))
+require "igc"
+require "kmz"
+require "stringio"
+require "test/unit"
+
+class TC_KMZ < Test::Unit::TestCase
+
+  def setup
+    @coords = (0...5).collect do |i|
+      Coord.new(Radians.new_from_deg(45.0 + 0.001 * i), Radians.new_from_deg(-6.0 - 0.0015 * i), 1000.0 - 7.5 * i)
+    end
+    @fix_buffer = IGC::FixBuffer.new(@coords.collect { |coord| IGC::Fix.new(Time.at(0).utc, coord.lat, coord.lon, coord.alt) })
+  end
+
+  def placemarks(range)
+    range.collect { |i| KML::Placemark.new(:name => i, :Point => KML::Point.new(:coordinates => @coords[i])) }
+  end
+
+  def assert_written_equal(expected, actual)
+    expected_io, actual_io = StringIO.new, StringIO.new
+    expected.write(expected_io)
+    actual.write(actual_io)
+    assert_equal(expected_io.string, actual_io.string)
+  end
+
+  def test_coordinates
+    assert_written_equal(KML::Coordinates.new(*@coords), KML::Coordinates.new_from_fix_buffer(@fix_buffer))
+    assert_written_equal(KML::Coordinates.new(*@coords[1..3]), KML::Coordinates.new_from_fix_buffer(@fix_buffer, 1..3))
+    assert_written_equal(KML::Coordinates.new(*@coords[1...3]), KML::Coordinates.new_from_fix_buffer(@fix_buffer, 1...3))
+  end
+
+  def test_to_kml_coord
+    assert_equal("6.25,45.5,-3", Coord.new(Radians.new_from_deg(45.5), Radians.new_from_deg(6.25), -3.7).to_kml_coord)
+    assert_equal("-6.0015,45.001,992", @coords[1].to_kml_coord)
+    assert_equal("0,0,0", Coord.new(0.0, -1e-12, 0).to_kml_coord)
+  end
+
+  # Longitudes over a wide range of magnitudes, including halfway cases,
+  # are written as "%.6f" without its trailing zeros
+  def test_to_kml_coord_fuzz
+    srand(1)
+    degs = [8514655.6902775, 30323716.323077496, 0.0000005, 2.5e-7, 123456.0000005]
+    degs += Array.new(2000) { (rand(2).zero? ? 1 : -1) * 10.0 ** (24.0 * rand - 8.0) }
+    degs += Array.new(500) { |i| (rand(10 ** (3 + i % 12)) + 0.5) / 1.0e6 }
+    degs.each do |deg|
+      lon = deg * Math::PI / 180.0
+      expected = ("%.6f" % (lon * 180.0 / Math::PI)).sub(/0+\z/, "").chomp(".")
+      expected = "0" if expected == "-0"
+      assert_equal("#{expected},0,0", Coord.new(0.0, lon, 0).to_kml_coord, deg.to_s)
+    end
+  end
+
+  def test_segment_coordinates
+    values = [0.0, 0.1, 0.9, 1.0, 0.2].pack("d*")
+    segments = KML.segment_coordinates(@fix_buffer.lats, @fix_buffer.lons, @fix_buffer.alts, values, false, 0.0, 1.0, 2)
+    assert_equal([0, 1, 0], segments.collect { |step, text| step })
+    assert_equal([0..2, 2..4, 4..4].collect { |range| @coords[range].collect(&:to_kml_coord).join("\n") }, segments.collect { |step, text| text })
+    yielded = []
+    KML.segment_coordinates(@fix_buffer.lats, @fix_buffer.lons, @fix_buffer.alts, values, false, 0.0, 1.0, 2) { |step, text| yielded << [step, text] }
+    assert_equal(segments, yielded)
+  end
+
+  # As Scale#discretize, the integer range only divides integer values
+  def test_segment_coordinates_integral
+    values = [0.0, 4.0, 4.0, 7.0, 10.0].pack("d*")
+    steps = lambda do |integral, minimum, maximum|
+      KML.segment_coordinates(@fix_buffer.lats, @fix_buffer.lons, @fix_buffer.alts, values, integral, minimum, maximum, 4).collect { |step, text| step }
+    end
+    assert_equal([0, 2, 3], steps[false, 0, 10])
+    assert_equal([0, 1, 2, 3], steps[true, 0, 10])
+    assert_equal([0, 2, 3], steps[true, 0.0, 10.0])
+  end
+
+  def test_writer
+    folder = KML::Folder.new(:name => "Folder", :open => 1)
+    folder.add(*placemarks(0...3))
+    expected = StringIO.new
+    KML.new(KML::Document.new(folder)).pretty_write(expected)
+    actual = StringIO.new
+    writer = KML::Writer.new(actual)
+    writer.begin_kml
+    writer.begin_element(:Document)
+    writer.element(:Folder) do
+      writer.add(KML::Name.new("Folder"), KML::Open.new(1))
+      writer.add(KML::Generator.new { |w| w.add(*placemarks(0...3)) })
+    end
+    writer.close
+    assert_equal(expected.string, actual.string)
+  end
+
+  def test_generator
+    expected = KML::Folder.new(:name => "Folder").add(*placemarks(0...3))
+    actual = KML::Folder.new(:name => "Folder").add(KML::Generator.new { |writer| writer.add(*placemarks(0...3)) })
+    assert_written_equal(expected, actual)
+  end
+
+  def test_write
+    kmz = KMZ.new(KML::Folder.new(:name => "Folder"), :files => {"images/a.txt" => "a" * 1000, "b.bin" => "\x01\x02"})
+    kmz.merge_elements(KML::Generator.new { |writer| writer.add(*placemarks(0...5)) })
+    filename = File.join(File.dirname(__FILE__), "test_kmz.kmz")
+    begin
+      kmz.write(filename)
+      entries = read_zip(File.open(filename, "rb") { |io| io.read })
+      assert_equal(["doc.kml", "images/a.txt", "b.bin"].sort, entries.keys.sort)
+      assert_match(/\A<\?xml.*<Document>.*<name>4<\/name>.*<\/Document>\n<\/kml>\n\z/m, entries["doc.kml"])
+      assert_equal("a" * 1000, entries["images/a.txt"])
+      assert_equal("\x01\x02", entries["b.bin"])
+    ensure
+      File.unlink(filename) if File.exist?(filename)
+    end
+  end
+
+  # Reads the entries named in the central directory
+  def read_zip(data)
+    entries = {}
+    n, offset = data[-22, 22].unpack("@10vx4V")
+    n.times do
+      method, crc, compressed_size, size, name_length, extra_length, comment_length, local_offset = data[offset, 46].unpack("@10vx4VVVvvvx8V")
+      name = data[offset + 46, name_length]
+      local_name_length, local_extra_length = data[local_offset + 26, 4].unpack("vv")
+      compressed = data[local_offset + 30 + local_name_length + local_extra_length, compressed_size]
+      contents = method == 8 ? Zlib::Inflate.new(-Zlib::MAX_WBITS).inflate(compressed) : compressed
+      assert_equal(size, contents.length)
+      assert_equal(crc, Zlib.crc32(contents))
+      entries[name] = contents
+      offset += 46 + name_length + extra_length + comment_length
+    end
+    entries
+  end
+
+end